@@ -69,6 +69,8 @@ typedef struct {
 #define OPTION_CALLBACK(n, c) {.type = OPTION_TYPE_CALLBACK, .name = (n), .cb = (c)}
 
 int ParseOptions(int argc, char **argv, PerfOption *opt, SubCmd *cmd);
+int ParseOptionsOptCmd(int argc, char **argv, PerfOption *opts, SubCmd *cmd);
+int ParseOptionsNoCmd(int argc, char **argv, PerfOption *opts);
 int ParseEvents(const char *argv, PerfEventConfig *eventsCfg, unsigned int *len);
 int ParseIds(const char *argv, int *arr, unsigned int *len);
 
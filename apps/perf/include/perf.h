@@ -112,6 +112,45 @@ enum PerfSampleType {
     PERF_RECORD_PID       = 1U << 7, /* record current process id */
 };
 
+/*
+ * perf ring buffer record types, see los_perf.h
+ */
+enum PerfRecordType {
+    PERF_RECORD_TYPE_HDR = 1,   /* section header, always in cpu 0's ring */
+    PERF_RECORD_TYPE_SAMPLE,    /* one sample */
+    PERF_RECORD_TYPE_LOST,      /* payload is an unsigned int count of dropped samples */
+};
+
+/*
+ * perf ring buffer record header, records start at 4 bytes aligned offsets
+ */
+typedef struct {
+    unsigned short type;        /* enum PerfRecordType */
+    unsigned short size;        /* size of this header and the payload */
+} PerfRecordHdr;
+
+#define PERF_RECORD_ALIGN(size) (((size) + sizeof(unsigned int) - 1) & ~(sizeof(unsigned int) - 1))
+
+/*
+ * callback of PerfRingsConsume, gets the payload of one record, in two pieces if it wraps around the ring
+ */
+typedef int (*PerfRecordFn)(const char *data, unsigned int len, const char *more, unsigned int moreLen, void *arg);
+
+/*
+ * perf ring buffer control page, one per cpu followed by its data area
+ */
+typedef struct {
+    unsigned int version;               /* layout version */
+    unsigned int cpuid;                 /* cpu writing this ring */
+    unsigned int cpuNum;                /* number of rings */
+    unsigned int dataOffset;            /* offset of the data area to this page */
+    unsigned int dataSize;              /* size of the data area, power of 2 */
+    unsigned int wakeupMark;            /* PerfWait returns when so many bytes are ready */
+    volatile unsigned int dataHead;     /* written by kernel */
+    volatile unsigned int dataTail;     /* written by reader */
+    volatile unsigned int lost;         /* samples dropped since boot */
+} PerfMmapPage;
+
 /*
  * perf configuration sub event information
  *
@@ -152,6 +191,10 @@ int PerfConfig(int fd, PerfConfigAttr *attr);
 void PerfStart(int fd, size_t sectionId);
 void PerfStop(int fd);
 ssize_t PerfRead(int fd, char *buf, size_t size);
+void *PerfMmap(int fd, size_t *size);
+int PerfWait(int fd, unsigned int timeoutMs);
+int PerfRingsConsume(char *rings, size_t size, PerfRecordFn fn, void *arg, unsigned int *lost);
+void PerfRingsSkip(char *rings, size_t size);
 void PerfPrintBuffer(const char *buf, ssize_t num);
 
 #ifdef __cplusplus
@@ -32,6 +32,8 @@
 #ifndef _PERF_RECORD_H
 #define _PERF_RECORD_H
 
+#include "perf.h"
+
 #ifdef  __cplusplus
 #if  __cplusplus
 extern "C" {
@@ -39,6 +41,8 @@ extern "C" {
 #endif /* __cplusplus */
 
 void PerfRecord(int fd, int argc, char **argv);
+int PerfRecordAttrInit(PerfConfigAttr *recordAttr);
+ssize_t PerfWriteFile(const char *filePath, const char *buf, ssize_t bufSize);
 
 #ifdef __cplusplus
 #if __cplusplus
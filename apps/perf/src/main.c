@@ -40,6 +40,8 @@
 #include "perf_list.h"
 #include "perf_stat.h"
 #include "perf_record.h"
+#include "perf_offcpu.h"
+#include "perf_report.h"
 
 int main(int argc, char **argv)
 {
@@ -72,6 +74,12 @@ int main(int argc, char **argv)
         PerfStat(fd, argc, argv);
     } else if ((argc >= THREE_ARGS) && strcmp(argv[1], "record") == 0) {
         PerfRecord(fd, argc, argv);
+    } else if ((argc >= THREE_ARGS) && strcmp(argv[1], "offcpu") == 0) {
+        PerfOffCpu(argc, argv);
+    } else if ((argc >= TWO_ARGS) && strcmp(argv[1], "report") == 0) {
+        PerfReport(argc, argv);
+    } else if ((argc >= THREE_ARGS) && strcmp(argv[1], "top") == 0) {
+        PerfTop(fd, argc, argv);
     } else {
         printf("Unsupported perf command.\n");
         PerfUsage();
@@ -68,7 +68,8 @@ static int ParseOption(char **argv, int *index, PerfOption *opts)
     return -1;
 }
 
-int ParseOptions(int argc, char **argv, PerfOption *opts, SubCmd *cmd)
+/* like ParseOptions, but the command is optional and cmd->path stays NULL without one, e.g. perf stat -p */
+int ParseOptionsOptCmd(int argc, char **argv, PerfOption *opts, SubCmd *cmd)
 {
     int i;
     int index = 0;
@@ -80,13 +81,13 @@ int ParseOptions(int argc, char **argv, PerfOption *opts, SubCmd *cmd)
         index++;
     }
 
+    cmd->path = NULL;
     if ((index < argc) && (argv[index] != NULL)) {
         cmd->path = argv[index];
         cmd->params[0] = argv[index];
         index++;
     } else {
-        printf("no subcmd to execute\n");
-        return -1;
+        return 0;
     }
 
     for (i = 1; (index < argc) && (i < CMD_MAX_PARAMS); index++, i++) {
@@ -99,6 +100,33 @@ int ParseOptions(int argc, char **argv, PerfOption *opts, SubCmd *cmd)
     return 0;
 }
 
+int ParseOptions(int argc, char **argv, PerfOption *opts, SubCmd *cmd)
+{
+    if (ParseOptionsOptCmd(argc, argv, opts, cmd) != 0) {
+        return -1;
+    }
+    if (cmd->path == NULL) {
+        printf("no subcmd to execute\n");
+        return -1;
+    }
+    return 0;
+}
+
+/* parse options of the subcommands that run no command, e.g. perf report */
+int ParseOptionsNoCmd(int argc, char **argv, PerfOption *opts)
+{
+    int index = 0;
+
+    while ((index < argc) && (argv[index] != NULL)) {
+        if ((*argv[index] != '-') || (index + 1 >= argc) || (ParseOption(argv, &index, opts) != 0)) {
+            printf("invalid option %s\n", argv[index]);
+            return -1;
+        }
+        index++;
+    }
+    return 0;
+}
+
 int ParseIds(const char *argv, int *arr, unsigned int *len)
 {
     int res, ret;
@@ -157,6 +185,11 @@ int ParseEvents(const char *argv, PerfEventConfig *eventsCfg, unsigned int *len)
 
     sp = strtok_r(list, ",", &this);
     while (sp) {
+        if (index >= PERF_MAX_EVENT) {
+            printf("at most %d events\n", PERF_MAX_EVENT);
+            ret = -1;
+            goto EXIT;
+        }
         event = StrToEvent(sp);
         if (event == NULL) {
             ret = -1;
@@ -35,11 +35,14 @@
 #include <sys/ioctl.h>
 #include <fcntl.h>
 #include <unistd.h>
+#include <sys/mman.h>
 #include "perf.h"
 
 #define PERF_IOC_MAGIC     'T'
 #define PERF_START         _IO(PERF_IOC_MAGIC, 1)
 #define PERF_STOP          _IO(PERF_IOC_MAGIC, 2)
+#define PERF_WAIT          _IO(PERF_IOC_MAGIC, 3)
+#define PERF_MMAP_SIZE     _IO(PERF_IOC_MAGIC, 5)
 
 void PerfUsage(void)
 {
@@ -49,7 +52,8 @@ void PerfUsage(void)
     printf("\nUsage: ./perf list. List events to be used in -e.\n");
     printf("\nUsage: ./perf stat/record [option] <command>. \n"
                     "-e, event selector. use './perf list' to list available events.\n"
-                    "-p, event period.\n"
+                    "    hardware events beyond the pmu counters are multiplexed, perf stat scales their counts.\n"
+                    "-p, event period (record), process id to count (stat, <command> then optional).\n"
                     "-o, perf data output filename.\n"
                     "-t, taskId filter(allowlist), if not set perf will sample all tasks.\n"
                     "-s, type of data to sample defined in PerfSampleType los_perf.h.\n"
@@ -57,6 +61,22 @@ void PerfUsage(void)
                     "-d, whether to prescaler (once every 64 counts),"
                     "which only take effect on cpu cycle hardware event.\n"
     );
+    printf("\nUsage: ./perf offcpu [option] <command>. Record off-cpu call chains while command runs.\n"
+                    "-o, folded stacks output filename.\n"
+                    "-w, weight of each stack, 0: blocked time, 1: wakeup latency.\n"
+    );
+    printf("\nUsage: ./perf report [option]. Symbolize perf data, save folded stacks and show the hottest symbols.\n"
+                    "-i, perf data input filename.\n"
+                    "-o, folded stacks output filename.\n"
+                    "-k, kernel symbol table, default /etc/liteos.sym.\n"
+                    "-n, number of symbols to show.\n"
+    );
+    printf("\nUsage: ./perf top [option] <command>. Show the hottest symbols while command runs.\n"
+                    "-e, -p, -P, same as perf record.\n"
+                    "-k, kernel symbol table, default /etc/liteos.sym.\n"
+                    "-n, number of symbols to show.\n"
+                    "-r, refresh period in seconds.\n"
+    );
 }
 
 static void PerfSetPeriod(PerfConfigAttr *attr)
@@ -133,4 +153,87 @@ ssize_t PerfRead(int fd, char *buf, size_t size)
 
     len = read(fd, buf, size);
     return len;
-}
\ No newline at end of file
+}
+
+void *PerfMmap(int fd, size_t *size)
+{
+    void *rings = NULL;
+    int len = ioctl(fd, PERF_MMAP_SIZE, NULL);
+    if (len <= 0) {
+        return NULL;
+    }
+
+    rings = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (rings == MAP_FAILED) {
+        return NULL;
+    }
+    *size = len;
+    return rings;
+}
+
+int PerfWait(int fd, unsigned int timeoutMs)
+{
+    return ioctl(fd, PERF_WAIT, timeoutMs);
+}
+
+/*
+ * Pass the HDR and SAMPLE records of one mapped ring to fn, then release them to the kernel.
+ * A record that wraps around the end of the ring is passed in two pieces, more is NULL otherwise.
+ */
+static int PerfRingConsume(PerfMmapPage *page, PerfRecordFn fn, void *arg, unsigned int *lost)
+{
+    const char *data = (const char *)page + page->dataOffset;
+    unsigned int mask = page->dataSize - 1;
+    unsigned int head = page->dataHead;
+    unsigned int tail = page->dataTail;
+    unsigned int pos, len, first;
+    PerfRecordHdr hdr;
+    int ret = 0;
+
+    __sync_synchronize(); /* read the records after dataHead */
+    while ((tail != head) && (ret == 0)) {
+        hdr = *(const PerfRecordHdr *)(data + (tail & mask));
+        if (hdr.size < sizeof(PerfRecordHdr)) {
+            tail = head;
+            break;
+        }
+        pos = (tail + sizeof(PerfRecordHdr)) & mask;
+        len = hdr.size - sizeof(PerfRecordHdr);
+        if (hdr.type == PERF_RECORD_TYPE_LOST) {
+            *lost += *(const unsigned int *)(data + pos);
+        } else {
+            first = (page->dataSize - pos < len) ? (page->dataSize - pos) : len;
+            ret = fn(data + pos, first, (first < len) ? data : NULL, len - first, arg);
+        }
+        tail += PERF_RECORD_ALIGN(hdr.size);
+    }
+    __sync_synchronize(); /* finish reading before releasing the space */
+    page->dataTail = tail;
+    return ret;
+}
+
+int PerfRingsConsume(char *rings, size_t size, PerfRecordFn fn, void *arg, unsigned int *lost)
+{
+    PerfMmapPage *page = (PerfMmapPage *)rings;
+    size_t ringSize = page->dataOffset + page->dataSize;
+    size_t offset;
+
+    for (offset = 0; offset + ringSize <= size; offset += ringSize) {
+        if (PerfRingConsume((PerfMmapPage *)(rings + offset), fn, arg, lost) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+void PerfRingsSkip(char *rings, size_t size)
+{
+    PerfMmapPage *page = (PerfMmapPage *)rings;
+    size_t ringSize = page->dataOffset + page->dataSize;
+    size_t offset;
+
+    for (offset = 0; offset + ringSize <= size; offset += ringSize) {
+        page = (PerfMmapPage *)(rings + offset);
+        page->dataTail = page->dataHead;
+    }
+}
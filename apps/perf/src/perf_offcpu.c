@@ -0,0 +1,216 @@
+/*
+ * Copyright (c) 2013-2019 Huawei Technologies Co., Ltd. All rights reserved.
+ * Copyright (c) 2020-2021 Huawei Device Co., Ltd. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of
+ *    conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list
+ *    of conditions and the following disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used
+ *    to endorse or promote products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <unistd.h>
+#include <sys/wait.h>
+#include <securec.h>
+
+#ifdef LOSCFG_FS_VFS
+#include <fcntl.h>
+#include <errno.h>
+#endif
+
+#include "perf.h"
+#include "option.h"
+#include "perf_record.h"
+#include "perf_offcpu.h"
+
+#define OFFCPU_PROC_PATH    "/proc/offcpu"
+#define OFFCPU_READ_CHUNK   4096
+#define OFFCPU_WEIGHT_BLOCK 0
+#define OFFCPU_WEIGHT_WAKE  1
+
+static const char *g_offCpuSavePath = "/storage/data/offcpu.folded";
+static unsigned int g_offCpuWeight = OFFCPU_WEIGHT_BLOCK;
+
+static PerfOption g_offCpuOpts[] = {
+    OPTION_STRING("-o", &g_offCpuSavePath),
+    OPTION_UINT("-w", &g_offCpuWeight),
+    OPTION_END(),
+};
+
+#ifdef LOSCFG_FS_VFS
+static int OffCpuCtrl(const char *cmd)
+{
+    int ret;
+    int fd = open(OFFCPU_PROC_PATH, O_WRONLY);
+    if (fd < 0) {
+        printf("open %s failed, %s, is LOSCFG_KERNEL_OFFCPU enabled?\n", OFFCPU_PROC_PATH, strerror(errno));
+        return -1;
+    }
+
+    ret = write(fd, cmd, strlen(cmd) + 1);
+    (void)close(fd);
+    return (ret < 0) ? -1 : 0;
+}
+
+/* /proc/offcpu 是 seq 文件, 一次读不完, 读到 EOF 为止, 返回的缓冲区以 '\0' 结尾 */
+static char *OffCpuReadAll(void)
+{
+    size_t size = 0;
+    size_t cap = OFFCPU_READ_CHUNK;
+    ssize_t len;
+    char *tmp = NULL;
+    char *buf = (char *)malloc(cap);
+    int fd = open(OFFCPU_PROC_PATH, O_RDONLY);
+
+    if ((buf == NULL) || (fd < 0)) {
+        printf("read %s failed\n", OFFCPU_PROC_PATH);
+        free(buf);
+        if (fd >= 0) {
+            (void)close(fd);
+        }
+        return NULL;
+    }
+
+    while ((len = read(fd, buf + size, cap - size - 1)) > 0) {
+        size += len;
+        if (cap - size > 1) {
+            continue;
+        }
+        tmp = (char *)realloc(buf, cap * 2); /* 2: 空间不够就翻倍 */
+        if (tmp == NULL) {
+            break;
+        }
+        buf = tmp;
+        cap *= 2; /* 2: 空间不够就翻倍 */
+    }
+    (void)close(fd);
+    buf[size] = '\0';
+    return buf;
+}
+
+/*
+ * 把 /proc/offcpu 的内容转换成折叠栈, 每个槽位一行: "<stack> <weight>",
+ * 权重是阻塞时间或唤醒延迟的总和(us), 可以直接交给 flamegraph.pl
+ */
+static ssize_t OffCpuFold(char *in, char *out, size_t outSize)
+{
+    char *line = NULL;
+    char *save = NULL;
+    unsigned long long block = 0;
+    unsigned long long wake = 0;
+    size_t len = 0;
+    int ret;
+
+    for (line = strtok_r(in, "\n", &save); line != NULL; line = strtok_r(NULL, "\n", &save)) {
+        if (strncmp(line, "pid ", strlen("pid ")) == 0) {
+            if (sscanf_s(line, "pid %*u type %*s obj %*s count %*d block %llu block-max %*llu wake %llu",
+                         &block, &wake) != 2) { /* 2: block 和 wake 两个值 */
+                block = 0;
+                wake = 0;
+            }
+            continue;
+        }
+        while (*line == ' ') {
+            line++;
+        }
+        if (strncmp(line, "stack ", strlen("stack ")) != 0) {
+            continue;
+        }
+        ret = snprintf_s(out + len, outSize - len, outSize - len - 1, "%s %llu\n", line + strlen("stack "),
+                         (g_offCpuWeight == OFFCPU_WEIGHT_WAKE) ? wake : block);
+        if (ret < 0) {
+            break;
+        }
+        len += ret;
+    }
+    return (ssize_t)len;
+}
+
+void PerfOffCpu(int argc, char **argv)
+{
+    int ret;
+    int child;
+    char *in = NULL;
+    char *out = NULL;
+    size_t inLen;
+    ssize_t len;
+    SubCmd cmd = {0};
+
+    if (argc < 3) { /* perf offcpu argc is at least 3 */
+        return;
+    }
+
+    ret = ParseOptions(argc - 2, &argv[2], g_offCpuOpts, &cmd); /* parse option and cmd begin at index 2 */
+    if (ret != 0) {
+        printf("parse error\n");
+        return;
+    }
+
+    if ((OffCpuCtrl("reset") != 0) || (OffCpuCtrl("on") != 0)) {
+        return;
+    }
+
+    child = fork();
+    if (child < 0) {
+        printf("fork error\n");
+        (void)OffCpuCtrl("off");
+        return;
+    } else if (child == 0) {
+        (void)execve(cmd.path, cmd.params, NULL);
+        exit(0);
+    }
+
+    waitpid(child, 0, 0);
+    (void)OffCpuCtrl("off");
+
+    in = OffCpuReadAll();
+    if (in == NULL) {
+        return;
+    }
+    /* 折叠栈比原始输出短, 同样大小的缓冲区就够了 */
+    inLen = strlen(in);
+    out = (char *)malloc(inLen + 1);
+    if (out == NULL) {
+        printf("no memory for offcpu output\n");
+        free(in);
+        return;
+    }
+
+    len = OffCpuFold(in, out, inLen + 1);
+    ret = (len > 0) ? PerfWriteFile(g_offCpuSavePath, out, len) : -1;
+    if (ret == 0) {
+        printf("save offcpu stacks success at %s\n", g_offCpuSavePath);
+    } else {
+        printf("save offcpu stacks failed at %s\n", g_offCpuSavePath);
+    }
+    free(out);
+    free(in);
+}
+#else
+void PerfOffCpu(int argc, char **argv)
+{
+    (void)argc;
+    (void)argv;
+    printf("perf offcpu needs /proc, LOSCFG_FS_VFS is not enabled\n");
+}
+#endif
@@ -36,6 +36,7 @@
 #ifdef LOSCFG_FS_VFS
 #include <fcntl.h>
 #include <errno.h>
+#include <sys/mman.h>
 #endif
 
 #include "perf.h"
@@ -43,6 +44,7 @@
 #include "perf_record.h"
 
 #define PERF_FILE_MODE 0644
+#define PERF_WAIT_MS   100
 static PerfConfigAttr g_recordAttr;
 static const char *g_savePath = "/storage/data/perf.data";
 
@@ -71,7 +73,7 @@ static PerfOption g_recordOpts[] = {
     OPTION_UINT("-d", &g_recordAttr.eventsCfg.predivided),
 };
 
-static int PerfRecordAttrInit(void)
+int PerfRecordAttrInit(PerfConfigAttr *recordAttr)
 {
     PerfConfigAttr attr = {
         .eventsCfg = {
@@ -102,7 +104,7 @@ static int PerfRecordAttrInit(void)
         .sampleType = PERF_RECORD_IP | PERF_RECORD_CALLCHAIN,
     };
 
-    return memcpy_s(&g_recordAttr, sizeof(PerfConfigAttr), &attr, sizeof(PerfConfigAttr)) != EOK ? -1 : 0;
+    return memcpy_s(recordAttr, sizeof(PerfConfigAttr), &attr, sizeof(PerfConfigAttr)) != EOK ? -1 : 0;
 }
 
 ssize_t PerfWriteFile(const char *filePath, const char *buf, ssize_t bufSize)
@@ -144,6 +146,90 @@ ssize_t PerfWriteFile(const char *filePath, const char *buf, ssize_t bufSize)
 #endif
 }
 
+#ifdef LOSCFG_FS_VFS
+static int PerfWriteAll(int out, const char *buf, size_t len)
+{
+    while (len > 0) {
+        ssize_t ret = write(out, buf, len);
+        if (ret < 0) {
+            return -1;
+        }
+        buf += ret;
+        len -= ret;
+    }
+    return 0;
+}
+
+/* write one record straight from the mapping to the file */
+static int PerfWriteRecord(const char *data, unsigned int len, const char *more, unsigned int moreLen, void *arg)
+{
+    int out = *(int *)arg;
+    int ret = PerfWriteAll(out, data, len);
+
+    if ((ret == 0) && (more != NULL)) {
+        ret = PerfWriteAll(out, more, moreLen);
+    }
+    return ret;
+}
+
+/*
+ * Stream the per-cpu rings into the output file while the command runs, the rings are mapped so samples
+ * are written to the file without copying them through read(). Return -1 if the rings can not be mapped.
+ */
+static int PerfRecordStream(int fd, const SubCmd *cmd)
+{
+    int child;
+    int out;
+    int ret;
+    size_t size = 0;
+    unsigned int lost = 0;
+    char *rings = (char *)PerfMmap(fd, &size);
+
+    if (rings == NULL) {
+        return -1;
+    }
+    out = open(g_savePath, O_CREAT | O_RDWR | O_TRUNC, PERF_FILE_MODE);
+    if (out < 0) {
+        printf("create file [%s] failed, %s!\n", g_savePath, strerror(errno));
+        (void)munmap(rings, size);
+        return 0;
+    }
+    PerfRingsSkip(rings, size); /* drop samples left from an earlier session */
+
+    PerfStart(fd, 0);
+    child = fork();
+    if (child < 0) {
+        printf("fork error\n");
+        PerfStop(fd);
+        goto EXIT;
+    } else if (child == 0) {
+        (void)execve(cmd->path, cmd->params, NULL);
+        exit(0);
+    }
+
+    ret = 0;
+    while ((ret == 0) && (waitpid(child, NULL, WNOHANG) == 0)) {
+        (void)PerfWait(fd, PERF_WAIT_MS);
+        ret = PerfRingsConsume(rings, size, PerfWriteRecord, &out, &lost);
+    }
+    if (ret != 0) {
+        (void)waitpid(child, NULL, 0);
+    }
+    PerfStop(fd);
+    ret |= PerfRingsConsume(rings, size, PerfWriteRecord, &out, &lost);
+    (void)fsync(out);
+    if (ret == 0) {
+        printf("save perf data success at %s, %u samples lost\n", g_savePath, lost);
+    } else {
+        printf("save perf data failed at %s, %s\n", g_savePath, strerror(errno));
+    }
+EXIT:
+    (void)close(out);
+    (void)munmap(rings, size);
+    return 0;
+}
+#endif
+
 void PerfRecord(int fd, int argc, char **argv)
 {
     int ret;
@@ -156,7 +242,7 @@ void PerfRecord(int fd, int argc, char **argv)
         return;
     }
 
-    ret = PerfRecordAttrInit();
+    ret = PerfRecordAttrInit(&g_recordAttr);
     if (ret != 0) {
         printf("perf record attr init failed\n");
         return;
@@ -174,6 +260,12 @@ void PerfRecord(int fd, int argc, char **argv)
         return;
     }
 
+#ifdef LOSCFG_FS_VFS
+    if (PerfRecordStream(fd, &cmd) == 0) {
+        return;
+    }
+#endif
+
     PerfStart(fd, 0);
     child = fork();
     if (child < 0) {
@@ -0,0 +1,569 @@
+/*
+ * Copyright (c) 2013-2019 Huawei Technologies Co., Ltd. All rights reserved.
+ * Copyright (c) 2020-2021 Huawei Device Co., Ltd. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of
+ *    conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list
+ *    of conditions and the following disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used
+ *    to endorse or promote products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <sys/mman.h>
+#include <securec.h>
+
+#ifdef LOSCFG_FS_VFS
+#include <fcntl.h>
+#include <errno.h>
+#include <sys/stat.h>
+#endif
+
+#include "perf.h"
+#include "option.h"
+#include "perf_record.h"
+#include "perf_symbol.h"
+#include "perf_report.h"
+
+#define PERF_DATA_MAGIC_WORD        0xEFEFEF00  /* see los_perf_pri.h */
+#define PERF_MAX_CALLCHAIN_DEPTH    10          /* see los_perf_pri.h */
+#define PERF_PATH_MAX               32          /* REGION_PATH_MAX, see los_exc_pri.h */
+#define PERF_FRAME_MAX              96
+#define PERF_STACK_MAX              ((PERF_MAX_CALLCHAIN_DEPTH + 2) * PERF_FRAME_MAX) /* 2: pid and pc */
+#define PERF_SAMPLE_MAX             1024        /* bigger than any sample record */
+#define PERF_COUNT_BUCKETS          1024
+#define PERF_TOP_NR                 20
+#define PERF_TOP_REFRESH            1           /* seconds */
+#define PERF_TOP_WAIT_MS            100
+#define PERF_PERCENT                100.0
+
+/*
+ * perf data file section header, same as PerfDataHdr in los_perf_pri.h
+ */
+typedef struct {
+    unsigned int magic;
+    unsigned int eventType;
+    unsigned int len;
+    unsigned int sampleType;
+    unsigned int sectionId;
+} PerfFileHdr;
+
+typedef struct {
+    unsigned int ip;                /* kernel address, or offset to the text base of path */
+    char path[PERF_PATH_MAX];       /* "kernel" or the file the ip belongs to */
+} PerfIp;
+
+typedef struct {
+    unsigned int taskId;
+    unsigned int processId;
+    PerfIp pc;
+    unsigned int ipNr;
+    PerfIp callChain[PERF_MAX_CALLCHAIN_DEPTH];   /* innermost caller first */
+} PerfSample;
+
+typedef struct PerfCount {
+    struct PerfCount *next;
+    unsigned int count;
+    char key[];
+} PerfCount;
+
+typedef struct {
+    PerfCount *buckets[PERF_COUNT_BUCKETS];
+    unsigned int nr;        /* distinct keys */
+    unsigned int total;     /* sum of counts */
+} PerfCountMap;
+
+static const char *g_reportInput = "/storage/data/perf.data";
+static const char *g_reportOutput = "/storage/data/perf.folded";
+static const char *g_ksymPath = PERF_KSYM_PATH;
+static unsigned int g_topNr = PERF_TOP_NR;
+static unsigned int g_topRefresh = PERF_TOP_REFRESH;
+static PerfConfigAttr g_topAttr;
+static PerfCountMap g_stackCounts;
+static PerfCountMap g_symCounts;
+
+static inline int GetTopEvents(const char *argv)
+{
+    return ParseEvents(argv, &g_topAttr.eventsCfg, &g_topAttr.eventsCfg.eventsNr);
+}
+
+static inline int GetTopPids(const char *argv)
+{
+    return ParseIds(argv, (int *)g_topAttr.processIds, &g_topAttr.processIdsNr);
+}
+
+static PerfOption g_reportOpts[] = {
+    OPTION_STRING("-i", &g_reportInput),
+    OPTION_STRING("-o", &g_reportOutput),
+    OPTION_STRING("-k", &g_ksymPath),
+    OPTION_UINT("-n", &g_topNr),
+    OPTION_END(),
+};
+
+static PerfOption g_topOpts[] = {
+    OPTION_CALLBACK("-e", GetTopEvents),
+    OPTION_CALLBACK("-P", GetTopPids),
+    OPTION_UINT("-p", &g_topAttr.eventsCfg.events[0].period),
+    OPTION_STRING("-k", &g_ksymPath),
+    OPTION_UINT("-n", &g_topNr),
+    OPTION_UINT("-r", &g_topRefresh),
+    OPTION_END(),
+};
+
+static unsigned int PerfHash(const char *key)
+{
+    unsigned int hash = 2166136261U; /* FNV-1a offset basis */
+
+    while (*key != '\0') {
+        hash = (hash ^ (unsigned char)*key++) * 16777619U; /* FNV-1a prime */
+    }
+    return hash;
+}
+
+static int PerfCountAdd(PerfCountMap *map, const char *key, unsigned int count)
+{
+    unsigned int index = PerfHash(key) % PERF_COUNT_BUCKETS;
+    size_t len = strlen(key) + 1;
+    PerfCount *node = map->buckets[index];
+
+    for (; node != NULL; node = node->next) {
+        if (strcmp(node->key, key) == 0) {
+            node->count += count;
+            map->total += count;
+            return 0;
+        }
+    }
+
+    node = (PerfCount *)malloc(sizeof(PerfCount) + len);
+    if (node == NULL) {
+        return -1;
+    }
+    (void)memcpy_s(node->key, len, key, len);
+    node->count = count;
+    node->next = map->buckets[index];
+    map->buckets[index] = node;
+    map->nr++;
+    map->total += count;
+    return 0;
+}
+
+static void PerfCountClear(PerfCountMap *map)
+{
+    PerfCount *node = NULL;
+    unsigned int i;
+
+    for (i = 0; i < PERF_COUNT_BUCKETS; i++) {
+        while (map->buckets[i] != NULL) {
+            node = map->buckets[i];
+            map->buckets[i] = node->next;
+            free(node);
+        }
+    }
+    map->nr = 0;
+    map->total = 0;
+}
+
+static int PerfCountCmp(const void *a, const void *b)
+{
+    const PerfCount *x = *(const PerfCount * const *)a;
+    const PerfCount *y = *(const PerfCount * const *)b;
+
+    if (x->count != y->count) {
+        return (x->count > y->count) ? -1 : 1;
+    }
+    return strcmp(x->key, y->key);
+}
+
+/* print the topNr keys with the most counts */
+static void PerfCountShow(const PerfCountMap *map, unsigned int topNr)
+{
+    PerfCount **sorted = NULL;
+    PerfCount *node = NULL;
+    unsigned int i;
+    unsigned int nr = 0;
+
+    if (map->nr == 0) {
+        printf("no samples\n");
+        return;
+    }
+    sorted = (PerfCount **)malloc(map->nr * sizeof(PerfCount *));
+    if (sorted == NULL) {
+        printf("no memory for sorting %u symbols\n", map->nr);
+        return;
+    }
+    for (i = 0; i < PERF_COUNT_BUCKETS; i++) {
+        for (node = map->buckets[i]; node != NULL; node = node->next) {
+            sorted[nr++] = node;
+        }
+    }
+    qsort(sorted, nr, sizeof(PerfCount *), PerfCountCmp);
+
+    printf("%9s %9s  %s\n", "overhead", "samples", "symbol");
+    for (i = 0; (i < nr) && (i < topNr); i++) {
+        printf("%8.2f%% %9u  %s\n", sorted[i]->count * PERF_PERCENT / map->total, sorted[i]->count, sorted[i]->key);
+    }
+    free(sorted);
+}
+
+static int PerfGetU32(const char **pos, const char *end, unsigned int *value)
+{
+    if ((size_t)(end - *pos) < sizeof(unsigned int)) {
+        return -1;
+    }
+    (void)memcpy_s(value, sizeof(unsigned int), *pos, sizeof(unsigned int)); /* fields are not always aligned */
+    *pos += sizeof(unsigned int);
+    return 0;
+}
+
+/* an ip is saved as the ip, the aligned path length and the path, see OsPerfSaveIpInfo */
+static int PerfGetIp(const char **pos, const char *end, PerfIp *ip)
+{
+    unsigned int len = 0;
+    unsigned int copy;
+
+    if ((PerfGetU32(pos, end, &ip->ip) != 0) || (PerfGetU32(pos, end, &len) != 0) ||
+        ((size_t)(end - *pos) < len)) {
+        return -1;
+    }
+    copy = (len < PERF_PATH_MAX - 1) ? len : (PERF_PATH_MAX - 1);
+    (void)memcpy_s(ip->path, PERF_PATH_MAX, *pos, copy);
+    ip->path[copy] = '\0';
+    *pos += len;
+    return 0;
+}
+
+/* parse the sample at buf, fields are in the order of OsPerfCollectData. Return its length, 0 if truncated */
+static unsigned int PerfSampleParse(const char *buf, unsigned int len, unsigned int sampleType, PerfSample *sample)
+{
+    const char *pos = buf;
+    const char *end = buf + len;
+    unsigned int value;
+    unsigned int i;
+
+    (void)memset_s(sample, sizeof(PerfSample), 0, sizeof(PerfSample));
+    if (((sampleType & PERF_RECORD_CPU) && (PerfGetU32(&pos, end, &value) != 0)) ||
+        ((sampleType & PERF_RECORD_TID) && (PerfGetU32(&pos, end, &sample->taskId) != 0)) ||
+        ((sampleType & PERF_RECORD_PID) && (PerfGetU32(&pos, end, &sample->processId) != 0)) ||
+        ((sampleType & PERF_RECORD_TYPE) && (PerfGetU32(&pos, end, &value) != 0)) ||
+        ((sampleType & PERF_RECORD_PERIOD) && (PerfGetU32(&pos, end, &value) != 0))) {
+        return 0;
+    }
+    if ((sampleType & PERF_RECORD_TIMESTAMP) &&
+        ((PerfGetU32(&pos, end, &value) != 0) || (PerfGetU32(&pos, end, &value) != 0))) { /* 64 bits timestamp */
+        return 0;
+    }
+    if ((sampleType & PERF_RECORD_IP) && (PerfGetIp(&pos, end, &sample->pc) != 0)) {
+        return 0;
+    }
+    if (sampleType & PERF_RECORD_CALLCHAIN) {
+        if ((PerfGetU32(&pos, end, &sample->ipNr) != 0) || (sample->ipNr > PERF_MAX_CALLCHAIN_DEPTH)) {
+            return 0;
+        }
+        for (i = 0; i < sample->ipNr; i++) {
+            if (PerfGetIp(&pos, end, &sample->callChain[i]) != 0) {
+                return 0;
+            }
+        }
+    }
+    return (unsigned int)(pos - buf);
+}
+
+/* name of one frame: the symbol, "file+offset" for user ips without symbols, or the raw kernel address */
+static void PerfFrameName(const PerfIp *ip, char *buf, size_t size)
+{
+    unsigned int offset = 0;
+    const char *name = PerfSymResolve(ip->path, ip->ip, &offset);
+    const char *file = strrchr(ip->path, '/');
+    int ret;
+
+    if (name != NULL) {
+        ret = snprintf_s(buf, size, size - 1, "%s", name);
+    } else if (file != NULL) {
+        ret = snprintf_s(buf, size, size - 1, "%s+0x%x", file + 1, ip->ip);
+    } else {
+        ret = snprintf_s(buf, size, size - 1, "0x%x", ip->ip);
+    }
+    if (ret < 0) {
+        buf[0] = '\0';
+    }
+}
+
+/* fold one sample to "pid-N;outermost;...;innermost;pc", root first as flamegraph.pl expects */
+static void PerfSampleFold(const PerfSample *sample, unsigned int sampleType, char *buf, size_t size)
+{
+    char frame[PERF_FRAME_MAX];
+    size_t len = 0;
+    unsigned int i;
+    int ret = 0;
+
+    buf[0] = '\0';
+    if (sampleType & PERF_RECORD_PID) {
+        ret = snprintf_s(buf, size, size - 1, "pid-%u;", sample->processId);
+        len = (ret > 0) ? ret : 0;
+    }
+    for (i = sample->ipNr; (i > 0) && (ret >= 0); i--) {
+        PerfFrameName(&sample->callChain[i - 1], frame, sizeof(frame));
+        ret = snprintf_s(buf + len, size - len, size - len - 1, "%s;", frame);
+        len += (ret > 0) ? ret : 0;
+    }
+    if ((sampleType & PERF_RECORD_IP) && (ret >= 0)) {
+        PerfFrameName(&sample->pc, frame, sizeof(frame));
+        ret = snprintf_s(buf + len, size - len, size - len - 1, "%s;", frame);
+        len += (ret > 0) ? ret : 0;
+    }
+    if ((len > 0) && (buf[len - 1] == ';')) {
+        buf[len - 1] = '\0';
+    }
+}
+
+#ifdef LOSCFG_FS_VFS
+static char *PerfReadData(const char *path, size_t *size)
+{
+    struct stat st;
+    char *buf = NULL;
+    int fd = open(path, O_RDONLY);
+
+    if (fd < 0) {
+        printf("open %s failed, %s\n", path, strerror(errno));
+        return NULL;
+    }
+    if ((fstat(fd, &st) != 0) || (st.st_size == 0)) {
+        printf("%s is empty\n", path);
+        (void)close(fd);
+        return NULL;
+    }
+    buf = (char *)malloc(st.st_size);
+    if ((buf != NULL) && (read(fd, buf, st.st_size) != st.st_size)) {
+        printf("read %s failed\n", path);
+        free(buf);
+        buf = NULL;
+    }
+    (void)close(fd);
+    *size = st.st_size;
+    return buf;
+}
+
+/* count folded stacks and pc symbols of all samples, a file may hold several sections each with its header */
+static unsigned int PerfReportParse(const char *data, size_t size)
+{
+    PerfFileHdr hdr = {0};
+    PerfSample sample;
+    char stack[PERF_STACK_MAX];
+    char frame[PERF_FRAME_MAX];
+    size_t pos = 0;
+    unsigned int len;
+    unsigned int nr = 0;
+
+    while (size - pos >= sizeof(unsigned int)) {
+        if ((size - pos >= sizeof(PerfFileHdr)) && (*(const unsigned int *)(data + pos) == PERF_DATA_MAGIC_WORD)) {
+            (void)memcpy_s(&hdr, sizeof(hdr), data + pos, sizeof(hdr));
+            pos += sizeof(PerfFileHdr);
+            continue;
+        }
+        if (hdr.magic != PERF_DATA_MAGIC_WORD) {
+            printf("%s is not a perf data file\n", g_reportInput);
+            break;
+        }
+        len = PerfSampleParse(data + pos, size - pos, hdr.sampleType, &sample);
+        if (len == 0) {
+            break;
+        }
+        pos += len;
+        nr++;
+
+        PerfSampleFold(&sample, hdr.sampleType, stack, sizeof(stack));
+        if (stack[0] != '\0') {
+            (void)PerfCountAdd(&g_stackCounts, stack, 1);
+        }
+        if (hdr.sampleType & PERF_RECORD_IP) {
+            PerfFrameName(&sample.pc, frame, sizeof(frame));
+            (void)PerfCountAdd(&g_symCounts, frame, 1);
+        }
+    }
+    return nr;
+}
+
+static int PerfWriteFolded(const char *path, const PerfCountMap *map)
+{
+    const PerfCount *node = NULL;
+    unsigned int i;
+    FILE *out = fopen(path, "w");
+
+    if (out == NULL) {
+        printf("create file [%s] failed, %s!\n", path, strerror(errno));
+        return -1;
+    }
+    for (i = 0; i < PERF_COUNT_BUCKETS; i++) {
+        for (node = map->buckets[i]; node != NULL; node = node->next) {
+            (void)fprintf(out, "%s %u\n", node->key, node->count);
+        }
+    }
+    (void)fclose(out);
+    return 0;
+}
+#endif
+
+void PerfReport(int argc, char **argv)
+{
+#ifdef LOSCFG_FS_VFS
+    char *data = NULL;
+    size_t size = 0;
+    unsigned int nr;
+
+    if (ParseOptionsNoCmd(argc - 2, &argv[2], g_reportOpts) != 0) { /* parse option begin at index 2 */
+        printf("parse error\n");
+        return;
+    }
+
+    data = PerfReadData(g_reportInput, &size);
+    if (data == NULL) {
+        return;
+    }
+    if (PerfSymKernelLoad(g_ksymPath) != 0) {
+        printf("no kernel symbols at %s, kernel ips are shown as addresses\n", g_ksymPath);
+    }
+
+    nr = PerfReportParse(data, size);
+    free(data);
+    if ((g_stackCounts.nr > 0) && (PerfWriteFolded(g_reportOutput, &g_stackCounts) == 0)) {
+        printf("save %u folded stacks of %u samples at %s\n", g_stackCounts.nr, nr, g_reportOutput);
+    }
+    PerfCountShow(&g_symCounts, g_topNr);
+
+    PerfCountClear(&g_stackCounts);
+    PerfCountClear(&g_symCounts);
+    PerfSymRelease();
+#else
+    (void)argc;
+    (void)argv;
+    printf("perf report needs LOSCFG_FS_VFS\n");
+#endif
+}
+
+/* count the pc symbol of one sample, a record wrapping around the ring is joined first */
+static int PerfTopRecord(const char *data, unsigned int len, const char *more, unsigned int moreLen, void *arg)
+{
+    char buf[PERF_SAMPLE_MAX];
+    char frame[PERF_FRAME_MAX];
+    unsigned int sampleType = *(unsigned int *)arg;
+    unsigned int magic = 0;
+    PerfSample sample;
+
+    if (more != NULL) {
+        if ((len + moreLen > sizeof(buf)) || (memcpy_s(buf, sizeof(buf), data, len) != EOK) ||
+            (memcpy_s(buf + len, sizeof(buf) - len, more, moreLen) != EOK)) {
+            return 0;
+        }
+        data = buf;
+        len += moreLen;
+    }
+
+    if ((len >= sizeof(magic)) && (memcpy_s(&magic, sizeof(magic), data, sizeof(magic)) == EOK) &&
+        (magic == PERF_DATA_MAGIC_WORD)) { /* section header */
+        return 0;
+    }
+    if (PerfSampleParse(data, len, sampleType, &sample) != 0) {
+        PerfFrameName(&sample.pc, frame, sizeof(frame));
+        (void)PerfCountAdd(&g_symCounts, frame, 1);
+    }
+    return 0;
+}
+
+static void PerfTopShow(unsigned int lost)
+{
+    printf("\033[H\033[J"); /* move the cursor home and clear the screen */
+    printf("perf top: %u samples, %u lost, refresh every %us\n\n", g_symCounts.total, lost, g_topRefresh);
+    PerfCountShow(&g_symCounts, g_topNr);
+    (void)fflush(stdout);
+    PerfCountClear(&g_symCounts);
+}
+
+/*
+ * Sample the pc while the command runs and show the hottest symbols of every refresh period,
+ * samples are read from the mapped rings so the screen is updated without stopping perf.
+ */
+void PerfTop(int fd, int argc, char **argv)
+{
+    int child;
+    char *rings = NULL;
+    size_t size = 0;
+    unsigned int lost = 0;
+    time_t last;
+    SubCmd cmd = {0};
+
+    if ((argc < 3) || (PerfRecordAttrInit(&g_topAttr) != 0)) { /* perf top argc is at least 3 */
+        return;
+    }
+    g_topAttr.sampleType = PERF_RECORD_IP;
+
+    if (ParseOptions(argc - 2, &argv[2], g_topOpts, &cmd) != 0) { /* parse option and cmd begin at index 2 */
+        printf("parse error\n");
+        return;
+    }
+    if (g_topRefresh == 0) {
+        g_topRefresh = PERF_TOP_REFRESH;
+    }
+    if (PerfConfig(fd, &g_topAttr) != 0) {
+        printf("perf config failed\n");
+        return;
+    }
+
+    rings = (char *)PerfMmap(fd, &size);
+    if (rings == NULL) {
+        printf("perf top needs the mapped perf rings\n");
+        return;
+    }
+    (void)PerfSymKernelLoad(g_ksymPath);
+    PerfRingsSkip(rings, size);
+
+    PerfStart(fd, 0);
+    child = fork();
+    if (child < 0) {
+        printf("fork error\n");
+        PerfStop(fd);
+        goto EXIT;
+    } else if (child == 0) {
+        (void)execve(cmd.path, cmd.params, NULL);
+        exit(0);
+    }
+
+    last = time(NULL);
+    while (waitpid(child, NULL, WNOHANG) == 0) {
+        (void)PerfWait(fd, PERF_TOP_WAIT_MS);
+        (void)PerfRingsConsume(rings, size, PerfTopRecord, &g_topAttr.sampleType, &lost);
+        if (time(NULL) - last >= (time_t)g_topRefresh) {
+            PerfTopShow(lost);
+            last = time(NULL);
+        }
+    }
+    PerfStop(fd);
+    (void)PerfRingsConsume(rings, size, PerfTopRecord, &g_topAttr.sampleType, &lost);
+    PerfTopShow(lost);
+
+EXIT:
+    (void)munmap(rings, size);
+    PerfSymRelease();
+}
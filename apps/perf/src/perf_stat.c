@@ -30,13 +30,18 @@
  */
 
 #include <unistd.h>
+#include <signal.h>
 #include <securec.h>
 #include <sys/wait.h>
 #include "perf.h"
 #include "option.h"
 #include "perf_stat.h"
 
+#define PERF_STAT_POLL_US 100000
+
 static PerfConfigAttr g_statAttr;
+static unsigned int g_statPid;
+static volatile sig_atomic_t g_statStop;
 
 static inline int GetEvents(const char *argv)
 {
@@ -57,9 +62,10 @@ static PerfOption g_statOpts[] = {
     OPTION_CALLBACK("-e", GetEvents),
     OPTION_CALLBACK("-t", GetTids),
     OPTION_CALLBACK("-P", GetPids),
-    OPTION_UINT("-p", &g_statAttr.eventsCfg.events[0].period),
+    OPTION_UINT("-p", &g_statPid),
     OPTION_UINT("-s", &g_statAttr.sampleType),
     OPTION_UINT("-d", &g_statAttr.eventsCfg.predivided),
+    OPTION_END(),
 };
 
 static int PerfStatAttrInit(void)
@@ -104,6 +110,24 @@ static int PerfStatAttrInit(void)
     return memcpy_s(&g_statAttr, sizeof(PerfConfigAttr), &attr, sizeof(PerfConfigAttr)) != EOK ? -1 : 0;
 }
 
+static void PerfStatSigHandler(int sig)
+{
+    (void)sig;
+    g_statStop = 1;
+}
+
+/* counting an existing process: it is not our child, so poll until it exits or we are interrupted */
+static void PerfStatWaitPid(unsigned int pid)
+{
+    void (*oldHandler)(int) = signal(SIGINT, PerfStatSigHandler);
+
+    g_statStop = 0;
+    while (!g_statStop && (kill((pid_t)pid, 0) == 0)) {
+        (void)usleep(PERF_STAT_POLL_US);
+    }
+    (void)signal(SIGINT, oldHandler);
+}
+
 void PerfStat(int fd, int argc, char **argv)
 {
     int ret;
@@ -120,12 +144,22 @@ void PerfStat(int fd, int argc, char **argv)
         return;
     }
 
-    ret = ParseOptions(argc - 2, &argv[2], g_statOpts, &cmd); /* parse option and cmd begin at index 2 */
-    if (ret != 0) {
+    g_statPid = 0;
+    ret = ParseOptionsOptCmd(argc - 2, &argv[2], g_statOpts, &cmd); /* parse option and cmd begin at index 2 */
+    if ((ret != 0) || ((cmd.path == NULL) && (g_statPid == 0))) {
         printf("parse error\n");
         return;
     }
 
+    if (g_statPid != 0) { /* the kernel then counts only while this process runs */
+        if (kill((pid_t)g_statPid, 0) != 0) {
+            printf("process %u not found\n", g_statPid);
+            return;
+        }
+        g_statAttr.processIds[0] = g_statPid;
+        g_statAttr.processIdsNr = 1;
+    }
+
     ret = PerfConfig(fd, &g_statAttr);
     if (ret != 0) {
         printf("perf config failed\n");
@@ -133,6 +167,11 @@ void PerfStat(int fd, int argc, char **argv)
     }
 
     PerfStart(fd, 0);
+    if (cmd.path == NULL) {
+        PerfStatWaitPid(g_statPid);
+        goto EXIT;
+    }
+
     child = fork();
     if (child < 0) {
         printf("fork error\n");
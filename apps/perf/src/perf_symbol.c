@@ -0,0 +1,288 @@
+/*
+ * Copyright (c) 2013-2019 Huawei Technologies Co., Ltd. All rights reserved.
+ * Copyright (c) 2020-2021 Huawei Device Co., Ltd. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of
+ *    conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list
+ *    of conditions and the following disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used
+ *    to endorse or promote products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <elf.h>
+#include <sys/stat.h>
+#include <securec.h>
+#include "perf_symbol.h"
+
+#define PERF_SYM_ADDR_MASK  (~1U) /* thumb functions have bit 0 set in st_value */
+
+typedef struct {
+    unsigned int addr;
+    unsigned int size;
+    const char *name;
+} PerfSym;
+
+/*
+ * symbols of one image sorted by address, a file which can not be loaded keeps
+ * an empty table so it is not read again for every sample
+ */
+typedef struct PerfSymTable {
+    struct PerfSymTable *next;
+    char *path;
+    char *strs;         /* names point into this buffer */
+    PerfSym *syms;
+    unsigned int nr;
+} PerfSymTable;
+
+static PerfSymTable g_kernelSyms;
+static PerfSymTable *g_elfSyms = NULL;
+
+static int PerfSymCmp(const void *a, const void *b)
+{
+    const PerfSym *x = (const PerfSym *)a;
+    const PerfSym *y = (const PerfSym *)b;
+
+    if (x->addr != y->addr) {
+        return (x->addr < y->addr) ? -1 : 1;
+    }
+    return 0;
+}
+
+static char *PerfReadAt(int fd, unsigned int offset, unsigned int size)
+{
+    char *buf = (char *)malloc(size + 1);
+
+    if (buf == NULL) {
+        return NULL;
+    }
+    if (pread(fd, buf, size, offset) != (ssize_t)size) {
+        free(buf);
+        return NULL;
+    }
+    buf[size] = '\0';
+    return buf;
+}
+
+int PerfSymKernelLoad(const char *path)
+{
+    char *line = NULL;
+    char *save = NULL;
+    char *end = NULL;
+    unsigned int nr = 0;
+    unsigned int cap = 0;
+    PerfSym *tmp = NULL;
+    struct stat st;
+    int fd;
+
+    fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return -1;
+    }
+    if ((fstat(fd, &st) != 0) || (st.st_size == 0) ||
+        ((g_kernelSyms.strs = PerfReadAt(fd, 0, st.st_size)) == NULL)) {
+        (void)close(fd);
+        return -1;
+    }
+    (void)close(fd);
+
+    for (line = strtok_r(g_kernelSyms.strs, "\n", &save); line != NULL; line = strtok_r(NULL, "\n", &save)) {
+        if (nr == cap) {
+            cap = (cap == 0) ? 1024 : cap * 2; /* 1024: initial capacity, 2: doubled when full */
+            tmp = (PerfSym *)realloc(g_kernelSyms.syms, cap * sizeof(PerfSym));
+            if (tmp == NULL) {
+                break;
+            }
+            g_kernelSyms.syms = tmp;
+        }
+        g_kernelSyms.syms[nr].addr = strtoul(line, &end, 16);   /* 16: hex */
+        g_kernelSyms.syms[nr].size = strtoul(end, &end, 16);    /* 16: hex */
+        while (*end == ' ') {
+            end++;
+        }
+        if (*end == '\0') {
+            continue;
+        }
+        g_kernelSyms.syms[nr].name = end;
+        nr++;
+    }
+    g_kernelSyms.nr = nr;
+    qsort(g_kernelSyms.syms, nr, sizeof(PerfSym), PerfSymCmp);
+    return 0;
+}
+
+/*
+ * Read the function symbols of an ELF file, .symtab if the file is not stripped or .dynsym.
+ * The recorded user ips are offsets to the first mapping of the file, which is the ELF vaddr
+ * itself for PIE and shared objects (first segment at 0) and for fixed address executables
+ * (the kernel reports absolute addresses for them), so st_value is compared with ip directly.
+ */
+static void PerfSymElfLoad(PerfSymTable *table, int fd)
+{
+    Elf32_Ehdr ehdr;
+    Elf32_Shdr *shdrs = NULL;
+    Elf32_Shdr *symSec = NULL;
+    Elf32_Sym *syms = NULL;
+    unsigned int i, count;
+
+    if ((pread(fd, &ehdr, sizeof(ehdr), 0) != sizeof(ehdr)) || (memcmp(ehdr.e_ident, ELFMAG, SELFMAG) != 0) ||
+        (ehdr.e_ident[EI_CLASS] != ELFCLASS32) || (ehdr.e_shentsize != sizeof(Elf32_Shdr)) || (ehdr.e_shnum == 0)) {
+        return;
+    }
+
+    shdrs = (Elf32_Shdr *)PerfReadAt(fd, ehdr.e_shoff, ehdr.e_shnum * sizeof(Elf32_Shdr));
+    if (shdrs == NULL) {
+        return;
+    }
+    for (i = 0; i < ehdr.e_shnum; i++) {
+        if (shdrs[i].sh_type == SHT_SYMTAB) {
+            symSec = &shdrs[i];
+            break;
+        } else if ((shdrs[i].sh_type == SHT_DYNSYM) && (symSec == NULL)) {
+            symSec = &shdrs[i];
+        }
+    }
+    if ((symSec == NULL) || (symSec->sh_link >= ehdr.e_shnum) || (symSec->sh_entsize != sizeof(Elf32_Sym))) {
+        goto EXIT;
+    }
+
+    count = symSec->sh_size / sizeof(Elf32_Sym);
+    syms = (Elf32_Sym *)PerfReadAt(fd, symSec->sh_offset, count * sizeof(Elf32_Sym));
+    table->strs = PerfReadAt(fd, shdrs[symSec->sh_link].sh_offset, shdrs[symSec->sh_link].sh_size);
+    table->syms = (PerfSym *)malloc(count * sizeof(PerfSym));
+    if ((syms == NULL) || (table->strs == NULL) || (table->syms == NULL)) {
+        goto EXIT;
+    }
+
+    for (i = 0; i < count; i++) {
+        if ((ELF32_ST_TYPE(syms[i].st_info) != STT_FUNC) || (syms[i].st_shndx == SHN_UNDEF) ||
+            (syms[i].st_name >= shdrs[symSec->sh_link].sh_size)) {
+            continue;
+        }
+        table->syms[table->nr].addr = syms[i].st_value & PERF_SYM_ADDR_MASK;
+        table->syms[table->nr].size = syms[i].st_size;
+        table->syms[table->nr].name = table->strs + syms[i].st_name;
+        table->nr++;
+    }
+    qsort(table->syms, table->nr, sizeof(PerfSym), PerfSymCmp);
+
+EXIT:
+    free(syms);
+    free(shdrs);
+}
+
+static PerfSymTable *PerfSymElfGet(const char *path)
+{
+    PerfSymTable *table = g_elfSyms;
+    int fd;
+
+    for (; table != NULL; table = table->next) {
+        if (strcmp(table->path, path) == 0) {
+            return table;
+        }
+    }
+
+    table = (PerfSymTable *)calloc(1, sizeof(PerfSymTable));
+    if (table == NULL) {
+        return NULL;
+    }
+    table->path = strdup(path);
+    if (table->path == NULL) {
+        free(table);
+        return NULL;
+    }
+
+    fd = open(path, O_RDONLY);
+    if (fd >= 0) {
+        PerfSymElfLoad(table, fd);
+        (void)close(fd);
+    }
+    table->next = g_elfSyms;
+    g_elfSyms = table;
+    return table;
+}
+
+static const char *PerfSymFind(const PerfSymTable *table, unsigned int ip, unsigned int *offset)
+{
+    const PerfSym *sym = NULL;
+    unsigned int low = 0;
+    unsigned int high = table->nr;
+    unsigned int mid;
+
+    /* find the last symbol starting at or below ip */
+    while (low < high) {
+        mid = low + (high - low) / 2; /* 2: binary search */
+        if (table->syms[mid].addr <= ip) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    if (low == 0) {
+        return NULL;
+    }
+
+    sym = &table->syms[low - 1];
+    if ((sym->size != 0) && (ip - sym->addr >= sym->size)) {
+        return NULL;
+    }
+    *offset = ip - sym->addr;
+    return sym->name;
+}
+
+const char *PerfSymResolve(const char *path, unsigned int ip, unsigned int *offset)
+{
+    const PerfSymTable *table = NULL;
+
+    if ((path == NULL) || (offset == NULL)) {
+        return NULL;
+    }
+
+    if (strcmp(path, PERF_KERNEL_PATH) == 0) {
+        table = &g_kernelSyms;
+    } else if (path[0] == '/') {
+        table = PerfSymElfGet(path);
+    }
+    return (table != NULL) ? PerfSymFind(table, ip, offset) : NULL;
+}
+
+void PerfSymRelease(void)
+{
+    PerfSymTable *table = NULL;
+
+    while (g_elfSyms != NULL) {
+        table = g_elfSyms;
+        g_elfSyms = table->next;
+        free(table->syms);
+        free(table->strs);
+        free(table->path);
+        free(table);
+    }
+    free(g_kernelSyms.syms);
+    free(g_kernelSyms.strs);
+    (void)memset_s(&g_kernelSyms, sizeof(g_kernelSyms), 0, sizeof(g_kernelSyms));
+}
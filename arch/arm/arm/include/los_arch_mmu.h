@@ -98,6 +98,10 @@ STATUS_T LOS_ArchMmuMove(LosArchMmu *archMmu, VADDR_T oldVaddr, VADDR_T newVaddr
 VOID LOS_ArchMmuContextSwitch(LosArchMmu *archMmu);
 STATUS_T LOS_ArchMmuDestroy(LosArchMmu *archMmu);
 VOID OsArchMmuInitPerCPU(VOID);
+BOOL OsArchMmuIsSection(const LosArchMmu *archMmu, VADDR_T vaddr);
+BOOL OsArchMmuIsL1Unmapped(const LosArchMmu *archMmu, VADDR_T vaddr);
+STATUS_T LOS_ArchMmuSwapEntryGet(const LosArchMmu *archMmu, VADDR_T vaddr, UINT32 *entry);
+STATUS_T LOS_ArchMmuSwapEntrySet(LosArchMmu *archMmu, VADDR_T vaddr, UINT32 entry);
 VADDR_T *OsGFirstTableGet(VOID);
 
 #ifdef __cplusplus
@@ -46,9 +46,14 @@ extern "C" {
 #endif /* __cplusplus */
 
 #define MMU_ARM_ASID_BITS           8
+#define MMU_ARM_ASID_MASK           ((1U << MMU_ARM_ASID_BITS) - 1)
 
-/* allocate and free asid */
-STATUS_T OsAllocAsid(UINT32 *asid);
+/* an address space records generation | asid, the generation lives above the hardware asid bits */
+#define OS_ASID_HW(asid)            ((asid) & MMU_ARM_ASID_MASK)
+#define OS_ASID_GEN(asid)           ((asid) & ~MMU_ARM_ASID_MASK)
+
+/* switch to and free asid */
+UINT32 OsAsidSwitch(UINT32 *asid);
 VOID OsFreeAsid(UINT32 asid);
 
 #ifdef __cplusplus
@@ -72,6 +72,7 @@ extern "C" {
 #define BARRIER __asm__ volatile("":::"memory")
 #define WFE     __asm__ volatile("wfe" ::: "memory")
 #define SEV     __asm__ volatile("sev" ::: "memory")
+#define YIELD   __asm__ volatile("yield" ::: "memory") ///< 忙等循环里提示CPU当前在空转,多线程核可把流水线让给别的线程
 
 #define ARM_SYSREG_READ(REG)                    \
 ({                                              \
@@ -167,6 +167,28 @@ STATIC INLINE BOOL OsIsPte2Invalid(PTE_T pte2)
     return (pte2 & MMU_DESCRIPTOR_L2_TYPE_MASK) == MMU_DESCRIPTOR_L2_TYPE_INVALID;
 }
 
+/*
+ * 换出页的L2页表项: 类型位仍是00(fault), MMU访问照样缺页, 其余位硬件不看, 
+ * bit2做换出标记, 高位存换出槽号, 缺页时据此把页换回来
+ */
+#define PTE2_SWAP_FLAG      (1 << 2)
+#define PTE2_SWAP_SHIFT     3
+
+STATIC INLINE BOOL OsIsPte2Swap(PTE_T pte2)
+{
+    return OsIsPte2Invalid(pte2) && ((pte2 & PTE2_SWAP_FLAG) != 0);
+}
+
+STATIC INLINE PTE_T OsMakePte2Swap(UINT32 entry)
+{
+    return (entry << PTE2_SWAP_SHIFT) | PTE2_SWAP_FLAG;
+}
+
+STATIC INLINE UINT32 OsGetPte2SwapEntry(PTE_T pte2)
+{
+    return pte2 >> PTE2_SWAP_SHIFT;
+}
+
 #ifdef __cplusplus
 #if __cplusplus
 }
@@ -76,6 +76,27 @@ STATIC INLINE VOID OsArmInvalidateTlbMvaRangeNoBarrier(VADDR_T start, UINT32 cou
     }
 }
 
+/* a range larger than this is dropped with one asid (or whole tlb) invalidation instead of one per page */
+#define MMU_TLB_BATCH_PAGES_MAX 64
+
+STATIC INLINE VOID OsArmInvalidateTlbAsidNoBarrier(UINT32 asid)
+{
+#ifdef LOSCFG_KERNEL_SMP
+    OsArmWriteTlbiasidis(asid);
+#else
+    OsArmWriteTlbiasid(asid);
+#endif
+}
+
+STATIC INLINE VOID OsArmInvalidateTlbAllNoBarrier(VOID)
+{
+#ifdef LOSCFG_KERNEL_SMP
+    OsArmWriteTlbiallis(0);
+#else
+    OsArmWriteTlbiall(0);
+#endif
+}
+
 STATIC INLINE VOID OsCleanTLB(VOID)
 {
     UINT32 val = 0;
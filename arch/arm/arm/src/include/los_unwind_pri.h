@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2013-2019 Huawei Technologies Co., Ltd. All rights reserved.
+ * Copyright (c) 2020-2021 Huawei Device Co., Ltd. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of
+ *    conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list
+ *    of conditions and the following disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used
+ *    to endorse or promote products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _LOS_UNWIND_PRI_H
+#define _LOS_UNWIND_PRI_H
+
+#include "los_typedef.h"
+#ifdef LOSCFG_ARCH_USER_UNWIND
+#include "los_vm_map.h"
+#endif
+
+#ifdef __cplusplus
+#if __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+#endif /* __cplusplus */
+
+#define UNWIND_REG_R7   7   ///< thumb 代码的帧指针
+#define UNWIND_REG_FP   11  ///< arm 代码的帧指针
+#define UNWIND_REG_SP   13
+#define UNWIND_REG_LR   14
+#define UNWIND_REG_PC   15
+#define UNWIND_REG_NUM  16
+
+/// 栈回溯的寄存器现场, 展开一帧后就是调用者的现场
+typedef struct {
+    UINTPTR R[UNWIND_REG_NUM];
+} UnwindRegs;
+
+#ifdef LOSCFG_ARCH_USER_UNWIND
+/**
+ * @brief 取当前任务陷入内核时保存在内核栈底的用户态现场.
+ * r4-r11 只在系统调用时保存, 在中断里打断用户态时它们还在寄存器中, 由调用者自行补上.
+ */
+extern BOOL OsUnwindUserRegsGet(UnwindRegs *regs);
+
+/**
+ * @brief 按加载的 ELF 镜像中的 .ARM.exidx/.ARM.extab 展开当前进程的用户栈, 不依赖帧指针.
+ * pcs[0] 是 regs 中的 pc, 之后是各级调用者的返回地址, 返回记录的层数.
+ * 只通过页表读用户内存, 不会触发缺页, 可以在中断和异常中调用.
+ * 中断里和关中断(持调度锁)时不查线性区, 只能展开已经缓存过索引表的镜像, 其余情况只尝试拿一次 regionMux.
+ */
+extern UINT32 OsUnwindUser(UnwindRegs *regs, UINTPTR *pcs, UINT32 maxDepth);
+
+/**
+ * @brief 文件映射线性区释放时作废与它重叠的索引表缓存, 由 LOS_RegionFree 在持有 regionMux 时调用.
+ */
+extern VOID OsUnwindRegionFree(const LosVmSpace *space, const LosVmMapRegion *region);
+#endif
+
+#ifdef __cplusplus
+#if __cplusplus
+}
+#endif /* __cplusplus */
+#endif /* __cplusplus */
+
+#endif /* _LOS_UNWIND_PRI_H */
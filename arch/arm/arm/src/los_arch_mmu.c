@@ -381,7 +381,108 @@ STATIC VOID OsCvtSecAttsToFlags(PTE_T l1Entry, UINT32 *flags)
     }
 }
 
-STATIC UINT32 OsUnmapL2PTE(const LosArchMmu *archMmu, vaddr_t vaddr, UINT32 *count)
+/**
+ * TLB invalidations of one unmap/protect/move operation. The tlb maintenance of armv7 is broadcast to the
+ * inner shareable domain, so no ipi is needed; what the batch saves is the barrier per page and, for a large
+ * range, the per page invalidations themselves.
+ */
+typedef struct {
+    const LosArchMmu *archMmu;
+    UINT32 pages;   ///< 已经按页失效的页数
+    BOOL overflow;  ///< 超过 MMU_TLB_BATCH_PAGES_MAX, 提交时按asid整体失效
+    BOOL global;    ///< 涉及内核(全局)映射, 整体失效时只能失效整个TLB
+} TlbBatch;
+
+STATIC INLINE VOID OsTlbBatchInit(TlbBatch *batch, const LosArchMmu *archMmu)
+{
+    batch->archMmu = archMmu;
+    batch->pages = 0;
+    batch->overflow = FALSE;
+    batch->global = FALSE;
+}
+
+STATIC VOID OsTlbBatchAdd(TlbBatch *batch, VADDR_T vaddr, UINT32 count)
+{
+    if (!LOS_IsUserAddress(vaddr)) {
+        batch->global = TRUE;
+    }
+    if (batch->overflow) {
+        return;
+    }
+    if ((batch->pages + count) > MMU_TLB_BATCH_PAGES_MAX) {
+        batch->overflow = TRUE;
+        return;
+    }
+    batch->pages += count;
+    OsArmInvalidateTlbMvaRangeNoBarrier(vaddr, count);
+}
+
+/// 提交批量失效, 返回后被解除的映射在所有CPU上都不可见
+STATIC VOID OsTlbBatchFlush(TlbBatch *batch)
+{
+    if (batch->overflow) {
+        DSB; /* the cleared descriptors are visible to the table walk before the invalidation */
+        if (batch->global) {
+            OsArmInvalidateTlbAllNoBarrier();
+        } else {
+            OsArmInvalidateTlbAsidNoBarrier(OS_ASID_HW(batch->archMmu->asid));
+        }
+    }
+    OsArmInvalidateTlbBarrier();
+    OsTlbBatchInit(batch, batch->archMmu);
+}
+
+STATIC STATUS_T OsGetL2Table(LosArchMmu *archMmu, UINT32 l1Index, paddr_t *ppa);
+STATIC UINT32 OsCvtPte2FlagsToAttrs(UINT32 flags);
+
+/*!
+ * @brief OsSplitSection 把一个section映射拆成256个小页映射, 物理地址和属性都不变,
+ * 之后就可以按页解除映射或修改权限
+ * @see
+ */
+STATIC STATUS_T OsSplitSection(LosArchMmu *archMmu, VADDR_T vaddr, TlbBatch *batch)
+{
+    PTE_T *pte1Ptr = OsGetPte1Ptr(archMmu->virtTtb, vaddr);
+    PTE_T l1Entry = *pte1Ptr;
+    VADDR_T base = ROUNDDOWN(vaddr, MMU_DESCRIPTOR_L1_SMALL_SIZE);
+    paddr_t pte2Base = 0;
+    PTE_T pte1;
+    UINT32 flags = 0;
+
+    OsCvtSecAttsToFlags(l1Entry, &flags);
+    if (OsGetL2Table(archMmu, OsGetPte1Index(base), &pte2Base) != LOS_OK) {
+        return LOS_ERRNO_VM_NO_MEMORY;
+    }
+
+    pte1 = pte2Base | MMU_DESCRIPTOR_L1_TYPE_PAGE_TABLE;
+    if (flags & VM_MAP_REGION_FLAG_NS) {
+        pte1 |= MMU_DESCRIPTOR_L1_PAGETABLE_NON_SECURE;
+    }
+    pte1 &= MMU_DESCRIPTOR_L1_SMALL_DOMAIN_MASK;
+    pte1 |= MMU_DESCRIPTOR_L1_SMALL_DOMAIN_CLIENT; // use client AP
+    (VOID)OsSavePte2Continuous(OsGetPte2BasePtr(pte1), 0,
+                               MMU_DESCRIPTOR_L1_SECTION_ADDR(l1Entry) | OsCvtPte2FlagsToAttrs(flags),
+                               MMU_DESCRIPTOR_L2_NUMBERS_PER_L1);
+
+    /* both the old and the new entries translate to the same pages with the same attributes */
+    OsSavePte1(pte1Ptr, pte1);
+    OsTlbBatchAdd(batch, base, 1);
+    return LOS_OK;
+}
+
+/// 该虚拟地址是否落在一个section映射里
+BOOL OsArchMmuIsSection(const LosArchMmu *archMmu, VADDR_T vaddr)
+{
+    return OsIsPte1Section(OsGetPte1(archMmu->virtTtb, vaddr));
+}
+
+/// 该虚拟地址所在的1M是否完全没有映射
+BOOL OsArchMmuIsL1Unmapped(const LosArchMmu *archMmu, VADDR_T vaddr)
+{
+    return OsIsPte1Invalid(OsGetPte1(archMmu->virtTtb, vaddr));
+}
+
+STATIC UINT32 OsUnmapL2PTE(const LosArchMmu *archMmu, vaddr_t vaddr, UINT32 *count, TlbBatch *batch)
 {
     UINT32 unmapCount;
     UINT32 pte2Index;
@@ -399,16 +500,16 @@ STATIC UINT32 OsUnmapL2PTE(const LosArchMmu *archMmu, vaddr_t vaddr, UINT32 *cou
     OsClearPte2Continuous(&pte2BasePtr[pte2Index], unmapCount);
 
     /* invalidate tlb */
-    OsArmInvalidateTlbMvaRangeNoBarrier(vaddr, unmapCount);
+    OsTlbBatchAdd(batch, vaddr, unmapCount);
 
     *count -= unmapCount;
     return unmapCount;
 }
 
-STATIC UINT32 OsUnmapSection(LosArchMmu *archMmu, vaddr_t *vaddr, UINT32 *count)
+STATIC UINT32 OsUnmapSection(LosArchMmu *archMmu, vaddr_t *vaddr, UINT32 *count, TlbBatch *batch)
 {
     OsClearPte1(OsGetPte1Ptr((PTE_T *)archMmu->virtTtb, *vaddr));
-    OsArmInvalidateTlbMvaNoBarrier(*vaddr);
+    OsTlbBatchAdd(batch, *vaddr, 1);
 
     *vaddr += MMU_DESCRIPTOR_L1_SMALL_SIZE;
     *count -= MMU_DESCRIPTOR_L2_NUMBERS_PER_L1;
@@ -429,10 +530,8 @@ STATIC UINT32 OsUnmapSection(LosArchMmu *archMmu, vaddr_t *vaddr, UINT32 *count)
 BOOL OsArchMmuInit(LosArchMmu *archMmu, VADDR_T *virtTtb)
 {
 #ifdef LOSCFG_KERNEL_VM
-    if (OsAllocAsid(&archMmu->asid) != LOS_OK) {//分配一个asid,ASID可用来唯一标识进程空间
-        VM_ERR("alloc arch mmu asid failed");//地址空间标识码（address-space identifier，ASID）为CP15协处理器 C13寄存器
-        return FALSE;
-    }
+    /* 地址空间标识码（address-space identifier，ASID）为CP15协处理器 C13寄存器, 第一次切换到该空间时按代分配 */
+    archMmu->asid = 0;
 #endif
 
     status_t retval = LOS_MuxInit(&archMmu->mtx, NULL);
@@ -511,7 +610,7 @@ STATUS_T LOS_ArchMmuQuery(const LosArchMmu *archMmu, VADDR_T vaddr, PADDR_T *pad
  *
  * @see
  */
-STATUS_T LOS_ArchMmuUnmap(LosArchMmu *archMmu, VADDR_T vaddr, size_t count)
+STATIC STATUS_T OsArchMmuUnmapBatch(LosArchMmu *archMmu, VADDR_T vaddr, size_t count, TlbBatch *batch)
 {
     PTE_T l1Entry;
     INT32 unmapped = 0;
@@ -523,12 +622,15 @@ STATUS_T LOS_ArchMmuUnmap(LosArchMmu *archMmu, VADDR_T vaddr, size_t count)
             unmapCount = OsUnmapL1Invalid(&vaddr, &count);
         } else if (OsIsPte1Section(l1Entry)) {// section页表项: l1Entry低二位是否为 10
             if (MMU_DESCRIPTOR_IS_L1_SIZE_ALIGNED(vaddr) && count >= MMU_DESCRIPTOR_L2_NUMBERS_PER_L1) {//对齐1M
-                unmapCount = OsUnmapSection(archMmu, &vaddr, &count);//解除section格式项映射关系
+                unmapCount = OsUnmapSection(archMmu, &vaddr, &count, batch);//解除section格式项映射关系
+            } else if (OsSplitSection(archMmu, vaddr, batch) == LOS_OK) {//只解除一部分, 先拆成小页再按L2处理
+                continue;
             } else {
-                LOS_Panic("%s %d, unimplemented\n", __FUNCTION__, __LINE__);
+                VM_ERR("split section failed, vaddr %#x", vaddr);
+                return LOS_ERRNO_VM_NO_MEMORY;
             }
         } else if (OsIsPte1PageTable(l1Entry)) {// section页表项: l1Entry低二位是否为 10
-            unmapCount = OsUnmapL2PTE(archMmu, vaddr, &count);//解除L2 映射关系
+            unmapCount = OsUnmapL2PTE(archMmu, vaddr, &count, batch);//解除L2 映射关系
             OsTryUnmapL1PTE(archMmu, vaddr, OsGetPte2Index(vaddr) + unmapCount,
                             MMU_DESCRIPTOR_L2_NUMBERS_PER_L1 - unmapCount);
             vaddr += unmapCount << MMU_DESCRIPTOR_L2_SMALL_SHIFT;//获取L1页表 index
@@ -537,7 +639,17 @@ STATUS_T LOS_ArchMmuUnmap(LosArchMmu *archMmu, VADDR_T vaddr, size_t count)
         }
         unmapped += unmapCount;
     }
-    OsArmInvalidateTlbBarrier();//TLB失效，不可用
+    return unmapped;
+}
+
+STATUS_T LOS_ArchMmuUnmap(LosArchMmu *archMmu, VADDR_T vaddr, size_t count)
+{
+    TlbBatch batch;
+    STATUS_T unmapped;
+
+    OsTlbBatchInit(&batch, archMmu);
+    unmapped = OsArchMmuUnmapBatch(archMmu, vaddr, count, &batch);
+    OsTlbBatchFlush(&batch);//TLB失效，不可用
     return unmapped;
 }
 
@@ -788,12 +900,14 @@ STATUS_T LOS_ArchMmuChangeProt(LosArchMmu *archMmu, VADDR_T vaddr, size_t count,
 {
     STATUS_T status;
     PADDR_T paddr = 0;
+    TlbBatch batch;
 
     if ((archMmu == NULL) || (vaddr == 0) || (count == 0)) {
         VM_ERR("invalid args: archMmu %p, vaddr %p, count %d", archMmu, vaddr, count);
         return LOS_NOK;
     }
 
+    OsTlbBatchInit(&batch, archMmu);//整个区间共用一次TLB失效
     while (count > 0) {
         count--;
         status = LOS_ArchMmuQuery(archMmu, vaddr, &paddr, NULL);//1. 先查出物理地址
@@ -802,20 +916,23 @@ STATUS_T LOS_ArchMmuChangeProt(LosArchMmu *archMmu, VADDR_T vaddr, size_t count,
             continue;
         }
 
-        status = LOS_ArchMmuUnmap(archMmu, vaddr, 1);//2. 取消原有映射
+        status = OsArchMmuUnmapBatch(archMmu, vaddr, 1, &batch);//2. 取消原有映射
         if (status < 0) {
+            OsTlbBatchFlush(&batch);
             VM_ERR("invalid args:aspace %p, vaddr %p, count %d", archMmu, vaddr, count);
             return LOS_NOK;
         }
 
         status = LOS_ArchMmuMap(archMmu, vaddr, paddr, 1, flags);//3. 重新映射 虚实地址
         if (status < 0) {
+            OsTlbBatchFlush(&batch);
             VM_ERR("invalid args:aspace %p, vaddr %p, count %d",
                    archMmu, vaddr, count);
             return LOS_NOK;
         }
         vaddr += MMU_DESCRIPTOR_L2_SMALL_SIZE;
     }
+    OsTlbBatchFlush(&batch);
     return LOS_OK;
 }
 
@@ -835,6 +952,8 @@ STATUS_T LOS_ArchMmuMove(LosArchMmu *archMmu, VADDR_T oldVaddr, VADDR_T newVaddr
 {
     STATUS_T status;
     PADDR_T paddr = 0;
+    UINT32 entry;
+    TlbBatch batch;
 
     if ((archMmu == NULL) || (oldVaddr == 0) || (newVaddr == 0) || (count == 0)) {
         VM_ERR("invalid args: archMmu %p, oldVaddr %p, newVaddr %p, count %d",
@@ -842,17 +961,23 @@ STATUS_T LOS_ArchMmuMove(LosArchMmu *archMmu, VADDR_T oldVaddr, VADDR_T newVaddr
         return LOS_NOK;
     }
 
+    OsTlbBatchInit(&batch, archMmu);
     while (count > 0) {
         count--;
         status = LOS_ArchMmuQuery(archMmu, oldVaddr, &paddr, NULL);
         if (status != LOS_OK) {
+            if (LOS_ArchMmuSwapEntryGet(archMmu, oldVaddr, &entry) == LOS_OK) {//换出的页把交换项一起搬过去
+                (VOID)LOS_ArchMmuSwapEntrySet(archMmu, newVaddr, entry);
+                (VOID)LOS_ArchMmuSwapEntrySet(archMmu, oldVaddr, 0);
+            }
             oldVaddr += MMU_DESCRIPTOR_L2_SMALL_SIZE;
             newVaddr += MMU_DESCRIPTOR_L2_SMALL_SIZE;
             continue;
         }
         // we need to clear the mapping here and remain the phy page.
-        status = LOS_ArchMmuUnmap(archMmu, oldVaddr, 1);
+        status = OsArchMmuUnmapBatch(archMmu, oldVaddr, 1, &batch);
         if (status < 0) {
+            OsTlbBatchFlush(&batch);
             VM_ERR("invalid args: archMmu %p, vaddr %p, count %d",
                    archMmu, oldVaddr, count);
             return LOS_NOK;
@@ -860,6 +985,7 @@ STATUS_T LOS_ArchMmuMove(LosArchMmu *archMmu, VADDR_T oldVaddr, VADDR_T newVaddr
 
         status = LOS_ArchMmuMap(archMmu, newVaddr, paddr, 1, flags);
         if (status < 0) {
+            OsTlbBatchFlush(&batch);
             VM_ERR("invalid args:archMmu %p, old_vaddr %p, new_addr %p, count %d",
                    archMmu, oldVaddr, newVaddr, count);
             return LOS_NOK;
@@ -868,6 +994,65 @@ STATUS_T LOS_ArchMmuMove(LosArchMmu *archMmu, VADDR_T oldVaddr, VADDR_T newVaddr
         newVaddr += MMU_DESCRIPTOR_L2_SMALL_SIZE;
     }
 
+    OsTlbBatchFlush(&batch);
+    return LOS_OK;
+}
+
+/// 查询虚拟地址的L2页表项是不是换出页的交换项, 是就带出槽号
+STATUS_T LOS_ArchMmuSwapEntryGet(const LosArchMmu *archMmu, VADDR_T vaddr, UINT32 *entry)
+{
+    PTE_T l1Entry = OsGetPte1(archMmu->virtTtb, vaddr);
+    PTE_T *l2Base = NULL;
+    PTE_T l2Entry;
+
+    if (!OsIsPte1PageTable(l1Entry)) {
+        return LOS_ERRNO_VM_NOT_FOUND;
+    }
+    l2Base = OsGetPte2BasePtr(l1Entry);
+    if (l2Base == NULL) {
+        return LOS_ERRNO_VM_NOT_FOUND;
+    }
+    l2Entry = OsGetPte2(l2Base, vaddr);
+    if (!OsIsPte2Swap(l2Entry)) {
+        return LOS_ERRNO_VM_NOT_FOUND;
+    }
+    if (entry != NULL) {
+        *entry = OsGetPte2SwapEntry(l2Entry);
+    }
+    return LOS_OK;
+}
+
+/*!
+ * @brief LOS_ArchMmuSwapEntrySet 把一个小页的页表项换成交换项, entry为0时清掉交换项
+ * 原来映射的物理页由调用者处理, 这里只负责页表项和TLB
+ */
+STATUS_T LOS_ArchMmuSwapEntrySet(LosArchMmu *archMmu, VADDR_T vaddr, UINT32 entry)
+{
+    PTE_T l1Entry = OsGetPte1(archMmu->virtTtb, vaddr);
+    PTE_T *l2Base = NULL;
+    TlbBatch batch;
+
+    if (OsIsPte1Section(l1Entry)) {//section映射的大页不做换出
+        return LOS_ERRNO_VM_INVALID_ARGS;
+    }
+    if (OsIsPte1Invalid(l1Entry)) {
+        if (entry == 0) {
+            return LOS_OK;
+        }
+        OsMapL1PTE(archMmu, &l1Entry, vaddr, 0);//fork时子进程这1M可能还没有L2表
+    }
+    l2Base = OsGetPte2BasePtr(l1Entry);
+    if (l2Base == NULL) {
+        return LOS_ERRNO_VM_NOT_FOUND;
+    }
+
+    OsTlbBatchInit(&batch, archMmu);
+    OsSavePte2(OsGetPte2Ptr(l2Base, vaddr), (entry != 0) ? OsMakePte2Swap(entry) : 0);
+    OsTlbBatchAdd(&batch, vaddr, 1);
+    if (entry == 0) {
+        OsTryUnmapL1PTE(archMmu, vaddr, 0, MMU_DESCRIPTOR_L2_NUMBERS_PER_L1);
+    }
+    OsTlbBatchFlush(&batch);
     return LOS_OK;
 }
 
@@ -882,7 +1067,17 @@ STATUS_T LOS_ArchMmuMove(LosArchMmu *archMmu, VADDR_T oldVaddr, VADDR_T newVaddr
 VOID LOS_ArchMmuContextSwitch(LosArchMmu *archMmu)
 {
     UINT32 ttbr;
-    UINT32 ttbcr = OsArmReadTtbcr();//读取TTB寄存器的状态值
+    UINT32 ttbcr;
+#ifdef LOSCFG_KERNEL_VM
+    UINT32 asid = 0;
+    UINT32 intSave = LOS_IntLock();
+
+    if ((archMmu != NULL) && (archMmu->virtTtb != OsGFirstTableGet())) {
+        asid = OsAsidSwitch(&archMmu->asid);//代号没变时直接沿用, 否则重新分配
+    }
+#endif
+
+    ttbcr = OsArmReadTtbcr();//读取TTB寄存器的状态值
     if (archMmu) {
         ttbr = MMU_TTBRx_FLAGS | (archMmu->physTtb);//进程TTB物理地址值
         /* enable TTBR0 */
@@ -895,7 +1090,7 @@ VOID LOS_ArchMmuContextSwitch(LosArchMmu *archMmu)
 
 #ifdef LOSCFG_KERNEL_VM
     /* from armv7a arm B3.10.4, we should do synchronization changes of ASID and TTBR. */
-    OsArmWriteContextidr(LOS_GetKVmSpace()->archMmu.asid);//这里先把asid切到内核空间的ID
+    OsArmWriteContextidr(OS_ASID_HW(LOS_GetKVmSpace()->archMmu.asid));//这里先把asid切到内核空间的ID
     ISB;
 #endif
     OsArmWriteTtbr0(ttbr);//通过r0寄存器将进程页面基址写入TTB
@@ -904,9 +1099,10 @@ VOID LOS_ArchMmuContextSwitch(LosArchMmu *archMmu)
     ISB;
 #ifdef LOSCFG_KERNEL_VM
     if (archMmu) {
-        OsArmWriteContextidr(archMmu->asid);//通过R0寄存器写入进程标识符至C13寄存器
+        OsArmWriteContextidr(asid);//通过R0寄存器写入进程标识符至C13寄存器
         ISB;
     }
+    LOS_IntRestore(intSave);
 #endif
 }
 
@@ -927,7 +1123,8 @@ STATUS_T LOS_ArchMmuDestroy(LosArchMmu *archMmu)
         LOS_PhysPageFree(page);//释放物理页
     }
 
-    OsArmWriteTlbiasidis(archMmu->asid);
+    OsArmWriteTlbiasidis(OS_ASID_HW(archMmu->asid));
+    DSB;
     OsFreeAsid(archMmu->asid);//释放asid
 #endif
     (VOID)LOS_MuxDestroy(&archMmu->mtx);
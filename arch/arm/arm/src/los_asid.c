@@ -64,41 +64,153 @@
  */
 
 #include "los_asid.h"
+#include "securec.h"
 #include "los_bitmap.h"
 #include "los_spinlock.h"
+#include "los_atomic.h"
+#include "los_hw_cpu.h"
 #include "los_mmu_descriptor_v6.h"
+#include "arm.h"
 
 
 #ifdef LOSCFG_KERNEL_VM
+/**
+ * asid按代(generation)分配: 地址空间记录的是 代号|asid, 代号和当前代相同才说明这个asid还属于它.
+ * 当前代的asid用完时代号加一, 清空asid池, 各CPU正在使用的asid保留到新的一代, 其余的在各CPU
+ * 下一次切换时通过一次本地TLB全失效回收. 所以活着的地址空间数不再受256个asid的限制.
+ */
+#define OS_ASID_NUM             (1U << MMU_ARM_ASID_BITS)
+#define OS_ASID_KERNEL          0U  ///< 内核空间用的asid, 内核映射是全局的, 这个asid不分配给用户空间
 
 STATIC SPIN_LOCK_INIT(g_cpuAsidLock); ///< asid专属自旋锁
-STATIC UINTPTR g_asidPool[BITMAP_NUM_WORDS(1UL << MMU_ARM_ASID_BITS)]; ///< 地址空间ID池 , 2^8 = 256 个
+STATIC UINTPTR g_asidPool[BITMAP_NUM_WORDS(1UL << MMU_ARM_ASID_BITS)] = { 1UL << OS_ASID_KERNEL }; ///< 当前代的地址空间ID池 , 2^8 = 256 个
+STATIC UINT32 g_asidGeneration = OS_ASID_NUM;              ///< 当前代号, 从1开始
+STATIC Atomic g_activeAsids[LOSCFG_KERNEL_CORE_NUM];       ///< 各CPU正在使用的 代号|asid, 为0表示正在换代
+STATIC UINT32 g_reservedAsids[LOSCFG_KERNEL_CORE_NUM];     ///< 换代时各CPU正在使用的asid, 带进新的一代
+STATIC BOOL g_asidFlushPending[LOSCFG_KERNEL_CORE_NUM];    ///< 换代后该CPU还没有做本地TLB全失效
 
-/* allocate and free asid | 分配地址空间ID */
-status_t OsAllocAsid(UINT32 *asid)
+STATIC INLINE BOOL OsAsidGenMatch(UINT32 asid)
 {
-    UINT32 flags;
-    LOS_SpinLockSave(&g_cpuAsidLock, &flags);
-    UINT32 firstZeroBit = LOS_BitmapFfz(g_asidPool, 1UL << MMU_ARM_ASID_BITS);//找到第一个0位,即可分配位
-    if (firstZeroBit >= 0 && firstZeroBit < (1UL << MMU_ARM_ASID_BITS)) {
-        LOS_BitmapSetNBits(g_asidPool, firstZeroBit, 1);//设为已分配
-        *asid = firstZeroBit;//由参数带走
-        LOS_SpinUnlockRestore(&g_cpuAsidLock, flags);
-        return LOS_OK;
+    return OS_ASID_GEN(asid) == OS_ASID_GEN(*(volatile UINT32 *)&g_asidGeneration);
+}
+
+/// 换代: 只保留各CPU正在用的asid, 其余的等各CPU本地TLB全失效后再复用
+STATIC VOID OsAsidFlushContext(VOID)
+{
+    UINT32 cpuid;
+    UINT32 asid;
+
+    (VOID)memset_s(g_asidPool, sizeof(g_asidPool), 0, sizeof(g_asidPool));
+    LOS_BitmapSetNBits(g_asidPool, OS_ASID_KERNEL, 1);
+
+    for (cpuid = 0; cpuid < LOSCFG_KERNEL_CORE_NUM; cpuid++) {
+        asid = (UINT32)LOS_AtomicXchg32bits(&g_activeAsids[cpuid], 0);
+        /*
+         * a zero active asid means that cpu already went through a rollover and has not
+         * switched since, so the asid it is still running with is the reserved one.
+         */
+        if (asid == 0) {
+            asid = g_reservedAsids[cpuid];
+        }
+        LOS_BitmapSetNBits(g_asidPool, OS_ASID_HW(asid), 1);
+        g_reservedAsids[cpuid] = asid;
+        g_asidFlushPending[cpuid] = TRUE;
     }
+}
 
-    LOS_SpinUnlockRestore(&g_cpuAsidLock, flags);
-    return firstZeroBit;
+/// 旧代的asid如果被某个CPU保留着, 所有保留它的CPU都改记新代号
+STATIC BOOL OsAsidCheckUpdateReserved(UINT32 asid, UINT32 newAsid)
+{
+    UINT32 cpuid;
+    BOOL hit = FALSE;
+
+    for (cpuid = 0; cpuid < LOSCFG_KERNEL_CORE_NUM; cpuid++) {
+        if (g_reservedAsids[cpuid] == asid) {
+            g_reservedAsids[cpuid] = newAsid;
+            hit = TRUE;
+        }
+    }
+    return hit;
 }
 
+STATIC UINT32 OsAsidNewContext(UINT32 asid)
+{
+    UINT32 newAsid;
+    INT32 firstZeroBit;
+
+    if (asid != 0) {
+        /* try to keep the same hardware asid in the new generation */
+        newAsid = g_asidGeneration | OS_ASID_HW(asid);
+        if (OsAsidCheckUpdateReserved(asid, newAsid)) {
+            return newAsid;
+        }
+        if (!(g_asidPool[BITMAP_WORD(OS_ASID_HW(asid))] & (1UL << BITMAP_BIT_IN_WORD(OS_ASID_HW(asid))))) {
+            LOS_BitmapSetNBits(g_asidPool, OS_ASID_HW(asid), 1);
+            return newAsid;
+        }
+    }
 
-/// 释放 asid
+    firstZeroBit = LOS_BitmapFfz(g_asidPool, OS_ASID_NUM);//找到第一个0位,即可分配位
+    if ((firstZeroBit < 0) || ((UINT32)firstZeroBit >= OS_ASID_NUM)) {
+        g_asidGeneration += OS_ASID_NUM;//当前代用完了, 换代
+        if (g_asidGeneration == 0) {
+            g_asidGeneration = OS_ASID_NUM; /* generation 0 is the "never allocated" mark */
+        }
+        OsAsidFlushContext();
+        firstZeroBit = LOS_BitmapFfz(g_asidPool, OS_ASID_NUM);
+    }
+
+    LOS_BitmapSetNBits(g_asidPool, (UINT32)firstZeroBit, 1);//设为已分配
+    return g_asidGeneration | (UINT32)firstZeroBit;
+}
+
+/*!
+ * @brief OsAsidSwitch 切换到一个用户空间前调用, 必须关中断
+ * 代号没变时只需更新本CPU正在使用的asid, 不拿锁
+ * @param asid	地址空间记录的 代号|asid, 需要时更新为新一代的值
+ * @return 要写入CONTEXTIDR的硬件asid
+ */
+UINT32 OsAsidSwitch(UINT32 *asid)
+{
+    UINT32 cpuid = ArchCurrCpuid();
+    UINT32 intSave;
+    UINT32 cur = *(volatile UINT32 *)asid;
+    INT32 oldActive = LOS_AtomicRead(&g_activeAsids[cpuid]);
+
+    /* the cmpxchg fails if a rollover on another cpu cleared our active asid meanwhile */
+    if ((oldActive != 0) && OsAsidGenMatch(cur) &&
+        !LOS_AtomicCmpXchg32bits(&g_activeAsids[cpuid], (INT32)cur, oldActive)) {
+        return OS_ASID_HW(cur);
+    }
+
+    LOS_SpinLockSave(&g_cpuAsidLock, &intSave);
+    cur = *asid;
+    if (!OsAsidGenMatch(cur)) {
+        cur = OsAsidNewContext(cur);
+        *(volatile UINT32 *)asid = cur;
+    }
+
+    if (g_asidFlushPending[cpuid]) {
+        g_asidFlushPending[cpuid] = FALSE;
+        OsArmWriteTlbiall(0);//换代后本CPU的TLB里可能还有旧一代asid的条目
+        DSB;
+        ISB;
+    }
+
+    LOS_AtomicSet(&g_activeAsids[cpuid], (INT32)cur);
+    LOS_SpinUnlockRestore(&g_cpuAsidLock, intSave);
+    return OS_ASID_HW(cur);
+}
+
+/// 释放 asid, 调用前该asid在TLB中的条目必须已经失效
 VOID OsFreeAsid(UINT32 asid)
 {
     UINT32 flags;
     LOS_SpinLockSave(&g_cpuAsidLock, &flags);
-    LOS_BitmapClrNBits(g_asidPool, asid, 1);//清空对应位,可继续分配给其他进程
+    /* an asid still reserved by some cpu stays allocated until the next rollover */
+    if ((asid != 0) && OsAsidGenMatch(asid) && !OsAsidCheckUpdateReserved(asid, asid)) {
+        LOS_BitmapClrNBits(g_asidPool, OS_ASID_HW(asid), 1);//清空对应位,可继续分配给其他进程
+    }
     LOS_SpinUnlockRestore(&g_cpuAsidLock, flags);
 }
 #endif
-
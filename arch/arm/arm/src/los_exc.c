@@ -115,6 +115,9 @@
 #ifdef LOSCFG_BLACKBOX
 #include "los_blackbox.h"
 #endif
+#ifdef LOSCFG_ARCH_USER_UNWIND
+#include "los_unwind_pri.h"
+#endif
 
 #define INVALID_CPUID 0xFFFF
 #define OS_EXC_VMM_NO_REGION 0x0U
@@ -920,6 +923,44 @@ VOID BackTrace(UINT32 regFP) //fp:R11寄存器
 
     BackTraceSub(regFP);
 }
+
+#ifdef LOSCFG_ARCH_USER_UNWIND
+///用户态异常时按 .ARM.exidx 展开用户栈, 不依赖 -fno-omit-frame-pointer
+STATIC VOID OsExcUserBackTrace(const ExcContext *excBufAddr)
+{
+    UnwindRegs regs;
+    UINTPTR pcs[OS_MAX_BACKTRACE];
+    UINT32 count, index;
+
+    regs.R[0] = excBufAddr->R0;
+    regs.R[1] = excBufAddr->R1;
+    regs.R[2] = excBufAddr->R2;
+    regs.R[3] = excBufAddr->R3;
+    regs.R[4] = excBufAddr->R4;
+    regs.R[5] = excBufAddr->R5;
+    regs.R[6] = excBufAddr->R6;
+    regs.R[7] = excBufAddr->R7;
+    regs.R[8] = excBufAddr->R8;
+    regs.R[9] = excBufAddr->R9;
+    regs.R[10] = excBufAddr->R10;
+    regs.R[11] = excBufAddr->R11;
+    regs.R[12] = excBufAddr->R12;
+    regs.R[UNWIND_REG_SP] = excBufAddr->USP; //用户栈
+    regs.R[UNWIND_REG_LR] = excBufAddr->ULR;
+    regs.R[UNWIND_REG_PC] = excBufAddr->PC;
+
+    PrintExcInfo("*******user backtrace begin*******\n");
+    count = OsUnwindUser(&regs, pcs, OS_MAX_BACKTRACE);
+    for (index = 0; index < count; index++) {
+        IpInfo info = {0};
+        if (OsGetUsrIpInfo(pcs[index], &info)) {
+            PrintExcInfo("traceback %u -- pc = 0x%x in %s --> 0x%x\n", index, pcs[index], info.f_path, info.ip);
+        } else {
+            PrintExcInfo("traceback %u -- pc = 0x%x\n", index, pcs[index]);
+        }
+    }
+}
+#endif
 ///异常接管模块的初始化
 VOID OsExcInit(VOID)
 {
@@ -933,6 +974,11 @@ VOID OsExcHook(UINT32 excType, ExcContext *excBufAddr, UINT32 far, UINT32 fsr)
     OsExcRegsInfo(excBufAddr);                //3.打印异常的寄存器信息
 
     BackTrace(excBufAddr->R11); //4.打印调用栈信息,
+#ifdef LOSCFG_ARCH_USER_UNWIND
+    if (g_excFromUserMode[ArchCurrCpuid()] == TRUE) { //用户态异常再按 exidx 展开一次, 黑匣子记录的是同一份日志
+        OsExcUserBackTrace(excBufAddr);
+    }
+#endif
 
     (VOID) OsShellCmdTskInfoGet(OS_ALL_TASK_MASK, NULL, OS_PROCESS_INFO_ALL); //打印进程线程基本信息 相当于执行下 shell task -a 命令
 
@@ -0,0 +1,555 @@
+/*
+ * Copyright (c) 2013-2019 Huawei Technologies Co., Ltd. All rights reserved.
+ * Copyright (c) 2020-2021 Huawei Device Co., Ltd. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of
+ *    conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list
+ *    of conditions and the following disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used
+ *    to endorse or promote products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*!
+ * @file    los_unwind.c
+ * @brief   用户态栈回溯
+ * @details
+ * @verbatim
+    用户程序一般以 -O2 编译且不保留帧指针, 沿 fp 回溯只能得到一层. ARM EHABI 要求每个函数在
+    .ARM.exidx 中有一项索引, 描述如何从函数体内恢复调用者的 sp/lr/pc, 这里按它展开用户栈:
+    1. 由 pc 找到所在的文件映射线性区, 往前找到同一文件的第一个线性区, 即 ELF 头所在处.
+       查线性区要拿 regionMux, 中断里和持调度锁时不能拿, 这时只查按镜像地址范围缓存的索引表
+    2. 从 ELF 程序头中找到 PT_ARM_EXIDX 段, 得到运行时的索引表范围, 按进程缓存
+    3. 在索引表中二分查找 pc 所在函数, 执行它的展开指令得到调用者现场, 重复直到栈底
+    所有用户内存都通过页表查到物理页后读取, 页不在内存中就停止, 不会触发缺页.
+   @endverbatim
+ */
+
+#include "los_unwind_pri.h"
+#include "los_task_pri.h"
+#include "los_process_pri.h"
+#include "los_hw_pri.h"
+#include "los_hwi.h"
+#include "los_spinlock.h"
+#include "los_memory.h"
+#include "los_init.h"
+#include "los_vm_map.h"
+#include "los_vm_phys.h"
+#include "los_vm_common.h"
+#include "los_arch_mmu.h"
+#include "los_ld_elf_pri.h"
+
+#ifdef LOSCFG_ARCH_USER_UNWIND
+
+#define UNWIND_CACHE_NUM        4           ///< 每个进程缓存的镜像数, 一般是可执行文件, libc 和少量常用库
+#define UNWIND_PHDR_MAX         32          ///< 最多检查的程序头个数
+#define UNWIND_EXIDX_SIZE       8           ///< 索引项: 函数地址(prel31) + 展开数据
+#define UNWIND_CANTUNWIND       1           ///< 索引项中表示该函数无法展开
+#define UNWIND_COMPACT          0x80000000U ///< 紧凑格式标志位
+#define UNWIND_INSN_FINISH      0xB0
+#define UNWIND_THUMB_BIT        1U
+
+/// 一个已加载镜像的展开索引表
+typedef struct {
+    LosVmSpace *space;      ///< 所属进程空间, NULL 表示空项
+    VADDR_T base;           ///< 镜像第一个线性区的基地址
+    VADDR_T end;            ///< 镜像最后一个线性区的结束地址, pc 落在 [base, end) 内就命中, 不需要查线性区
+    VADDR_T exidxStart;     ///< 运行时 .ARM.exidx 的起止地址
+    VADDR_T exidxEnd;
+} UnwindTable;
+
+/// 按进程缓存的索引表, 以镜像的地址范围为键. 在 regionMux 保护下填入, 镜像的线性区释放时由 OsUnwindRegionFree 作废
+typedef struct {
+    UnwindTable table[UNWIND_CACHE_NUM];
+    UINT32 next;            ///< 下一个被替换的项
+} UnwindCache;
+
+/// 展开指令流, 指令按字节从高到低排列在若干个字中
+typedef struct {
+    LosVmSpace *space;
+    VADDR_T addr;           ///< 当前字的地址
+    UINT32 word;            ///< 当前字的内容
+    INT32 byte;             ///< 当前字中下一条指令的字节序号, 3 为最高字节
+    UINT32 words;           ///< 包括当前字在内剩余的字数
+} UnwindInsn;
+
+STATIC UnwindCache *g_unwindCache = NULL; ///< g_processMaxNum 个, 按进程号索引
+LITE_OS_SEC_BSS STATIC SPIN_LOCK_INIT(g_unwindSpin);
+
+extern BOOL g_excFromUserMode[LOSCFG_KERNEL_CORE_NUM];
+
+STATIC BOOL OsUnwindRead(LosVmSpace *space, VADDR_T vaddr, UINT32 *value)
+{
+    PADDR_T paddr;
+    UINT32 *kvaddr = NULL;
+
+    if (!IS_ALIGNED(vaddr, sizeof(UINT32)) || !LOS_IsUserAddress(vaddr)) {
+        return FALSE;
+    }
+    if (LOS_ArchMmuQuery(&space->archMmu, vaddr, &paddr, NULL) != LOS_OK) {
+        return FALSE;
+    }
+    kvaddr = (UINT32 *)LOS_PaddrToKVaddr(paddr);
+    if (kvaddr == NULL) {
+        return FALSE;
+    }
+    *value = *kvaddr;
+    return TRUE;
+}
+
+STATIC BOOL OsUnwindReadBuf(LosVmSpace *space, VADDR_T vaddr, VOID *buf, UINT32 size)
+{
+    UINT32 *word = (UINT32 *)buf;
+    UINT32 i;
+
+    for (i = 0; i < size / sizeof(UINT32); i++) {
+        if (OsUnwindRead(space, vaddr + i * sizeof(UINT32), &word[i]) != TRUE) {
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+/// prel31: 相对自身地址的 31 位有符号偏移
+STATIC INLINE VADDR_T OsUnwindPrel31(VADDR_T addr, UINT32 value)
+{
+    return addr + (VADDR_T)((INT32)(value << 1) >> 1);
+}
+
+/// 往前找同一文件的第一个线性区, ELF 头映射在它的起始处, 往后找到同一文件的最后一个线性区. 调用者持有 regionMux
+STATIC LosVmMapRegion *OsUnwindImageRegion(LosVmSpace *space, VADDR_T pc, VADDR_T *end)
+{
+    LosVmMapRegion *region = OsFindRegion(&space->regionRbTree, pc, 1);
+    LosVmMapRegion *last = region;
+    LosVmMapRegion *next = NULL;
+
+    if ((region == NULL) || !LOS_IsRegionFileValid(region)) {
+        return NULL;
+    }
+    while (((next = OsFindRegion(&space->regionRbTree, region->range.base - 1, 1)) != NULL) &&
+           LOS_IsRegionFileValid(next) && (next->unTypeData.rf.vnode == region->unTypeData.rf.vnode)) {
+        region = next;
+    }
+    while (((next = OsFindRegion(&space->regionRbTree, last->range.base + last->range.size, 1)) != NULL) &&
+           LOS_IsRegionFileValid(next) && (next->unTypeData.rf.vnode == last->unTypeData.rf.vnode)) {
+        last = next;
+    }
+    *end = last->range.base + last->range.size;
+    return region;
+}
+
+/// 从映射的 ELF 程序头中找 PT_ARM_EXIDX 段, 加载偏移由第一个 PT_LOAD 段算出
+STATIC BOOL OsUnwindTableLoad(LosVmSpace *space, const LosVmMapRegion *image, VADDR_T end, UnwindTable *table)
+{
+    LDElf32Ehdr ehdr;
+    LDElf32Phdr phdr;
+    VADDR_T base = image->range.base;
+    VADDR_T bias = 0;
+    VADDR_T exidx = 0;
+    UINT32 exidxSize = 0;
+    BOOL loadFound = FALSE;
+    UINT32 i;
+
+    if ((OsUnwindReadBuf(space, base, &ehdr, sizeof(ehdr)) != TRUE) ||
+        (memcmp(ehdr.elfIdent, LD_ELFMAG, sizeof(LD_ELFMAG) - 1) != 0) ||
+        (ehdr.elfPhEntSize != sizeof(LDElf32Phdr))) {
+        return FALSE;
+    }
+
+    for (i = 0; (i < ehdr.elfPhNum) && (i < UNWIND_PHDR_MAX); i++) {
+        if (OsUnwindReadBuf(space, base + ehdr.elfPhoff + i * sizeof(phdr), &phdr, sizeof(phdr)) != TRUE) {
+            return FALSE;
+        }
+        if ((phdr.type == LD_PT_LOAD) && (loadFound == FALSE)) {
+            bias = base - ROUNDDOWN(phdr.vAddr, PAGE_SIZE);
+            loadFound = TRUE;
+        } else if (phdr.type == LD_PT_ARM_EXIDX) {
+            exidx = phdr.vAddr;
+            exidxSize = phdr.memSize;
+        }
+    }
+    if ((loadFound == FALSE) || (exidxSize < UNWIND_EXIDX_SIZE)) {
+        return FALSE;
+    }
+
+    table->space = space;
+    table->base = base;
+    table->end = end;
+    table->exidxStart = bias + exidx;
+    table->exidxEnd = table->exidxStart + ROUNDDOWN(exidxSize, UNWIND_EXIDX_SIZE);
+    return TRUE;
+}
+
+STATIC BOOL OsUnwindTableFind(const UnwindCache *cache, const LosVmSpace *space, VADDR_T pc, UnwindTable *out)
+{
+    UINT32 intSave;
+    UINT32 i;
+
+    LOS_SpinLockSave(&g_unwindSpin, &intSave);
+    for (i = 0; i < UNWIND_CACHE_NUM; i++) {
+        if ((cache->table[i].space == space) && (pc >= cache->table[i].base) && (pc < cache->table[i].end)) {
+            *out = cache->table[i];
+            LOS_SpinUnlockRestore(&g_unwindSpin, intSave);
+            return TRUE;
+        }
+    }
+    LOS_SpinUnlockRestore(&g_unwindSpin, intSave);
+    return FALSE;
+}
+
+/*
+ * 能否去拿 regionMux. LOS_MuxTrylock 也要拿调度锁, 中断里不能调用, 本核持有调度锁时会自锁;
+ * 持调度锁时中断一定是关的, 所以关中断时只查缓存. 用户态异常时本核不持有任何内核锁, 可以拿.
+ */
+STATIC BOOL OsUnwindRegionLockable(VOID)
+{
+    if (OS_INT_ACTIVE) {
+        return FALSE;
+    }
+    return (OsIntLocked() == 0) || (g_excFromUserMode[ArchCurrCpuid()] == TRUE);
+}
+
+STATIC BOOL OsUnwindTableGet(LosVmSpace *space, UINT32 processID, VADDR_T pc, UnwindTable *out)
+{
+    UnwindCache *cache = &g_unwindCache[processID];
+    LosVmMapRegion *image = NULL;
+    UnwindTable table;
+    VADDR_T end = 0;
+    UINT32 intSave;
+    BOOL ret = FALSE;
+
+    if (OsUnwindTableFind(cache, space, pc, out) == TRUE) {
+        return TRUE;
+    }
+
+    /* 没缓存时只尝试拿一次锁, 拿不到就放弃这次展开, 不会在 trace 或 perf 路径上阻塞 */
+    if (!OsUnwindRegionLockable() || (LOS_MuxTrylock(&space->regionMux) != LOS_OK)) {
+        return FALSE;
+    }
+    /* 持锁读 ELF 头和写缓存, 和 LOS_RegionFree 里的作废互斥. 读不到(页不在内存)时不缓存, 下次再试 */
+    image = OsUnwindImageRegion(space, pc, &end);
+    if ((image != NULL) && (OsUnwindTableLoad(space, image, end, &table) == TRUE)) {
+        LOS_SpinLockSave(&g_unwindSpin, &intSave);
+        cache->table[cache->next] = table;
+        cache->next = (cache->next + 1) % UNWIND_CACHE_NUM;
+        LOS_SpinUnlockRestore(&g_unwindSpin, intSave);
+        *out = table;
+        ret = TRUE;
+    }
+    (VOID)LOS_MuxUnlock(&space->regionMux);
+    return ret;
+}
+
+VOID OsUnwindRegionFree(const LosVmSpace *space, const LosVmMapRegion *region)
+{
+    VADDR_T base = region->range.base;
+    VADDR_T end = base + region->range.size;
+    UnwindTable *table = NULL;
+    UINT32 intSave;
+    UINT32 pid, i;
+
+    if (g_unwindCache == NULL) {
+        return;
+    }
+
+    /* 线性区释放时进程可能已经不是当前进程(退出回收), 按空间匹配, 扫一遍所有进程的缓存 */
+    LOS_SpinLockSave(&g_unwindSpin, &intSave);
+    for (pid = 0; pid < g_processMaxNum; pid++) {
+        for (i = 0; i < UNWIND_CACHE_NUM; i++) {
+            table = &g_unwindCache[pid].table[i];
+            if ((table->space == space) && (table->base < end) && (base < table->end)) {
+                table->space = NULL;
+            }
+        }
+    }
+    LOS_SpinUnlockRestore(&g_unwindSpin, intSave);
+}
+
+/// 二分查找起始地址不大于 pc 的最后一个索引项
+STATIC BOOL OsUnwindIndexFind(LosVmSpace *space, const UnwindTable *table, VADDR_T pc, VADDR_T *entry)
+{
+    UINT32 low = 0;
+    UINT32 high = (table->exidxEnd - table->exidxStart) / UNWIND_EXIDX_SIZE;
+    UINT32 mid, value;
+    VADDR_T addr;
+
+    while (low < high) {
+        mid = low + (high - low) / 2; /* 2: 二分 */
+        addr = table->exidxStart + mid * UNWIND_EXIDX_SIZE;
+        if (OsUnwindRead(space, addr, &value) != TRUE) {
+            return FALSE;
+        }
+        if (OsUnwindPrel31(addr, value) <= pc) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    if (low == 0) {
+        return FALSE;
+    }
+    *entry = table->exidxStart + (low - 1) * UNWIND_EXIDX_SIZE;
+    return TRUE;
+}
+
+/// 按个性例程的格式定位展开指令, 只支持 ARM 定义的紧凑格式 0/1/2 和 gcc 通用例程的数据格式
+STATIC BOOL OsUnwindInsnInit(LosVmSpace *space, VADDR_T entry, UnwindInsn *insn)
+{
+    UINT32 data;
+    UINT32 index;
+
+    insn->space = space;
+    insn->addr = entry + sizeof(UINT32);
+    if ((OsUnwindRead(space, insn->addr, &data) != TRUE) || (data == UNWIND_CANTUNWIND)) {
+        return FALSE;
+    }
+
+    if (!(data & UNWIND_COMPACT)) { /* 指向 .ARM.extab 中的展开表项 */
+        insn->addr = OsUnwindPrel31(insn->addr, data);
+        if (OsUnwindRead(space, insn->addr, &data) != TRUE) {
+            return FALSE;
+        }
+        if (!(data & UNWIND_COMPACT)) { /* 通用个性例程, 展开数据紧跟在例程地址之后 */
+            insn->addr += sizeof(UINT32);
+            if (OsUnwindRead(space, insn->addr, &data) != TRUE) {
+                return FALSE;
+            }
+            insn->word = data;
+            insn->byte = 2;                 /* 2: 最高字节是后续字数 */
+            insn->words = 1 + (data >> 24); /* 24: 后续字数所在位置 */
+            return TRUE;
+        }
+    }
+
+    index = (data >> 24) & 0xF; /* 24: 个性例程序号所在位置 */
+    insn->word = data;
+    if (index == 0) {           /* Su16: 3 条指令 */
+        insn->byte = 2;         /* 2: 跳过格式字节 */
+        insn->words = 1;
+    } else if (index <= 2) {    /* 2: Lu16/Lu32, 次高字节是后续字数 */
+        insn->byte = 1;
+        insn->words = 1 + ((data >> 16) & 0xFF); /* 16: 后续字数所在位置 */
+    } else {
+        return FALSE;
+    }
+    return TRUE;
+}
+
+/// 取下一条指令字节, 指令用完时相当于 FINISH
+STATIC UINT8 OsUnwindInsnByte(UnwindInsn *insn)
+{
+    UINT8 byte;
+
+    if (insn->byte < 0) {
+        if (insn->words <= 1) {
+            return UNWIND_INSN_FINISH;
+        }
+        insn->words--;
+        insn->addr += sizeof(UINT32);
+        if (OsUnwindRead(insn->space, insn->addr, &insn->word) != TRUE) {
+            return UNWIND_INSN_FINISH;
+        }
+        insn->byte = 3; /* 3: 从最高字节开始 */
+    }
+    byte = (UINT8)(insn->word >> ((UINT32)insn->byte * 8)); /* 8: bits per byte */
+    insn->byte--;
+    return byte;
+}
+
+/// 按掩码从 vsp 依次弹出 r0-r15, 弹出 sp 时 vsp 以弹出的值为准
+STATIC BOOL OsUnwindPop(LosVmSpace *space, UnwindRegs *regs, VADDR_T *vsp, UINT32 mask, BOOL *pcSet)
+{
+    VADDR_T sp = *vsp;
+    UINT32 value;
+    UINT32 i;
+
+    for (i = 0; i < UNWIND_REG_NUM; i++) {
+        if (!(mask & (1U << i))) {
+            continue;
+        }
+        if (OsUnwindRead(space, sp, &value) != TRUE) {
+            return FALSE;
+        }
+        regs->R[i] = value;
+        sp += sizeof(UINT32);
+    }
+    *vsp = (mask & (1U << UNWIND_REG_SP)) ? regs->R[UNWIND_REG_SP] : sp;
+    if (mask & (1U << UNWIND_REG_PC)) {
+        *pcSet = TRUE;
+    }
+    return TRUE;
+}
+
+/// 执行展开指令, 见 ARM EHABI 10.3 "Frame unwinding instructions"
+STATIC BOOL OsUnwindExec(UnwindInsn *insn, UnwindRegs *regs, BOOL *pcSet)
+{
+    VADDR_T vsp = regs->R[UNWIND_REG_SP];
+    UINT32 op, arg, shift;
+    BOOL ret = TRUE;
+
+    while (ret == TRUE) {
+        op = OsUnwindInsnByte(insn);
+        if ((op & 0xC0) == 0x00) {              /* 00xxxxxx: vsp += (x << 2) + 4 */
+            vsp += ((op & 0x3F) << 2) + 4;      /* 2, 4: 以字为单位 */
+        } else if ((op & 0xC0) == 0x40) {       /* 01xxxxxx: vsp -= (x << 2) + 4 */
+            vsp -= ((op & 0x3F) << 2) + 4;      /* 2, 4: 以字为单位 */
+        } else if ((op & 0xF0) == 0x80) {       /* 1000iiii iiiiiiii: 按掩码弹出 r4-r15 */
+            arg = ((op & 0xF) << 8) | OsUnwindInsnByte(insn); /* 8: 12 位掩码 */
+            ret = (arg != 0) && OsUnwindPop(insn->space, regs, &vsp, arg << 4, pcSet); /* 4: 从 r4 开始 */
+        } else if ((op & 0xF0) == 0x90) {       /* 1001nnnn: vsp = r[nnnn] */
+            arg = op & 0xF;
+            ret = (arg != UNWIND_REG_SP) && (arg != UNWIND_REG_PC);
+            vsp = regs->R[arg];
+        } else if ((op & 0xF0) == 0xA0) {       /* 1010Lnnn: 弹出 r4-r[4+nnn], L 为 1 时再弹出 r14 */
+            arg = ((1U << ((op & 0x7) + 1)) - 1) << 4; /* 4: 从 r4 开始 */
+            arg |= (op & 0x8) ? (1U << UNWIND_REG_LR) : 0;
+            ret = OsUnwindPop(insn->space, regs, &vsp, arg, pcSet);
+        } else if (op == UNWIND_INSN_FINISH) {
+            break;
+        } else if (op == 0xB1) {                /* 10110001 0000iiii: 按掩码弹出 r0-r3 */
+            arg = OsUnwindInsnByte(insn);
+            ret = (arg != 0) && !(arg & 0xF0) && OsUnwindPop(insn->space, regs, &vsp, arg, pcSet);
+        } else if (op == 0xB2) {                /* 10110010 uleb128: vsp += 0x204 + (uleb128 << 2) */
+            arg = 0;
+            shift = 0;
+            do {
+                op = OsUnwindInsnByte(insn);
+                arg |= (op & 0x7F) << shift;
+                shift += 7;                     /* 7: uleb128 每字节 7 位 */
+            } while ((op & 0x80) && (shift < 32)); /* 32: bits of arg */
+            vsp += 0x204 + (arg << 2);          /* 2: 以字为单位 */
+        } else if (op == 0xC7) {                /* 11000111 0000iiii: 弹出 wCGR */
+            arg = OsUnwindInsnByte(insn);
+            vsp += __builtin_popcount(arg & 0xF) * sizeof(UINT32);
+        } else if ((op == 0xB3) || (op == 0xC8) || (op == 0xC9) || (op == 0xC6)) {
+            /* 弹出 VFP/iWMMXt 寄存器 d[ssss]-d[ssss+cccc], FSTMFDX 格式(B3)多一个字 */
+            arg = OsUnwindInsnByte(insn);
+            vsp += ((arg & 0xF) + 1) * sizeof(UINT64) + ((op == 0xB3) ? sizeof(UINT32) : 0);
+        } else if ((op & 0xF8) == 0xB8) {       /* 10111nnn: FSTMFDX 弹出 d8-d[8+nnn] */
+            vsp += ((op & 0x7) + 1) * sizeof(UINT64) + sizeof(UINT32);
+        } else if (((op & 0xF8) == 0xC0) || ((op & 0xF8) == 0xD0)) { /* 11000nnn/11010nnn: 弹出 8 字节寄存器 */
+            vsp += ((op & 0x7) + 1) * sizeof(UINT64);
+        } else {                                /* spare 或 refuse to unwind */
+            ret = FALSE;
+        }
+    }
+    regs->R[UNWIND_REG_SP] = vsp;
+    return ret;
+}
+
+/// 展开一帧, regs 变为调用者的现场
+STATIC BOOL OsUnwindFrame(LosVmSpace *space, UINT32 processID, UnwindRegs *regs, VADDR_T pc)
+{
+    UnwindTable table;
+    UnwindInsn insn;
+    VADDR_T entry;
+    VADDR_T sp = regs->R[UNWIND_REG_SP];
+    VADDR_T oldPc = regs->R[UNWIND_REG_PC] & ~UNWIND_THUMB_BIT;
+    BOOL pcSet = FALSE;
+
+    if ((OsUnwindTableGet(space, processID, pc, &table) != TRUE) ||
+        (OsUnwindIndexFind(space, &table, pc, &entry) != TRUE) ||
+        (OsUnwindInsnInit(space, entry, &insn) != TRUE) ||
+        (OsUnwindExec(&insn, regs, &pcSet) != TRUE)) {
+        return FALSE;
+    }
+    if (pcSet == FALSE) {
+        regs->R[UNWIND_REG_PC] = regs->R[UNWIND_REG_LR];
+    }
+    /* 栈向低地址增长, 调用者的 sp 不会更低, sp 和 pc 都不变说明没有进展 */
+    if ((regs->R[UNWIND_REG_SP] < sp) ||
+        ((regs->R[UNWIND_REG_SP] == sp) && ((regs->R[UNWIND_REG_PC] & ~UNWIND_THUMB_BIT) == oldPc))) {
+        return FALSE;
+    }
+    return TRUE;
+}
+
+UINT32 OsUnwindUser(UnwindRegs *regs, UINTPTR *pcs, UINT32 maxDepth)
+{
+    LosProcessCB *processCB = OsCurrProcessGet();
+    VADDR_T pc;
+    UINT32 count = 0;
+
+    if ((g_unwindCache == NULL) || (pcs == NULL) || !OsProcessIsUserMode(processCB)) {
+        return 0;
+    }
+
+    while (count < maxDepth) {
+        pc = regs->R[UNWIND_REG_PC] & ~UNWIND_THUMB_BIT;
+        if (!LOS_IsUserAddress(pc)) {
+            break;
+        }
+        pcs[count++] = pc;
+        /* 返回地址可能已越过函数末尾(调用 noreturn 函数), 往回退一条指令再查找所在函数 */
+        if (OsUnwindFrame(processCB->vmSpace, processCB->processID, regs,
+                          (count == 1) ? pc : (pc - sizeof(UINT16))) != TRUE) {
+            break;
+        }
+    }
+    return count;
+}
+
+BOOL OsUnwindUserRegsGet(UnwindRegs *regs)
+{
+    LosTaskCB *taskCB = OsCurrTaskGet();
+    const TaskContext *context = NULL;
+
+    if (!OsProcessIsUserMode(OsCurrProcessGet()) || (regs == NULL)) {
+        return FALSE;
+    }
+
+    /* 用户态任务陷入内核时, 用户态现场保存在内核栈底, 见 OsUserCloneParentStack */
+    context = (const TaskContext *)((taskCB->topOfStack + taskCB->stackSize) - sizeof(TaskContext));
+    (VOID)memset_s(regs, sizeof(UnwindRegs), 0, sizeof(UnwindRegs));
+    regs->R[0] = context->R0;                           /* 0: r0 */
+    regs->R[1] = context->R1;                           /* 1: r1 */
+    regs->R[2] = context->R2;                           /* 2: r2 */
+    regs->R[3] = context->R3;                           /* 3: r3 */
+    regs->R[4] = context->R4;                           /* 4: r4 */
+    regs->R[5] = context->R5;                           /* 5: r5 */
+    regs->R[6] = context->R6;                           /* 6: r6 */
+    regs->R[UNWIND_REG_R7] = context->R7;
+    regs->R[8] = context->R8;                           /* 8: r8 */
+    regs->R[9] = context->R9;                           /* 9: r9 */
+    regs->R[10] = context->R10;                         /* 10: r10 */
+    regs->R[UNWIND_REG_FP] = context->R11;
+    regs->R[12] = context->R12;                         /* 12: r12 */
+    regs->R[UNWIND_REG_SP] = context->USP;
+    regs->R[UNWIND_REG_LR] = context->ULR;
+    regs->R[UNWIND_REG_PC] = context->PC;
+    return TRUE;
+}
+
+STATIC UINT32 OsUnwindInit(VOID)
+{
+    UINT32 size = g_processMaxNum * sizeof(UnwindCache);
+
+    g_unwindCache = (UnwindCache *)LOS_MemAlloc(m_aucSysMem0, size);
+    if (g_unwindCache == NULL) {
+        return LOS_NOK;
+    }
+    (VOID)memset_s(g_unwindCache, size, 0, size);
+    return LOS_OK;
+}
+
+LOS_MODULE_INIT(OsUnwindInit, LOS_INIT_LEVEL_KMOD_EXTENDED);
+#endif
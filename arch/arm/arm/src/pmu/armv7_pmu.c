@@ -314,7 +314,7 @@ STATIC VOID Armv7PmuIrqHandler(VOID)
          * We have a single interrupt for all counters. Check that
          * each counter has overflowed before we process it.
          */
-        if (!Armv7PmuCntOverflowed(pmnc, event->counter) || (event->period == 0)) {
+        if (!Armv7PmuCntOverflowed(pmnc, event->counter) || (event->period == 0) || !OsPerfHwEventActive(event)) {
             continue;
         }
 
@@ -323,7 +323,14 @@ STATIC VOID Armv7PmuIrqHandler(VOID)
         OsPerfUpdateEventCount(event, event->period);
         OsPerfHandleOverFlow(event, &regs);
     }
-    Armv7StartAllCnt();
+    OsPerfHwMuxTick(); /* multiplexed groups rotate here while the counters are stopped */
+    /*
+     * An overflow may still be pending when the cpu switches to a task that is filtered out, the counters were
+     * stopped by OsPerfHwPause then and have to stay stopped until the next filtered task resumes them.
+     */
+    if (OsPerfHwCounting()) {
+        Armv7StartAllCnt();
+    }
 }
 
 UINT32 OsGetPmuMaxCounter(VOID)
@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2013-2019 Huawei Technologies Co., Ltd. All rights reserved.
+ * Copyright (c) 2020-2021 Huawei Device Co., Ltd. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of
+ *    conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list
+ *    of conditions and the following disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used
+ *    to endorse or promote products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __LOS_DEV_EVENTFD_H__
+#define __LOS_DEV_EVENTFD_H__
+
+#include "los_event.h"
+#include "los_spinlock.h"
+#include "linux/wait.h"
+#include "sys/ioctl.h"
+
+#ifdef __cplusplus
+#if __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+#endif /* __cplusplus */
+
+/*
+ * A kernel event group exported as a device file. A user process opens the file and then
+ * read()s a 4-byte event mask (blocking unless O_NONBLOCK, the bits read are cleared),
+ * write()s a 4-byte event mask to set bits, or waits for POLLIN with poll/select/epoll.
+ * Only the bits in eventMask are visible through the file.
+ */
+typedef struct {
+    PEVENT_CB_S eventCB;    /* exported event group, must stay valid until unregistered */
+    unsigned int eventMask; /* bits visible to userspace */
+    wait_queue_head_t wait; /* poll waiters, woken on every write of a visible bit */
+} EventFdDev;
+
+extern int EventFdRegister(EventFdDev *dev, const char *path, PEVENT_CB_S eventCB, unsigned int eventMask);
+
+extern int EventFdUnregister(EventFdDev *dev, const char *path);
+
+/*
+ * EVENTFD_DRIVER behaves like Linux eventfd: every open() gets its own 64-bit counter.
+ * write() adds an 8-byte value. It blocks, or fails with EAGAIN under O_NONBLOCK, while the sum
+ * would exceed EVENTFD_COUNTER_MAX. read() returns the counter and resets it to 0. In semaphore
+ * mode, read() returns 1 and decrements the counter. poll reports POLLIN while the counter is
+ * non-zero, and POLLOUT while a write of 1 would not block. Blocking is done on a kernel event
+ * group, so the poll wakeup uses the same notifier as the exported groups above.
+ */
+#define EVENTFD_DRIVER          "/dev/eventfd"
+#define EVENTFD_COUNTER_MAX     0xFFFFFFFFFFFFFFFEULL
+#define EVENTFD_IOC_MAGIC       'E'
+#define EVENTFD_SET_SEMAPHORE   _IO(EVENTFD_IOC_MAGIC, 1) /* arg != 0: semaphore mode, 0: counter mode */
+
+typedef struct {
+    EVENT_CB_S event;       /* EVENTFD_READABLE/EVENTFD_WRITABLE, blocked readers and writers wait here */
+    SPIN_LOCK_S lock;       /* protects count, semaphore, users and closing */
+    UINT64 count;
+    BOOL semaphore;
+    BOOL closing;           /* set by close, new reads and writes fail with EBADF */
+    UINT32 users;           /* reads and writes in progress, close waits for them to drain */
+    wait_queue_head_t wait; /* poll waiters, woken through the event notifier */
+} EventFdCounter;
+
+#ifdef __cplusplus
+#if __cplusplus
+}
+#endif /* __cplusplus */
+#endif /* __cplusplus */
+
+#endif
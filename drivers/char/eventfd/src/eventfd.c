@@ -0,0 +1,511 @@
+/*
+ * Copyright (c) 2013-2019 Huawei Technologies Co., Ltd. All rights reserved.
+ * Copyright (c) 2020-2021 Huawei Device Co., Ltd. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of
+ *    conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list
+ *    of conditions and the following disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used
+ *    to endorse or promote products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "fcntl.h"
+#include "poll.h"
+#include "user_copy.h"
+#include "fs/file.h"
+#include "fs/driver.h"
+#include "los_dev_eventfd.h"
+#include "los_event_pri.h"
+#include "los_init.h"
+#include "los_memory.h"
+#include "los_task.h"
+
+#define EVENTFD_DRIVER_MODE  0600 /* exported kernel event groups, owner only */
+#define EVENTFD_COUNTER_MODE 0666 /* every open gets a private counter */
+#define EVENTFD_READABLE     0x1U
+#define EVENTFD_WRITABLE     0x2U
+
+static EventFdDev *EventFdDevGet(const struct file *filep)
+{
+    struct drv_data *drv = NULL;
+
+    if ((filep == NULL) || (filep->f_vnode == NULL) || (filep->f_vnode->data == NULL)) {
+        return NULL;
+    }
+
+    drv = (struct drv_data *)filep->f_vnode->data;
+    return (EventFdDev *)drv->priv;
+}
+
+static int EventFdOpen(struct file *filep)
+{
+    (void)filep;
+    return 0;
+}
+
+static int EventFdClose(struct file *filep)
+{
+    (void)filep;
+    return 0;
+}
+
+static ssize_t EventFdRead(struct file *filep, char *buffer, size_t buflen)
+{
+    EventFdDev *dev = EventFdDevGet(filep);
+    UINT32 timeout = LOS_WAIT_FOREVER;
+    UINT32 events;
+
+    if (dev == NULL) {
+        return -EINVAL;
+    }
+
+    if (buflen < sizeof(UINT32)) {
+        return -EINVAL;
+    }
+
+    if (filep->f_oflags & O_NONBLOCK) {
+        timeout = LOS_NO_WAIT;
+    }
+
+    events = LOS_EventRead(dev->eventCB, dev->eventMask, LOS_WAITMODE_OR | LOS_WAITMODE_CLR, timeout);
+    if (events & LOS_ERRTYPE_ERROR) {
+        return -EINVAL;
+    }
+
+    if (events == 0) {
+        return -EAGAIN;
+    }
+
+    if (LOS_CopyFromKernel(buffer, buflen, &events, sizeof(UINT32)) != 0) {
+        return -EFAULT;
+    }
+
+    return sizeof(UINT32);
+}
+
+static ssize_t EventFdWrite(struct file *filep, const char *buffer, size_t buflen)
+{
+    EventFdDev *dev = EventFdDevGet(filep);
+    UINT32 events = 0;
+
+    if (dev == NULL) {
+        return -EINVAL;
+    }
+
+    if (buflen < sizeof(UINT32)) {
+        return -EINVAL;
+    }
+
+    if (LOS_CopyToKernel(&events, sizeof(UINT32), buffer, sizeof(UINT32)) != 0) {
+        return -EFAULT;
+    }
+
+    events &= dev->eventMask;
+    if (events == 0) {
+        return -EINVAL;
+    }
+
+    if (LOS_EventWrite(dev->eventCB, events) != LOS_OK) {
+        return -EINVAL;
+    }
+
+    return sizeof(UINT32);
+}
+
+static int EventFdPoll(struct file *filep, poll_table *table)
+{
+    EventFdDev *dev = EventFdDevGet(filep);
+    int mask = POLLOUT | POLLWRNORM;
+
+    if (dev == NULL) {
+        return -EINVAL;
+    }
+
+    poll_wait(filep, &dev->wait, table);
+
+    if (*(volatile UINT32 *)&dev->eventCB->uwEventID & dev->eventMask) {
+        mask |= POLLIN | POLLRDNORM;
+    }
+    return mask;
+}
+
+static const struct file_operations_vfs g_eventFdDevOps = {
+    EventFdOpen,     /* open */
+    EventFdClose,    /* close */
+    EventFdRead,     /* read */
+    EventFdWrite,    /* write */
+    NULL,            /* seek */
+    NULL,            /* ioctl */
+    NULL,            /* mmap */
+#ifndef CONFIG_DISABLE_POLL
+    EventFdPoll,     /* poll */
+#endif
+    NULL,            /* unlink */
+};
+
+/* called by LOS_EventWrite outside the scheduler lock, possibly in interrupt context */
+static VOID EventFdNotify(PEVENT_CB_S eventCB, UINT32 events, VOID *arg)
+{
+    EventFdDev *dev = (EventFdDev *)arg;
+
+    (void)eventCB;
+    if (events & dev->eventMask) {
+        notify_poll(&dev->wait);
+    }
+}
+
+/* called by LOS_EventWrite on the counter's own event group */
+static VOID EventFdCounterNotify(PEVENT_CB_S eventCB, UINT32 events, VOID *arg)
+{
+    EventFdCounter *efd = (EventFdCounter *)arg;
+
+    (void)eventCB;
+    (void)events;
+    notify_poll(&efd->wait);
+}
+
+/*
+ * Tell the waiters what the counter allows now. Stale bits only cost a spurious wakeup, because every
+ * waiter checks the counter again under the lock. The bits are re-raised after each read and write, so
+ * a waiter that consumed a bit cannot leave the next waiter asleep.
+ */
+static VOID EventFdCounterSignal(EventFdCounter *efd, UINT64 count)
+{
+    UINT32 events = 0;
+
+    if (count != 0) {
+        events |= EVENTFD_READABLE;
+    }
+    if (count < EVENTFD_COUNTER_MAX) {
+        events |= EVENTFD_WRITABLE;
+    }
+    (VOID)LOS_EventWrite(&efd->event, events);
+}
+
+static int EventFdCounterOpen(struct file *filep)
+{
+    EventFdCounter *efd = (EventFdCounter *)LOS_MemAlloc(m_aucSysMem0, sizeof(EventFdCounter));
+
+    if (efd == NULL) {
+        return -ENOMEM;
+    }
+
+    (void)memset_s(efd, sizeof(EventFdCounter), 0, sizeof(EventFdCounter));
+    (VOID)LOS_EventInit(&efd->event);
+    LOS_SpinInit(&efd->lock);
+    init_waitqueue_head(&efd->wait);
+    (VOID)OsEventNotifySet(&efd->event, EventFdCounterNotify, efd);
+
+    filep->f_priv = efd;
+    return 0;
+}
+
+/* every read and write holds a use of the counter, so close can wait for them to leave before freeing it */
+static int EventFdCounterGet(EventFdCounter *efd)
+{
+    UINT32 intSave;
+    int ret = 0;
+
+    LOS_SpinLockSave(&efd->lock, &intSave);
+    if (efd->closing) {
+        ret = -EBADF;
+    } else {
+        efd->users++;
+    }
+    LOS_SpinUnlockRestore(&efd->lock, intSave);
+    return ret;
+}
+
+static VOID EventFdCounterPut(EventFdCounter *efd)
+{
+    UINT32 intSave;
+
+    LOS_SpinLockSave(&efd->lock, &intSave);
+    efd->users--;
+    LOS_SpinUnlockRestore(&efd->lock, intSave);
+}
+
+static int EventFdCounterClose(struct file *filep)
+{
+    EventFdCounter *efd = (EventFdCounter *)filep->f_priv;
+    UINT32 users;
+    UINT32 intSave;
+
+    if (efd == NULL) {
+        return -EINVAL;
+    }
+
+    LOS_SpinLockSave(&efd->lock, &intSave);
+    efd->closing = TRUE;
+    LOS_SpinUnlockRestore(&efd->lock, intSave);
+
+    /* wake the blocked readers and writers, they see closing and leave with EBADF */
+    for (;;) {
+        LOS_SpinLockSave(&efd->lock, &intSave);
+        users = efd->users;
+        LOS_SpinUnlockRestore(&efd->lock, intSave);
+        if (users == 0) {
+            break;
+        }
+        (VOID)LOS_EventWrite(&efd->event, EVENTFD_READABLE | EVENTFD_WRITABLE);
+        (VOID)LOS_TaskDelay(1);
+    }
+
+    if (LOS_EventDestroy(&efd->event) != LOS_OK) {
+        return -EBUSY;
+    }
+    (VOID)OsEventNotifySet(&efd->event, NULL, NULL);
+
+    filep->f_priv = NULL;
+    (VOID)LOS_MemFree(m_aucSysMem0, efd);
+    return 0;
+}
+
+/* wait until the counter is non-zero and take from it, called with a use held */
+static int EventFdCounterTake(EventFdCounter *efd, int oflags, UINT64 *value)
+{
+    UINT64 count;
+    UINT32 intSave;
+    UINT32 ret;
+
+    for (;;) {
+        LOS_SpinLockSave(&efd->lock, &intSave);
+        if (efd->closing) {
+            LOS_SpinUnlockRestore(&efd->lock, intSave);
+            return -EBADF;
+        }
+        if (efd->count != 0) {
+            break;
+        }
+        LOS_SpinUnlockRestore(&efd->lock, intSave);
+
+        if (oflags & O_NONBLOCK) {
+            return -EAGAIN;
+        }
+        ret = LOS_EventRead(&efd->event, EVENTFD_READABLE, LOS_WAITMODE_OR | LOS_WAITMODE_CLR, LOS_WAIT_FOREVER);
+        if (ret & LOS_ERRTYPE_ERROR) {
+            return -EINVAL;
+        }
+    }
+
+    *value = efd->semaphore ? 1 : efd->count;
+    efd->count -= *value;
+    count = efd->count;
+    LOS_SpinUnlockRestore(&efd->lock, intSave);
+
+    EventFdCounterSignal(efd, count);
+    return 0;
+}
+
+/* wait until value fits below EVENTFD_COUNTER_MAX and add it, called with a use held */
+static int EventFdCounterAdd(EventFdCounter *efd, int oflags, UINT64 value)
+{
+    UINT64 count;
+    UINT32 intSave;
+    UINT32 ret;
+
+    for (;;) {
+        LOS_SpinLockSave(&efd->lock, &intSave);
+        if (efd->closing) {
+            LOS_SpinUnlockRestore(&efd->lock, intSave);
+            return -EBADF;
+        }
+        if ((EVENTFD_COUNTER_MAX - efd->count) >= value) {
+            break;
+        }
+        LOS_SpinUnlockRestore(&efd->lock, intSave);
+
+        if (oflags & O_NONBLOCK) {
+            return -EAGAIN;
+        }
+        ret = LOS_EventRead(&efd->event, EVENTFD_WRITABLE, LOS_WAITMODE_OR | LOS_WAITMODE_CLR, LOS_WAIT_FOREVER);
+        if (ret & LOS_ERRTYPE_ERROR) {
+            return -EINVAL;
+        }
+    }
+
+    efd->count += value;
+    count = efd->count;
+    LOS_SpinUnlockRestore(&efd->lock, intSave);
+
+    EventFdCounterSignal(efd, count);
+    return 0;
+}
+
+static ssize_t EventFdCounterRead(struct file *filep, char *buffer, size_t buflen)
+{
+    EventFdCounter *efd = (EventFdCounter *)filep->f_priv;
+    UINT64 value = 0;
+    int ret;
+
+    if ((efd == NULL) || (buflen < sizeof(UINT64))) {
+        return -EINVAL;
+    }
+
+    ret = EventFdCounterGet(efd);
+    if (ret != 0) {
+        return ret;
+    }
+    ret = EventFdCounterTake(efd, filep->f_oflags, &value);
+    EventFdCounterPut(efd);
+    if (ret != 0) {
+        return ret;
+    }
+
+    if (LOS_CopyFromKernel(buffer, buflen, &value, sizeof(UINT64)) != 0) {
+        return -EFAULT;
+    }
+    return sizeof(UINT64);
+}
+
+static ssize_t EventFdCounterWrite(struct file *filep, const char *buffer, size_t buflen)
+{
+    EventFdCounter *efd = (EventFdCounter *)filep->f_priv;
+    UINT64 value = 0;
+    int ret;
+
+    if ((efd == NULL) || (buflen < sizeof(UINT64))) {
+        return -EINVAL;
+    }
+
+    if (LOS_CopyToKernel(&value, sizeof(UINT64), buffer, sizeof(UINT64)) != 0) {
+        return -EFAULT;
+    }
+
+    if (value > EVENTFD_COUNTER_MAX) {
+        return -EINVAL;
+    }
+
+    ret = EventFdCounterGet(efd);
+    if (ret != 0) {
+        return ret;
+    }
+    ret = EventFdCounterAdd(efd, filep->f_oflags, value);
+    EventFdCounterPut(efd);
+    if (ret != 0) {
+        return ret;
+    }
+    return sizeof(UINT64);
+}
+
+static int EventFdCounterIoctl(struct file *filep, int cmd, unsigned long arg)
+{
+    EventFdCounter *efd = (EventFdCounter *)filep->f_priv;
+    UINT32 intSave;
+
+    if ((efd == NULL) || (cmd != EVENTFD_SET_SEMAPHORE)) {
+        return -EINVAL;
+    }
+
+    LOS_SpinLockSave(&efd->lock, &intSave);
+    efd->semaphore = (arg != 0);
+    LOS_SpinUnlockRestore(&efd->lock, intSave);
+    return 0;
+}
+
+static int EventFdCounterPoll(struct file *filep, poll_table *table)
+{
+    EventFdCounter *efd = (EventFdCounter *)filep->f_priv;
+    UINT64 count;
+    UINT32 intSave;
+    int mask = 0;
+
+    if (efd == NULL) {
+        return -EINVAL;
+    }
+
+    poll_wait(filep, &efd->wait, table);
+
+    LOS_SpinLockSave(&efd->lock, &intSave);
+    count = efd->count;
+    LOS_SpinUnlockRestore(&efd->lock, intSave);
+
+    if (count != 0) {
+        mask |= POLLIN | POLLRDNORM;
+    }
+    if (count < EVENTFD_COUNTER_MAX) {
+        mask |= POLLOUT | POLLWRNORM;
+    }
+    return mask;
+}
+
+static const struct file_operations_vfs g_eventFdCounterOps = {
+    EventFdCounterOpen,     /* open */
+    EventFdCounterClose,    /* close */
+    EventFdCounterRead,     /* read */
+    EventFdCounterWrite,    /* write */
+    NULL,                   /* seek */
+    EventFdCounterIoctl,    /* ioctl */
+    NULL,                   /* mmap */
+#ifndef CONFIG_DISABLE_POLL
+    EventFdCounterPoll,     /* poll */
+#endif
+    NULL,                   /* unlink */
+};
+
+int EventFdRegister(EventFdDev *dev, const char *path, PEVENT_CB_S eventCB, unsigned int eventMask)
+{
+    int ret;
+
+    if ((dev == NULL) || (path == NULL) || (eventCB == NULL) || (eventMask == 0) ||
+        (eventMask & LOS_ERRTYPE_ERROR)) {
+        return -EINVAL;
+    }
+
+    dev->eventCB = eventCB;
+    dev->eventMask = eventMask;
+    init_waitqueue_head(&dev->wait);
+
+    if (OsEventNotifySet(eventCB, EventFdNotify, dev) != LOS_OK) {
+        return -EBUSY;
+    }
+
+    ret = register_driver(path, &g_eventFdDevOps, EVENTFD_DRIVER_MODE, dev);
+    if (ret != 0) {
+        (VOID)OsEventNotifySet(eventCB, NULL, NULL);
+    }
+    return ret;
+}
+
+int EventFdUnregister(EventFdDev *dev, const char *path)
+{
+    int ret;
+
+    if ((dev == NULL) || (path == NULL)) {
+        return -EINVAL;
+    }
+
+    ret = unregister_driver(path);
+    if (ret != 0) {
+        return ret;
+    }
+
+    return (int)OsEventNotifySet(dev->eventCB, NULL, NULL);
+}
+
+int DevEventFdRegister(void)
+{
+    return register_driver(EVENTFD_DRIVER, &g_eventFdCounterOps, EVENTFD_COUNTER_MODE, NULL);
+}
+
+LOS_MODULE_INIT(DevEventFdRegister, LOS_INIT_LEVEL_KMOD_EXTENDED);
@@ -36,6 +36,10 @@
 #include "los_dev_perf.h"
 #include "los_perf.h"
 #include "los_init.h"
+#include "los_sys.h"
+#ifdef LOSCFG_KERNEL_VM
+#include "los_vm_map.h"
+#endif
 
 #define PERF_DRIVER "/dev/perf"
 #define PERF_DRIVER_MODE 0666
@@ -44,6 +48,9 @@
 #define PERF_IOC_MAGIC     'T'
 #define PERF_START         _IO(PERF_IOC_MAGIC, 1)
 #define PERF_STOP          _IO(PERF_IOC_MAGIC, 2)
+#define PERF_WAIT          _IO(PERF_IOC_MAGIC, 3)
+#define PERF_SET_WAKEUP    _IO(PERF_IOC_MAGIC, 4)
+#define PERF_MMAP_SIZE     _IO(PERF_IOC_MAGIC, 5)
 
 static int PerfOpen(struct file *filep)
 {
@@ -124,6 +131,15 @@ static int PerfIoctl(struct file *filep, int cmd, unsigned long arg)
         case PERF_STOP:
             LOS_PerfStop();
             break;
+        case PERF_WAIT: /* arg: timeout in ms */
+            return (LOS_PerfDataWait(LOS_MS2Tick((UINT32)arg)) == LOS_OK) ? 0 : -ETIMEDOUT;
+        case PERF_SET_WAKEUP: /* arg: water mark in bytes */
+            LOS_PerfWakeupMarkSet((UINT32)arg);
+            break;
+        case PERF_MMAP_SIZE: {
+            UINT32 size = 0;
+            return (LOS_PerfRingBufGet(&size) == NULL) ? -EINVAL : (int)size;
+        }
         default:
             PRINT_ERR("Unknown perf ioctl cmd:%d\n", cmd);
             return -EINVAL;
@@ -131,6 +147,29 @@ static int PerfIoctl(struct file *filep, int cmd, unsigned long arg)
     return 0;
 }
 
+/* map the per-cpu sample rings as a whole, the offset must be 0 and the length must be PERF_MMAP_SIZE */
+static ssize_t PerfMap(struct file *filep, LosVmMapRegion *region)
+{
+    (void)filep;
+#ifdef LOSCFG_KERNEL_VM
+    UINT32 size = 0;
+    VOID *rings = LOS_PerfRingBufGet(&size);
+    LosVmSpace *space = LOS_SpaceGet(region->range.base);
+
+    if ((rings == NULL) || (space == NULL) || (region->pgOff != 0) || (region->range.size != size)) {
+        return -EINVAL;
+    }
+    if (LOS_ArchMmuMap(&space->archMmu, region->range.base, LOS_PaddrQuery(rings), size >> PAGE_SHIFT,
+                       region->regionFlags) <= 0) {
+        return -EAGAIN;
+    }
+    return 0;
+#else
+    (void)region;
+    return -ENOSYS;
+#endif
+}
+
 static const struct file_operations_vfs g_perfDevOps = {
     PerfOpen,        /* open */
     PerfClose,       /* close */
@@ -138,7 +177,7 @@ static const struct file_operations_vfs g_perfDevOps = {
     PerfConfig,      /* write */
     NULL,            /* seek */
     PerfIoctl,       /* ioctl */
-    NULL,            /* mmap */
+    PerfMap,         /* mmap */
 #ifndef CONFIG_DISABLE_POLL
     NULL,            /* poll */
 #endif
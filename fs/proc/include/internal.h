@@ -49,6 +49,8 @@ void ProcPmInit(void);
 
 void ProcVmmInit(void);
 
+void ProcMeminfoInit(void);
+
 void ProcProcessInit(void);
 
 int ProcMatch(unsigned int len, const char *name, struct ProcDirEntry *pde);
@@ -67,6 +69,22 @@ extern void ProcFsCacheInit(void);
 
 extern void ProcFdInit(void);
 
+#ifdef LOSCFG_KERNEL_LOCKSTAT
+extern void ProcLockStatInit(void);
+#endif
+
+#ifdef LOSCFG_KERNEL_OFFCPU
+extern void ProcOffCpuInit(void);
+#endif
+
+#ifdef LOSCFG_KERNEL_MEMPROF
+extern void ProcMemProfInit(void);
+#endif
+
+#ifdef LOSCFG_SCHED_DEBUG
+extern void ProcSchedLatencyInit(void);
+#endif
+
 #ifdef __cplusplus
 #if __cplusplus
 }
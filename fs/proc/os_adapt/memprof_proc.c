@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2013-2019 Huawei Technologies Co., Ltd. All rights reserved.
+ * Copyright (c) 2020-2021 Huawei Device Co., Ltd. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of
+ *    conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list
+ *    of conditions and the following disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used
+ *    to endorse or promote products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+#include "proc_fs.h"
+#include "internal.h"
+#include "los_memprof.h"
+
+#ifdef LOSCFG_KERNEL_MEMPROF
+#define MEMPROF_PROC_CMD_LEN 32
+#define MEMPROF_PROC_ARGC_MAX 2
+
+//cat /proc/memprof, 和 shell 命令 memprof 输出相同
+static int MemProfProcFill(struct SeqBuf *seqBuf, void *v)
+{
+    (void)v;
+    OsMemProfDump(seqBuf);
+    return 0;
+}
+
+//echo "on [interval]"/off/reset > /proc/memprof, 可以在现网上按需打开采样
+//按空白切成单词后交给 OsMemProfCmd, 和 shell 命令接受同样的输入
+static int MemProfProcWrite(struct ProcFile *pf, const char *buf, size_t count, loff_t *ppos)
+{
+    char cmd[MEMPROF_PROC_CMD_LEN] = {0};
+    const char *argv[MEMPROF_PROC_ARGC_MAX] = {NULL};
+    char *savePtr = NULL;
+    char *word = NULL;
+    int argc = 0;
+
+    (void)pf;
+    (void)ppos;
+
+    if ((buf == NULL) || (count == 0) || (count >= MEMPROF_PROC_CMD_LEN)) {
+        return -EINVAL;
+    }
+    (void)memcpy_s(cmd, sizeof(cmd), buf, count);
+
+    for (word = strtok_r(cmd, " \t\n", &savePtr); word != NULL; word = strtok_r(NULL, " \t\n", &savePtr)) {
+        if (argc == MEMPROF_PROC_ARGC_MAX) {
+            return -EINVAL;
+        }
+        argv[argc++] = word;
+    }
+
+    if ((argc == 0) || (OsMemProfCmd(argc, argv) != LOS_OK)) {
+        return -EINVAL;
+    }
+    return count;
+}
+
+static const struct ProcFileOperations MEMPROF_PROC_FOPS = {
+    .read       = MemProfProcFill,
+    .write      = MemProfProcWrite,
+};
+
+void ProcMemProfInit(void)
+{
+    struct ProcDirEntry *pde = CreateProcEntry("memprof", S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH, NULL);
+    if (pde == NULL) {
+        PRINT_ERR("create /proc/memprof error!\n");
+        return;
+    }
+
+    pde->procFileOps = &MEMPROF_PROC_FOPS;
+}
+#endif
@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2013-2019 Huawei Technologies Co., Ltd. All rights reserved.
+ * Copyright (c) 2020-2021 Huawei Device Co., Ltd. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of
+ *    conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list
+ *    of conditions and the following disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used
+ *    to endorse or promote products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "proc_fs.h"
+#include "internal.h"
+#include "los_offcpu.h"
+
+#ifdef LOSCFG_KERNEL_OFFCPU
+//cat /proc/offcpu, 和 shell 命令 offcpu 输出相同
+static int OffCpuProcFill(struct SeqBuf *seqBuf, void *v)
+{
+    (void)v;
+    OsOffCpuDump(seqBuf);
+    return 0;
+}
+
+//echo on/off/reset > /proc/offcpu, 供 perf offcpu 控制统计
+static int OffCpuProcWrite(struct ProcFile *pf, const char *buf, size_t count, loff_t *ppos)
+{
+    (void)pf;
+    (void)ppos;
+
+    if ((buf == NULL) || (count == 0)) {
+        return -EINVAL;
+    }
+
+    if (strncmp(buf, "on", strlen("on")) == 0) {
+        LOS_OffCpuStart();
+    } else if (strncmp(buf, "off", strlen("off")) == 0) {
+        LOS_OffCpuStop();
+    } else if (strncmp(buf, "reset", strlen("reset")) == 0) {
+        LOS_OffCpuReset();
+    } else {
+        return -EINVAL;
+    }
+    return count;
+}
+
+static const struct ProcFileOperations OFFCPU_PROC_FOPS = {
+    .read       = OffCpuProcFill,
+    .write      = OffCpuProcWrite,
+};
+
+void ProcOffCpuInit(void)
+{
+    struct ProcDirEntry *pde = CreateProcEntry("offcpu", S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH, NULL);
+    if (pde == NULL) {
+        PRINT_ERR("create /proc/offcpu error!\n");
+        return;
+    }
+
+    pde->procFileOps = &OFFCPU_PROC_FOPS;
+}
+#endif
@@ -59,6 +59,9 @@ void ProcFsInit(void)
     ProcMountsInit();//初始化 /proc/mounts
 #if defined(LOSCFG_SHELL_CMD_DEBUG) && defined(LOSCFG_KERNEL_VM)
     ProcVmmInit();//初始化 /proc/vmm
+#endif
+#ifdef LOSCFG_KERNEL_VM
+    ProcMeminfoInit();//初始化 /proc/meminfo
 #endif
     ProcProcessInit();//初始化 /proc/process
     ProcUptimeInit();//初始化 /proc/uptime
@@ -67,6 +70,18 @@ void ProcFsInit(void)
 #ifdef LOSCFG_KERNEL_PM
     ProcPmInit();
 #endif
+#ifdef LOSCFG_KERNEL_LOCKSTAT
+    ProcLockStatInit();//初始化 /proc/lockstat
+#endif
+#ifdef LOSCFG_KERNEL_OFFCPU
+    ProcOffCpuInit();//初始化 /proc/offcpu
+#endif
+#ifdef LOSCFG_KERNEL_MEMPROF
+    ProcMemProfInit();//初始化 /proc/memprof
+#endif
+#ifdef LOSCFG_SCHED_DEBUG
+    ProcSchedLatencyInit();//初始化 /proc/sched_latency
+#endif
 }
 
 LOS_MODULE_INIT(ProcFsInit, LOS_INIT_LEVEL_KMOD_EXTENDED);
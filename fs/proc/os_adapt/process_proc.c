@@ -33,6 +33,10 @@
 #include <sys/mount.h>
 #include "proc_fs.h"
 #include "los_process_pri.h"
+#ifdef LOSCFG_KERNEL_CPUP
+#include "los_cpup_pri.h"
+#include "los_sys_pri.h"
+#endif
 //这个太牛了,直接读 taskinfo,注意 SeqBuf 的第一个参数是 char* buf
 static int ProcessProcFill(struct SeqBuf *m, void *v)
 {
@@ -44,6 +48,54 @@ static int ProcessProcFill(struct SeqBuf *m, void *v)
 static const struct ProcFileOperations PROCESS_PROC_FOPS = {
     .read       = ProcessProcFill,//读取操作
 };
+
+#ifdef LOSCFG_KERNEL_CPUP
+static UINT64 CpuTimeCycleToNs(UINT64 cycle)
+{
+    return (cycle / OS_SYS_CLOCK) * OS_SYS_NS_PER_SECOND +
+           (cycle % OS_SYS_CLOCK) * OS_SYS_NS_PER_SECOND / OS_SYS_CLOCK;
+}
+/// /proc/cputime 每行一条记录, 时间单位都是纳秒, 格式固定方便工具解析
+static int CpuTimeProcFill(struct SeqBuf *m, void *v)
+{
+    CPUP_CPU_TIME_S cpuTime;
+    CPUP_TIME_S time;
+    UINT32 id;
+
+    (void)v;
+    for (id = 0; id < LOSCFG_KERNEL_CORE_NUM; id++) {
+        if (LOS_CpupCpuTimeGet((UINT16)id, &cpuTime) != LOS_OK) {
+            continue;
+        }
+        (void)LosBufPrintf(m, "cpu %u user %llu sys %llu irq %llu softirq %llu idle %llu\n", id,
+                           CpuTimeCycleToNs(cpuTime.userTime), CpuTimeCycleToNs(cpuTime.sysTime),
+                           CpuTimeCycleToNs(cpuTime.irqTime), CpuTimeCycleToNs(cpuTime.softirqTime),
+                           CpuTimeCycleToNs(cpuTime.idleTime));
+    }
+
+    for (id = 0; id < g_processMaxNum; id++) {
+        if (LOS_CpupProcessTimeGet(id, &time) != LOS_OK) {
+            continue;
+        }
+        (void)LosBufPrintf(m, "process %u user %llu sys %llu irq %llu\n", id, CpuTimeCycleToNs(time.userTime),
+                           CpuTimeCycleToNs(time.sysTime), CpuTimeCycleToNs(time.irqTime));
+    }
+
+    for (id = 0; id < g_taskMaxNum; id++) {
+        if (LOS_CpupTaskTimeGet(id, &time) != LOS_OK) {
+            continue;
+        }
+        (void)LosBufPrintf(m, "thread %u pid %u user %llu sys %llu irq %llu\n", id, OS_TCB_FROM_TID(id)->processID,
+                           CpuTimeCycleToNs(time.userTime), CpuTimeCycleToNs(time.sysTime),
+                           CpuTimeCycleToNs(time.irqTime));
+    }
+    return 0;
+}
+
+static const struct ProcFileOperations CPUTIME_PROC_FOPS = {
+    .read       = CpuTimeProcFill,
+};
+#endif
 //创建进程相关信息 /proc/process
 void ProcProcessInit(void)
 {
@@ -54,5 +106,15 @@ void ProcProcessInit(void)
     }
 
     pde->procFileOps = &PROCESS_PROC_FOPS;
+
+#ifdef LOSCFG_KERNEL_CPUP
+    pde = CreateProcEntry("cputime", 0, NULL);//创建 /proc/cputime, 按CPU/进程/线程输出 user/sys/irq 时间
+    if (pde == NULL) {
+        PRINT_ERR("create /proc/cputime error!\n");
+        return;
+    }
+
+    pde->procFileOps = &CPUTIME_PROC_FOPS;
+#endif
 }
 
@@ -33,6 +33,100 @@
 #include <sys/mount.h>
 #include "proc_fs.h"
 
+#ifdef LOSCFG_KERNEL_VM
+#include "los_vm_dump.h"
+#include "los_vm_filemap.h"
+#include "los_vm_phys.h"
+#include "los_vm_zram.h"
+#include "los_vm_ksm.h"
+
+#define PAGES_TO_KB(pages) ((UINT32)(pages) << (PAGE_SHIFT - 10))
+
+//cat /proc/meminfo, 物理内存和页面回收的统计, 格式仿照linux
+static int MeminfoProcFill(struct SeqBuf *m, void *v)
+{
+    UINT32 index;
+    UINT32 usedPages = 0;
+    UINT32 totalPages = 0;
+    size_t activeFile = 0;
+    size_t inactiveFile = 0;
+    LosVmPhysSeg *seg = NULL;
+#ifdef LOSCFG_KERNEL_VM_KSWAPD
+    size_t wmarkLow;
+    size_t wmarkHigh;
+#endif
+#ifdef LOSCFG_KERNEL_VM_ZRAM
+    LosVmZramStat zram;
+#endif
+#ifdef LOSCFG_KERNEL_VM_KSM
+    LosVmKsmStat ksm;
+#endif
+
+    (void)v;
+    OsVmPhysUsedInfoGet(&usedPages, &totalPages);
+    for (index = 0; index < g_vmPhysSegNum; index++) {
+        seg = &g_vmPhysSeg[index];
+        activeFile += seg->lruSize[VM_LRU_ACTIVE_FILE];
+        inactiveFile += seg->lruSize[VM_LRU_INACTIVE_FILE];
+    }
+
+    (void)LosBufPrintf(m, "MemTotal:       %8u kB\n", PAGES_TO_KB(totalPages));
+    (void)LosBufPrintf(m, "MemFree:        %8u kB\n", PAGES_TO_KB(totalPages - usedPages));
+    (void)LosBufPrintf(m, "Active(file):   %8u kB\n", PAGES_TO_KB(activeFile));
+    (void)LosBufPrintf(m, "Inactive(file): %8u kB\n", PAGES_TO_KB(inactiveFile));
+#ifdef LOSCFG_KERNEL_VM_KSWAPD
+    OsKswapdWmarkGet(&wmarkLow, &wmarkHigh);
+    (void)LosBufPrintf(m, "WmarkLow:       %8u kB\n", PAGES_TO_KB(wmarkLow));
+    (void)LosBufPrintf(m, "WmarkHigh:      %8u kB\n", PAGES_TO_KB(wmarkHigh));
+#endif
+#ifdef LOSCFG_FS_VFS
+    (void)LosBufPrintf(m, "KswapdWakeups:  %8d\n", LOS_AtomicRead(&g_vmReclaimStat.kswapdWakeups));
+    (void)LosBufPrintf(m, "PgStealKswapd:  %8d\n", LOS_AtomicRead(&g_vmReclaimStat.stealKswapd));
+    (void)LosBufPrintf(m, "PgStealDirect:  %8d\n", LOS_AtomicRead(&g_vmReclaimStat.stealDirect));
+    (void)LosBufPrintf(m, "PgWriteback:    %8d\n", LOS_AtomicRead(&g_vmReclaimStat.writeback));
+    (void)LosBufPrintf(m, "PgLazyFree:     %8d\n", LOS_AtomicRead(&g_vmReclaimStat.lazyFree));
+#endif
+#ifdef LOSCFG_KERNEL_VM_ZRAM
+    OsZramStatGet(&zram);
+    (void)LosBufPrintf(m, "SwapTotal:      %8u kB\n", PAGES_TO_KB(zram.totalPages));
+    (void)LosBufPrintf(m, "SwapFree:       %8u kB\n", PAGES_TO_KB(zram.totalPages - zram.storedPages));
+    (void)LosBufPrintf(m, "ZramStored:     %8u kB\n", PAGES_TO_KB(zram.storedPages));
+    (void)LosBufPrintf(m, "ZramCompressed: %8u kB\n", zram.comprBytes >> 10);
+    (void)LosBufPrintf(m, "ZramRatio:      %8u%%\n", (zram.comprBytes == 0) ? 0 :
+                       (UINT32)(((UINT64)zram.storedPages << PAGE_SHIFT) * 100 / zram.comprBytes));
+    (void)LosBufPrintf(m, "ZramRejected:   %8u\n", zram.rejected);
+    (void)LosBufPrintf(m, "PSwpIn:         %8u\n", zram.swapIn);
+    (void)LosBufPrintf(m, "PSwpOut:        %8u\n", zram.swapOut);
+    (void)LosBufPrintf(m, "SwpInAvgNs:     %8llu\n", (zram.swapIn == 0) ? 0 : (zram.faultNsTotal / zram.swapIn));
+    (void)LosBufPrintf(m, "SwpInMaxNs:     %8llu\n", zram.faultNsMax);
+#endif
+#ifdef LOSCFG_KERNEL_VM_KSM
+    OsKsmStatGet(&ksm);
+    (void)LosBufPrintf(m, "KsmShared:      %8u kB\n", PAGES_TO_KB(ksm.pagesShared));
+    (void)LosBufPrintf(m, "KsmSaved:       %8u kB\n", PAGES_TO_KB(ksm.pagesSharing));
+    (void)LosBufPrintf(m, "KsmScanned:     %8u\n", ksm.pagesScanned);
+    (void)LosBufPrintf(m, "KsmFullScans:   %8u\n", ksm.fullScans);
+#endif
+    return 0;
+}
+
+static const struct ProcFileOperations MEMINFO_PROC_FOPS = {
+    .write      = NULL,
+    .read       = MeminfoProcFill,
+};
+
+void ProcMeminfoInit(void)
+{
+    struct ProcDirEntry *pde = CreateProcEntry("meminfo", 0, NULL);
+    if (pde == NULL) {
+        PRINT_ERR("create /proc/meminfo error!\n");
+        return;
+    }
+
+    pde->procFileOps = &MEMINFO_PROC_FOPS;
+}
+#endif
+
 #ifdef LOSCFG_SHELL_CMD_DEBUG
 #include "los_vm_map.h"
 #include "los_vm_dump.h"
@@ -54,6 +54,7 @@ extern UINT32 OsEventReadWithCond(const EventCond *cond, PEVENT_CB_S eventCB,
 extern VOID OsEventWriteUnsafe(PEVENT_CB_S eventCB, UINT32 events, BOOL once, UINT8 *exitFlag);
 extern UINT32 OsEventReadOnce(PEVENT_CB_S eventCB, UINT32 eventMask, UINT32 mode, UINT32 timeout);
 extern UINT32 OsEventWriteOnce(PEVENT_CB_S eventCB, UINT32 events);
+extern UINT32 OsEventNotifySet(PEVENT_CB_S eventCB, EVENT_NOTIFY_FUNC notify, VOID *arg);
 
 #ifdef __cplusplus
 #if __cplusplus
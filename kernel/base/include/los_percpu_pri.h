@@ -34,6 +34,7 @@
 
 #include "los_base.h"
 #include "los_hw_cpu.h"
+#include "los_atomic.h"
 #include "los_spinlock.h"
 #include "los_sortlink_pri.h"
 
@@ -74,7 +75,7 @@ typedef struct {
 #ifdef LOSCFG_KERNEL_SMP
     UINT32            excFlag;               ///<  cpu halt or exc flag | cpu 停止或 异常 标志
 #ifdef LOSCFG_KERNEL_SMP_CALL
-    LOS_DL_LIST       funcLink;              ///<  mp function call link | 回调函数链表,由 LOS_MP_IPI_FUNC_CALL 触发
+    Atomic            funcCallPending;       ///<  mp function call slots | 位图,第n位表示调用槽n里有发给本核的回调,由 LOS_MP_IPI_FUNC_CALL 触发
 #endif
 #endif
 } Percpu;
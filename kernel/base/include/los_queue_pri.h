@@ -33,6 +33,7 @@
 #define _LOS_QUEUE_PRI_H
 
 #include "los_queue.h"
+#include "los_atomic.h"
 
 #ifdef __cplusplus
 #if __cplusplus
@@ -98,6 +99,11 @@ typedef struct {
     LOS_DL_LIST readWriteList[OS_QUEUE_N_RW]; /**< the linked list to be read or written, 0:readlist, 1:writelist 
     										| 挂的都是等待读/写消息的任务链表，0表示读消息的链表，1表示写消息的任务链表*/										
     LOS_DL_LIST memList; /**< Pointer to the memory linked list | 内存块链表*/
+    UINT16 queueMode;   /**< Queue mode, normal or zero-copy | 队列模式,拷贝或零拷贝*/
+    Atomic zcCount;     /**< Committed messages of a zero-copy queue | 零拷贝队列中已提交的消息数,生产者加,消费者减*/
+    Atomic zcSlotState; /**< Reservation state of a zero-copy queue | 零拷贝队列写端槽位状态,空闲/已预留/正在删除*/
+    Atomic zcWaiters[OS_QUEUE_N_RW]; /**< Tasks pending on a zero-copy queue, 0:reader, 1:writer
+                                        | 零拷贝队列上等待的任务数,为0时读写两端都不需要进调度锁*/
 } LosQueueCB;
 
 /* queue state */
@@ -125,6 +131,30 @@ typedef struct {
  */
 #define OS_QUEUE_NORMAL        0
 
+/**
+ *  @ingroup los_queue
+ *  Zero-copy message queue.
+ */
+#define OS_QUEUE_ZERO_COPY     2
+
+/**
+ *  @ingroup los_queue
+ *  Zero-copy slot state: no slot reserved.
+ */
+#define OS_QUEUE_ZC_SLOT_FREE     0
+
+/**
+ *  @ingroup los_queue
+ *  Zero-copy slot state: the writer holds a reserved slot.
+ */
+#define OS_QUEUE_ZC_SLOT_RESERVED 1
+
+/**
+ *  @ingroup los_queue
+ *  Zero-copy slot state: the queue is being deleted, no more reservations.
+ */
+#define OS_QUEUE_ZC_SLOT_DELETING 2
+
 /**
  *  @ingroup los_queue
  *  Queue information control block
@@ -42,6 +42,13 @@ extern "C" {
 #endif /* __cplusplus */
 
 #define OS_RWLOCK_MAGIC 0xBEFDCAU
+#define OS_BRLOCK_MAGIC 0xBEFDCBU
+
+enum BrlockWriterState {
+    BRLOCK_WRITER_NONE,     /* 没有写者 */
+    BRLOCK_WRITER_DRAINING, /* 写者已登记,等读者离开 */
+    BRLOCK_WRITER_HELD      /* 写者持有锁 */
+};
 
 enum RwlockMode {
     RWLOCK_NONE_MODE,
@@ -221,6 +221,19 @@ extern UINT32 OsShellShowTickRespo(VOID);
 
 extern UINT32 OsShellShowSchedParam(VOID);
 
+extern UINT32 OsShellShowSchedLatency(VOID);
+
+#ifdef LOSCFG_SCHED_DEBUG
+extern UINT32 OsSchedLatencyShow(VOID *seqBuf);
+
+extern VOID OsSchedLatencyReset(VOID);
+#endif
+
+#ifdef LOSCFG_KERNEL_PERF
+/* 按任务计数时, 在切换点暂停/恢复硬件计数器, 实现见 los_perf.c */
+extern VOID OsPerfTaskSwitch(const LosTaskCB *runTask, const LosTaskCB *newTask);
+#endif
+
 #ifdef __cplusplus
 #if __cplusplus
 }
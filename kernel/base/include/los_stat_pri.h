@@ -45,6 +45,8 @@ typedef struct {
     UINT32      contexSwitch;
 } SchedPercpu;
 
+#define SCHED_HIST_NUM          20  /* log2 buckets in us: [0, 1), [1, 2), [2, 4) ... the last one is 256ms and more */
+
 typedef struct {
     UINT64      allRuntime;
     UINT64      runTime;
@@ -56,6 +58,11 @@ typedef struct {
     UINT64      pendCount;
     UINT64      waitSchedTime;        /* task status is ready to running times */
     UINT64      waitSchedCount;
+    UINT64      preemptCount;         /* switched out while still ready, yields excluded */
+    UINT64      dispatchRuntime;      /* allRuntime when the task was last switched in */
+    BOOL        yielded;              /* set by OsSchedYield until the next switch */
+    UINT32      waitSchedHist[SCHED_HIST_NUM]; /* ready to running latency */
+    UINT32      runHist[SCHED_HIST_NUM];       /* time used each time the task got the cpu */
     SchedPercpu schedPercpu[LOSCFG_KERNEL_CORE_NUM];
 } SchedStat;
 
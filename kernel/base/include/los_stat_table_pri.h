@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2013-2019 Huawei Technologies Co., Ltd. All rights reserved.
+ * Copyright (c) 2020-2021 Huawei Device Co., Ltd. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of
+ *    conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list
+ *    of conditions and the following disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used
+ *    to endorse or promote products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _LOS_STAT_TABLE_PRI_H
+#define _LOS_STAT_TABLE_PRI_H
+
+#include "los_atomic.h"
+#include "los_list.h"
+#include "los_printf.h"
+#ifdef LOSCFG_FS_VFS
+#include "los_seq_buf.h"
+#endif
+
+#ifdef __cplusplus
+#if __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+#endif /* __cplusplus */
+
+/*
+ * 统计槽位表: lock-stat, off-CPU 剖析和堆采样剖析共用的固定大小开放寻址哈希表.
+ * 每个槽位的第一个成员必须是 Atomic state, 键是槽位里一段定长的成员, 其余是调用者自己的计数.
+ * 抢空槽和清槽都走 EMPTY -> FILLING -> READY/EMPTY 的状态转换, 而且都关中断进行,
+ * 本核的中断在同一条探测链上查找时不会去等一个被它打断的 FILLING 槽.
+ */
+enum {
+    STAT_SLOT_EMPTY = 0,
+    STAT_SLOT_FILLING,
+    STAT_SLOT_READY,
+};
+
+typedef struct {
+    VOID        *slots;     /* 槽位数组 */
+    UINT32      slotSize;
+    UINT32      slotNum;
+    UINT32      keyOffset;  /* 键在槽位里的偏移 */
+    UINT32      keySize;    /* 4 字节的整数倍, 填键前调用者要把填充字节清0 */
+    Atomic      dropped;    /* 表满没记上的次数 */
+} StatTable;
+
+#define STAT_TABLE_INIT(slotArray, slotType, keyMember) {                       \
+    .slots = (slotArray),                                                       \
+    .slotSize = sizeof(slotType),                                               \
+    .slotNum = sizeof(slotArray) / sizeof(slotType),                            \
+    .keyOffset = (UINT32)LOS_OFF_SET_OF(slotType, keyMember),                   \
+    .keySize = sizeof(((slotType *)0)->keyMember),                              \
+    .dropped = 0,                                                               \
+}
+
+/* 统计结果输出到 seqBuf(/proc), seqBuf 为 NULL 时直接打印到串口(shell 命令) */
+#ifdef LOSCFG_FS_VFS
+#define STAT_TABLE_SHOW(seqBuf, arg...) do {                \
+    if (seqBuf != NULL) {                                   \
+        (void)LosBufPrintf((struct SeqBuf *)seqBuf, ##arg); \
+    } else {                                                \
+        PRINTK(arg);                                        \
+    }                                                       \
+} while (0)
+#else
+#define STAT_TABLE_SHOW(seqBuf, arg...) PRINTK(arg)
+#endif
+
+STATIC INLINE BOOL OsStatSlotReady(const VOID *slot)
+{
+    return (LOS_AtomicRead((const Atomic *)slot) == STAT_SLOT_READY);
+}
+
+/* 找到键对应的槽位, 没有就占一个空槽. 表满时返回 NULL 并记一次 dropped */
+extern VOID *OsStatTableGet(StatTable *table, const VOID *key);
+
+/* 逐个槽位清空, 和正在填槽的核走同样的状态转换, 不会把填了一半的槽清掉 */
+extern VOID OsStatTableReset(StatTable *table);
+
+#ifdef __cplusplus
+#if __cplusplus
+}
+#endif /* __cplusplus */
+#endif /* __cplusplus */
+
+#endif /* _LOS_STAT_TABLE_PRI_H */
@@ -47,6 +47,9 @@
 #ifdef LOSCFG_KERNEL_LITEIPC
 #include "hm_liteipc.h"
 #endif
+#ifdef LOSCFG_KERNEL_OFFCPU
+#include "los_offcpu.h"
+#endif
 #ifdef __cplusplus
 #if __cplusplus
 extern "C" {
@@ -354,6 +357,9 @@ typedef struct {
 #endif
 #ifdef LOSCFG_SCHED_DEBUG //调试调度开关
     SchedStat       schedStat;          /**< Schedule statistics | 调度统计 */
+#endif
+#ifdef LOSCFG_KERNEL_OFFCPU
+    OffCpuRecord    offCpu;             /**< Off-cpu block record | 阻塞剖析记录 */
 #endif
     UINTPTR         userArea;			///< 用户空间的堆区开始位置
     UINTPTR         userMapBase;		///< 用户空间的栈顶位置,内存来自用户空间,和topOfStack有本质的区别.
@@ -38,6 +38,7 @@
 #define __LOS_VM_DUMP_H__
 
 #include "los_vm_map.h"
+#include "los_vm_phys.h"
 #include "los_process_pri.h"
 
 #ifdef __cplusplus
@@ -67,6 +68,7 @@ UINT32 OsCountRegionPages(LosVmSpace *space, LosVmMapRegion *region, UINT32 *pss
 UINT32 OsCountAspacePages(LosVmSpace *space);
 VOID OsDumpAllAspace(VOID);
 VOID OsVmPhysDump(VOID);
+UINT32 OsVmPhySegPagesGet(LosVmPhysSeg *seg);
 VOID OsVmPhysUsedInfoGet(UINT32 *usedCount, UINT32 *totalCount);
 INT32 OsRegionOverlapCheck(LosVmSpace *space, LosVmMapRegion *region);
 VOID OsDumpPte(VADDR_T vaddr);
@@ -125,12 +125,15 @@ enum OsPageFlags {
     FILE_PAGE_LRU,			///< LRU置换页
     FILE_PAGE_ACTIVE,		///< 活动页
     FILE_PAGE_SHARED,		///< 共享页
+    FILE_PAGE_LAZYFREE,		///< madvise(MADV_FREE)过的匿名页,没再写过就可以直接回收
+    FILE_PAGE_KSM,			///< 内容相同的匿名页合并出来的只读共享页
 };
 
 #define PGOFF_MAX                       2000
 #define MAX_SHRINK_PAGECACHE_TRY        2
 #define VM_FILEMAP_MAX_SCAN             (SYS_MEM_SIZE_DEFAULT >> PAGE_SHIFT) ///< 扫描文件映射页最大数量
 #define VM_FILEMAP_MIN_SCAN             32 ///< 扫描文件映射页最小数量
+#define VM_FILE_READAHEAD_PAGES         32 ///< MADV_SEQUENTIAL线性区读缺页后向后异步预读的页数
 /// 给页面贴上被锁的标签
 STATIC INLINE VOID OsSetPageLocked(LosVmPage *page)
 {
@@ -227,13 +230,55 @@ STATIC INLINE BOOL OsIsPageShared(LosVmPage *page)
 {
     return BIT_GET(page->flags, FILE_PAGE_SHARED);
 }
+/// 给页面贴上可懒回收的标签
+STATIC INLINE VOID OsSetPageLazyFree(LosVmPage *page)
+{
+    LOS_BitmapSet(&page->flags, FILE_PAGE_LAZYFREE);
+}
+/// 给页面撕掉可懒回收的标签
+STATIC INLINE VOID OsCleanPageLazyFree(LosVmPage *page)
+{
+    LOS_BitmapClr(&page->flags, FILE_PAGE_LAZYFREE);
+}
+/// 是否为可懒回收页
+STATIC INLINE BOOL OsIsPageLazyFree(LosVmPage *page)
+{
+    return BIT_GET(page->flags, FILE_PAGE_LAZYFREE);
+}
+/// 给页面贴上同页合并的标签
+STATIC INLINE VOID OsSetPageKsm(LosVmPage *page)
+{
+    LOS_BitmapSet(&page->flags, FILE_PAGE_KSM);
+}
+
+STATIC INLINE VOID OsCleanPageKsm(LosVmPage *page)
+{
+    LOS_BitmapClr(&page->flags, FILE_PAGE_KSM);
+}
+/// 是否为同页合并出来的共享页
+STATIC INLINE BOOL OsIsPageKsm(LosVmPage *page)
+{
+    return BIT_GET(page->flags, FILE_PAGE_KSM);
+}
 
 typedef struct ProcessCB LosProcessCB;
 
+/// 页面回收统计, 由 /proc/meminfo 输出
+typedef struct {
+    Atomic kswapdWakeups;   ///< 后台回收任务被唤醒的次数
+    Atomic stealKswapd;     ///< 后台回收释放的页数
+    Atomic stealDirect;     ///< 分配路径和OOM同步回收释放的页数
+    Atomic writeback;       ///< 回收时回写磁盘的脏页数
+    Atomic lazyFree;        ///< 回收的MADV_FREE页数
+} LosVmReclaimStat;
+
+extern LosVmReclaimStat g_vmReclaimStat;
+
 #ifdef LOSCFG_FS_VFS
 INT32 OsVfsFileMmap(struct file *filep, LosVmMapRegion *region);
 STATUS_T OsNamedMMap(struct file *filep, LosVmMapRegion *region);
 VOID OsVmmFileRegionFree(struct file *filep, LosProcessCB *processCB);
+VOID OsFileReadaheadAsync(struct Vnode *vnode, VM_OFFSET_T pgoff, UINT32 nPages);
 #endif
 
 LosFilePage *OsPageCacheAlloc(struct page_mapping *mapping, VM_OFFSET_T pgoff);
@@ -253,6 +298,10 @@ VOID OsDeletePageCacheLru(LosFilePage *page);
 VOID OsPageRefDecNoLock(LosFilePage *page);
 VOID OsPageRefIncLocked(LosFilePage *page);
 int OsTryShrinkMemory(size_t nPage);
+#ifdef LOSCFG_KERNEL_VM_KSWAPD
+VOID OsKswapdWakeupCheck(UINT32 segID, size_t freePages);
+VOID OsKswapdWmarkGet(size_t *wmarkLow, size_t *wmarkHigh);
+#endif
 VOID OsMarkPageDirty(LosFilePage *fpage, LosVmMapRegion *region, int off, int len);
 
 #ifdef LOSCFG_DEBUG_VERSION
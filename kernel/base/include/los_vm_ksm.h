@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2013-2019 Huawei Technologies Co., Ltd. All rights reserved.
+ * Copyright (c) 2020-2021 Huawei Device Co., Ltd. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of
+ *    conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list
+ *    of conditions and the following disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used
+ *    to endorse or promote products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __LOS_VM_KSM_H__
+#define __LOS_VM_KSM_H__
+
+#include "los_typedef.h"
+
+#ifdef __cplusplus
+#if __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+#endif /* __cplusplus */
+
+#ifdef LOSCFG_KERNEL_VM_KSM
+/**
+ * @brief 
+ * @verbatim
+    同页合并(Kernel Samepage Merging): 从同一个模板fork出来的进程, 写时拷贝拆开后很多页内容其实一样,
+    比如清零的页和只读数据页. 后台任务按限速扫描用户进程的私有匿名页, 内容相同的页合并成一个只读的共享页,
+    再写时照常走写时拷贝拆开.
+    稳定表: 已合并的共享页, 合并任务自己持有一个引用, 只剩这个引用时说明没人映射了, 从表里摘掉释放.
+    候选表: 本轮全量扫描里见过的页(只记空间和虚拟地址), 后面扫到内容相同的页时两个一起合并, 每轮全量扫描后清空.
+ * @endverbatim
+ */
+
+/// 同页合并统计, 由 /proc/meminfo 输出
+typedef struct {
+    UINT32 pagesShared;     ///< 合并出来的只读共享页数
+    UINT32 pagesSharing;    ///< 指到共享页上而省下来的页数
+    UINT32 pagesScanned;    ///< 累计扫描的页数
+    UINT32 fullScans;       ///< 扫完所有用户进程的轮数
+} LosVmKsmStat;
+
+VOID OsKsmStatGet(LosVmKsmStat *stat);
+#endif
+
+#ifdef __cplusplus
+#if __cplusplus
+}
+#endif /* __cplusplus */
+#endif /* __cplusplus */
+
+#endif /* __LOS_VM_KSM_H__ */
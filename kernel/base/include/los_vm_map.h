@@ -191,6 +191,11 @@ typedef struct VmSpace {
 #define     VM_MAP_REGION_FLAG_FIXED                (1<<17)
 #define     VM_MAP_REGION_FLAG_FIXED_NOREPLACE      (1<<18)
 #define     VM_MAP_REGION_FLAG_INVALID              (1<<19) /* indicates that flags are not specified */
+#define     VM_MAP_REGION_FLAG_HUGEPAGE             (1<<20)		///< 匿名线性区缺页时尽量用1M section映射, 减少TLB缺失
+#define     VM_MAP_REGION_FLAG_SEQUENTIAL           (1<<21)		///< madvise(MADV_SEQUENTIAL) 顺序访问,读缺页时向后异步预读
+#define     VM_MAP_REGION_FLAG_RANDOM               (1<<22)		///< madvise(MADV_RANDOM) 随机访问,关掉fault-around
+#define     VM_MAP_REGION_FLAG_LAZYFREE             (1<<23)		///< 区内有MADV_FREE过的页,内存回收时要扫描
+#define     VM_MAP_REGION_FLAG_MADV_MASK            (7<<21)		///< madvise设置的标签掩码,mprotect时要保留
 /// 从外部权限标签转化为线性区权限标签
 STATIC INLINE UINT32 OsCvtProtFlagsToRegionFlags(unsigned long prot, unsigned long flags)
 {
@@ -204,6 +209,7 @@ STATIC INLINE UINT32 OsCvtProtFlagsToRegionFlags(unsigned long prot, unsigned lo
     regionFlags |= (flags & MAP_PRIVATE) ? VM_MAP_REGION_FLAG_PRIVATE : 0;
     regionFlags |= (flags & MAP_FIXED) ? VM_MAP_REGION_FLAG_FIXED : 0;
     regionFlags |= (flags & MAP_FIXED_NOREPLACE) ? VM_MAP_REGION_FLAG_FIXED_NOREPLACE : 0;
+    regionFlags |= (flags & MAP_HUGETLB) ? VM_MAP_REGION_FLAG_HUGEPAGE : 0;
 
     return regionFlags;
 }
@@ -308,6 +314,7 @@ VADDR_T OsAllocRange(LosVmSpace *vmSpace, size_t len);
 VADDR_T OsAllocSpecificRange(LosVmSpace *vmSpace, VADDR_T vaddr, size_t len, UINT32 regionFlags);
 LosVmMapRegion *OsCreateRegion(VADDR_T vaddr, size_t len, UINT32 regionFlags, unsigned long offset);
 BOOL OsInsertRegion(LosRbTree *regionRbTree, LosVmMapRegion *region);
+LosVmMapRegion *OsFindRegion(LosRbTree *regionRbTree, VADDR_T vaddr, size_t len);
 LosVmSpace *LOS_SpaceGet(VADDR_T vaddr);
 LosVmSpace *LOS_CurrSpaceGet(VOID);
 BOOL LOS_IsRegionFileValid(LosVmMapRegion *region);
@@ -317,6 +324,7 @@ PADDR_T LOS_PaddrQuery(VOID *vaddr);
 LosVmMapRegion *LOS_RegionAlloc(LosVmSpace *vmSpace, VADDR_T vaddr, size_t len, UINT32 regionFlags, VM_OFFSET_T pgoff);
 STATUS_T OsRegionsRemove(LosVmSpace *space, VADDR_T vaddr, size_t size);
 STATUS_T OsVmRegionAdjust(LosVmSpace *space, VADDR_T vaddr, size_t size);
+STATUS_T OsRegionPagesDrop(LosVmSpace *space, LosVmMapRegion *region, VADDR_T vaddr, size_t size);
 LosVmMapRegion *OsVmRegionDup(LosVmSpace *space, LosVmMapRegion *oldRegion, VADDR_T vaddr, size_t size);
 STATUS_T OsIsRegionCanExpand(LosVmSpace *space, LosVmMapRegion *region, size_t size);
 STATUS_T LOS_RegionFree(LosVmSpace *space, LosVmMapRegion *region);
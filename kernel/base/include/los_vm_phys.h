@@ -53,6 +53,8 @@ extern "C" {
  */
 #define VM_LIST_ORDER_MAX    9	///< 伙伴算法分组数量,从 2^0,2^1,...,2^8 (256*4K)=1M 
 #define VM_PHYS_SEG_MAX    32	///< 最大支持32个段
+#define VM_SECTION_PAGES   (1U << (VM_LIST_ORDER_MAX - 1)) ///< 一个1M section映射的页数, 即伙伴算法最大块
+#define VM_SECTION_SIZE    (VM_SECTION_PAGES << PAGE_SHIFT)
 
 #ifndef min
 #define min(x, y) ((x) < (y) ? (x) : (y)) 
@@ -117,6 +119,7 @@ VOID OsVmPhysPagesFreeContiguous(LosVmPage *page, size_t nPages);
 LosVmPage *OsVmPhysToPage(paddr_t pa, UINT8 segID);
 
 LosVmPage *LOS_PhysPageAlloc(VOID);
+LosVmPage *LOS_PhysSectionAlloc(VOID);
 VOID LOS_PhysPageFree(LosVmPage *page);
 size_t LOS_PhysPagesAlloc(size_t nPages, LOS_DL_LIST *list);
 size_t LOS_PhysPagesFree(LOS_DL_LIST *list);
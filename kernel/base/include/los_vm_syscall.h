@@ -40,6 +40,10 @@
 #include "sys/shm.h"
 #include "sys/mman.h"
 
+#ifndef MADV_FREE
+#define MADV_FREE 8
+#endif
+
 #ifdef __cplusplus
 #if __cplusplus
 extern "C" {
@@ -61,6 +65,7 @@ STATUS_T LOS_UnMMap(VADDR_T addr, size_t size);
 VOID *LOS_DoBrk(VOID *addr);
 INT32 LOS_DoMprotect(VADDR_T vaddr, size_t len, unsigned long prot);
 VADDR_T LOS_DoMremap(VADDR_T oldAddress, size_t oldSize, size_t newSize, int flags, VADDR_T newAddr);
+INT32 LOS_DoMadvise(VADDR_T vaddr, size_t len, INT32 advice);
 VOID LOS_DumpMemRegion(VADDR_T vaddr);
 UINT32 ShmInit(VOID);
 UINT32 ShmDeinit(VOID);
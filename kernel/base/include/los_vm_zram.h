@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2013-2019 Huawei Technologies Co., Ltd. All rights reserved.
+ * Copyright (c) 2020-2021 Huawei Device Co., Ltd. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of
+ *    conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list
+ *    of conditions and the following disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used
+ *    to endorse or promote products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __LOS_VM_ZRAM_H__
+#define __LOS_VM_ZRAM_H__
+
+#include "los_typedef.h"
+#include "los_vm_map.h"
+
+#ifdef __cplusplus
+#if __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+#endif /* __cplusplus */
+
+#ifdef LOSCFG_KERNEL_VM_ZRAM
+/**
+ * @brief 
+ * @verbatim
+    匿名页没有后备文件, 以前只能常驻内存, 内存紧张时只能靠OOM杀进程.
+    zram在内核堆里建一个压缩池: 回收时把冷的私有匿名页deflate进池子, 页表项换成记着槽号的交换项,
+    物理页释放; 进程再访问时缺页, 从池子里解压到新页重新映射.
+    fork后父子进程的交换项指向同一个槽, 槽里有引用计数, 最后一个页表项换入或解除后才释放.
+ * @endverbatim
+ */
+
+/// 压缩池统计, 由 /proc/meminfo 输出
+typedef struct {
+    UINT32 totalPages;      ///< 池子最多能放的页数
+    UINT32 storedPages;     ///< 池子里现在的页数
+    UINT32 comprBytes;      ///< 池子里压缩后的总字节数
+    UINT32 swapOut;         ///< 累计换出页数
+    UINT32 swapIn;          ///< 累计换入页数
+    UINT32 rejected;        ///< 压缩率太差没有换出的页数
+    UINT64 faultNsTotal;    ///< 换入缺页累计耗时
+    UINT64 faultNsMax;      ///< 最长一次换入缺页耗时
+} LosVmZramStat;
+
+size_t OsZramSwapOut(size_t nPage);
+STATUS_T OsZramSwapIn(LosVmSpace *space, LosVmMapRegion *region, VADDR_T vaddr);
+VOID OsZramEntryDup(LosArchMmu *oldArchMmu, LosArchMmu *newArchMmu, VADDR_T vaddr);
+VOID OsZramEntryRelease(LosArchMmu *archMmu, VADDR_T vaddr);
+VOID OsZramStatGet(LosVmZramStat *stat);
+#endif
+
+#ifdef __cplusplus
+#if __cplusplus
+}
+#endif /* __cplusplus */
+#endif /* __cplusplus */
+
+#endif /* __LOS_VM_ZRAM_H__ */
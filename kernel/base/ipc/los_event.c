@@ -36,6 +36,7 @@
 #include "los_percpu_pri.h"
 #include "los_sched_pri.h"
 #include "los_hook.h"
+#include "los_atomic.h"
 #ifdef LOSCFG_BASE_CORE_SWTMR_ENABLE
 #include "los_exc.h"
 #endif
@@ -88,6 +89,57 @@
  * @endverbatim
  */
 
+/*
+ * 事件快路径: uwEventID 的修改全部用 CAS 完成, 写事件先原子置位, 再看 uwWaiters;
+ * 没有读者在等也没有挂通知者时直接返回, 不进调度锁. 读者在慢路径上先登记 uwWaiters 再检查事件,
+ * 两边 "先写后读" 之间都有 DMB, 所以写者要么看到读者, 要么读者看到写入的事件, 不会丢唤醒.
+ */
+STATIC INLINE VOID OsEventBitsSet(PEVENT_CB_S eventCB, UINT32 events)
+{
+    UINT32 oldVal;
+
+    do {
+        oldVal = *(volatile UINT32 *)&eventCB->uwEventID;
+        if ((oldVal & events) == events) {
+            return;
+        }
+    } while (LOS_AtomicCmpXchg32bits((Atomic *)&eventCB->uwEventID, (INT32)(oldVal | events), (INT32)oldVal));
+}
+
+STATIC INLINE VOID OsEventBitsKeep(UINT32 *eventID, UINT32 keepMask)
+{
+    UINT32 oldVal;
+
+    do {
+        oldVal = *(volatile UINT32 *)eventID;
+        if ((oldVal & keepMask) == oldVal) {
+            return;
+        }
+    } while (LOS_AtomicCmpXchg32bits((Atomic *)eventID, (INT32)(oldVal & keepMask), (INT32)oldVal));
+}
+
+STATIC UINT32 OsEventPollAtomic(UINT32 *eventID, UINT32 eventMask, UINT32 mode)
+{
+    UINT32 oldVal;
+    UINT32 ret;
+
+    do {
+        oldVal = *(volatile UINT32 *)eventID;
+        ret = 0;
+        if (mode & LOS_WAITMODE_OR) {//如果模式是读取掩码中任意事件
+            ret = oldVal & eventMask;
+        } else if ((eventMask != 0) && (eventMask == (oldVal & eventMask))) {//必须满足全部事件发生
+            ret = oldVal & eventMask;
+        }
+
+        if ((ret == 0) || !(mode & LOS_WAITMODE_CLR)) {
+            return ret;
+        }
+    } while (LOS_AtomicCmpXchg32bits((Atomic *)eventID, (INT32)(oldVal & ~ret), (INT32)oldVal));//读取完成后清除事件
+
+    return ret;
+}
+
 //初始化一个事件控制块
 LITE_OS_SEC_TEXT_INIT UINT32 LOS_EventInit(PEVENT_CB_S eventCB)
 {
@@ -100,6 +152,9 @@ LITE_OS_SEC_TEXT_INIT UINT32 LOS_EventInit(PEVENT_CB_S eventCB)
     intSave = LOS_IntLock();//锁中断
     eventCB->uwEventID = 0;//事件类型初始化
     LOS_ListInit(&eventCB->stEventList);//事件链表初始化
+    eventCB->uwWaiters = 0;
+    eventCB->pfnNotify = NULL;
+    eventCB->pNotifyArg = NULL;
     LOS_IntRestore(intSave);//恢复中断
     OsHookCall(LOS_HOOK_TYPE_EVENT_INIT, eventCB);
     return LOS_OK;
@@ -129,26 +184,10 @@ LITE_OS_SEC_TEXT STATIC UINT32 OsEventParamCheck(const VOID *ptr, UINT32 eventMa
 ///根据用户传入的事件值、事件掩码及校验模式，返回用户传入的事件是否符合预期
 LITE_OS_SEC_TEXT UINT32 OsEventPoll(UINT32 *eventID, UINT32 eventMask, UINT32 mode)
 {
-    UINT32 ret = 0;
-
     LOS_ASSERT(OsIntLocked());//断言不允许中断了
     LOS_ASSERT(LOS_SpinHeld(&g_taskSpin));//任务自旋锁
 
-    if (mode & LOS_WAITMODE_OR) {//如果模式是读取掩码中任意事件
-        if ((*eventID & eventMask) != 0) {
-            ret = *eventID & eventMask;
-        }
-    } else {//等待全部事件发生
-        if ((eventMask != 0) && (eventMask == (*eventID & eventMask))) {//必须满足全部事件发生
-            ret = *eventID & eventMask;
-        }
-    }
-
-    if (ret && (mode & LOS_WAITMODE_CLR)) {//读取完成后清除事件
-        *eventID = *eventID & ~ret;
-    }
-
-    return ret;
+    return OsEventPollAtomic(eventID, eventMask, mode);//写事件可能不持锁,清除也得是原子的
 }
 ///检查读事件
 LITE_OS_SEC_TEXT STATIC UINT32 OsEventReadCheck(const PEVENT_CB_S eventCB, UINT32 eventMask, UINT32 mode)
@@ -180,17 +219,20 @@ LITE_OS_SEC_TEXT STATIC UINT32 OsEventReadImp(PEVENT_CB_S eventCB, UINT32 eventM
     LosTaskCB *runTask = OsCurrTaskGet();
     OsHookCall(LOS_HOOK_TYPE_EVENT_READ, eventCB, eventMask, mode, timeout);
 
+    LOS_AtomicInc((Atomic *)&eventCB->uwWaiters);//先登记,再检查事件,写者才不会漏掉本任务
+    DMB;
     if (once == FALSE) {
         ret = OsEventPoll(&eventCB->uwEventID, eventMask, mode);//检测事件是否符合预期
     }
 
     if (ret == 0) {//不符合预期时
         if (timeout == 0) {//不等待的情况
-            return ret;
+            goto OUT;
         }
 
         if (!OsPreemptableInSched()) {//不能抢占式调度
-            return LOS_ERRNO_EVENT_READ_IN_LOCK;
+            ret = LOS_ERRNO_EVENT_READ_IN_LOCK;
+            goto OUT;
         }
 
         runTask->eventMask = eventMask;	//等待事件
@@ -199,11 +241,14 @@ LITE_OS_SEC_TEXT STATIC UINT32 OsEventReadImp(PEVENT_CB_S eventCB, UINT32 eventM
         OsTaskWaitSetPendMask(OS_TASK_WAIT_EVENT, eventMask, timeout);//任务进入等待状态,等待事件的到来并设置时长和掩码
         ret = OsSchedTaskWait(&eventCB->stEventList, timeout, TRUE);//任务暂停,切换调度.
         if (ret == LOS_ERRNO_TSK_TIMEOUT) {
-            return LOS_ERRNO_EVENT_READ_TIMEOUT;
+            ret = LOS_ERRNO_EVENT_READ_TIMEOUT;
+            goto OUT;
         }
 
         ret = OsEventPoll(&eventCB->uwEventID, eventMask, mode);//检测事件是否符合预期
     }
+OUT:
+    LOS_AtomicDec((Atomic *)&eventCB->uwWaiters);
     return ret;
 }
 ///读取指定事件类型，超时时间为相对时间：单位为Tick
@@ -218,6 +263,14 @@ LITE_OS_SEC_TEXT STATIC UINT32 OsEventRead(PEVENT_CB_S eventCB, UINT32 eventMask
         return ret;
     }
 
+    if (once == FALSE) {//快路径: 事件已经满足,或者不等待,都不用进调度锁
+        ret = OsEventPollAtomic(&eventCB->uwEventID, eventMask, mode);
+        if ((ret != 0) || (timeout == 0)) {
+            OsHookCall(LOS_HOOK_TYPE_EVENT_READ, eventCB, eventMask, mode, timeout);
+            return ret;
+        }
+    }
+
     SCHEDULER_LOCK(intSave);
     ret = OsEventReadImp(eventCB, eventMask, mode, timeout, once);//读事件实现函数
     SCHEDULER_UNLOCK(intSave);
@@ -240,14 +293,13 @@ LITE_OS_SEC_TEXT STATIC UINT8 OsEventResume(LosTaskCB *resumedTask, const PEVENT
 
     return exitFlag;
 }
-///以不安全的方式写事件
-LITE_OS_SEC_TEXT VOID OsEventWriteUnsafe(PEVENT_CB_S eventCB, UINT32 events, BOOL once, UINT8 *exitFlag)
+///唤醒等待链表上事件已满足的任务,调用者已持调度锁
+LITE_OS_SEC_TEXT STATIC VOID OsEventWakeUnsafe(PEVENT_CB_S eventCB, UINT32 events, BOOL once, UINT8 *exitFlag)
 {
     LosTaskCB *resumedTask = NULL;
     LosTaskCB *nextTask = NULL;
     BOOL schedFlag = FALSE;
-    OsHookCall(LOS_HOOK_TYPE_EVENT_WRITE, eventCB, events);
-    eventCB->uwEventID |= events;//对应位贴上标签
+
     if (!LOS_ListEmpty(&eventCB->stEventList)) {//等待事件链表判断,处理等待事件的任务
         for (resumedTask = LOS_DL_LIST_ENTRY((&eventCB->stEventList)->pstNext, LosTaskCB, pendList);
              &resumedTask->pendList != &eventCB->stEventList;) {//循环获取任务链表
@@ -266,9 +318,18 @@ LITE_OS_SEC_TEXT VOID OsEventWriteUnsafe(PEVENT_CB_S eventCB, UINT32 events, BOO
         *exitFlag = 1;
     }
 }
+///以不安全的方式写事件
+LITE_OS_SEC_TEXT VOID OsEventWriteUnsafe(PEVENT_CB_S eventCB, UINT32 events, BOOL once, UINT8 *exitFlag)
+{
+    OsHookCall(LOS_HOOK_TYPE_EVENT_WRITE, eventCB, events);
+    OsEventBitsSet(eventCB, events);//对应位贴上标签
+    OsEventWakeUnsafe(eventCB, events, once, exitFlag);
+}
 ///写入事件
 LITE_OS_SEC_TEXT STATIC UINT32 OsEventWrite(PEVENT_CB_S eventCB, UINT32 events, BOOL once)
 {
+    EVENT_NOTIFY_FUNC notify = NULL;
+    VOID *notifyArg = NULL;
     UINT32 intSave;
     UINT8 exitFlag = 0;
 
@@ -280,10 +341,23 @@ LITE_OS_SEC_TEXT STATIC UINT32 OsEventWrite(PEVENT_CB_S eventCB, UINT32 events,
         return LOS_ERRNO_EVENT_SETBIT_INVALID;
     }
 
+    OsHookCall(LOS_HOOK_TYPE_EVENT_WRITE, eventCB, events);
+    OsEventBitsSet(eventCB, events);//对应位贴上标签
+    DMB;
+    if (LOS_AtomicRead((Atomic *)&eventCB->uwWaiters) == 0) {//快路径: 没有任务在等,也没有通知者
+        return LOS_OK;
+    }
+
     SCHEDULER_LOCK(intSave);	//禁止调度
-    OsEventWriteUnsafe(eventCB, events, once, &exitFlag);//写入事件
+    OsEventWakeUnsafe(eventCB, events, once, &exitFlag);//唤醒等待的任务
+    notify = eventCB->pfnNotify;
+    notifyArg = eventCB->pNotifyArg;
     SCHEDULER_UNLOCK(intSave);	//允许调度
 
+    if (notify != NULL) {//通知者可能要拿别的锁(如 poll 等待队列),不能在调度锁里调
+        notify(eventCB, events, notifyArg);
+    }
+
     if (exitFlag == 1) { //需要发生调度
         LOS_MpSchedule(OS_MP_CPU_ALL);//通知所有CPU调度
         LOS_Schedule();//执行调度
@@ -337,7 +411,7 @@ LITE_OS_SEC_TEXT_INIT UINT32 LOS_EventDestroy(PEVENT_CB_S eventCB)
     }
 
     SCHEDULER_LOCK(intSave);
-    if (!LOS_ListEmpty(&eventCB->stEventList)) {
+    if (!LOS_ListEmpty(&eventCB->stEventList) || (eventCB->pfnNotify != NULL)) {
         SCHEDULER_UNLOCK(intSave);
         return LOS_ERRNO_EVENT_SHOULD_NOT_DESTROY;
     }
@@ -350,17 +424,39 @@ LITE_OS_SEC_TEXT_INIT UINT32 LOS_EventDestroy(PEVENT_CB_S eventCB)
 }
 ///清除指定的事件类型
 LITE_OS_SEC_TEXT_MINOR UINT32 LOS_EventClear(PEVENT_CB_S eventCB, UINT32 eventMask)
+{
+    if (eventCB == NULL) {
+        return LOS_ERRNO_EVENT_PTR_NULL;
+    }
+    OsHookCall(LOS_HOOK_TYPE_EVENT_CLEAR, eventCB, eventMask);
+    OsEventBitsKeep(&eventCB->uwEventID, eventMask);
+
+    return LOS_OK;
+}
+///挂上/摘掉写事件的通知者,同一时刻只能挂一个
+LITE_OS_SEC_TEXT_MINOR UINT32 OsEventNotifySet(PEVENT_CB_S eventCB, EVENT_NOTIFY_FUNC notify, VOID *arg)
 {
     UINT32 intSave;
 
     if (eventCB == NULL) {
         return LOS_ERRNO_EVENT_PTR_NULL;
     }
-    OsHookCall(LOS_HOOK_TYPE_EVENT_CLEAR, eventCB, eventMask);
+
     SCHEDULER_LOCK(intSave);
-    eventCB->uwEventID &= eventMask;
-    SCHEDULER_UNLOCK(intSave);
+    if ((notify != NULL) && (eventCB->pfnNotify != NULL)) {
+        SCHEDULER_UNLOCK(intSave);
+        return LOS_NOK;
+    }
 
+    if ((notify != NULL) && (eventCB->pfnNotify == NULL)) {
+        LOS_AtomicInc((Atomic *)&eventCB->uwWaiters);//有通知者时写事件都走慢路径
+    } else if ((notify == NULL) && (eventCB->pfnNotify != NULL)) {
+        LOS_AtomicDec((Atomic *)&eventCB->uwWaiters);
+    }
+    eventCB->pfnNotify = notify;
+    eventCB->pNotifyArg = arg;
+    SCHEDULER_UNLOCK(intSave);
+    DMB;
     return LOS_OK;
 }
 ///有条件式读事件
@@ -379,7 +475,7 @@ LITE_OS_SEC_TEXT UINT32 OsEventReadWithCond(const EventCond *cond, PEVENT_CB_S e
     SCHEDULER_LOCK(intSave);
 
     if (*cond->realValue != cond->value) {
-        eventCB->uwEventID &= cond->clearEvent;
+        OsEventBitsKeep(&eventCB->uwEventID, cond->clearEvent);
         goto OUT;
     }
 
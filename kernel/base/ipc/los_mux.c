@@ -93,6 +93,9 @@
 
 #ifdef LOSCFG_BASE_IPC_MUX
 #define MUTEXATTR_TYPE_MASK 0x0FU
+
+STATIC UINT32 g_muxSpinCycles = LOSCFG_BASE_IPC_MUX_SPIN_CYCLES; ///< 自旋预算(cycle),0表示不自旋
+STATIC LosMuxSpinStat g_muxSpinStat[LOSCFG_KERNEL_CORE_NUM]; ///< 每个CPU各记各的,只在调度锁内更新
 ///互斥属性初始化
 LITE_OS_SEC_TEXT UINT32 LOS_MuxAttrInit(LosMuxAttr *attr)
 {
@@ -281,6 +284,9 @@ LITE_OS_SEC_TEXT UINT32 LOS_MuxInit(LosMux *mutex, const LosMuxAttr *attr)
     mutex->muxCount = 0;			//锁定互斥量的次数
     mutex->owner = NULL;			//谁持有该锁
     LOS_ListInit(&mutex->muxList);	//互斥量双循环链表
+#ifdef LOSCFG_KERNEL_LOCKSTAT
+    mutex->statHold.slot = 0;
+#endif
     mutex->magic = OS_MUX_MAGIC;	//固定标识,互斥锁的魔法数字
     SCHEDULER_UNLOCK(intSave);		//释放调度自旋锁
     return LOS_OK;
@@ -387,6 +393,7 @@ STATIC UINT32 OsMuxPendOp(LosTaskCB *runTask, LosMux *mutex, UINT32 timeout)
         return ret;
     }
 
+    g_muxSpinStat[ArchCurrCpuid()].sleep++;//真正挂起才算一次
     OsTaskWaitSetPendMask(OS_TASK_WAIT_MUTEX, (UINTPTR)mutex, timeout);
     ret = OsSchedTaskWait(node, timeout, TRUE);
     if (ret == LOS_ERRNO_TSK_TIMEOUT) {//这行代码虽和OsTaskWait挨在一起,但要过很久才会执行到,因为在OsTaskWait中CPU切换了任务上下文
@@ -401,6 +408,110 @@ STATIC UINT32 OsMuxPendOp(LosTaskCB *runTask, LosMux *mutex, UINT32 timeout)
     return ret;
 }
 
+#ifdef LOSCFG_KERNEL_SMP
+/*
+ * 自适应自旋: 持锁任务正在别的核上运行时,它多半马上就会释放锁,与其挂起(两次上下文切换)不如先空转等一会儿.
+ * 只有没有任务在排队等锁时才自旋,避免插队饿死已挂起的任务. 调用时持有调度锁.
+ */
+STATIC LosTaskCB *OsMuxSpinOwnerGet(const LosMux *mutex, const LosTaskCB *runTask, UINT32 timeout)
+{
+    LosTaskCB *owner = (LosTaskCB *)mutex->owner;
+
+    if ((g_muxSpinCycles == 0) || (timeout == 0)) {
+        return NULL;
+    }
+
+    if (mutex->magic != OS_MUX_MAGIC) {//没初始化的锁不自旋
+        return NULL;
+    }
+
+    if ((owner == NULL) || (owner == runTask)) {//宏初始化的锁第一次加锁时才建链表,在此之前没有持锁者
+        return NULL;
+    }
+
+    if (!LOS_ListEmpty((LOS_DL_LIST *)&mutex->muxList)) {
+        return NULL;
+    }
+
+    if (!(owner->taskStatus & OS_TASK_STATUS_RUNNING)) {
+        return NULL;
+    }
+
+    return owner;
+}
+
+/*
+ * 不持调度锁空转,直到锁被释放,或者持锁任务离开了CPU,或者预算用完. 预算不超过调用者的超时,
+ * 返回扣掉自旋时间后剩下的超时(tick),至少留1个tick给后面的挂起.
+ * 不用WFE: 持锁任务一直不释放时WFE可能睡到下一个tick中断,预算就不作数了.
+ */
+STATIC UINT32 OsMuxSpinOnOwner(const LosMux *mutex, const LosTaskCB *owner, UINT32 timeout)
+{
+    UINT64 start = HalClockGetCycles();
+    UINT64 budget = g_muxSpinCycles;
+    UINT64 spent = 0;
+    UINT32 elapsed;
+
+    if ((timeout != LOS_WAIT_FOREVER) && (budget >= ((UINT64)timeout * OS_CYCLE_PER_TICK))) {
+        budget = ((UINT64)timeout * OS_CYCLE_PER_TICK) - 1;
+    }
+
+    while (*(VOID * volatile *)&mutex->owner == (VOID *)owner) {
+        if (!(*(volatile UINT16 *)&owner->taskStatus & OS_TASK_STATUS_RUNNING)) {
+            break;
+        }
+
+        spent = HalClockGetCycles() - start;
+        if (spent > budget) {
+            break;
+        }
+        YIELD;
+    }
+
+    if (timeout == LOS_WAIT_FOREVER) {
+        return timeout;
+    }
+    elapsed = (UINT32)(spent / OS_CYCLE_PER_TICK);
+    return (elapsed < timeout) ? (timeout - elapsed) : 1;
+}
+#endif
+
+STATIC VOID OsMuxSpinStatUpdate(BOOL spun, BOOL contended)
+{
+    LosMuxSpinStat *stat = &g_muxSpinStat[ArchCurrCpuid()];
+
+    if (spun && !contended) {
+        stat->spinAcquire++;
+    } else if (spun) {
+        stat->spinFailed++;
+    }
+}
+
+VOID LOS_MuxSpinBudgetSet(UINT32 cycles)
+{
+    g_muxSpinCycles = cycles;
+}
+
+UINT32 LOS_MuxSpinStatGet(LosMuxSpinStat *stat)
+{
+    UINT32 intSave;
+    UINT32 cpuid;
+
+    if (stat == NULL) {
+        return LOS_EINVAL;
+    }
+
+    (VOID)memset_s(stat, sizeof(LosMuxSpinStat), 0, sizeof(LosMuxSpinStat));
+    SCHEDULER_LOCK(intSave);
+    for (cpuid = 0; cpuid < LOSCFG_KERNEL_CORE_NUM; cpuid++) {
+        stat->spinAcquire += g_muxSpinStat[cpuid].spinAcquire;
+        stat->spinFailed += g_muxSpinStat[cpuid].spinFailed;
+        stat->sleep += g_muxSpinStat[cpuid].sleep;
+    }
+    SCHEDULER_UNLOCK(intSave);
+    return LOS_OK;
+}
+
 UINT32 OsMuxLockUnsafe(LosMux *mutex, UINT32 timeout)
 {
     LosTaskCB *runTask = OsCurrTaskGet();//获取当前任务
@@ -419,6 +530,30 @@ UINT32 OsMuxLockUnsafe(LosMux *mutex, UINT32 timeout)
 
     return OsMuxPendOp(runTask, mutex, timeout);
 }
+/* lock-stat: 只在第一次拿到锁(muxCount 变成1)时记录, 递归加锁不算 */
+STATIC INLINE VOID OsMuxStatAcquired(LosMux *mutex, UINT64 start, BOOL contended, const VOID *site, UINT32 ret)
+{
+#ifdef LOSCFG_KERNEL_LOCKSTAT
+    if ((start != 0) && (ret == LOS_OK) && (mutex->muxCount == 1)) {
+        OsLockStatAcquired(&mutex->statHold, mutex, LOCKSTAT_MUX, site, contended, start);
+    }
+#else
+    (VOID)mutex;
+    (VOID)start;
+    (VOID)contended;
+    (VOID)site;
+    (VOID)ret;
+#endif
+}
+
+STATIC INLINE UINT64 OsMuxStatStart(VOID)
+{
+#ifdef LOSCFG_KERNEL_LOCKSTAT
+    return LOCKSTAT_ON() ? OsLockStatCycles() : 0;
+#else
+    return 0;
+#endif
+}
 /// 尝试加锁,
 UINT32 OsMuxTrylockUnsafe(LosMux *mutex, UINT32 timeout)
 {
@@ -443,6 +578,12 @@ UINT32 OsMuxTrylockUnsafe(LosMux *mutex, UINT32 timeout)
 LITE_OS_SEC_TEXT UINT32 LOS_MuxLock(LosMux *mutex, UINT32 timeout)
 {
     LosTaskCB *runTask = NULL;
+#ifdef LOSCFG_KERNEL_SMP
+    LosTaskCB *owner = NULL;
+#endif
+    BOOL spun = FALSE;
+    BOOL contended;
+    UINT64 statStart;
     UINT32 intSave;
     UINT32 ret;
 
@@ -461,8 +602,21 @@ LITE_OS_SEC_TEXT UINT32 LOS_MuxLock(LosMux *mutex, UINT32 timeout)
         OsBackTrace();//打印task信息
     }
 
+    statStart = OsMuxStatStart();
     SCHEDULER_LOCK(intSave);//调度自旋锁
+#ifdef LOSCFG_KERNEL_SMP
+    owner = OsMuxSpinOwnerGet(mutex, runTask, timeout);
+    if (owner != NULL) {//持锁任务正在别的核上跑,先自旋等它释放
+        SCHEDULER_UNLOCK(intSave);
+        timeout = OsMuxSpinOnOwner(mutex, owner, timeout);
+        spun = TRUE;
+        SCHEDULER_LOCK(intSave);
+    }
+#endif
+    contended = (mutex->owner != NULL) && (mutex->owner != (VOID *)runTask) && (timeout != 0);
     ret = OsMuxLockUnsafe(mutex, timeout);//如果任务没拿到锁,将进入阻塞队列一直等待,直到timeout或者持锁任务释放锁时唤醒它 
+    OsMuxSpinStatUpdate(spun, contended);
+    OsMuxStatAcquired(mutex, statStart, (spun || contended), LOCKSTAT_SITE(), ret);
     SCHEDULER_UNLOCK(intSave);
     return ret;
 }
@@ -490,6 +644,7 @@ LITE_OS_SEC_TEXT UINT32 LOS_MuxTrylock(LosMux *mutex)
 
     SCHEDULER_LOCK(intSave);
     ret = OsMuxTrylockUnsafe(mutex, 0);//timeout = 0,不等待,没拿到锁就算了
+    OsMuxStatAcquired(mutex, OsMuxStatStart(), FALSE, LOCKSTAT_SITE(), ret);
     SCHEDULER_UNLOCK(intSave);
     return ret;
 }
@@ -616,6 +771,11 @@ LITE_OS_SEC_TEXT UINT32 LOS_MuxUnlock(LosMux *mutex)
     }
 
     SCHEDULER_LOCK(intSave);
+#ifdef LOSCFG_KERNEL_LOCKSTAT
+    if (((LosTaskCB *)mutex->owner == runTask) && (mutex->muxCount == 1)) {//这次解锁会真正释放锁
+        OsLockStatReleased(&mutex->statHold);
+    }
+#endif
     ret = OsMuxUnlockUnsafe(runTask, mutex, &needSched);
     SCHEDULER_UNLOCK(intSave);
     if (needSched == TRUE) {//需要调度的情况
@@ -137,7 +137,6 @@ LITE_OS_SEC_TEXT_INIT UINT32 LOS_QueueCreate(CHAR *queueName, UINT16 len, UINT32
     UINT16 msgSize;
 
     (VOID)queueName;
-    (VOID)flags;
 
     if (queueID == NULL) {
         return LOS_ERRNO_QUEUE_CREAT_PTR_NULL;
@@ -183,6 +182,11 @@ LITE_OS_SEC_TEXT_INIT UINT32 LOS_QueueCreate(CHAR *queueName, UINT16 len, UINT32
     LOS_ListInit(&queueCB->readWriteList[OS_QUEUE_READ]);//初始化可读队列任务链表
     LOS_ListInit(&queueCB->readWriteList[OS_QUEUE_WRITE]);//初始化可写队列任务链表
     LOS_ListInit(&queueCB->memList);//
+    queueCB->queueMode = (flags & LOS_QUEUE_ZERO_COPY) ? OS_QUEUE_ZERO_COPY : OS_QUEUE_NORMAL;//队列模式
+    LOS_AtomicSet(&queueCB->zcCount, 0);
+    LOS_AtomicSet(&queueCB->zcSlotState, OS_QUEUE_ZC_SLOT_FREE);
+    LOS_AtomicSet(&queueCB->zcWaiters[OS_QUEUE_READ], 0);
+    LOS_AtomicSet(&queueCB->zcWaiters[OS_QUEUE_WRITE], 0);
 
     OsQueueDbgUpdateHook(queueCB->queueID, OsCurrTaskGet()->taskEntry);//在创建或删除队列调试信息时更新任务条目
     SCHEDULER_UNLOCK(intSave);
@@ -300,6 +304,10 @@ STATIC UINT32 OsQueueOperateParamCheck(const LosQueueCB *queueCB, UINT32 queueID
         return LOS_ERRNO_QUEUE_NOT_CREATE;
     }
 
+    if (queueCB->queueMode == OS_QUEUE_ZERO_COPY) {//零拷贝队列只能走 reserve/commit, peek/release
+        return LOS_ERRNO_QUEUE_MODE_INVALID;
+    }
+
     if (OS_QUEUE_IS_READ(operateType) && (*bufferSize < (queueCB->queueSize - sizeof(UINT32)))) {//读时判断
         return LOS_ERRNO_QUEUE_READ_SIZE_TOO_SMALL;//接走队列数据的buffer太小了,接不走整个消息数据
     } else if (OS_QUEUE_IS_WRITE(operateType) && (*bufferSize > (queueCB->queueSize - sizeof(UINT32)))) {//写时判断
@@ -476,6 +484,268 @@ LITE_OS_SEC_TEXT UINT32 LOS_QueueWriteHead(UINT32 queueID,
     return LOS_QueueWriteHeadCopy(queueID, &bufferAddr, bufferSize, timeout);
 }
 
+/*
+ * 零拷贝队列
+ * 消息直接在 queueHandle 的槽位里生产和消费: 写端 reserve 拿到 queueTail 处的槽位, 填好后 commit;
+ * 读端 peek 拿到 queueHead 处的槽位, 用完后 release. 单生产者单消费者下 queueTail 只归写端,
+ * queueHead 只归读端, 双方只通过原子计数 zcCount 交接, 不需要调度锁. 只有对端有任务挂起
+ * (zcWaiters 非0)时才进调度锁去唤醒它.
+ */
+STATIC INLINE UINT8 *OsQueueZcSlot(const LosQueueCB *queueCB, UINT16 position)
+{
+    return &queueCB->queueHandle[position * queueCB->queueSize];
+}
+
+STATIC INLINE UINT32 OsQueueZcAvail(LosQueueCB *queueCB, UINT32 readWrite)
+{
+    UINT32 count = (UINT32)LOS_AtomicRead(&queueCB->zcCount);
+    return (readWrite == OS_QUEUE_READ) ? count : (queueCB->queueLen - count);
+}
+
+STATIC UINT32 OsQueueZcCheck(UINT32 queueID, LosQueueCB **queueCB)
+{
+    LosQueueCB *queue = NULL;
+
+    if (GET_QUEUE_INDEX(queueID) >= LOSCFG_BASE_IPC_QUEUE_LIMIT) {
+        return LOS_ERRNO_QUEUE_INVALID;
+    }
+
+    queue = (LosQueueCB *)GET_QUEUE_HANDLE(queueID);
+    if ((queue->queueID != queueID) || (queue->queueState == OS_QUEUE_UNUSED)) {
+        return LOS_ERRNO_QUEUE_NOT_CREATE;
+    }
+
+    if (queue->queueMode != OS_QUEUE_ZERO_COPY) {
+        return LOS_ERRNO_QUEUE_MODE_INVALID;
+    }
+
+    *queueCB = queue;
+    return LOS_OK;
+}
+
+/* 慢路径: 读端没消息/写端没槽位时挂起, 先登记 zcWaiters 再复查, 与对端的 "先发布再查 zcWaiters" 配对, 不会丢唤醒 */
+STATIC UINT32 OsQueueZcWait(LosQueueCB *queueCB, UINT32 queueID, UINT32 readWrite, UINT32 timeout)
+{
+    UINT32 intSave;
+    UINT32 ret = LOS_OK;
+
+    if (timeout == LOS_NO_WAIT) {
+        return (readWrite == OS_QUEUE_READ) ? LOS_ERRNO_QUEUE_ISEMPTY : LOS_ERRNO_QUEUE_ISFULL;
+    }
+
+    if (OS_INT_ACTIVE) {
+        return (readWrite == OS_QUEUE_READ) ? LOS_ERRNO_QUEUE_READ_IN_INTERRUPT : LOS_ERRNO_QUEUE_WRITE_IN_INTERRUPT;
+    }
+
+    SCHEDULER_LOCK(intSave);
+    if ((queueCB->queueID != queueID) || (queueCB->queueState == OS_QUEUE_UNUSED)) {
+        SCHEDULER_UNLOCK(intSave);
+        return LOS_ERRNO_QUEUE_NOT_CREATE;
+    }
+
+    LOS_AtomicInc(&queueCB->zcWaiters[readWrite]);
+    DMB;
+    if (OsQueueZcAvail(queueCB, readWrite) == 0) {
+        if (!OsPreemptableInSched()) {
+            ret = LOS_ERRNO_QUEUE_PEND_IN_LOCK;
+        } else {
+            OsTaskWaitSetPendMask(OS_TASK_WAIT_QUEUE, queueCB->queueID, timeout);
+            ret = OsSchedTaskWait(&queueCB->readWriteList[readWrite], timeout, TRUE);
+            if (ret == LOS_ERRNO_TSK_TIMEOUT) {
+                ret = LOS_ERRNO_QUEUE_TIMEOUT;
+            }
+        }
+    }
+    LOS_AtomicDec(&queueCB->zcWaiters[readWrite]);
+    SCHEDULER_UNLOCK(intSave);
+    return ret;
+}
+
+/*
+ * 写端登记预留的槽位. 删除队列时把 zcSlotState 从空闲改成正在删除, 与这里在同一个原子量上竞争,
+ * 所以预留成功后队列一定删不掉, 删除开始后也不会再有新的预留.
+ */
+STATIC UINT32 OsQueueZcSlotClaim(LosQueueCB *queueCB, UINT32 queueID)
+{
+    INT32 state;
+    BOOL claimed = FALSE;
+
+    do {
+        state = LOS_AtomicRead(&queueCB->zcSlotState);
+        if (state == OS_QUEUE_ZC_SLOT_DELETING) {
+            return LOS_ERRNO_QUEUE_NOT_CREATE;
+        }
+        if (state == OS_QUEUE_ZC_SLOT_RESERVED) {//再次预留,还是同一个槽位
+            break;
+        }
+        claimed = !LOS_AtomicCmpXchg32bits(&queueCB->zcSlotState, OS_QUEUE_ZC_SLOT_RESERVED, OS_QUEUE_ZC_SLOT_FREE);
+    } while (!claimed);
+    DMB;
+
+    if ((queueCB->queueID != queueID) || (queueCB->queueState == OS_QUEUE_UNUSED)) {//控制块已被删除并重新分配
+        if (claimed) {
+            (VOID)LOS_AtomicCmpXchg32bits(&queueCB->zcSlotState, OS_QUEUE_ZC_SLOT_FREE, OS_QUEUE_ZC_SLOT_RESERVED);
+        }
+        return LOS_ERRNO_QUEUE_NOT_CREATE;
+    }
+    return LOS_OK;
+}
+
+/* 唤醒对端挂起的任务, 没有挂起任务时只是一次原子读 */
+STATIC VOID OsQueueZcWake(LosQueueCB *queueCB, UINT32 readWrite)
+{
+    LosTaskCB *resumedTask = NULL;
+    UINT32 intSave;
+
+    DMB;
+    if (LOS_AtomicRead(&queueCB->zcWaiters[readWrite]) == 0) {
+        return;
+    }
+
+    SCHEDULER_LOCK(intSave);
+    if (LOS_ListEmpty(&queueCB->readWriteList[readWrite])) {
+        SCHEDULER_UNLOCK(intSave);
+        return;
+    }
+
+    resumedTask = OS_TCB_FROM_PENDLIST(LOS_DL_LIST_FIRST(&queueCB->readWriteList[readWrite]));
+    OsTaskWakeClearPendMask(resumedTask);
+    OsSchedTaskWake(resumedTask);
+    SCHEDULER_UNLOCK(intSave);
+    LOS_MpSchedule(OS_MP_CPU_ALL);
+    LOS_Schedule();
+}
+///零拷贝队列 写端申请槽位
+LITE_OS_SEC_TEXT UINT32 LOS_QueueReserve(UINT32 queueID, VOID **slotAddr, UINT32 *slotSize, UINT32 timeout)
+{
+    LosQueueCB *queueCB = NULL;
+    UINT32 ret;
+
+    if ((slotAddr == NULL) || (slotSize == NULL)) {
+        return LOS_ERRNO_QUEUE_WRITE_PTR_NULL;
+    }
+
+    ret = OsQueueZcCheck(queueID, &queueCB);
+    if (ret != LOS_OK) {
+        return ret;
+    }
+
+    if (OsQueueZcAvail(queueCB, OS_QUEUE_WRITE) == 0) {
+        ret = OsQueueZcWait(queueCB, queueID, OS_QUEUE_WRITE, timeout);
+        if (ret != LOS_OK) {
+            return ret;
+        }
+        if (OsQueueZcAvail(queueCB, OS_QUEUE_WRITE) == 0) {//只有一个写者,等到了就一定有空槽,这里只是防御
+            return LOS_ERRNO_QUEUE_ISFULL;
+        }
+    }
+
+    ret = OsQueueZcSlotClaim(queueCB, queueID);
+    if (ret != LOS_OK) {
+        return ret;
+    }
+
+    *slotAddr = OsQueueZcSlot(queueCB, queueCB->queueTail);
+    *slotSize = queueCB->queueSize - sizeof(UINT32);
+    return LOS_OK;
+}
+///零拷贝队列 写端提交槽位,所有权交给读端
+LITE_OS_SEC_TEXT UINT32 LOS_QueueCommit(UINT32 queueID, VOID *slotAddr, UINT32 msgSize)
+{
+    LosQueueCB *queueCB = NULL;
+    UINT8 *slot = NULL;
+    UINT32 ret;
+
+    ret = OsQueueZcCheck(queueID, &queueCB);
+    if (ret != LOS_OK) {
+        return ret;
+    }
+
+    if (msgSize == 0) {
+        return LOS_ERRNO_QUEUE_WRITESIZE_ISZERO;
+    }
+
+    if (msgSize > (queueCB->queueSize - sizeof(UINT32))) {
+        return LOS_ERRNO_QUEUE_WRITE_SIZE_TOO_BIG;
+    }
+
+    slot = OsQueueZcSlot(queueCB, queueCB->queueTail);
+    if ((slotAddr != slot) || (OsQueueZcAvail(queueCB, OS_QUEUE_WRITE) == 0) ||
+        (LOS_AtomicRead(&queueCB->zcSlotState) != OS_QUEUE_ZC_SLOT_RESERVED)) {
+        return LOS_ERRNO_QUEUE_SLOT_INVALID;
+    }
+
+    *(UINT32 *)(slot + queueCB->queueSize - sizeof(UINT32)) = msgSize;//槽位末尾4个字节记录消息长度,与拷贝模式一致
+    ((queueCB->queueTail + 1) == queueCB->queueLen) ? (queueCB->queueTail = 0) : (queueCB->queueTail++);
+    DMB;//消息内容必须先于计数对读端可见
+    LOS_AtomicInc(&queueCB->zcCount);
+    DMB;//删除者看到槽位空闲时必须也能看到这条消息
+    LOS_AtomicSet(&queueCB->zcSlotState, OS_QUEUE_ZC_SLOT_FREE);
+    OsHookCall(LOS_HOOK_TYPE_QUEUE_WRITE, queueCB, OS_QUEUE_WRITE_TAIL, msgSize, 0);
+
+    OsQueueZcWake(queueCB, OS_QUEUE_READ);
+    return LOS_OK;
+}
+///零拷贝队列 读端取最早的消息,不拷贝
+LITE_OS_SEC_TEXT UINT32 LOS_QueuePeek(UINT32 queueID, VOID **msgAddr, UINT32 *msgSize, UINT32 timeout)
+{
+    LosQueueCB *queueCB = NULL;
+    UINT8 *slot = NULL;
+    UINT32 ret;
+
+    if ((msgAddr == NULL) || (msgSize == NULL)) {
+        return LOS_ERRNO_QUEUE_READ_PTR_NULL;
+    }
+
+    ret = OsQueueZcCheck(queueID, &queueCB);
+    if (ret != LOS_OK) {
+        return ret;
+    }
+
+    if (OsQueueZcAvail(queueCB, OS_QUEUE_READ) == 0) {
+        ret = OsQueueZcWait(queueCB, queueID, OS_QUEUE_READ, timeout);
+        if (ret != LOS_OK) {
+            return ret;
+        }
+        if (OsQueueZcAvail(queueCB, OS_QUEUE_READ) == 0) {
+            return LOS_ERRNO_QUEUE_ISEMPTY;
+        }
+    }
+    DMB;//看到计数后才能读消息内容
+
+    slot = OsQueueZcSlot(queueCB, queueCB->queueHead);
+    *msgAddr = slot;
+    *msgSize = *(UINT32 *)(slot + queueCB->queueSize - sizeof(UINT32));
+    return LOS_OK;
+}
+///零拷贝队列 读端归还槽位给写端
+LITE_OS_SEC_TEXT UINT32 LOS_QueueRelease(UINT32 queueID, VOID *msgAddr)
+{
+    LosQueueCB *queueCB = NULL;
+    UINT32 ret;
+
+    ret = OsQueueZcCheck(queueID, &queueCB);
+    if (ret != LOS_OK) {
+        return ret;
+    }
+
+    if (OsQueueZcAvail(queueCB, OS_QUEUE_READ) == 0) {
+        return LOS_ERRNO_QUEUE_ISEMPTY;
+    }
+
+    if (msgAddr != OsQueueZcSlot(queueCB, queueCB->queueHead)) {
+        return LOS_ERRNO_QUEUE_SLOT_INVALID;
+    }
+
+    ((queueCB->queueHead + 1) == queueCB->queueLen) ? (queueCB->queueHead = 0) : (queueCB->queueHead++);
+    DMB;//读端用完槽位后才能交还
+    LOS_AtomicDec(&queueCB->zcCount);
+    OsHookCall(LOS_HOOK_TYPE_QUEUE_READ, queueCB, OS_QUEUE_READ_HEAD, 0, 0);
+
+    OsQueueZcWake(queueCB, OS_QUEUE_WRITE);
+    return LOS_OK;
+}
+
 /**
  * @brief 
  * @verbatim
@@ -523,6 +793,19 @@ LITE_OS_SEC_TEXT_INIT UINT32 LOS_QueueDelete(UINT32 queueID)
         goto QUEUE_END;
     }
 
+    if (queueCB->queueMode == OS_QUEUE_ZERO_COPY) {
+        if (LOS_AtomicCmpXchg32bits(&queueCB->zcSlotState, OS_QUEUE_ZC_SLOT_DELETING, OS_QUEUE_ZC_SLOT_FREE)) {
+            ret = LOS_ERRNO_QUEUE_SLOT_IN_USE;//写端还持有预留的槽位
+            goto QUEUE_END;
+        }
+        DMB;
+        if (LOS_AtomicRead(&queueCB->zcCount) != 0) {//还有消息未被消费
+            LOS_AtomicSet(&queueCB->zcSlotState, OS_QUEUE_ZC_SLOT_FREE);
+            ret = LOS_ERRNO_QUEUE_SLOT_IN_USE;
+            goto QUEUE_END;
+        }
+    }
+
     queue = queueCB->queueHandle;	//队列buf
     queueCB->queueHandle = NULL;	//
     queueCB->queueState = OS_QUEUE_UNUSED;//重置队列状态
@@ -571,6 +854,10 @@ LITE_OS_SEC_TEXT_MINOR UINT32 LOS_QueueInfoGet(UINT32 queueID, QUEUE_INFO_S *que
     queueInfo->usQueueTail = queueCB->queueTail;
     queueInfo->usReadableCnt = queueCB->readWriteableCnt[OS_QUEUE_READ];//可读数
     queueInfo->usWritableCnt = queueCB->readWriteableCnt[OS_QUEUE_WRITE];//可写数
+    if (queueCB->queueMode == OS_QUEUE_ZERO_COPY) {//零拷贝队列的计数不走 readWriteableCnt
+        queueInfo->usReadableCnt = (UINT16)LOS_AtomicRead(&queueCB->zcCount);
+        queueInfo->usWritableCnt = queueCB->queueLen - queueInfo->usReadableCnt;
+    }
 
     LOS_DL_LIST_FOR_EACH_ENTRY(tskCB, &queueCB->readWriteList[OS_QUEUE_READ], LosTaskCB, pendList) {//找出哪些task需要读消息
         queueInfo->uwWaitReadTask |= 1ULL << tskCB->taskID;//记录等待读消息的任务号, uwWaitReadTask 每一位代表一个任务编号
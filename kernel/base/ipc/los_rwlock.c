@@ -68,6 +68,9 @@ UINT32 LOS_RwlockInit(LosRwlock *rwlock)
     rwlock->writeOwner = NULL;
     LOS_ListInit(&(rwlock->readList));
     LOS_ListInit(&(rwlock->writeList));
+#ifdef LOSCFG_KERNEL_LOCKSTAT
+    rwlock->statHold.slot = 0;
+#endif
     rwlock->magic = OS_RWLOCK_MAGIC;
     SCHEDULER_UNLOCK(intSave);
     return LOS_OK;
@@ -280,9 +283,57 @@ UINT32 OsRwlockTryWrUnsafe(LosRwlock *rwlock, UINT32 timeout)
     return OsRwlockWrPendOp(runTask, rwlock, timeout);
 }
 
+/* lock-stat: 在调度锁内调用, 拿锁前取时间并看锁是否被别人占着 */
+STATIC INLINE UINT64 OsRwlockStatStart(const LosRwlock *rwlock, BOOL isWrite, BOOL *contended)
+{
+#ifdef LOSCFG_KERNEL_LOCKSTAT
+    const LosTaskCB *runTask = OsCurrTaskGet();
+
+    if (!LOCKSTAT_ON()) {
+        return 0;
+    }
+    if (isWrite) {
+        *contended = (rwlock->rwCount != 0) && ((LosTaskCB *)rwlock->writeOwner != runTask);
+    } else {
+        *contended = (rwlock->rwCount < 0) && ((LosTaskCB *)rwlock->writeOwner != runTask);
+    }
+    return OsLockStatCycles();
+#else
+    (VOID)rwlock;
+    (VOID)isWrite;
+    (VOID)contended;
+    return 0;
+#endif
+}
+
+/* 读者可以有多个, 只记录拿锁; 写者在第一次拿到锁(rwCount 变成-1)时开始记持锁时间 */
+STATIC INLINE VOID OsRwlockStatAcquired(LosRwlock *rwlock, BOOL isWrite, UINT64 start, BOOL contended,
+                                        const VOID *site, UINT32 ret)
+{
+#ifdef LOSCFG_KERNEL_LOCKSTAT
+    if ((start == 0) || (ret != LOS_OK)) {
+        return;
+    }
+    if (!isWrite) {
+        OsLockStatAcquired(NULL, rwlock, LOCKSTAT_RWLOCK_RD, site, contended, start);
+    } else if (rwlock->rwCount == -1) {
+        OsLockStatAcquired(&rwlock->statHold, rwlock, LOCKSTAT_RWLOCK_WR, site, contended, start);
+    }
+#else
+    (VOID)rwlock;
+    (VOID)isWrite;
+    (VOID)start;
+    (VOID)contended;
+    (VOID)site;
+    (VOID)ret;
+#endif
+}
+
 UINT32 LOS_RwlockRdLock(LosRwlock *rwlock, UINT32 timeout)
 {
     UINT32 intSave;
+    UINT64 statStart;
+    BOOL contended = FALSE;
 
     UINT32 ret = OsRwlockCheck(rwlock);
     if (ret != LOS_OK) {
@@ -290,7 +341,9 @@ UINT32 LOS_RwlockRdLock(LosRwlock *rwlock, UINT32 timeout)
     }
 
     SCHEDULER_LOCK(intSave);
+    statStart = OsRwlockStatStart(rwlock, FALSE, &contended);
     ret = OsRwlockRdUnsafe(rwlock, timeout);
+    OsRwlockStatAcquired(rwlock, FALSE, statStart, contended, LOCKSTAT_SITE(), ret);
     SCHEDULER_UNLOCK(intSave);
     return ret;
 }
@@ -298,6 +351,8 @@ UINT32 LOS_RwlockRdLock(LosRwlock *rwlock, UINT32 timeout)
 UINT32 LOS_RwlockTryRdLock(LosRwlock *rwlock)
 {
     UINT32 intSave;
+    UINT64 statStart;
+    BOOL contended = FALSE;
 
     UINT32 ret = OsRwlockCheck(rwlock);
     if (ret != LOS_OK) {
@@ -305,7 +360,9 @@ UINT32 LOS_RwlockTryRdLock(LosRwlock *rwlock)
     }
 
     SCHEDULER_LOCK(intSave);
+    statStart = OsRwlockStatStart(rwlock, FALSE, &contended);
     ret = OsRwlockTryRdUnsafe(rwlock, 0);
+    OsRwlockStatAcquired(rwlock, FALSE, statStart, contended, LOCKSTAT_SITE(), ret);
     SCHEDULER_UNLOCK(intSave);
     return ret;
 }
@@ -313,6 +370,8 @@ UINT32 LOS_RwlockTryRdLock(LosRwlock *rwlock)
 UINT32 LOS_RwlockWrLock(LosRwlock *rwlock, UINT32 timeout)
 {
     UINT32 intSave;
+    UINT64 statStart;
+    BOOL contended = FALSE;
 
     UINT32 ret = OsRwlockCheck(rwlock);
     if (ret != LOS_OK) {
@@ -320,7 +379,9 @@ UINT32 LOS_RwlockWrLock(LosRwlock *rwlock, UINT32 timeout)
     }
 
     SCHEDULER_LOCK(intSave);
+    statStart = OsRwlockStatStart(rwlock, TRUE, &contended);
     ret = OsRwlockWrUnsafe(rwlock, timeout);
+    OsRwlockStatAcquired(rwlock, TRUE, statStart, contended, LOCKSTAT_SITE(), ret);
     SCHEDULER_UNLOCK(intSave);
     return ret;
 }
@@ -328,6 +389,8 @@ UINT32 LOS_RwlockWrLock(LosRwlock *rwlock, UINT32 timeout)
 UINT32 LOS_RwlockTryWrLock(LosRwlock *rwlock)
 {
     UINT32 intSave;
+    UINT64 statStart;
+    BOOL contended = FALSE;
 
     UINT32 ret = OsRwlockCheck(rwlock);
     if (ret != LOS_OK) {
@@ -335,7 +398,9 @@ UINT32 LOS_RwlockTryWrLock(LosRwlock *rwlock)
     }
 
     SCHEDULER_LOCK(intSave);
+    statStart = OsRwlockStatStart(rwlock, TRUE, &contended);
     ret = OsRwlockTryWrUnsafe(rwlock, 0);
+    OsRwlockStatAcquired(rwlock, TRUE, statStart, contended, LOCKSTAT_SITE(), ret);
     SCHEDULER_UNLOCK(intSave);
     return ret;
 }
@@ -451,6 +516,11 @@ UINT32 LOS_RwlockUnLock(LosRwlock *rwlock)
     }
 
     SCHEDULER_LOCK(intSave);
+#ifdef LOSCFG_KERNEL_LOCKSTAT
+    if ((rwlock->rwCount == -1) && ((LosTaskCB *)rwlock->writeOwner == OsCurrTaskGet())) {//写者真正释放锁
+        OsLockStatReleased(&rwlock->statHold);
+    }
+#endif
     ret = OsRwlockUnlockUnsafe(rwlock, &needSched);
     SCHEDULER_UNLOCK(intSave);
     LOS_MpSchedule(OS_MP_CPU_ALL);
@@ -460,5 +530,342 @@ UINT32 LOS_RwlockUnLock(LosRwlock *rwlock)
     return ret;
 }
 
+/*
+ * 大读者锁(brlock)
+ * LosRwlock 的读计数 rwCount 只有一个,并且在调度锁里改,读多的时候所有核都在抢同一条 cache line.
+ * brlock 把读计数拆到每个CPU的槽位上: 读者只加/减自己CPU的槽位, 然后看一眼 writerState, 没有写者就不进调度锁.
+ * 写者先登记(DRAINING), 再等所有槽位之和归零后持锁(HELD). 读者 "先计数再看写者", 写者 "先登记再数读者",
+ * 两边之间都有 DMB, 所以不会出现读者没看到写者而写者也没数到读者的情况.
+ */
+STATIC INLINE BOOL OsBrlockPolicyValid(UINT32 policy)
+{
+    return (policy == LOS_BRLOCK_WRITER_PREFER) || (policy == LOS_BRLOCK_READER_PREFER);
+}
+
+STATIC INT32 OsBrlockReaders(const LosBrlock *brlock)
+{
+    INT32 readers = 0;
+    UINT32 cpuid;
+
+    for (cpuid = 0; cpuid < LOSCFG_KERNEL_CORE_NUM; cpuid++) {
+        readers += *(volatile INT32 *)&brlock->slot[cpuid].readers;
+    }
+
+    return readers;
+}
+
+STATIC INLINE BOOL OsBrlockReaderMayEnter(const LosBrlock *brlock)
+{
+    UINT32 state = brlock->writerState;
+
+    if (state == BRLOCK_WRITER_NONE) {
+        return TRUE;
+    }
+
+    return (state == BRLOCK_WRITER_DRAINING) && (brlock->policy == LOS_BRLOCK_READER_PREFER);
+}
+
+/* 读者离开后,如果写者在等读者清空,而且已经清空了,就唤醒它 */
+STATIC VOID OsBrlockDrainWake(LosBrlock *brlock)
+{
+    LosTaskCB *resumedTask = NULL;
+    UINT32 intSave;
+
+    SCHEDULER_LOCK(intSave);
+    if (LOS_ListEmpty(&brlock->drainList) || (OsBrlockReaders(brlock) != 0)) {
+        SCHEDULER_UNLOCK(intSave);
+        return;
+    }
+
+    resumedTask = OS_TCB_FROM_PENDLIST(LOS_DL_LIST_FIRST(&brlock->drainList));
+    OsSchedTaskWake(resumedTask);
+    SCHEDULER_UNLOCK(intSave);
+    LOS_MpSchedule(OS_MP_CPU_ALL);
+    LOS_Schedule();
+}
+
+/* 写者放手(解锁或等读者超时): 写者优先时把锁直接交给下一个写者, 否则放行所有读者 */
+STATIC VOID OsBrlockWriterRelease(LosBrlock *brlock, BOOL *needSched)
+{
+    LosTaskCB *resumedTask = NULL;
+
+    brlock->writeOwner = NULL;
+    brlock->writerState = BRLOCK_WRITER_NONE;
+
+    if ((brlock->policy == LOS_BRLOCK_WRITER_PREFER) && !LOS_ListEmpty(&brlock->writeList)) {
+        resumedTask = OS_TCB_FROM_PENDLIST(LOS_DL_LIST_FIRST(&brlock->writeList));
+        brlock->writeOwner = (VOID *)resumedTask;
+        brlock->writerState = BRLOCK_WRITER_DRAINING;
+        OsSchedTaskWake(resumedTask);
+        *needSched = TRUE;
+        return;
+    }
+
+    while (!LOS_ListEmpty(&brlock->readList)) {
+        resumedTask = OS_TCB_FROM_PENDLIST(LOS_DL_LIST_FIRST(&brlock->readList));
+        OsSchedTaskWake(resumedTask);
+        *needSched = TRUE;
+    }
+
+    if (!LOS_ListEmpty(&brlock->writeList)) {
+        resumedTask = OS_TCB_FROM_PENDLIST(LOS_DL_LIST_FIRST(&brlock->writeList));
+        OsSchedTaskWake(resumedTask);
+        *needSched = TRUE;
+    }
+}
+
+STATIC UINT32 OsBrlockPend(LosTaskCB *runTask, LOS_DL_LIST *list, UINT32 timeout)
+{
+    UINT32 ret;
+
+    if (!timeout) {
+        return LOS_EINVAL;
+    }
+
+    if (!OsPreemptableInSched()) {
+        return LOS_EDEADLK;
+    }
+
+    ret = OsSchedTaskWait(OsSchedLockPendFindPos(runTask, list), timeout, TRUE);
+    if (ret == LOS_ERRNO_TSK_TIMEOUT) {
+        return LOS_ETIMEDOUT;
+    }
+
+    return ret;
+}
+
+UINT32 LOS_BrlockInit(LosBrlock *brlock, UINT32 policy)
+{
+    UINT32 intSave;
+
+    if ((brlock == NULL) || !OsBrlockPolicyValid(policy)) {
+        return LOS_EINVAL;
+    }
+
+    SCHEDULER_LOCK(intSave);
+    if (brlock->magic == OS_BRLOCK_MAGIC) {
+        SCHEDULER_UNLOCK(intSave);
+        return LOS_EPERM;
+    }
+
+    (VOID)memset_s(brlock->slot, sizeof(brlock->slot), 0, sizeof(brlock->slot));
+    brlock->writerState = BRLOCK_WRITER_NONE;
+    brlock->policy = policy;
+    brlock->writeOwner = NULL;
+    LOS_ListInit(&brlock->readList);
+    LOS_ListInit(&brlock->writeList);
+    LOS_ListInit(&brlock->drainList);
+    brlock->magic = OS_BRLOCK_MAGIC;
+    SCHEDULER_UNLOCK(intSave);
+    return LOS_OK;
+}
+
+UINT32 LOS_BrlockDestroy(LosBrlock *brlock)
+{
+    UINT32 intSave;
+
+    if (brlock == NULL) {
+        return LOS_EINVAL;
+    }
+
+    SCHEDULER_LOCK(intSave);
+    if (brlock->magic != OS_BRLOCK_MAGIC) {
+        SCHEDULER_UNLOCK(intSave);
+        return LOS_EBADF;
+    }
+
+    if ((brlock->writeOwner != NULL) || (OsBrlockReaders(brlock) != 0) || !LOS_ListEmpty(&brlock->readList) ||
+        !LOS_ListEmpty(&brlock->writeList)) {
+        SCHEDULER_UNLOCK(intSave);
+        return LOS_EBUSY;
+    }
+
+    (VOID)memset_s(brlock, sizeof(LosBrlock), 0, sizeof(LosBrlock));
+    SCHEDULER_UNLOCK(intSave);
+    return LOS_OK;
+}
+
+UINT32 LOS_BrlockPolicySet(LosBrlock *brlock, UINT32 policy)
+{
+    UINT32 intSave;
+
+    if ((brlock == NULL) || !OsBrlockPolicyValid(policy)) {
+        return LOS_EINVAL;
+    }
+
+    SCHEDULER_LOCK(intSave);
+    if (brlock->magic != OS_BRLOCK_MAGIC) {
+        SCHEDULER_UNLOCK(intSave);
+        return LOS_EBADF;
+    }
+    brlock->policy = policy;
+    SCHEDULER_UNLOCK(intSave);
+    return LOS_OK;
+}
+
+UINT32 LOS_BrlockRdLock(LosBrlock *brlock, UINT32 timeout)
+{
+    LosBrlockSlot *slot = NULL;
+    LosTaskCB *runTask = NULL;
+    UINT32 intSave;
+
+    UINT32 ret = OsRwlockCheck((LosRwlock *)brlock);
+    if (ret != LOS_OK) {
+        return ret;
+    }
+
+    if (brlock->magic != OS_BRLOCK_MAGIC) {
+        return LOS_EBADF;
+    }
+
+    /* 快路径: 只动本CPU的槽位,关中断保证计数期间不换核 */
+    intSave = LOS_IntLock();
+    slot = &brlock->slot[ArchCurrCpuid()];
+    slot->readers++;
+    DMB;
+    if (OsBrlockReaderMayEnter(brlock)) {
+        LOS_IntRestore(intSave);
+        return LOS_OK;
+    }
+    slot->readers--;
+    LOS_IntRestore(intSave);
+    DMB;
+    OsBrlockDrainWake(brlock);//退回的计数可能正是写者在等的最后一个
+
+    /* 慢路径: 有写者,在调度锁里排队 */
+    runTask = OsCurrTaskGet();
+    SCHEDULER_LOCK(intSave);
+    while (!OsBrlockReaderMayEnter(brlock)) {
+        if ((LosTaskCB *)brlock->writeOwner == runTask) {
+            ret = LOS_EDEADLK;
+            goto OUT;
+        }
+        ret = OsBrlockPend(runTask, &brlock->readList, timeout);
+        if (ret != LOS_OK) {
+            goto OUT;
+        }
+    }
+    brlock->slot[ArchCurrCpuid()].readers++;
+OUT:
+    SCHEDULER_UNLOCK(intSave);
+    return ret;
+}
+
+UINT32 LOS_BrlockRdUnlock(LosBrlock *brlock)
+{
+    UINT32 intSave;
+
+    UINT32 ret = OsRwlockCheck((LosRwlock *)brlock);
+    if (ret != LOS_OK) {
+        return ret;
+    }
+
+    if (brlock->magic != OS_BRLOCK_MAGIC) {
+        return LOS_EBADF;
+    }
+
+    intSave = LOS_IntLock();
+    brlock->slot[ArchCurrCpuid()].readers--;
+    LOS_IntRestore(intSave);
+    DMB;
+    if (brlock->writerState != BRLOCK_WRITER_NONE) {//有写者在等,才需要进调度锁
+        OsBrlockDrainWake(brlock);
+    }
+    return LOS_OK;
+}
+
+UINT32 LOS_BrlockWrLock(LosBrlock *brlock, UINT32 timeout)
+{
+    LosTaskCB *runTask = NULL;
+    BOOL needSched = FALSE;
+    UINT32 intSave;
+
+    UINT32 ret = OsRwlockCheck((LosRwlock *)brlock);
+    if (ret != LOS_OK) {
+        return ret;
+    }
+
+    runTask = OsCurrTaskGet();
+    SCHEDULER_LOCK(intSave);
+    if (brlock->magic != OS_BRLOCK_MAGIC) {
+        ret = LOS_EBADF;
+        goto OUT;
+    }
+
+    if ((LosTaskCB *)brlock->writeOwner == runTask) {
+        ret = LOS_EDEADLK;
+        goto OUT;
+    }
+
+    /* 先排到写者的位置,写者之间互斥; 写者优先时上一个写者会直接把 writeOwner 交过来 */
+    while ((brlock->writeOwner != NULL) && ((LosTaskCB *)brlock->writeOwner != runTask)) {
+        ret = OsBrlockPend(runTask, &brlock->writeList, timeout);
+        if (ret != LOS_OK) {
+            goto OUT;
+        }
+    }
+    brlock->writeOwner = (VOID *)runTask;
+    brlock->writerState = BRLOCK_WRITER_DRAINING;
+    DMB;
+
+    /* 再等所有CPU上的读者离开 */
+    while (TRUE) {
+        if (OsBrlockReaders(brlock) == 0) {
+            brlock->writerState = BRLOCK_WRITER_HELD;
+            DMB;
+            if (OsBrlockReaders(brlock) == 0) {//读者优先时,登记期间可能又进来了读者
+                break;
+            }
+            brlock->writerState = BRLOCK_WRITER_DRAINING;
+            DMB;
+            continue;
+        }
+
+        ret = OsBrlockPend(runTask, &brlock->drainList, timeout);
+        if (ret != LOS_OK) {
+            OsBrlockWriterRelease(brlock, &needSched);
+            goto OUT;
+        }
+    }
+
+OUT:
+    SCHEDULER_UNLOCK(intSave);
+    if (needSched) {
+        LOS_MpSchedule(OS_MP_CPU_ALL);
+        LOS_Schedule();
+    }
+    return ret;
+}
+
+UINT32 LOS_BrlockWrUnlock(LosBrlock *brlock)
+{
+    BOOL needSched = FALSE;
+    UINT32 intSave;
+
+    UINT32 ret = OsRwlockCheck((LosRwlock *)brlock);
+    if (ret != LOS_OK) {
+        return ret;
+    }
+
+    SCHEDULER_LOCK(intSave);
+    if (brlock->magic != OS_BRLOCK_MAGIC) {
+        SCHEDULER_UNLOCK(intSave);
+        return LOS_EBADF;
+    }
+
+    if (((LosTaskCB *)brlock->writeOwner != OsCurrTaskGet()) || (brlock->writerState != BRLOCK_WRITER_HELD)) {
+        SCHEDULER_UNLOCK(intSave);
+        return LOS_EPERM;
+    }
+
+    OsBrlockWriterRelease(brlock, &needSched);
+    SCHEDULER_UNLOCK(intSave);
+    if (needSched) {
+        LOS_MpSchedule(OS_MP_CPU_ALL);
+        LOS_Schedule();
+    }
+    return LOS_OK;
+}
+
 #endif /* LOSCFG_BASE_IPC_RWLOCK */
 
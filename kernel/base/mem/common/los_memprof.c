@@ -0,0 +1,426 @@
+/*
+ * Copyright (c) 2013-2019 Huawei Technologies Co., Ltd. All rights reserved.
+ * Copyright (c) 2020-2021 Huawei Device Co., Ltd. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of
+ *    conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list
+ *    of conditions and the following disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used
+ *    to endorse or promote products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "los_memprof.h"
+#include "stdlib.h"
+#include "los_atomic.h"
+#include "los_exc.h"
+#include "los_hw_cpu.h"
+#include "los_printf.h"
+#include "los_seq_buf.h"
+#include "los_spinlock.h"
+#include "los_stat_table_pri.h"
+#ifdef LOSCFG_SHELL
+#include "shcmd.h"
+#include "shell.h"
+#endif
+
+/*
+ * 文件作用: 内核堆分配采样剖析
+ * 每个核累计分配的字节数, 每到采样间隔(带随机抖动)采一次样, 记下分配点的调用栈,
+ * 以调用栈为键在槽位表里累计采样次数和估计的分配字节. 采到的地址另外记在存活表里,
+ * 释放时匹配上就从该调用栈的存活字节里减掉, 于是同时得到累计分配和当前存活两种分布.
+ * 槽位表和 off-CPU 剖析共用 los_stat_table 的开放寻址哈希表; 存活表由自旋锁保护,
+ * 释放路径先不加锁查一次, 没采样的地址(绝大多数)不拿锁.
+ */
+#ifdef LOSCFG_KERNEL_MEMPROF
+
+#define MEMPROF_SITE_NUM        LOSCFG_KERNEL_MEMPROF_SLOTS
+#define MEMPROF_LIVE_NUM        LOSCFG_KERNEL_MEMPROF_LIVE
+#define MEMPROF_LIVE_PROBE      32U     /* 存活表最多探测这么多项, 限制释放路径上的开销 */
+#define MEMPROF_STACK_SKIP      2U      /* 跳过 OsMemProfRecord 和 LOS_MemAlloc 这两层 */
+#define MEMPROF_HASH_MUL        0x9E3779B1U
+#define MEMPROF_RAND_MUL        1103515245U
+#define MEMPROF_RAND_ADD        12345U
+#define MEMPROF_RAND_SHIFT      8U
+#define MEMPROF_PTR_SHIFT       3U      /* 分配出的地址至少8字节对齐 */
+#define MEMPROF_LIVE_TOMBSTONE  ((const VOID *)1) /* 已删除的存活项, 查找时要越过 */
+
+typedef struct {
+    UINTPTR     ip[MEMPROF_STACK_DEPTH];  /* 内层在前, 没用满的填 0 */
+} MemProfKey;
+
+typedef struct {
+    Atomic      state;                  /* 必须是第一个成员, 见 los_stat_table_pri.h */
+    MemProfKey  key;
+    Atomic      allocCount;             /* 采样次数 */
+    Atomic64    allocBytes;             /* 估计的累计分配字节 */
+    Atomic      liveCount;              /* 还没释放的采样 */
+    Atomic64    liveBytes;              /* 估计的存活字节 */
+} MemProfSite;
+
+typedef struct {
+    const VOID  *ptr;                   /* NULL 表示空项 */
+    UINT32      site;
+    UINT32      weight;
+} MemProfLive;
+
+typedef struct {
+    UINT32      bytes;                  /* 上次采样后本核分配的字节 */
+    UINT32      next;                   /* 累计到这个数就采样 */
+    UINT32      seed;
+} MemProfCpu;
+
+LosStaticKey g_memProfKey = LOS_STATIC_KEY_INIT;
+LosStaticKey g_memProfFreeKey = LOS_STATIC_KEY_INIT;
+STATIC BOOL g_memProfOn = FALSE;
+STATIC BOOL g_memProfFreeOn = FALSE;
+STATIC UINT32 g_memProfInterval = LOSCFG_KERNEL_MEMPROF_INTERVAL;
+STATIC UINT32 g_memProfLiveDropped;
+STATIC MemProfCpu g_memProfCpu[LOSCFG_KERNEL_CORE_NUM];
+STATIC MemProfSite g_memProfSites[MEMPROF_SITE_NUM];
+STATIC StatTable g_memProfSiteTable = STAT_TABLE_INIT(g_memProfSites, MemProfSite, key);
+STATIC MemProfLive g_memProfLive[MEMPROF_LIVE_NUM];
+LITE_OS_SEC_BSS SPIN_LOCK_INIT(g_memProfSpin);  /* 保护存活表 */
+
+/* 在 [interval / 2, interval * 3 / 2) 里取下一次采样点, 平均仍是 interval, 避免和固定模式的分配序列同步 */
+STATIC UINT32 OsMemProfNextGet(MemProfCpu *cpu)
+{
+    cpu->seed = (cpu->seed * MEMPROF_RAND_MUL) + MEMPROF_RAND_ADD;
+    return (g_memProfInterval >> 1) + ((cpu->seed >> MEMPROF_RAND_SHIFT) % g_memProfInterval);
+}
+
+UINT32 OsMemProfTick(UINT32 size)
+{
+    MemProfCpu *cpu = &g_memProfCpu[ArchCurrCpuid()];
+    UINT32 bytes = cpu->bytes + size;
+
+    if (bytes < cpu->next) {
+        cpu->bytes = bytes;
+        return 0;
+    }
+
+    cpu->bytes = 0;
+    cpu->next = OsMemProfNextGet(cpu);
+    return bytes;
+}
+
+STATIC INLINE UINT32 OsMemProfLiveHash(const VOID *ptr)
+{
+    return (((UINT32)(UINTPTR)ptr >> MEMPROF_PTR_SHIFT) * MEMPROF_HASH_MUL) % MEMPROF_LIVE_NUM;
+}
+
+/*
+ * 查找 ptr 的存活项. 释放路径上先不加锁调用: 一个地址的存活项在它被分配出去之前就写好了,
+ * 释放时一定能看到; 只有后面紧跟空项的已删除项才会被清空(见 OsMemProfLiveRemove),
+ * 所以一个存活项和它的哈希起点之间不会出现空项, 查找不会提前停下.
+ */
+STATIC MemProfLive *OsMemProfLiveFind(const VOID *ptr)
+{
+    UINT32 index = OsMemProfLiveHash(ptr);
+    MemProfLive *live = NULL;
+    UINT32 probe;
+
+    for (probe = 0; probe < MEMPROF_LIVE_PROBE; probe++) {
+        live = &g_memProfLive[(index + probe) % MEMPROF_LIVE_NUM];
+        if (live->ptr == ptr) {
+            return live;
+        }
+        if (live->ptr == NULL) {
+            break;
+        }
+    }
+    return NULL;
+}
+
+/*
+ * 删除存活项. 后面一项是空项时, 连同前面连续的已删除项一起清空, 否则已删除项越积越多,
+ * 每次释放都要探测满 MEMPROF_LIVE_PROBE 项, 而且停止采样后也一直如此
+ */
+STATIC VOID OsMemProfLiveRemove(MemProfLive *live)
+{
+    MemProfSite *site = &g_memProfSites[live->site];
+    UINT32 index = (UINT32)(live - g_memProfLive);
+
+    LOS_AtomicDec(&site->liveCount);
+    LOS_Atomic64Add(&site->liveBytes, -(INT64)live->weight);
+    if (g_memProfLive[(index + 1) % MEMPROF_LIVE_NUM].ptr != NULL) {
+        live->ptr = MEMPROF_LIVE_TOMBSTONE;
+        return;
+    }
+
+    do {
+        g_memProfLive[index].ptr = NULL;
+        index = (index + MEMPROF_LIVE_NUM - 1) % MEMPROF_LIVE_NUM;
+    } while (g_memProfLive[index].ptr == MEMPROF_LIVE_TOMBSTONE);
+}
+
+STATIC VOID OsMemProfLiveInsert(const VOID *ptr, UINT32 siteIndex, UINT32 weight)
+{
+    UINT32 index = OsMemProfLiveHash(ptr);
+    MemProfLive *live = NULL;
+    MemProfLive *free = NULL;
+    UINT32 probe;
+
+    for (probe = 0; probe < MEMPROF_LIVE_PROBE; probe++) {
+        live = &g_memProfLive[(index + probe) % MEMPROF_LIVE_NUM];
+        if (live->ptr == ptr) {
+            /* 旧的一次没有经过 LOS_MemFree 就被回收了, 例如 LOS_MemFreeByTaskID, 直接覆盖 */
+            LOS_AtomicDec(&g_memProfSites[live->site].liveCount);
+            LOS_Atomic64Add(&g_memProfSites[live->site].liveBytes, -(INT64)live->weight);
+            free = live;
+            break;
+        }
+        if ((live->ptr == MEMPROF_LIVE_TOMBSTONE) && (free == NULL)) {
+            free = live;
+        } else if (live->ptr == NULL) {
+            free = (free == NULL) ? live : free;
+            break;
+        }
+    }
+
+    if (free == NULL) {
+        g_memProfLiveDropped++;
+        return;
+    }
+
+    free->site = siteIndex;
+    free->weight = weight;
+    DMB;
+    free->ptr = ptr;
+    LOS_AtomicInc(&g_memProfSites[siteIndex].liveCount);
+    LOS_Atomic64Add(&g_memProfSites[siteIndex].liveBytes, (INT64)weight);
+}
+
+VOID OsMemProfRecord(const VOID *ptr, UINT32 weight)
+{
+    MemProfKey key;
+    MemProfSite *site = NULL;
+    UINT32 intSave;
+
+    (VOID)memset_s(&key, sizeof(MemProfKey), 0, sizeof(MemProfKey));
+    LOS_RecordLR(key.ip, MEMPROF_STACK_DEPTH, MEMPROF_STACK_DEPTH, MEMPROF_STACK_SKIP);
+
+    site = (MemProfSite *)OsStatTableGet(&g_memProfSiteTable, &key);
+    if (site == NULL) {
+        return;
+    }
+    LOS_AtomicInc(&site->allocCount);
+    LOS_Atomic64Add(&site->allocBytes, (INT64)weight);
+
+    LOS_SpinLockSave(&g_memProfSpin, &intSave);
+    OsMemProfLiveInsert(ptr, (UINT32)(site - g_memProfSites), weight);
+    LOS_SpinUnlockRestore(&g_memProfSpin, intSave);
+}
+
+VOID OsMemProfFree(const VOID *ptr)
+{
+    MemProfLive *live = NULL;
+    UINT32 intSave;
+
+    if (OsMemProfLiveFind(ptr) == NULL) {
+        return;
+    }
+
+    LOS_SpinLockSave(&g_memProfSpin, &intSave);
+    live = OsMemProfLiveFind(ptr);
+    if (live != NULL) {
+        OsMemProfLiveRemove(live);
+    }
+    LOS_SpinUnlockRestore(&g_memProfSpin, intSave);
+}
+
+VOID OsMemProfMove(const VOID *oldPtr, const VOID *newPtr)
+{
+    MemProfLive *live = NULL;
+    UINT32 siteIndex;
+    UINT32 weight;
+    UINT32 intSave;
+
+    if ((oldPtr == newPtr) || (OsMemProfLiveFind(oldPtr) == NULL)) {
+        return;
+    }
+
+    LOS_SpinLockSave(&g_memProfSpin, &intSave);
+    live = OsMemProfLiveFind(oldPtr);
+    if (live != NULL) {
+        siteIndex = live->site;
+        weight = live->weight;
+        OsMemProfLiveRemove(live);
+        OsMemProfLiveInsert(newPtr, siteIndex, weight);
+    }
+    LOS_SpinUnlockRestore(&g_memProfSpin, intSave);
+}
+
+VOID LOS_MemProfStart(UINT32 interval)
+{
+    MemProfCpu *cpu = NULL;
+    UINT32 cpuid;
+
+    if (interval != 0) {
+        g_memProfInterval = (interval < MEMPROF_INTERVAL_MAX) ? interval : MEMPROF_INTERVAL_MAX;
+    }
+    if (g_memProfOn) {
+        return;
+    }
+
+    for (cpuid = 0; cpuid < LOSCFG_KERNEL_CORE_NUM; cpuid++) {
+        cpu = &g_memProfCpu[cpuid];
+        cpu->seed = (cpu->seed == 0) ? (cpuid + 1) : cpu->seed;
+        cpu->bytes = 0;
+        cpu->next = OsMemProfNextGet(cpu);
+    }
+
+    /* 先打开释放匹配再开始采样, 不漏掉采到的分配的释放 */
+    if (!g_memProfFreeOn) {
+        g_memProfFreeOn = TRUE;
+        LOS_StaticKeyInc(&g_memProfFreeKey);
+    }
+    g_memProfOn = TRUE;
+    LOS_StaticKeyInc(&g_memProfKey);
+}
+
+VOID LOS_MemProfStop(VOID)
+{
+    if (!g_memProfOn) {
+        return;
+    }
+    g_memProfOn = FALSE;
+    LOS_StaticKeyDec(&g_memProfKey);
+}
+
+/*
+ * 清表前先停止采样和释放匹配, 其他核上还在填的槽位等它填完再清.
+ * 正在记录的采样可能在清表之后才写进槽位表, 这时会留下一个没有存活项对应的存活计数, 再 reset 一次即可.
+ */
+VOID LOS_MemProfReset(VOID)
+{
+    UINT32 intSave;
+
+    LOS_MemProfStop();
+    if (g_memProfFreeOn) {
+        g_memProfFreeOn = FALSE;
+        LOS_StaticKeyDec(&g_memProfFreeKey);
+    }
+
+    LOS_SpinLockSave(&g_memProfSpin, &intSave);
+    (VOID)memset_s(g_memProfLive, sizeof(g_memProfLive), 0, sizeof(g_memProfLive));
+    g_memProfLiveDropped = 0;
+    LOS_SpinUnlockRestore(&g_memProfSpin, intSave);
+
+    OsStatTableReset(&g_memProfSiteTable);
+}
+
+/* 折叠栈: 内核栈外层在前, 各层之间用 ';' 分隔, 最后是估计的存活字节, 可以直接生成存活内存的火焰图 */
+STATIC VOID OsMemProfStackShow(VOID *seqBuf, const MemProfSite *site)
+{
+    INT32 index;
+    BOOL first = TRUE;
+
+    STAT_TABLE_SHOW(seqBuf, "    stack ");
+    for (index = MEMPROF_STACK_DEPTH - 1; index >= 0; index--) {
+        if (site->key.ip[index] != 0) {
+            STAT_TABLE_SHOW(seqBuf, first ? "0x%x" : ";0x%x", site->key.ip[index]);
+            first = FALSE;
+        }
+    }
+    STAT_TABLE_SHOW(seqBuf, "%s %lld\n", first ? "unknown" : "", LOS_Atomic64Read(&site->liveBytes));
+}
+
+VOID OsMemProfDump(VOID *seqBuf)
+{
+    const MemProfSite *site = NULL;
+    INT64 allocTotal = 0;
+    INT64 liveTotal = 0;
+    UINT32 index;
+
+    for (index = 0; index < MEMPROF_SITE_NUM; index++) {
+        site = &g_memProfSites[index];
+        if (OsStatSlotReady(site)) {
+            allocTotal += LOS_Atomic64Read(&site->allocBytes);
+            liveTotal += LOS_Atomic64Read(&site->liveBytes);
+        }
+    }
+
+    STAT_TABLE_SHOW(seqBuf, "memprof %s, interval %u bytes, sites dropped %d, live dropped %u\n",
+                    g_memProfOn ? "on" : (g_memProfFreeOn ? "off, matching frees" : "off"), g_memProfInterval,
+                    LOS_AtomicRead(&g_memProfSiteTable.dropped), g_memProfLiveDropped);
+    STAT_TABLE_SHOW(seqBuf, "estimated bytes: alloc %lld live %lld\n", allocTotal, liveTotal);
+
+    for (index = 0; index < MEMPROF_SITE_NUM; index++) {
+        site = &g_memProfSites[index];
+        if (!OsStatSlotReady(site) || (LOS_AtomicRead(&site->allocCount) == 0)) {
+            continue;
+        }
+        STAT_TABLE_SHOW(seqBuf, "samples %d alloc %lld live-samples %d live %lld\n",
+                        LOS_AtomicRead(&site->allocCount), LOS_Atomic64Read(&site->allocBytes),
+                        LOS_AtomicRead(&site->liveCount), LOS_Atomic64Read(&site->liveBytes));
+        OsMemProfStackShow(seqBuf, site);
+    }
+}
+
+/* shell 命令和 /proc/memprof 共用的命令解析, 两边接受和拒绝的输入完全一样 */
+UINT32 OsMemProfCmd(INT32 argc, const CHAR **argv)
+{
+    unsigned long interval = 0;
+    CHAR *endPtr = NULL;
+
+    if ((argc >= 1) && (argc <= 2) && (strcmp(argv[0], "on") == 0)) { /* 2: on interval */
+        if (argc == 2) { /* 2: on interval */
+            interval = strtoul(argv[1], &endPtr, 0);
+            if ((endPtr == argv[1]) || (*endPtr != 0) || (interval == 0) || (interval > MEMPROF_INTERVAL_MAX)) {
+                return LOS_NOK;
+            }
+        }
+        LOS_MemProfStart((UINT32)interval);
+    } else if ((argc == 1) && (strcmp(argv[0], "off") == 0)) {
+        LOS_MemProfStop();
+    } else if ((argc == 1) && (strcmp(argv[0], "reset") == 0)) {
+        LOS_MemProfReset();
+    } else {
+        return LOS_NOK;
+    }
+    return LOS_OK;
+}
+
+#ifdef LOSCFG_SHELL
+/*
+ * 命令格式: memprof [on [interval] | off | reset]
+ * 不带参数时打印每个分配调用栈的累计和存活字节, 同样的内容也可以读 /proc/memprof
+ */
+LITE_OS_SEC_TEXT_MINOR UINT32 OsShellCmdMemProf(INT32 argc, const CHAR **argv)
+{
+    if (argc == 0) {
+        OsMemProfDump(NULL);
+        return LOS_OK;
+    }
+
+    if (OsMemProfCmd(argc, argv) != LOS_OK) {
+        PRINTK("\nUsage: memprof [on [interval] | off | reset], interval in [1, %u] bytes\n", MEMPROF_INTERVAL_MAX);
+        return LOS_NOK;
+    }
+    return LOS_OK;
+}
+
+SHELLCMD_ENTRY(memprof_shellcmd, CMD_TYPE_EX, "memprof", XARGS, (CmdCallBackFunc)OsShellCmdMemProf);
+#endif
+
+#endif /* LOSCFG_KERNEL_MEMPROF */
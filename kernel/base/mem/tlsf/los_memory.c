@@ -86,6 +86,7 @@
 #include "los_vm_filemap.h"
 #include "los_task_pri.h"
 #include "los_hook.h"
+#include "los_memprof.h"
 
 #ifdef LOSCFG_KERNEL_LMS
 #include "los_lms_pri.h"
@@ -1129,6 +1130,9 @@ VOID *LOS_MemAlloc(VOID *pool, UINT32 size)
     struct OsMemPoolHead *poolHead = (struct OsMemPoolHead *)pool;
     VOID *ptr = NULL;
     UINT32 intSave;
+#ifdef LOSCFG_KERNEL_MEMPROF
+    UINT32 weight = 0;
+#endif
 
     do {
         if (OS_MEM_NODE_GET_USED_FLAG(size) || OS_MEM_NODE_GET_ALIGNED_FLAG(size)) {
@@ -1136,8 +1140,18 @@ VOID *LOS_MemAlloc(VOID *pool, UINT32 size)
         }
         MEM_LOCK(poolHead, intSave);
         ptr = OsMemAlloc(poolHead, size, intSave);//真正的分配内存函数
+#ifdef LOSCFG_KERNEL_MEMPROF
+        if (MEMPROF_ON() && (ptr != NULL)) {
+            weight = OsMemProfTick(size);//按分配字节采样,还在锁内所以不会被抢占到别的核
+        }
+#endif
         MEM_UNLOCK(poolHead, intSave);
     } while (0);
+#ifdef LOSCFG_KERNEL_MEMPROF
+    if (weight != 0) {
+        OsMemProfRecord(ptr, weight);//记录调用栈要在锁外做
+    }
+#endif
 
     OsHookCall(LOS_HOOK_TYPE_MEM_ALLOC, pool, ptr, size);//打印日志,到此一游
     return ptr;
@@ -1174,10 +1188,18 @@ VOID *LOS_MemAllocAlign(VOID *pool, UINT32 size, UINT32 boundary)
     UINT32 intSave;
     VOID *ptr = NULL;
     VOID *alignedPtr = NULL;
+#ifdef LOSCFG_KERNEL_MEMPROF
+    UINT32 weight = 0;
+#endif
 
     do {
         MEM_LOCK(poolHead, intSave);
         ptr = OsMemAlloc(pool, useSize, intSave);
+#ifdef LOSCFG_KERNEL_MEMPROF
+        if (MEMPROF_ON() && (ptr != NULL)) {
+            weight = OsMemProfTick(size);
+        }
+#endif
         MEM_UNLOCK(poolHead, intSave);
         alignedPtr = (VOID *)OS_MEM_ALIGN(ptr, boundary);
         if (ptr == alignedPtr) {
@@ -1198,6 +1220,11 @@ VOID *LOS_MemAllocAlign(VOID *pool, UINT32 size, UINT32 boundary)
 #endif
         ptr = alignedPtr;
     } while (0);
+#ifdef LOSCFG_KERNEL_MEMPROF
+    if (weight != 0) {
+        OsMemProfRecord(ptr, weight);//记录的是对齐后的地址,和释放时传进来的一致
+    }
+#endif
 
     OsHookCall(LOS_HOOK_TYPE_MEM_ALLOCALIGN, pool, ptr, size, boundary);//打印对齐日志,表示程序曾临幸过此处
     return ptr;
@@ -1366,6 +1393,11 @@ UINT32 LOS_MemFree(VOID *pool, VOID *ptr)
         return LOS_NOK;
     }
     OsHookCall(LOS_HOOK_TYPE_MEM_FREE, pool, ptr);
+#ifdef LOSCFG_KERNEL_MEMPROF
+    if (MEMPROF_FREE_ON()) {
+        OsMemProfFree(ptr);//在真正释放之前摘掉采样记录,避免这块地址被别的核重新分配后误删
+    }
+#endif
 
     UINT32 ret = LOS_NOK;
     struct OsMemPoolHead *poolHead = (struct OsMemPoolHead *)pool;
@@ -1522,6 +1554,10 @@ VOID *LOS_MemRealloc(VOID *pool, VOID *ptr, UINT32 size)
     struct OsMemNodeHead *node = NULL;
     VOID *newPtr = NULL;
     UINT32 intSave;
+#ifdef LOSCFG_KERNEL_MEMPROF
+    VOID *oldPtr = ptr;
+    UINT32 weight = 0;
+#endif
 
     MEM_LOCK(poolHead, intSave);
     do {
@@ -1536,8 +1572,21 @@ VOID *LOS_MemRealloc(VOID *pool, VOID *ptr, UINT32 size)
         }
 
         newPtr = OsMemRealloc(pool, ptr, node, size, intSave);
+#ifdef LOSCFG_KERNEL_MEMPROF
+        if ((newPtr != NULL) && MEMPROF_FREE_ON()) {
+            OsMemProfMove(oldPtr, newPtr);//采样跟着内存块走,原地扩大或缩小时不变;旧地址已经还给内存池,要在锁内做
+        }
+        if ((newPtr != NULL) && MEMPROF_ON()) {
+            weight = OsMemProfTick(size);
+        }
+#endif
     } while (0);
     MEM_UNLOCK(poolHead, intSave);
+#ifdef LOSCFG_KERNEL_MEMPROF
+    if (weight != 0) {
+        OsMemProfRecord(newPtr, weight);
+    }
+#endif
 
     return newPtr;
 }
@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2013-2019 Huawei Technologies Co., Ltd. All rights reserved.
+ * Copyright (c) 2020-2021 Huawei Device Co., Ltd. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of
+ *    conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list
+ *    of conditions and the following disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used
+ *    to endorse or promote products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "los_stat_table_pri.h"
+#include "los_hw_cpu.h"
+#include "los_hwi.h"
+#include "securec.h"
+
+#define STAT_TABLE_HASH_MUL     0x9E3779B1U
+
+STATIC INLINE UINT8 *OsStatSlotAddr(const StatTable *table, UINT32 index)
+{
+    return (UINT8 *)table->slots + (index * table->slotSize);
+}
+
+STATIC INLINE UINT32 OsStatTableHash(const StatTable *table, const VOID *key)
+{
+    const UINT32 *word = (const UINT32 *)key;
+    UINT32 hash = 0;
+    UINT32 index;
+
+    for (index = 0; index < (table->keySize / sizeof(UINT32)); index++) {
+        hash = (hash ^ word[index]) * STAT_TABLE_HASH_MUL;
+    }
+    return hash % table->slotNum;
+}
+
+VOID *OsStatTableGet(StatTable *table, const VOID *key)
+{
+    UINT32 index = OsStatTableHash(table, key);
+    UINT8 *slot = NULL;
+    Atomic *state = NULL;
+    UINT32 intSave;
+    UINT32 probe = 0;
+
+    while (probe < table->slotNum) {
+        slot = OsStatSlotAddr(table, (index + probe) % table->slotNum);
+        state = (Atomic *)slot;
+        if (LOS_AtomicRead(state) == STAT_SLOT_EMPTY) {
+            intSave = LOS_IntLock();
+            if (LOS_AtomicCmpXchg32bits(state, STAT_SLOT_FILLING, STAT_SLOT_EMPTY) == FALSE) {
+                (VOID)memcpy_s(slot + table->keyOffset, table->keySize, key, table->keySize);
+                DMB;
+                LOS_AtomicSet(state, STAT_SLOT_READY);
+                LOS_IntRestore(intSave);
+                return slot;
+            }
+            LOS_IntRestore(intSave);
+        }
+        while (LOS_AtomicRead(state) == STAT_SLOT_FILLING) {
+            /* 别的核正在关中断填或清这个槽, 很快就好 */
+        }
+        DMB;
+        if (LOS_AtomicRead(state) == STAT_SLOT_EMPTY) {
+            continue; /* 刚被清掉, 重新抢这个槽 */
+        }
+        if (memcmp(slot + table->keyOffset, key, table->keySize) == 0) {
+            return slot;
+        }
+        probe++;
+    }
+
+    LOS_AtomicInc(&table->dropped);
+    return NULL;
+}
+
+VOID OsStatTableReset(StatTable *table)
+{
+    UINT32 bodySize = table->slotSize - sizeof(Atomic);
+    UINT8 *slot = NULL;
+    Atomic *state = NULL;
+    UINT32 intSave;
+    UINT32 index;
+
+    for (index = 0; index < table->slotNum; index++) {
+        slot = OsStatSlotAddr(table, index);
+        state = (Atomic *)slot;
+        intSave = LOS_IntLock();
+        while (LOS_AtomicRead(state) != STAT_SLOT_EMPTY) {
+            /* 只清已经填好的槽, 正在填的等它填完 */
+            if (LOS_AtomicCmpXchg32bits(state, STAT_SLOT_FILLING, STAT_SLOT_READY) == FALSE) {
+                (VOID)memset_s(slot + sizeof(Atomic), bodySize, 0, bodySize);
+                DMB;
+                LOS_AtomicSet(state, STAT_SLOT_EMPTY);
+            }
+        }
+        LOS_IntRestore(intSave);
+    }
+    LOS_AtomicSet(&table->dropped, 0);
+    DMB;
+}
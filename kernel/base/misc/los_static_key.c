@@ -0,0 +1,201 @@
+/*
+ * Copyright (c) 2013-2019 Huawei Technologies Co., Ltd. All rights reserved.
+ * Copyright (c) 2020-2021 Huawei Device Co., Ltd. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of
+ *    conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list
+ *    of conditions and the following disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used
+ *    to endorse or promote products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "los_static_key.h"
+#include "los_init.h"
+#include "los_spinlock.h"
+#ifdef LOSCFG_ARCH_STATIC_KEY
+#include "los_arch_mmu.h"
+#include "los_hw.h"
+#include "los_hw_cpu.h"
+#include "los_mmu_descriptor_v6.h"
+#include "los_pte_ops.h"
+#include "los_vm_phys.h"
+#include "los_vm_common.h"
+#include "los_vm_lock.h"
+#include "los_vm_map.h"
+#endif
+
+/*
+ * 文件作用: 静态开关, 分支点的记录和改写见 los_static_key.h
+ * 内核代码段在两个映射里都是只读的, 初始化时在 vmalloc 区映射好一个可写页, 改代码时只把这一页的
+ * 页表项换成代码所在的物理页并失效本核的 TLB, 写完一条指令后清 D-Cache, 全部改完后失效所有核的 I-Cache.
+ * 单条对齐的 nop 和 b 之间的互换是 ARMv7 允许和执行并发的修改, 所以不需要让其他核停下来.
+ */
+
+LITE_OS_SEC_BSS SPIN_LOCK_INIT(g_staticKeySpin);
+STATIC BOOL g_staticKeyReady = FALSE;
+
+#ifdef LOSCFG_ARCH_STATIC_KEY
+#define OS_STATIC_KEY_NOP       0xE320F000U     /* ARM nop */
+#define OS_STATIC_KEY_B         0xEA000000U     /* ARM b, 条件码 AL */
+#define OS_STATIC_KEY_B_MASK    0x00FFFFFFU
+#define OS_STATIC_KEY_PC_AHEAD  8               /* ARM 状态下读到的 pc 是当前指令地址 + 8 */
+
+extern LosStaticKeyEntry __static_key_table_start[];
+extern LosStaticKeyEntry __static_key_table_end[];
+
+STATIC VADDR_T g_staticKeyPokeVa;
+STATIC PTE_T *g_staticKeyPokePte;   /* g_staticKeyPokeVa 的二级页表项 */
+STATIC PTE_T g_staticKeyPokeAttr;   /* 页表项里除物理页号外的属性位 */
+
+STATIC UINT32 OsStaticKeyInsn(const LosStaticKeyEntry *entry, BOOL enable)
+{
+    INT32 offset;
+
+    if (!enable) {
+        return OS_STATIC_KEY_NOP;
+    }
+    offset = (INT32)(entry->target - entry->code) - OS_STATIC_KEY_PC_AHEAD;
+    return OS_STATIC_KEY_B | (((UINT32)offset >> 2) & OS_STATIC_KEY_B_MASK); /* 2: 偏移以字为单位 */
+}
+
+/*
+ * 持有 g_staticKeySpin 并关中断调用, 不会换核. 这一页只有这里访问, 换了页表项后失效本核的 TLB 即可,
+ * 不分配内存也不动页表结构
+ */
+STATIC VOID OsStaticKeyPoke(UINTPTR code, UINT32 insn)
+{
+    PADDR_T paddr = LOS_PaddrQuery((VOID *)code);
+    UINTPTR addr;
+
+    if (paddr == 0) {
+        return;
+    }
+    OsSavePte2(g_staticKeyPokePte, MMU_DESCRIPTOR_L2_SMALL_PAGE_ADDR(paddr) | g_staticKeyPokeAttr);
+    OsArmWriteTlbimva(g_staticKeyPokeVa & MMU_DESCRIPTOR_L2_SMALL_FRAME);
+    DSB;
+    ISB;
+    addr = g_staticKeyPokeVa + (paddr & (PAGE_SIZE - 1));
+    *(volatile UINT32 *)addr = insn;
+    DCacheFlushRange(addr, addr + sizeof(UINT32));
+}
+
+/* 按 key 当前的计数改写它的所有分支点, key 为 NULL 时改写所有已打开的分支点 */
+STATIC VOID OsStaticKeyUpdate(const LosStaticKey *key)
+{
+    LosStaticKeyEntry *entry = NULL;
+    BOOL enable;
+
+    for (entry = __static_key_table_start; entry < __static_key_table_end; entry++) {
+        enable = (entry->key->count != 0);
+        if ((entry->key == key) || ((key == NULL) && enable)) {
+            OsStaticKeyPoke(entry->code, OsStaticKeyInsn(entry, enable));
+        }
+    }
+    DSB;
+    FlushICache();
+    DSB;
+    ISB;
+}
+
+/*
+ * 申请一页 vmalloc 地址并常驻映射成可写, 和 vmalloc 一样在 regionMux 下建立映射.
+ * 之后改代码只改写这一页的页表项, 二级页表不会被释放, 也不会再分配内存, 因此可以在持有自旋锁时进行.
+ */
+STATIC UINT32 OsStaticKeyPokeInit(VOID)
+{
+    LosVmSpace *space = LOS_GetVmallocSpace();
+    LosVmMapRegion *region = NULL;
+    PADDR_T pin = LOS_PaddrQuery((VOID *)OsStaticKeyPokeInit);
+    PTE_T pte1;
+    UINT32 ret = LOS_NOK;
+
+    (VOID)LOS_MuxAcquire(&space->regionMux);
+    region = LOS_RegionAlloc(space, 0, PAGE_SIZE, VM_MAP_REGION_FLAG_PERM_READ | VM_MAP_REGION_FLAG_PERM_WRITE, 0);
+    if ((region != NULL) && (LOS_ArchMmuMap(&space->archMmu, region->range.base, ROUNDDOWN(pin, PAGE_SIZE), 1,
+                                            VM_MAP_REGION_FLAG_PERM_READ | VM_MAP_REGION_FLAG_PERM_WRITE) == 1)) {
+        pte1 = OsGetPte1(space->archMmu.virtTtb, region->range.base);
+        LOS_ASSERT(OsIsPte1PageTable(pte1));
+        g_staticKeyPokeVa = region->range.base;
+        g_staticKeyPokePte = OsGetPte2Ptr((PTE_T *)LOS_PaddrToKVaddr(MMU_DESCRIPTOR_L1_PAGE_TABLE_ADDR(pte1)),
+                                          g_staticKeyPokeVa);
+        g_staticKeyPokeAttr = *g_staticKeyPokePte & ~MMU_DESCRIPTOR_L2_SMALL_FRAME;
+        ret = LOS_OK;
+    }
+    (VOID)LOS_MuxRelease(&space->regionMux);
+    return ret;
+}
+#endif
+
+VOID LOS_StaticKeyInc(LosStaticKey *key)
+{
+    UINT32 intSave;
+
+    LOS_SpinLockSave(&g_staticKeySpin, &intSave);
+    key->count++;
+#ifdef LOSCFG_ARCH_STATIC_KEY
+    if ((key->count == 1) && g_staticKeyReady) {
+        OsStaticKeyUpdate(key);
+    }
+#endif
+    LOS_SpinUnlockRestore(&g_staticKeySpin, intSave);
+}
+
+VOID LOS_StaticKeyDec(LosStaticKey *key)
+{
+    UINT32 intSave;
+
+    LOS_SpinLockSave(&g_staticKeySpin, &intSave);
+    if (key->count == 0) {
+        LOS_SpinUnlockRestore(&g_staticKeySpin, intSave);
+        return;
+    }
+    key->count--;
+#ifdef LOSCFG_ARCH_STATIC_KEY
+    if ((key->count == 0) && g_staticKeyReady) {
+        OsStaticKeyUpdate(key);
+    }
+#endif
+    LOS_SpinUnlockRestore(&g_staticKeySpin, intSave);
+}
+
+/* 初始化前打开的开关在这里统一改写 */
+STATIC UINT32 OsStaticKeyInit(VOID)
+{
+    UINT32 intSave;
+
+#ifdef LOSCFG_ARCH_STATIC_KEY
+    if (OsStaticKeyPokeInit() != LOS_OK) {
+        PRINT_ERR("static key: no poke page, branch sites stay disabled\n");
+        return LOS_NOK;
+    }
+#endif
+    LOS_SpinLockSave(&g_staticKeySpin, &intSave);
+#ifdef LOSCFG_ARCH_STATIC_KEY
+    OsStaticKeyUpdate(NULL);
+#endif
+    g_staticKeyReady = TRUE;
+    LOS_SpinUnlockRestore(&g_staticKeySpin, intSave);
+    return LOS_OK;
+}
+
+LOS_MODULE_INIT(OsStaticKeyInit, LOS_INIT_LEVEL_VM_COMPLETE);
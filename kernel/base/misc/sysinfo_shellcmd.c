@@ -35,6 +35,7 @@
 #include "los_queue_pri.h"
 #include "los_swtmr_pri.h"
 #include "los_task_pri.h"
+#include "los_mux.h"
 
 #ifdef LOSCFG_SHELL
 #include "shcmd.h"
@@ -115,6 +116,19 @@ UINT32 OsShellCmdSwtmrCntGet(VOID)
     LOS_IntRestore(intSave);
     return swtmrCnt;
 }
+#if defined(LOSCFG_BASE_IPC_MUX) && defined(LOSCFG_KERNEL_SMP)
+///自适应互斥锁统计: 自旋拿到锁 vs 挂起等锁
+STATIC VOID OsShellCmdMuxSpinStatGet(VOID)
+{
+    LosMuxSpinStat muxStat;
+
+    if (LOS_MuxSpinStatGet(&muxStat) != LOS_OK) {
+        return;
+    }
+    PRINTK("\n   Mutex spin acquire: %llu, spin failed: %llu, sleep: %llu\n",
+           muxStat.spinAcquire, muxStat.spinFailed, muxStat.sleep);
+}
+#endif
 ///查看系统资源使用情况
 LITE_OS_SEC_TEXT_MINOR VOID OsShellCmdSystemInfoGet(VOID)
 {
@@ -153,6 +167,9 @@ LITE_OS_SEC_TEXT_MINOR VOID OsShellCmdSystemInfoGet(VOID)
            OsShellCmdSwtmrCntGet(),		//定时器的数量
            LOSCFG_BASE_CORE_SWTMR_LIMIT,	//定时器的总数 1024
            SYSINFO_ENABLED(isSwtmrEnable));	//定时器是否失效 YES or NO
+#if defined(LOSCFG_BASE_IPC_MUX) && defined(LOSCFG_KERNEL_SMP)
+    OsShellCmdMuxSpinStatGet();
+#endif
 }
 ///systeminfo命令用于显示当前操作系统内资源使用情况，包括任务、信号量、互斥量、队列、定时器等。
 INT32 OsShellCmdSystemInfo(INT32 argc, const CHAR **argv)
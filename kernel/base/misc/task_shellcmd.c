@@ -593,6 +593,11 @@ LITE_OS_SEC_TEXT_MINOR UINT32 OsShellCmdDumpTask(INT32 argc, const CHAR **argv)
                 return LOS_OK;
             }
             goto TASK_HELP;
+        } else if (strcmp("-l", argv[0]) == 0) {//就绪等待和运行时长直方图, 需要 LOSCFG_SCHED_DEBUG
+            if (!OsShellShowSchedLatency()) {
+                return LOS_OK;
+            }
+            goto TASK_HELP;
         } else {
             goto TASK_HELP;
         }
@@ -138,6 +138,7 @@ STATIC VOID OsLockDepDumpLock(const LosTaskCB *task, const SPIN_LOCK_S *lock,
     OsPrintLockDepInfo("lockdep check failed\n");
     OsPrintLockDepInfo("error type   : %s\n", OsLockDepErrorStringGet(errType));
     OsPrintLockDepInfo("request addr : 0x%x\n", requestAddr);
+    OsPrintLockDepInfo("lock queue   : %u\n", SPINLOCK_TICKETS_OUT(lock->rawLock));
 
     while (1) {
         OsPrintLockDepInfo("task name    : %s\n", temp->taskName);
@@ -146,10 +147,11 @@ STATIC VOID OsLockDepDumpLock(const LosTaskCB *task, const SPIN_LOCK_S *lock,
         OsPrintLockDepInfo("start dumping lockdep infomation\n");
         for (i = 0; i < lockDep->lockDepth; i++) {
             if (lockDep->heldLocks[i].lockPtr == lock) {
-                OsPrintLockDepInfo("[%d] %s <-- addr:0x%x\n", i, LOCKDEP_GET_NAME(lockDep, i),
-                                   LOCKDEP_GET_ADDR(lockDep, i));
+                OsPrintLockDepInfo("[%d] %s queue:%u <-- addr:0x%x\n", i, LOCKDEP_GET_NAME(lockDep, i),
+                                   lockDep->heldLocks[i].waitQueue, LOCKDEP_GET_ADDR(lockDep, i));
             } else {
-                OsPrintLockDepInfo("[%d] %s \n", i, LOCKDEP_GET_NAME(lockDep, i));
+                OsPrintLockDepInfo("[%d] %s queue:%u\n", i, LOCKDEP_GET_NAME(lockDep, i),
+                                   lockDep->heldLocks[i].waitQueue);
             }
         }
         OsPrintLockDepInfo("[%d] %s <-- now\n", i, lock->name);
@@ -234,6 +236,7 @@ OUT:
         lockDep->waitLock = lock;
         lockDep->heldLocks[lockDep->lockDepth].lockAddr = requestAddr;
         lockDep->heldLocks[lockDep->lockDepth].waitTime = OsLockDepGetCycles(); /* start time */
+        lockDep->heldLocks[lockDep->lockDepth].waitQueue = SPINLOCK_TICKETS_OUT(lock->rawLock);
         OsLockDepRelease(intSave);
         return;
     }
@@ -290,7 +293,8 @@ VOID OsLockDepCheckOut(SPIN_LOCK_S *lock)
     OsLockDepRequire(&intSave);
 
     owner = lock->owner;
-    if (owner == SPINLOCK_OWNER_INIT) {
+    /* 排队锁上没有发出去的号说明锁是空闲的, 这时解锁会让 owner 越过 next, 锁就再也拿不到了 */
+    if ((owner == SPINLOCK_OWNER_INIT) || (SPINLOCK_TICKETS_OUT(lock->rawLock) == 0)) {
         checkResult = LOCKDEP_ERR_UNLOCK_WITOUT_LOCK;
         OsLockDepDumpLock(current, lock, requestAddr, checkResult);
         OsLockDepRelease(intSave);
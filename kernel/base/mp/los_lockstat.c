@@ -0,0 +1,321 @@
+/*
+ * Copyright (c) 2013-2019 Huawei Technologies Co., Ltd. All rights reserved.
+ * Copyright (c) 2020-2021 Huawei Device Co., Ltd. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of
+ *    conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list
+ *    of conditions and the following disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used
+ *    to endorse or promote products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "los_lockstat.h"
+#include "los_atomic.h"
+#include "los_bitmap.h"
+#include "los_hw_cpu.h"
+#include "los_printf.h"
+#include "los_seq_buf.h"
+#include "los_sched_pri.h"
+#include "los_stat_table_pri.h"
+#ifdef LOSCFG_SHELL
+#include "shcmd.h"
+#include "shell.h"
+#endif
+
+/*
+ * 文件作用: 锁竞争统计(lock-stat)
+ * 以 (锁类别, 锁类型, 调用点) 为键记录拿锁次数, 竞争次数, 等锁时间和持锁时间的直方图.
+ * 槽位表用 los_stat_table 的开放寻址哈希表, 关中断用 CAS 抢占空槽, 计数都用原子操作,
+ * 整个统计路径不拿任何锁, 所以自旋锁本身也能被统计.
+ */
+#ifdef LOSCFG_KERNEL_LOCKSTAT
+
+#define LOCKSTAT_SLOT_NUM       LOSCFG_KERNEL_LOCKSTAT_SLOTS
+#define LOCKSTAT_HIST_NUM       16U     /* 直方图桶数 */
+#define LOCKSTAT_HIST_BASE      6U      /* 第0个桶是 [0, 64) cycles, 之后每个桶翻倍 */
+
+typedef struct {
+    const VOID  *lockClass;
+    const VOID  *site;
+    UINT32      type;
+} LockStatKey;
+
+typedef struct {
+    Atomic      state;                      /* 必须是第一个成员, 见 los_stat_table_pri.h */
+    LockStatKey key;
+    Atomic      acquire;
+    Atomic      contended;
+    Atomic64    waitTotal;
+    Atomic64    holdTotal;
+    UINT64      waitMax;                    /* best effort, updated without lock */
+    UINT64      holdMax;
+    Atomic      waitHist[LOCKSTAT_HIST_NUM];
+    Atomic      holdHist[LOCKSTAT_HIST_NUM];
+} LockStatSlot;
+
+LosStaticKey g_lockStatKey = LOS_STATIC_KEY_INIT;
+STATIC BOOL g_lockStatOn = FALSE;
+STATIC LockStatSlot g_lockStatSlots[LOCKSTAT_SLOT_NUM];
+STATIC StatTable g_lockStatTable = STAT_TABLE_INIT(g_lockStatSlots, LockStatSlot, key);
+
+STATIC const CHAR *g_lockStatTypeName[LOCKSTAT_TYPE_MAX] = { "spin", "mux", "rw-rd", "rw-wr" };
+
+UINT64 OsLockStatCycles(VOID)
+{
+    return HalClockGetCycles();
+}
+
+STATIC INLINE UINT32 OsLockStatHistIndex(UINT64 cycles)
+{
+    UINT32 index;
+
+    if ((cycles >> 32) != 0) { /* 32: 超过32位的都算进最后一个桶 */
+        return LOCKSTAT_HIST_NUM - 1;
+    }
+    if (cycles < (1U << LOCKSTAT_HIST_BASE)) {
+        return 0;
+    }
+    index = LOS_HighBitGet((UINT32)cycles) - LOCKSTAT_HIST_BASE + 1;
+    return (index < LOCKSTAT_HIST_NUM) ? index : (LOCKSTAT_HIST_NUM - 1);
+}
+
+/* 找到键对应的槽位, 没有就占一个空槽. 表满时返回 NULL */
+STATIC LockStatSlot *OsLockStatSlotGet(const VOID *lockClass, LockStatType type, const VOID *site)
+{
+    LockStatKey key;
+
+    (VOID)memset_s(&key, sizeof(key), 0, sizeof(key)); /* 键按字节比较, 填充字节也要清0 */
+    key.lockClass = lockClass;
+    key.site = site;
+    key.type = (UINT32)type;
+    return (LockStatSlot *)OsStatTableGet(&g_lockStatTable, &key);
+}
+
+VOID OsLockStatAcquired(LockStatHold *hold, const VOID *lockClass, LockStatType type,
+                        const VOID *site, BOOL contended, UINT64 waitStart)
+{
+    UINT64 now = OsLockStatCycles();
+    UINT64 wait = now - waitStart;
+    LockStatSlot *slot = OsLockStatSlotGet(lockClass, type, site);
+
+    if (slot == NULL) {
+        return;
+    }
+
+    LOS_AtomicInc(&slot->acquire);
+    if (contended) {
+        LOS_AtomicInc(&slot->contended);
+    }
+    LOS_Atomic64Add(&slot->waitTotal, (INT64)wait);
+    LOS_AtomicInc(&slot->waitHist[OsLockStatHistIndex(wait)]);
+    if (wait > slot->waitMax) {
+        slot->waitMax = wait;
+    }
+
+    if (hold != NULL) {
+        hold->slot = (UINT32)(slot - g_lockStatSlots) + 1;
+        hold->start = now;
+    }
+}
+
+VOID OsLockStatReleased(LockStatHold *hold)
+{
+    LockStatSlot *slot = NULL;
+    UINT64 held;
+
+    if (hold->slot == 0) {
+        return;
+    }
+
+    slot = &g_lockStatSlots[hold->slot - 1];
+    hold->slot = 0;
+    if (!OsStatSlotReady(slot)) {
+        return; /* 持锁期间表被 reset 了 */
+    }
+    held = OsLockStatCycles() - hold->start;
+    LOS_Atomic64Add(&slot->holdTotal, (INT64)held);
+    LOS_AtomicInc(&slot->holdHist[OsLockStatHistIndex(held)]);
+    if (held > slot->holdMax) {
+        slot->holdMax = held;
+    }
+}
+
+VOID LOS_LockStatStart(VOID)
+{
+    if (g_lockStatOn) {
+        return;
+    }
+    g_lockStatOn = TRUE;
+    LOS_StaticKeyInc(&g_lockStatKey);
+}
+
+VOID LOS_LockStatStop(VOID)
+{
+    if (!g_lockStatOn) {
+        return;
+    }
+    g_lockStatOn = FALSE;
+    LOS_StaticKeyDec(&g_lockStatKey);
+}
+
+/*
+ * 清表前先停止统计, 还在统计路径上的核和清表走同样的槽位状态转换, 不会留下填了一半的槽.
+ * 已经拿到槽位号的持锁记录在解锁时仍可能写回一个刚被重新占用的槽,
+ * 所以 reset 之后短时间内可能看到只有持锁时间没有拿锁次数的槽位, 再 reset 一次即可.
+ */
+VOID LOS_LockStatReset(VOID)
+{
+    LOS_LockStatStop();
+    OsStatTableReset(&g_lockStatTable);
+}
+
+STATIC VOID OsLockStatClassShow(VOID *seqBuf, const LockStatSlot *slot)
+{
+    if (slot->key.type == LOCKSTAT_SPIN) {
+        STAT_TABLE_SHOW(seqBuf, "class %s type %s", (const CHAR *)slot->key.lockClass,
+                        g_lockStatTypeName[slot->key.type]);
+    } else {
+        STAT_TABLE_SHOW(seqBuf, "class %p type %s", slot->key.lockClass, g_lockStatTypeName[slot->key.type]);
+    }
+}
+
+STATIC VOID OsLockStatHistShow(VOID *seqBuf, const CHAR *name, const Atomic *hist)
+{
+    UINT32 index;
+
+    STAT_TABLE_SHOW(seqBuf, "    %s", name);
+    for (index = 0; index < LOCKSTAT_HIST_NUM; index++) {
+        STAT_TABLE_SHOW(seqBuf, " %d", LOS_AtomicRead(&hist[index]));
+    }
+    STAT_TABLE_SHOW(seqBuf, "\n");
+}
+
+STATIC BOOL OsLockStatSameClass(const LockStatSlot *a, const LockStatSlot *b)
+{
+    return (a->key.lockClass == b->key.lockClass) && (a->key.type == b->key.type);
+}
+
+STATIC VOID OsLockStatClassSum(const VOID *lockClass, UINT32 type, UINT32 from, LockStatClassInfo *info)
+{
+    const LockStatSlot *slot = NULL;
+    UINT32 index;
+
+    (VOID)memset_s(info, sizeof(LockStatClassInfo), 0, sizeof(LockStatClassInfo));
+    for (index = from; index < LOCKSTAT_SLOT_NUM; index++) {
+        slot = &g_lockStatSlots[index];
+        if (!OsStatSlotReady(slot) || (slot->key.lockClass != lockClass) || (slot->key.type != type)) {
+            continue;
+        }
+        info->acquire += (UINT32)LOS_AtomicRead(&slot->acquire);
+        info->contended += (UINT32)LOS_AtomicRead(&slot->contended);
+        info->waitTotal += (UINT64)LOS_Atomic64Read(&slot->waitTotal);
+        info->holdTotal += (UINT64)LOS_Atomic64Read(&slot->holdTotal);
+    }
+}
+
+UINT32 LOS_LockStatClassGet(const VOID *lockClass, LockStatType type, LockStatClassInfo *info)
+{
+    if ((info == NULL) || (type >= LOCKSTAT_TYPE_MAX)) {
+        return LOS_NOK;
+    }
+
+    OsLockStatClassSum(lockClass, type, 0, info);
+    return (info->acquire != 0) ? LOS_OK : LOS_NOK;
+}
+
+/* 按锁类别分组输出: 先是类别汇总行, 再是这个类别下每个调用点的计数和直方图 */
+VOID OsLockStatDump(VOID *seqBuf)
+{
+    const LockStatSlot *slot = NULL;
+    const LockStatSlot *site = NULL;
+    LockStatClassInfo info;
+    UINT32 index, inner, first;
+
+    STAT_TABLE_SHOW(seqBuf, "lockstat %s, dropped %d, histogram bucket 0 is [0, %u) cycles and doubles after\n",
+                    g_lockStatOn ? "on" : "off", LOS_AtomicRead(&g_lockStatTable.dropped), 1U << LOCKSTAT_HIST_BASE);
+
+    for (index = 0; index < LOCKSTAT_SLOT_NUM; index++) {
+        slot = &g_lockStatSlots[index];
+        if (!OsStatSlotReady(slot)) {
+            continue;
+        }
+        /* 每个类别只在第一次出现的槽位处输出 */
+        for (first = 0; first < index; first++) {
+            if (OsStatSlotReady(&g_lockStatSlots[first]) &&
+                OsLockStatSameClass(&g_lockStatSlots[first], slot)) {
+                break;
+            }
+        }
+        if (first != index) {
+            continue;
+        }
+
+        OsLockStatClassSum(slot->key.lockClass, slot->key.type, index, &info);
+        OsLockStatClassShow(seqBuf, slot);
+        STAT_TABLE_SHOW(seqBuf, " acquire %u contended %u wait %llu hold %llu\n",
+                        info.acquire, info.contended, info.waitTotal, info.holdTotal);
+
+        for (inner = index; inner < LOCKSTAT_SLOT_NUM; inner++) {
+            site = &g_lockStatSlots[inner];
+            if (!OsStatSlotReady(site) || !OsLockStatSameClass(site, slot)) {
+                continue;
+            }
+            STAT_TABLE_SHOW(seqBuf, "  site %p acquire %d contended %d wait %lld wait-max %llu hold %lld hold-max %llu\n",
+                            site->key.site, LOS_AtomicRead(&site->acquire), LOS_AtomicRead(&site->contended),
+                            LOS_Atomic64Read(&site->waitTotal), site->waitMax,
+                            LOS_Atomic64Read(&site->holdTotal), site->holdMax);
+            OsLockStatHistShow(seqBuf, "wait-hist", site->waitHist);
+            OsLockStatHistShow(seqBuf, "hold-hist", site->holdHist);
+        }
+    }
+}
+
+#ifdef LOSCFG_SHELL
+/*
+ * 命令格式: lockstat [on | off | reset]
+ * 不带参数时按锁类别和调用点打印统计结果, 同样的内容也可以读 /proc/lockstat
+ */
+LITE_OS_SEC_TEXT_MINOR UINT32 OsShellCmdLockStat(INT32 argc, const CHAR **argv)
+{
+    if (argc == 0) {
+        OsLockStatDump(NULL);
+        return LOS_OK;
+    }
+
+    if ((argc == 1) && (strcmp(argv[0], "on") == 0)) {
+        LOS_LockStatStart();
+    } else if ((argc == 1) && (strcmp(argv[0], "off") == 0)) {
+        LOS_LockStatStop();
+    } else if ((argc == 1) && (strcmp(argv[0], "reset") == 0)) {
+        LOS_LockStatReset();
+    } else {
+        PRINTK("\nUsage: lockstat [on | off | reset]\n");
+        return LOS_NOK;
+    }
+    return LOS_OK;
+}
+
+SHELLCMD_ENTRY(lockstat_shellcmd, CMD_TYPE_EX, "lockstat", XARGS, (CmdCallBackFunc)OsShellCmdLockStat);
+#endif
+
+#endif /* LOSCFG_KERNEL_LOCKSTAT */
@@ -68,11 +68,6 @@
 
 #ifdef LOSCFG_KERNEL_SMP
 //给参数CPU发送调度信号
-#ifdef LOSCFG_KERNEL_SMP_CALL
-LITE_OS_SEC_BSS SPIN_LOCK_INIT(g_mpCallSpin);
-#define MP_CALL_LOCK(state)       LOS_SpinLockSave(&g_mpCallSpin, &(state))
-#define MP_CALL_UNLOCK(state)     LOS_SpinUnlockRestore(&g_mpCallSpin, (state))
-#endif
 VOID LOS_MpSchedule(UINT32 target)//target每位对应CPU core 
 {
     UINT32 cpuid = ArchCurrCpuid();
@@ -130,46 +125,143 @@ VOID OsMpCollectTasks(VOID)
 }
 
 #ifdef LOSCFG_KERNEL_SMP_CALL
-/*!
- * @brief OsMpFuncCall	
- * 向指定CPU的funcLink上注册回调函数, 该怎么理解这个函数呢 ? 具体有什么用呢 ?
- * \n 可由CPU a核向b核发起一个请求,让b核去执行某个函数, 这是否是分布式调度的底层实现基础 ?
- * @param args	
- * @param func	
- * @param target	
- * @return	
- *
- * @see
+/**
+ * 预分配的调用槽, 发起方用 CAS 把空闲槽的 pending 从 0 改成目标核数来占用它, 再把槽号对应的位
+ * 置到每个目标核的 g_percpu[].funcCallPending 中. 目标核在 IPI 里取走这些位并执行槽里的回调,
+ * pending 归零后槽位空闲, 所以整个路径不需要分配内存也不需要全局锁.
+ */
+#define MP_CALL_SLOT_NUM    32  /* funcCallPending 的位数 */
+STATIC MpCallSlot g_mpCallSlots[MP_CALL_SLOT_NUM];
+
+/// 取走并执行发给当前CPU的所有回调, 只在 IPI 中断里调用
+STATIC VOID OsMpFuncCallRun(UINT32 cpuid)
+{
+    UINT32 slots = (UINT32)LOS_AtomicXchg32bits(&g_percpu[cpuid].funcCallPending, 0);
+    UINT32 index;
+    MpCallSlot *slot = NULL;
+
+    DMB; /* see the slot contents published before the pending bit */
+    while (slots != 0) {
+        index = CTZ(slots);
+        slots &= slots - 1;
+        slot = &g_mpCallSlots[index];
+        slot->func(slot->args);
+        DMB; /* the function's effects are visible before the slot may be reused */
+        LOS_AtomicDec(&slot->pending);
+    }
+}
+
+/*
+ * 等待期间按调用者原来的中断状态短暂开中断, 发给本核的回调(包括发给自己的)由 IPI 在中断上下文里执行,
+ * 不会在调用者持有的锁里执行. 调用者关着中断时本核的 IPI 进不来, 所以关中断时不能发起同步调用,
+ * 槽位用完时也不等待, 而是直接返回错误.
  */
-VOID OsMpFuncCall(UINT32 target, SMP_FUNC_CALL func, VOID *args)
+STATIC VOID OsMpFuncCallWait(const MpCallSlot *slot, UINT32 intSave)
 {
+    while (LOS_AtomicRead(&slot->pending) != 0) {
+        LOS_IntRestore(intSave);
+        (VOID)LOS_IntLock();
+    }
+    DMB;
+}
+
+/// 占用一个空闲的调用槽, 所有槽都在用时 mayWait 为真就和 OsMpFuncCallWait 一样等待, 否则返回 NULL
+STATIC MpCallSlot *OsMpFuncCallSlotGet(INT32 count, UINT32 intSave, BOOL mayWait)
+{
+    MpCallSlot *slot = NULL;
     UINT32 index;
+
+    while (TRUE) {
+        for (index = 0; index < MP_CALL_SLOT_NUM; index++) {
+            slot = &g_mpCallSlots[index];
+            if ((LOS_AtomicRead(&slot->pending) == 0) &&
+                (LOS_AtomicCmpXchg32bits(&slot->pending, count, 0) == FALSE)) {
+                return slot;
+            }
+        }
+        if (!mayWait) {
+            return NULL;
+        }
+        LOS_IntRestore(intSave);
+        (VOID)LOS_IntLock();
+    }
+}
+
+STATIC UINT32 OsMpFuncCallPost(UINT32 target, SMP_FUNC_CALL func, VOID *args, BOOL sync)
+{
     UINT32 intSave;
+    UINT32 index;
+    UINT32 bit;
+    INT32 old;
+    BOOL mayWait = !OsIntLocked();
+    MpCallSlot *slot = NULL;
 
     if (func == NULL) {
-        return;
+        return LOS_NOK;
     }
 
-    if (!(target & OS_MP_CPU_ALL)) {//检查目标CPU是否正确
-        return;
+    target &= OS_MP_CPU_ALL;
+    if (target == 0) {//检查目标CPU是否正确
+        return LOS_NOK;
     }
 
-    for (index = 0; index < LOSCFG_KERNEL_CORE_NUM; index++) {//遍历所有核
-        if (CPUID_TO_AFFI_MASK(index) & target) {
-            MpCallFunc *mpCallFunc = (MpCallFunc *)LOS_MemAlloc(m_aucSysMem0, sizeof(MpCallFunc));//从内核空间 分配回调结构体
-            if (mpCallFunc == NULL) {
-                PRINT_ERR("smp func call malloc failed\n");
-                return;
-            }
-            mpCallFunc->func = func;
-            mpCallFunc->args = args;
+    if (sync && !mayWait) {
+        PRINT_ERR("smp sync func call with interrupts disabled, not waiting\n");
+        sync = FALSE;
+    }
 
-            MP_CALL_LOCK(intSave);
-            LOS_ListAdd(&g_percpu[index].funcLink, &(mpCallFunc->node));//将回调结构体挂入链表尾部
-            MP_CALL_UNLOCK(intSave);
+    intSave = LOS_IntLock();
+    slot = OsMpFuncCallSlotGet((INT32)__builtin_popcount(target), intSave, mayWait);
+    if (slot == NULL) {
+        /* 关中断时占着槽位的调用可能正等本核开中断, 在这里等会死锁 */
+        LOS_IntRestore(intSave);
+        PRINT_ERR("smp func call slots exhausted with interrupts disabled\n");
+        return LOS_NOK;
+    }
+    slot->func = func;
+    slot->args = args;
+    bit = 1U << (UINT32)(slot - g_mpCallSlots);
+    DMB; /* publish the slot before any target can see its pending bit */
+
+    for (index = 0; index < LOSCFG_KERNEL_CORE_NUM; index++) {
+        if (!(CPUID_TO_AFFI_MASK(index) & target)) {
+            continue;
         }
+        do {
+            old = LOS_AtomicRead(&g_percpu[index].funcCallPending);
+        } while (LOS_AtomicCmpXchg32bits(&g_percpu[index].funcCallPending, old | (INT32)bit, old));
     }
-    HalIrqSendIpi(target, LOS_MP_IPI_FUNC_CALL);//向目标CPU发起核间中断
+    DSB; /* the gic sgi register write must not overtake the pending bits */
+    /* 本核也在目标内时同样发 IPI 给自己, 回调在开中断后执行, 不在调用者的锁里执行 */
+    HalIrqSendIpi(target, LOS_MP_IPI_FUNC_CALL);
+
+    if (sync) {
+        OsMpFuncCallWait(slot, intSave);
+    }
+    LOS_IntRestore(intSave);
+    return LOS_OK;
+}
+
+/*!
+ * @brief OsMpFuncCall	
+ * 让目标CPU执行回调函数, 可由CPU a核向b核发起一个请求,让b核去执行某个函数.
+ * 不等待目标核执行完, 本核也是目标时同样在 IPI 里执行, 不会在调用者持有的锁里执行
+ * @param args	
+ * @param func	
+ * @param target	
+ * @return	LOS_OK 已发出; LOS_NOK 参数错误, 或关中断时调用槽已用完
+ *
+ * @see
+ */
+UINT32 OsMpFuncCall(UINT32 target, SMP_FUNC_CALL func, VOID *args)
+{
+    return OsMpFuncCallPost(target, func, args, FALSE);
+}
+
+/// 让目标CPU执行回调函数, 所有目标核都执行完后才返回, 必须在开中断时调用
+UINT32 OsMpFuncCallSync(UINT32 target, SMP_FUNC_CALL func, VOID *args)
+{
+    return OsMpFuncCallPost(target, func, args, TRUE);
 }
 
 /*!
@@ -181,33 +273,7 @@ VOID OsMpFuncCall(UINT32 target, SMP_FUNC_CALL func, VOID *args)
  */
 VOID OsMpFuncCallHandler(VOID)
 {
-    UINT32 intSave;
-    UINT32 cpuid = ArchCurrCpuid();//获取当前CPU
-    LOS_DL_LIST *list = NULL;
-    MpCallFunc *mpCallFunc = NULL;
-
-    MP_CALL_LOCK(intSave);
-    while (!LOS_ListEmpty(&g_percpu[cpuid].funcLink)) {//遍历回调函数链表,知道为空
-        list = LOS_DL_LIST_FIRST(&g_percpu[cpuid].funcLink);//获取链表第一个数据
-        LOS_ListDelete(list);//将自己从链表上摘除
-        MP_CALL_UNLOCK(intSave);
-
-        mpCallFunc = LOS_DL_LIST_ENTRY(list, MpCallFunc, node);//获取回调函数
-        mpCallFunc->func(mpCallFunc->args);//获取参数并回调该函数
-        (VOID)LOS_MemFree(m_aucSysMem0, mpCallFunc);//释放回调函数内存
-
-        MP_CALL_LOCK(intSave);
-    }
-    MP_CALL_UNLOCK(intSave);
-}
-/// CPU层级的回调模块初始化
-VOID OsMpFuncCallInit(VOID)
-{
-    UINT32 index;
-    /* init funclink for each core | 为每个CPU核整一个回调函数链表*/
-    for (index = 0; index < LOSCFG_KERNEL_CORE_NUM; index++) {
-        LOS_ListInit(&g_percpu[index].funcLink);//链表初始化
-    }
+    OsMpFuncCallRun(ArchCurrCpuid());
 }
 #endif /* LOSCFG_KERNEL_SMP_CALL */
 //MP(multiprocessing) 多核处理器初始化
@@ -218,9 +284,6 @@ UINT32 OsMpInit(VOID)
     (VOID)LOS_SwtmrCreate(OS_MP_GC_PERIOD, LOS_SWTMR_MODE_PERIOD, //创建一个周期性,持续时间为 100个tick的定时器
                           (SWTMR_PROC_FUNC)OsMpCollectTasks, &swtmrId, 0);//OsMpCollectTasks为超时回调函数
     (VOID)LOS_SwtmrStart(swtmrId);//开始定时任务
-#ifdef LOSCFG_KERNEL_SMP_CALL
-    OsMpFuncCallInit();
-#endif
     return LOS_OK;
 }
 
@@ -33,18 +33,40 @@
 #ifdef LOSCFG_KERNEL_SMP
 #include "los_sched_pri.h"
 
+/* 加锁. 打开了 lock-stat 时顺带记录等锁时间和调用点 */
+STATIC INLINE VOID OsSpinLockAcquire(SPIN_LOCK_S *lock, const VOID *site)
+{
+#ifdef LOSCFG_KERNEL_LOCKSTAT
+    UINT64 start;
+    BOOL contended;
+
+    if (LOCKSTAT_ON()) {
+        start = OsLockStatCycles();
+        contended = (SPINLOCK_TICKETS_OUT(lock->rawLock) != 0);
+        ArchSpinLock(&lock->rawLock);
+        OsLockStatAcquired(&lock->statHold, lock->name, LOCKSTAT_SPIN, site, contended, start);
+        return;
+    }
+#else
+    (VOID)site;
+#endif
+    ArchSpinLock(&lock->rawLock);
+}
 
-VOID LOS_SpinInit(SPIN_LOCK_S *lock)
+VOID OsSpinInit(SPIN_LOCK_S *lock, const CHAR *name)
 {
     lock->rawLock = 0;
     lock->cpuid   = (UINT32)-1;
     lock->owner   = SPINLOCK_OWNER_INIT;
-    lock->name    = "spinlock";
+    lock->name    = name;
+#ifdef LOSCFG_KERNEL_LOCKSTAT
+    lock->statHold.slot = 0;
+#endif
 }
 
 BOOL LOS_SpinHeld(const SPIN_LOCK_S *lock)
 {
-    return (lock->rawLock != 0);
+    return (SPINLOCK_TICKETS_OUT(lock->rawLock) != 0);
 }
 
 VOID LOS_SpinLock(SPIN_LOCK_S *lock)
@@ -54,7 +76,7 @@ VOID LOS_SpinLock(SPIN_LOCK_S *lock)
     LOS_IntRestore(intSave);
 
     LOCKDEP_CHECK_IN(lock);
-    ArchSpinLock(&lock->rawLock);
+    OsSpinLockAcquire(lock, LOCKSTAT_SITE());
     LOCKDEP_RECORD(lock);
 }
 
@@ -67,6 +89,12 @@ INT32 LOS_SpinTrylock(SPIN_LOCK_S *lock)
 
     INT32 ret = ArchSpinTrylock(&lock->rawLock);
     if (ret == LOS_OK) {
+#ifdef LOSCFG_KERNEL_LOCKSTAT
+        if (LOCKSTAT_ON()) {
+            OsLockStatAcquired(&lock->statHold, lock->name, LOCKSTAT_SPIN, LOCKSTAT_SITE(),
+                               FALSE, OsLockStatCycles());
+        }
+#endif
         LOCKDEP_CHECK_IN(lock);
         LOCKDEP_RECORD(lock);
     } else {
@@ -79,7 +107,7 @@ INT32 LOS_SpinTrylock(SPIN_LOCK_S *lock)
 VOID LOS_SpinUnlock(SPIN_LOCK_S *lock)
 {
     LOCKDEP_CHECK_OUT(lock);
-    ArchSpinUnlock(&lock->rawLock);
+    OsSpinLockRelease(lock);
 
     OsCpuSchedUnlock(OsPercpuGet(), LOS_IntLock());
 }
@@ -90,14 +118,14 @@ VOID LOS_SpinLockSave(SPIN_LOCK_S *lock, UINT32 *intSave)
     OsCpuSchedLock(OsPercpuGet());
 
     LOCKDEP_CHECK_IN(lock);
-    ArchSpinLock(&lock->rawLock);
+    OsSpinLockAcquire(lock, LOCKSTAT_SITE());
     LOCKDEP_RECORD(lock);
 }
 
 VOID LOS_SpinUnlockRestore(SPIN_LOCK_S *lock, UINT32 intSave)
 {
     LOCKDEP_CHECK_OUT(lock);
-    ArchSpinUnlock(&lock->rawLock);
+    OsSpinLockRelease(lock);
 
     OsCpuSchedUnlock(OsPercpuGet(), intSave);
 }
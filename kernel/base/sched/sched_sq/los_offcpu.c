@@ -0,0 +1,272 @@
+/*
+ * Copyright (c) 2013-2019 Huawei Technologies Co., Ltd. All rights reserved.
+ * Copyright (c) 2020-2021 Huawei Device Co., Ltd. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of
+ *    conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list
+ *    of conditions and the following disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used
+ *    to endorse or promote products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "los_offcpu.h"
+#include "los_atomic.h"
+#include "los_bitmap.h"
+#include "los_exc.h"
+#include "los_hw_cpu.h"
+#include "los_printf.h"
+#include "los_process_pri.h"
+#include "los_seq_buf.h"
+#include "los_stat_table_pri.h"
+#include "los_sys_pri.h"
+#ifdef LOSCFG_SHELL
+#include "shcmd.h"
+#include "shell.h"
+#endif
+
+/*
+ * 文件作用: off-CPU 剖析
+ * 任务阻塞时记下 (进程, 阻塞原因, 等待对象, 用户态 pc, 内核调用栈), 以此为键在槽位表里累计
+ * 阻塞时长(阻塞 -> 唤醒)和唤醒延迟(唤醒 -> 真正上 CPU)的次数, 总和, 最大值和直方图.
+ * 槽位表和 lock-stat 共用 los_stat_table 的开放寻址哈希表, 计数用原子操作.
+ * 结果按折叠栈格式输出, 可以直接生成火焰图.
+ */
+#ifdef LOSCFG_KERNEL_OFFCPU
+
+#define OFFCPU_SLOT_NUM         LOSCFG_KERNEL_OFFCPU_SLOTS
+#define OFFCPU_HIST_NUM         24U     /* 直方图桶数, 第0个桶是 [0, 1) us, 之后每个桶翻倍, 最后一个桶是 4 秒以上 */
+#define OFFCPU_STACK_SKIP       3U      /* 跳过 OsOffCpuBlock, OsSchedTaskSwitch, OsSchedResched 这三层 */
+
+typedef struct {
+    UINT32      processID;
+    UINT32      type;
+    const VOID  *obj;
+    UINTPTR     userPc;
+    UINTPTR     ip[OFFCPU_STACK_DEPTH]; /* 内层在前, 没用满的填 0 */
+} OffCpuKey;
+
+typedef struct {
+    Atomic      state;                  /* 必须是第一个成员, 见 los_stat_table_pri.h */
+    OffCpuKey   key;
+    Atomic      count;
+    Atomic64    blockTotal;             /* us */
+    Atomic64    wakeTotal;
+    UINT64      blockMax;               /* best effort, updated without lock */
+    UINT64      wakeMax;
+    Atomic      blockHist[OFFCPU_HIST_NUM];
+    Atomic      wakeHist[OFFCPU_HIST_NUM];
+} OffCpuSlot;
+
+BOOL g_offCpuOn = FALSE;
+STATIC UINT32 g_offCpuCyclePerUs = 1;
+STATIC OffCpuSlot g_offCpuSlots[OFFCPU_SLOT_NUM];
+STATIC StatTable g_offCpuTable = STAT_TABLE_INIT(g_offCpuSlots, OffCpuSlot, key);
+
+STATIC const CHAR *g_offCpuTypeName[OFFCPU_TYPE_MAX] = { "mux", "event", "pend", "delay", "suspend" };
+
+STATIC INLINE UINT32 OsOffCpuHistIndex(UINT64 us)
+{
+    UINT32 index;
+
+    if ((us >> 32) != 0) { /* 32: 超过32位的都算进最后一个桶 */
+        return OFFCPU_HIST_NUM - 1;
+    }
+    if (us == 0) {
+        return 0;
+    }
+    index = LOS_HighBitGet((UINT32)us) + 1;
+    return (index < OFFCPU_HIST_NUM) ? index : (OFFCPU_HIST_NUM - 1);
+}
+
+VOID OsOffCpuBlock(OffCpuRecord *record, UINT32 processID, OffCpuType type,
+                   const VOID *obj, UINTPTR userPc, UINT64 now)
+{
+    OffCpuKey key;
+    OffCpuSlot *slot = NULL;
+
+    (VOID)memset_s(&key, sizeof(OffCpuKey), 0, sizeof(OffCpuKey));
+    key.processID = processID;
+    key.type = (UINT32)type;
+    key.obj = obj;
+    key.userPc = userPc;
+    LOS_RecordLR(key.ip, OFFCPU_STACK_DEPTH, OFFCPU_STACK_DEPTH, OFFCPU_STACK_SKIP);
+
+    slot = (OffCpuSlot *)OsStatTableGet(&g_offCpuTable, &key);
+    if (slot == NULL) {
+        record->slot = 0;
+        return;
+    }
+
+    record->slot = (UINT32)(slot - g_offCpuSlots) + 1;
+    record->blockTime = now;
+    record->wakeTime = 0;
+}
+
+VOID OsOffCpuRun(OffCpuRecord *record, UINT64 now)
+{
+    OffCpuSlot *slot = NULL;
+    UINT64 block, wake;
+
+    if (record->slot == 0) {
+        return;
+    }
+
+    slot = &g_offCpuSlots[record->slot - 1];
+    record->slot = 0;
+    if ((record->wakeTime == 0) || !OsStatSlotReady(slot)) {
+        return; /* 中途 reset 过 */
+    }
+
+    block = (record->wakeTime - record->blockTime) / g_offCpuCyclePerUs;
+    wake = (now - record->wakeTime) / g_offCpuCyclePerUs;
+
+    LOS_AtomicInc(&slot->count);
+    LOS_Atomic64Add(&slot->blockTotal, (INT64)block);
+    LOS_Atomic64Add(&slot->wakeTotal, (INT64)wake);
+    LOS_AtomicInc(&slot->blockHist[OsOffCpuHistIndex(block)]);
+    LOS_AtomicInc(&slot->wakeHist[OsOffCpuHistIndex(wake)]);
+    if (block > slot->blockMax) {
+        slot->blockMax = block;
+    }
+    if (wake > slot->wakeMax) {
+        slot->wakeMax = wake;
+    }
+}
+
+VOID LOS_OffCpuStart(VOID)
+{
+    UINT32 cyclePerUs = OS_SYS_CLOCK / OS_SYS_US_PER_SECOND;
+
+    g_offCpuCyclePerUs = (cyclePerUs != 0) ? cyclePerUs : 1;
+    g_offCpuOn = TRUE;
+    DMB;
+}
+
+VOID LOS_OffCpuStop(VOID)
+{
+    g_offCpuOn = FALSE;
+    DMB;
+}
+
+/*
+ * 清表前先停止统计, 其他核上还在填的槽位等它填完再清.
+ * 已经阻塞的任务手里还拿着槽位号, 上 CPU 时发现槽位已空就直接丢弃,
+ * 但如果槽位在这期间又被别的栈占了, 这一次会记到别的栈上, 再 reset 一次即可.
+ */
+VOID LOS_OffCpuReset(VOID)
+{
+    LOS_OffCpuStop();
+    OsStatTableReset(&g_offCpuTable);
+}
+
+STATIC VOID OsOffCpuHistShow(VOID *seqBuf, const CHAR *name, const Atomic *hist)
+{
+    UINT32 index;
+
+    STAT_TABLE_SHOW(seqBuf, "    %s", name);
+    for (index = 0; index < OFFCPU_HIST_NUM; index++) {
+        STAT_TABLE_SHOW(seqBuf, " %d", LOS_AtomicRead(&hist[index]));
+    }
+    STAT_TABLE_SHOW(seqBuf, "\n");
+}
+
+/* 折叠栈: 进程;用户态pc;内核栈(外层在前);阻塞原因:对象, 各层之间用 ';' 分隔 */
+STATIC VOID OsOffCpuStackShow(VOID *seqBuf, const OffCpuKey *key)
+{
+    LosProcessCB *processCB = NULL;
+    INT32 index;
+
+    STAT_TABLE_SHOW(seqBuf, "    stack ");
+    if (!OS_PID_CHECK_INVALID(key->processID)) {
+        processCB = OS_PCB_FROM_PID(key->processID);
+    }
+    /* 进程可能已经退出, 名字只是输出时的快照 */
+    if ((processCB != NULL) && !OsProcessIsUnused(processCB)) {
+        STAT_TABLE_SHOW(seqBuf, "%s-%u", processCB->processName, key->processID);
+    } else {
+        STAT_TABLE_SHOW(seqBuf, "pid-%u", key->processID);
+    }
+
+    if (key->userPc != 0) {
+        STAT_TABLE_SHOW(seqBuf, ";0x%x", key->userPc);
+    }
+    for (index = OFFCPU_STACK_DEPTH - 1; index >= 0; index--) {
+        if (key->ip[index] != 0) {
+            STAT_TABLE_SHOW(seqBuf, ";0x%x", key->ip[index]);
+        }
+    }
+    STAT_TABLE_SHOW(seqBuf, ";%s:%p\n", g_offCpuTypeName[key->type], key->obj);
+}
+
+VOID OsOffCpuDump(VOID *seqBuf)
+{
+    const OffCpuSlot *slot = NULL;
+    UINT32 index;
+
+    STAT_TABLE_SHOW(seqBuf, "offcpu %s, dropped %d, times in us, histogram bucket 0 is [0, 1) us and doubles after\n",
+                    g_offCpuOn ? "on" : "off", LOS_AtomicRead(&g_offCpuTable.dropped));
+
+    for (index = 0; index < OFFCPU_SLOT_NUM; index++) {
+        slot = &g_offCpuSlots[index];
+        if (!OsStatSlotReady(slot) || (LOS_AtomicRead(&slot->count) == 0)) {
+            continue;
+        }
+        STAT_TABLE_SHOW(seqBuf, "pid %u type %s obj %p count %d block %lld block-max %llu wake %lld wake-max %llu\n",
+                        slot->key.processID, g_offCpuTypeName[slot->key.type], slot->key.obj,
+                        LOS_AtomicRead(&slot->count), LOS_Atomic64Read(&slot->blockTotal), slot->blockMax,
+                        LOS_Atomic64Read(&slot->wakeTotal), slot->wakeMax);
+        OsOffCpuHistShow(seqBuf, "block-hist", slot->blockHist);
+        OsOffCpuHistShow(seqBuf, "wake-hist", slot->wakeHist);
+        OsOffCpuStackShow(seqBuf, &slot->key);
+    }
+}
+
+#ifdef LOSCFG_SHELL
+/*
+ * 命令格式: offcpu [on | off | reset]
+ * 不带参数时打印每个调用栈的统计结果, 同样的内容也可以读 /proc/offcpu
+ */
+LITE_OS_SEC_TEXT_MINOR UINT32 OsShellCmdOffCpu(INT32 argc, const CHAR **argv)
+{
+    if (argc == 0) {
+        OsOffCpuDump(NULL);
+        return LOS_OK;
+    }
+
+    if ((argc == 1) && (strcmp(argv[0], "on") == 0)) {
+        LOS_OffCpuStart();
+    } else if ((argc == 1) && (strcmp(argv[0], "off") == 0)) {
+        LOS_OffCpuStop();
+    } else if ((argc == 1) && (strcmp(argv[0], "reset") == 0)) {
+        LOS_OffCpuReset();
+    } else {
+        PRINTK("\nUsage: offcpu [on | off | reset]\n");
+        return LOS_NOK;
+    }
+    return LOS_OK;
+}
+
+SHELLCMD_ENTRY(offcpu_shellcmd, CMD_TYPE_EX, "offcpu", XARGS, (CmdCallBackFunc)OsShellCmdOffCpu);
+#endif
+
+#endif /* LOSCFG_KERNEL_OFFCPU */
@@ -46,6 +46,9 @@
 #include "los_mp.h"
 #ifdef LOSCFG_SCHED_DEBUG
 #include "los_stat_pri.h"
+#include "los_bitmap.h"
+#include "los_seq_buf.h"
+#include "los_stat_table_pri.h"
 #endif
 #include "los_pm_pri.h"
 
@@ -230,12 +233,175 @@ UINT32 OsShellShowSchedParam(VOID)
     return LOS_OK;
 }
 
+/* 每个 CPU 上按任务优先级统计的调度延迟, 持有调度锁时由本 CPU 更新, 不需要原子操作 */
+typedef struct {
+    UINT32 waitSchedHist[OS_PRIORITY_QUEUE_NUM][SCHED_HIST_NUM];
+    UINT32 runHist[OS_PRIORITY_QUEUE_NUM][SCHED_HIST_NUM];
+    UINT32 switchCount[OS_PRIORITY_QUEUE_NUM];
+    UINT32 preemptCount[OS_PRIORITY_QUEUE_NUM];
+} __attribute__((aligned(64))) SchedLatPercpu;
+
+STATIC SchedLatPercpu g_schedLatPercpu[LOSCFG_KERNEL_CORE_NUM];
+
+STATIC INLINE UINT32 OsSchedHistIndex(UINT64 cycles)
+{
+    UINT64 us = (cycles * OS_NS_PER_CYCLE) / OS_SYS_NS_PER_US;
+    UINT32 index;
+
+    if ((us >> 32) != 0) { /* 32: 超过32位的都算进最后一个桶 */
+        return SCHED_HIST_NUM - 1;
+    }
+    if (us == 0) {
+        return 0;
+    }
+    index = LOS_HighBitGet((UINT32)us) + 1;
+    return (index < SCHED_HIST_NUM) ? index : (SCHED_HIST_NUM - 1);
+}
+
+/*
+ * 在任务切换时记录: 老任务这次上 CPU 用了多久, 是否还就绪(被抢占), 新任务在就绪队列里等了多久.
+ * 空闲任务不计入直方图.
+ */
+STATIC VOID OsSchedLatencyRecord(LosTaskCB *runTask, LosTaskCB *newTask, UINT64 waitTime)
+{
+    SchedLatPercpu *lat = &g_schedLatPercpu[ArchCurrCpuid()];
+    UINT32 index;
+
+    if (runTask->policy != LOS_SCHED_IDLE) {
+        index = OsSchedHistIndex(runTask->schedStat.allRuntime - runTask->schedStat.dispatchRuntime);
+        runTask->schedStat.runHist[index]++;
+        lat->runHist[runTask->priority][index]++;
+        lat->switchCount[runTask->priority]++;
+        if ((runTask->taskStatus & OS_TASK_STATUS_READY) && !runTask->schedStat.yielded) {
+            runTask->schedStat.preemptCount++;
+            lat->preemptCount[runTask->priority]++;
+        }
+    }
+    runTask->schedStat.yielded = FALSE;
+
+    if (newTask->policy != LOS_SCHED_IDLE) {
+        index = OsSchedHistIndex(waitTime);
+        newTask->schedStat.waitSchedHist[index]++;
+        lat->waitSchedHist[newTask->priority][index]++;
+    }
+    newTask->schedStat.dispatchRuntime = newTask->schedStat.allRuntime;
+}
+
+STATIC VOID OsSchedHistShow(VOID *seqBuf, const CHAR *name, const UINT32 *hist)
+{
+    UINT32 index;
+
+    STAT_TABLE_SHOW(seqBuf, "    %-10s", name);
+    for (index = 0; index < SCHED_HIST_NUM; index++) {
+        STAT_TABLE_SHOW(seqBuf, " %u", hist[index]);
+    }
+    STAT_TABLE_SHOW(seqBuf, "\n");
+}
+
+STATIC VOID OsSchedLatencyPriShow(VOID *seqBuf, const SchedLatPercpu *lat)
+{
+    SchedLatPercpu sum;
+    UINT32 cpu, pri, index;
+
+    (VOID)memset_s(&sum, sizeof(SchedLatPercpu), 0, sizeof(SchedLatPercpu));
+    for (cpu = 0; cpu < LOSCFG_KERNEL_CORE_NUM; cpu++) {
+        for (pri = 0; pri < OS_PRIORITY_QUEUE_NUM; pri++) {
+            sum.switchCount[pri] += lat[cpu].switchCount[pri];
+            sum.preemptCount[pri] += lat[cpu].preemptCount[pri];
+            for (index = 0; index < SCHED_HIST_NUM; index++) {
+                sum.waitSchedHist[pri][index] += lat[cpu].waitSchedHist[pri][index];
+                sum.runHist[pri][index] += lat[cpu].runHist[pri][index];
+            }
+        }
+    }
+
+    STAT_TABLE_SHOW(seqBuf, "\n  Pri      Switch     Preempt\n");
+    for (pri = 0; pri < OS_PRIORITY_QUEUE_NUM; pri++) {
+        if (sum.switchCount[pri] == 0) {
+            continue;
+        }
+        STAT_TABLE_SHOW(seqBuf, "%5u%12u%12u\n", pri, sum.switchCount[pri], sum.preemptCount[pri]);
+        OsSchedHistShow(seqBuf, "ready-wait", sum.waitSchedHist[pri]);
+        OsSchedHistShow(seqBuf, "run", sum.runHist[pri]);
+    }
+}
+
+/*
+ * 按任务和按优先级输出就绪等待时间(唤醒/被抢占后进入就绪队列到真正运行)和每次运行时长的直方图,
+ * 以及被抢占次数(切走时仍是就绪状态, 主动 yield 的不算). 数据先在调度锁内拷出来再打印.
+ */
+UINT32 OsSchedLatencyShow(VOID *seqBuf)
+{
+    UINT32 intSave;
+    UINT32 taskSize = g_taskMaxNum * sizeof(LosTaskCB);
+    UINT32 latSize = sizeof(g_schedLatPercpu);
+    LosTaskCB *taskCBArray = LOS_MemAlloc(m_aucSysMem1, taskSize);
+    SchedLatPercpu *lat = LOS_MemAlloc(m_aucSysMem1, latSize);
+    if ((taskCBArray == NULL) || (lat == NULL)) {
+        (VOID)LOS_MemFree(m_aucSysMem1, taskCBArray);
+        (VOID)LOS_MemFree(m_aucSysMem1, lat);
+        return LOS_NOK;
+    }
+
+    SCHEDULER_LOCK(intSave);
+    (VOID)memcpy_s(taskCBArray, taskSize, g_taskCBArray, taskSize);
+    (VOID)memcpy_s(lat, latSize, g_schedLatPercpu, latSize);
+    SCHEDULER_UNLOCK(intSave);
+
+    STAT_TABLE_SHOW(seqBuf, "histogram bucket 0 is [0, 1) us and doubles after, %u buckets\n", SCHED_HIST_NUM);
+    STAT_TABLE_SHOW(seqBuf, "  Tid      Switch     Preempt  TaskName\n");
+    for (UINT32 tid = 0; tid < g_taskMaxNum; tid++) {
+        LosTaskCB *taskCB = taskCBArray + tid;
+        if (OsTaskIsUnused(taskCB) || (taskCB->policy == LOS_SCHED_IDLE)) {
+            continue;
+        }
+
+        STAT_TABLE_SHOW(seqBuf, "%5u%12llu%12llu  %-32s\n", taskCB->taskID, taskCB->schedStat.switchCount,
+                        taskCB->schedStat.preemptCount, taskCB->taskName);
+        OsSchedHistShow(seqBuf, "ready-wait", taskCB->schedStat.waitSchedHist);
+        OsSchedHistShow(seqBuf, "run", taskCB->schedStat.runHist);
+    }
+    OsSchedLatencyPriShow(seqBuf, lat);
+
+    (VOID)LOS_MemFree(m_aucSysMem1, lat);
+    (VOID)LOS_MemFree(m_aucSysMem1, taskCBArray);
+    return LOS_OK;
+}
+
+VOID OsSchedLatencyReset(VOID)
+{
+    UINT32 intSave;
+    LosTaskCB *taskCB = NULL;
+
+    SCHEDULER_LOCK(intSave);
+    (VOID)memset_s(g_schedLatPercpu, sizeof(g_schedLatPercpu), 0, sizeof(g_schedLatPercpu));
+    for (UINT32 tid = 0; tid < g_taskMaxNum; tid++) {
+        taskCB = OS_TCB_FROM_TID(tid);
+        taskCB->schedStat.preemptCount = 0;
+        (VOID)memset_s(taskCB->schedStat.waitSchedHist, sizeof(taskCB->schedStat.waitSchedHist), 0,
+                       sizeof(taskCB->schedStat.waitSchedHist));
+        (VOID)memset_s(taskCB->schedStat.runHist, sizeof(taskCB->schedStat.runHist), 0,
+                       sizeof(taskCB->schedStat.runHist));
+    }
+    SCHEDULER_UNLOCK(intSave);
+}
+
+UINT32 OsShellShowSchedLatency(VOID)
+{
+    return OsSchedLatencyShow(NULL);
+}
+
 #else
 
 UINT32 OsShellShowSchedParam(VOID)
 {
     return LOS_NOK;
 }
+
+UINT32 OsShellShowSchedLatency(VOID)
+{
+    return LOS_NOK;
+}
 #endif
 ///< 设置节拍器类型
 UINT32 OsSchedSetTickTimerType(UINT32 timerType)
@@ -639,6 +805,9 @@ VOID OsSchedTaskEnQueue(LosTaskCB *taskCB)
     if (!(taskCB->taskStatus & OS_TASK_STATUS_RUNNING)) {
         taskCB->startTime = OsGetCurrSchedTimeCycle();
     }
+#endif
+#ifdef LOSCFG_KERNEL_OFFCPU
+    OsOffCpuWake(&taskCB->offCpu, OsGetCurrSchedTimeCycle());//阻塞的任务被唤醒
 #endif
     OsSchedEnTaskQueue(taskCB, processCB);
 }
@@ -666,10 +835,16 @@ VOID OsSchedYield(VOID)
     LosTaskCB *runTask = OsCurrTaskGet();
 
     runTask->timeSlice = 0;//时间片变成0,代表主动让出运行时间.
+#ifdef LOSCFG_SCHED_DEBUG
+    runTask->schedStat.yielded = TRUE;//主动让出的不算被抢占
+#endif
 
     runTask->startTime = OsGetCurrSchedTimeCycle();//重新获取开始时间
     OsSchedTaskEnQueue(runTask);//跑队列尾部排队
     OsSchedResched();//发起调度
+#ifdef LOSCFG_SCHED_DEBUG
+    runTask->schedStat.yielded = FALSE;//没有切走时也要清掉
+#endif
 }
 ///延期调度
 VOID OsSchedDelay(LosTaskCB *runTask, UINT32 tick)
@@ -1024,7 +1199,7 @@ VOID OsSchedToUserReleaseLock(VOID)
 {
     /* The scheduling lock needs to be released before returning to user mode */
     LOCKDEP_CHECK_OUT(&g_taskSpin);
-    ArchSpinUnlock(&g_taskSpin.rawLock);
+    OsSpinLockRelease(&g_taskSpin);
 
     OsPercpuGet()->taskLockCnt--;
 }
@@ -1045,6 +1220,63 @@ STATIC VOID OsTaskStackCheck(LosTaskCB *runTask, LosTaskCB *newTask)
 }
 #endif
 
+#ifdef LOSCFG_KERNEL_OFFCPU
+/* 用户态任务陷入内核时, 用户态上下文保存在内核栈的栈底, 见 OsCloneParentStack */
+STATIC INLINE UINTPTR OsSchedOffCpuUserPc(const LosTaskCB *taskCB)
+{
+    const TaskContext *context = NULL;
+
+    if (!OsProcessIsUserMode(OS_PCB_FROM_PID(taskCB->processID))) {
+        return 0;
+    }
+    context = (const TaskContext *)((taskCB->topOfStack + taskCB->stackSize) - sizeof(TaskContext));
+    return (UINTPTR)context->PC;
+}
+
+/* 等待队列的链表头嵌在被等待的对象里, 顺着 pendList 跳过其他等待任务的节点就能找到它 */
+STATIC INLINE const VOID *OsSchedOffCpuPendObj(const LosTaskCB *taskCB)
+{
+    const LOS_DL_LIST *node = taskCB->pendList.pstNext;
+    UINTPTR poolStart = (UINTPTR)g_taskCBArray;
+    UINTPTR poolEnd = poolStart + (g_taskMaxNum * sizeof(LosTaskCB));
+
+    while ((node != &taskCB->pendList) && ((UINTPTR)node >= poolStart) && ((UINTPTR)node < poolEnd)) {
+        node = node->pstNext;
+    }
+    return (node != &taskCB->pendList) ? (const VOID *)node : NULL;
+}
+
+STATIC VOID OsSchedOffCpuSwitch(LosTaskCB *runTask, LosTaskCB *newTask)
+{
+    UINT64 now = OsGetCurrSchedTimeCycle();
+    OffCpuType type;
+    const VOID *obj = NULL;
+
+    if (OFFCPU_ON() && (runTask->taskStatus & (OS_TASK_STATUS_PENDING | OS_TASK_STATUS_DELAY |
+                                              OS_TASK_STATUS_SUSPENDED))) {
+        if (runTask->taskStatus & OS_TASK_STATUS_PENDING) {
+            if (runTask->taskMux != NULL) {
+                type = OFFCPU_PEND_MUX;
+                obj = runTask->taskMux;
+            } else if (runTask->taskEvent != NULL) {
+                type = OFFCPU_PEND_EVENT;
+                obj = runTask->taskEvent;
+            } else {
+                type = OFFCPU_PEND;
+                obj = OsSchedOffCpuPendObj(runTask);
+            }
+        } else if (runTask->taskStatus & OS_TASK_STATUS_DELAY) {
+            type = OFFCPU_DELAY;
+        } else {
+            type = OFFCPU_SUSPEND;
+        }
+        OsOffCpuBlock(&runTask->offCpu, runTask->processID, type, obj, OsSchedOffCpuUserPc(runTask), now);
+    }
+
+    OsOffCpuRun(&newTask->offCpu, now);
+}
+#endif
+
 STATIC INLINE VOID OsSchedSwitchCheck(LosTaskCB *runTask, LosTaskCB *newTask)
 {
 #ifdef LOSCFG_BASE_CORE_TSK_MONITOR
@@ -1089,6 +1321,12 @@ STATIC VOID OsSchedTaskSwitch(LosTaskCB *runTask, LosTaskCB *newTask)
     UINT64 endTime;
 
     OsSchedSwitchCheck(runTask, newTask);//任务内容检查
+#ifdef LOSCFG_KERNEL_OFFCPU
+    OsSchedOffCpuSwitch(runTask, newTask);//要在切换当前任务之前做, 内核栈要从当前栈上取
+#endif
+#ifdef LOSCFG_KERNEL_PERF
+    OsPerfTaskSwitch(runTask, newTask);//计数器随任务换入换出, perf stat -p 只统计目标进程
+#endif
 
     runTask->taskStatus &= ~OS_TASK_STATUS_RUNNING; //当前任务去掉正在运行的标签
     newTask->taskStatus |= OS_TASK_STATUS_RUNNING;	//新任务贴上正在运行的标签,虽标签贴上了,但目前还是在老任务中跑.
@@ -1144,6 +1382,7 @@ STATIC VOID OsSchedTaskSwitch(LosTaskCB *runTask, LosTaskCB *newTask)
     newTask->schedStat.waitSchedCount++;
     runTask->schedStat.runTime = runTask->schedStat.allRuntime;
     runTask->schedStat.switchCount++;
+    OsSchedLatencyRecord(runTask, newTask, newTask->startTime - waitStartTime);
 #endif
     /* do the task context switch */
     OsTaskSchedule(newTask, runTask); //执行汇编代码,,注意OsTaskSchedule是一个汇编函数 见于 los_dispatch.s
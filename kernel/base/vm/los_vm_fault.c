@@ -39,6 +39,7 @@
 #include "los_vm_filemap.h"
 #include "los_vm_page.h"
 #include "los_vm_lock.h"
+#include "los_vm_zram.h"
 #include "los_exc.h"
 #include "los_oom.h"
 #include "los_printf.h"
@@ -96,6 +97,91 @@ STATIC VOID OsFaultTryFixup(ExcContext *frame, VADDR_T excVaddr, STATUS_T *statu
 }
 
 #ifdef LOSCFG_FS_VFS 
+#if (LOSCFG_KERNEL_VM_FAULT_AROUND_PAGES > 1)
+#define VM_FAULT_AROUND_SIZE (LOSCFG_KERNEL_VM_FAULT_AROUND_PAGES << PAGE_SHIFT)
+
+/* 读缺页时把对齐窗口内已经在页高速缓存里的相邻页一起映射上(只读), 省掉它们各自的缺页异常 */
+STATIC VOID OsDoFaultAround(LosVmMapRegion *region, const LosVmPgFault *vmPgFault)
+{
+    UINT32 intSave;
+    UINT32 count = 0;
+    UINT32 index;
+    STATUS_T ret;
+    VADDR_T vaddr;
+    VADDR_T start;
+    VADDR_T end;
+    VADDR_T regionEnd = region->range.base + region->range.size;
+    VM_OFFSET_T startPgoff;
+    VM_OFFSET_T endPgoff;
+    LosVmPgFault vmf = { 0 };
+    LosFilePage *fpage = NULL;
+    LosArchMmu *archMmu = &region->space->archMmu;
+    struct page_mapping *mapping = &region->unTypeData.rf.vnode->mapping;
+    VADDR_T aroundVaddr[LOSCFG_KERNEL_VM_FAULT_AROUND_PAGES];
+    PADDR_T aroundPaddr[LOSCFG_KERNEL_VM_FAULT_AROUND_PAGES];
+
+    if (region->regionFlags & VM_MAP_REGION_FLAG_SEQUENTIAL) {//顺序访问时前面的页用不上,窗口从缺页地址往后开
+        start = vmPgFault->vaddr;
+    } else {
+        start = ROUNDDOWN(vmPgFault->vaddr, VM_FAULT_AROUND_SIZE);
+    }
+    end = start + VM_FAULT_AROUND_SIZE;
+    if (start < region->range.base) {
+        start = region->range.base;
+    }
+    if ((end > regionEnd) || (end < start)) {
+        end = regionEnd;
+    }
+    startPgoff = ((start - region->range.base) >> PAGE_SHIFT) + region->pgOff;
+    endPgoff = ((end - region->range.base) >> PAGE_SHIFT) + region->pgOff;
+
+    /* page_list is sorted by pgoff, so one walk covers the whole window */
+    LOS_SpinLockSave(&mapping->list_lock, &intSave);
+    LOS_DL_LIST_FOR_EACH_ENTRY(fpage, &mapping->page_list, LosFilePage, node) {
+        if (fpage->pgoff < startPgoff) {
+            continue;
+        }
+        if (fpage->pgoff >= endPgoff) {
+            break;
+        }
+        vaddr = region->range.base + ((fpage->pgoff - region->pgOff) << PAGE_SHIFT);
+        if ((vaddr == vmPgFault->vaddr) || OsIsPageLocked(fpage->vmPage) ||//正在读盘的页不映射
+            (LOS_ArchMmuQuery(archMmu, vaddr, NULL, NULL) == LOS_OK)) {
+            continue;
+        }
+        OsPageRefIncLocked(fpage);
+        OsAddMapInfo(fpage, archMmu, vaddr);
+        fpage->flags = region->regionFlags;
+        LOS_AtomicInc(&fpage->vmPage->refCounts);
+        aroundVaddr[count] = vaddr;
+        aroundPaddr[count] = VM_PAGE_TO_PHYS(fpage->vmPage);
+        count++;
+    }
+    LOS_SpinUnlockRestore(&mapping->list_lock, intSave);
+
+    for (index = 0; index < count; index++) {
+        ret = LOS_ArchMmuMap(archMmu, aroundVaddr[index], aroundPaddr[index], 1,
+                             region->regionFlags & (~VM_MAP_REGION_FLAG_PERM_WRITE));
+        if (ret < 0) {
+            vmf.vaddr = aroundVaddr[index];
+            vmf.pgoff = ((aroundVaddr[index] - region->range.base) >> PAGE_SHIFT) + region->pgOff;
+            OsDelMapInfo(region, &vmf, FALSE);
+        }
+    }
+}
+#endif
+
+/* MADV_SEQUENTIAL线性区: 读缺页后把后面一段异步读进页高速缓存, 后续缺页由fault-around直接映射 */
+STATIC VOID OsDoSeqReadahead(LosVmMapRegion *region, const LosVmPgFault *vmPgFault)
+{
+    UINT32 nPages = (LOS_RegionEndAddr(region) - vmPgFault->vaddr) >> PAGE_SHIFT;
+
+    if (nPages > VM_FILE_READAHEAD_PAGES) {
+        nPages = VM_FILE_READAHEAD_PAGES;
+    }
+    OsFileReadaheadAsync(region->unTypeData.rf.vnode, vmPgFault->pgoff + 1, nPages);
+}
+
 //读页时发生缺页的处理
 STATIC STATUS_T OsDoReadFault(LosVmMapRegion *region, LosVmPgFault *vmPgFault)//读缺页
 {
@@ -131,8 +217,16 @@ STATIC STATUS_T OsDoReadFault(LosVmMapRegion *region, LosVmPgFault *vmPgFault)//
             (VOID)LOS_MuxRelease(&region->unTypeData.rf.vnode->mapping.mux_lock);
             return LOS_ERRNO_VM_NO_MEMORY;
         }
+#if (LOSCFG_KERNEL_VM_FAULT_AROUND_PAGES > 1)
+        if (!(region->regionFlags & VM_MAP_REGION_FLAG_RANDOM)) {//随机访问时相邻页多半用不上
+            OsDoFaultAround(region, vmPgFault);
+        }
+#endif
 
         (VOID)LOS_MuxRelease(&region->unTypeData.rf.vnode->mapping.mux_lock);
+        if (region->regionFlags & VM_MAP_REGION_FLAG_SEQUENTIAL) {
+            OsDoSeqReadahead(region, vmPgFault);
+        }
         return LOS_OK;
     }
     (VOID)LOS_MuxRelease(&region->unTypeData.rf.vnode->mapping.mux_lock);
@@ -349,6 +443,96 @@ STATIC STATUS_T OsDoFileFault(LosVmMapRegion *region, LosVmPgFault *vmPgFault, U
  * @param frame 
  * @return STATUS_T 
  */
+/* MADV_FREE过的页被写: 撤销懒回收标签, 恢复线性区原本的写权限, 页里的数据原样保留 */
+STATIC STATUS_T OsDoLazyFreeFault(LosVmSpace *space, LosVmMapRegion *region, VADDR_T vaddr)
+{
+    PADDR_T paddr = 0;
+    LosVmPage *page = NULL;
+
+    if (LOS_ArchMmuQuery(&space->archMmu, vaddr, &paddr, NULL) != LOS_OK) {
+        return LOS_NOK;
+    }
+    page = LOS_VmPageGet(paddr);
+    if ((page == NULL) || !OsIsPageLazyFree(page) || (LOS_AtomicRead(&page->refCounts) != 1)) {
+        return LOS_NOK;//fork后共享的页还得走写时拷贝
+    }
+    OsCleanPageLazyFree(page);
+    if (LOS_ArchMmuChangeProt(&space->archMmu, vaddr, 1, region->regionFlags) < 0) {
+        return LOS_NOK;
+    }
+    return LOS_OK;
+}
+
+/* 大页线性区缺页时, 如果所在的1M整个属于该线性区且还没有任何映射, 直接分配1M物理块按section映射 */
+STATIC STATUS_T OsDoHugePageFault(LosVmSpace *space, LosVmMapRegion *region, VADDR_T vaddr)
+{
+    UINT32 index;
+    LosVmPage *page = NULL;
+    VADDR_T base = ROUNDDOWN(vaddr, VM_SECTION_SIZE);
+
+    if (!LOS_IsRegionTypeAnon(region) ||
+        (region->regionFlags & (VM_MAP_REGION_FLAG_SHARED | VM_MAP_REGION_FLAG_SHM)) ||
+        (base < region->range.base) || ((base + VM_SECTION_SIZE - 1) > LOS_RegionEndAddr(region)) ||
+        !OsArchMmuIsL1Unmapped(&space->archMmu, base)) {
+        return LOS_NOK;
+    }
+
+    page = LOS_PhysSectionAlloc();
+    if (page == NULL) {
+        return LOS_NOK;//拿不到1M连续内存就退回按页映射
+    }
+    (VOID)memset_s(OsVmPageToVaddr(page), VM_SECTION_SIZE, 0, VM_SECTION_SIZE);
+    for (index = 0; index < VM_SECTION_PAGES; index++) {
+        LOS_AtomicInc(&page[index].refCounts);
+    }
+
+    if (LOS_ArchMmuMap(&space->archMmu, base, VM_PAGE_TO_PHYS(page), VM_SECTION_PAGES, region->regionFlags) < 0) {
+        for (index = 0; index < VM_SECTION_PAGES; index++) {
+            LOS_PhysPageFree(&page[index]);
+        }
+        return LOS_NOK;
+    }
+    return LOS_OK;
+}
+
+#if (LOSCFG_KERNEL_VM_ANON_FAULT_PAGES > 1)
+/* 私有匿名线性区缺页时顺带把后面几页也映射成清零的新页, 顺序访问的堆和匿名映射就少几次缺页 */
+STATIC VOID OsDoAnonFaultBatch(LosVmSpace *space, LosVmMapRegion *region, VADDR_T vaddr)
+{
+    UINT32 index;
+    LosVmPage *page = NULL;
+    VADDR_T regionEnd = region->range.base + region->range.size;
+
+    if (!LOS_IsRegionTypeAnon(region) ||
+        (region->regionFlags & (VM_MAP_REGION_FLAG_SHARED | VM_MAP_REGION_FLAG_SHM))) {
+        return;
+    }
+
+    for (index = 1; index < LOSCFG_KERNEL_VM_ANON_FAULT_PAGES; index++) {
+        vaddr += PAGE_SIZE;
+        if ((vaddr >= regionEnd) || (vaddr < region->range.base) ||
+            (LOS_ArchMmuQuery(&space->archMmu, vaddr, NULL, NULL) == LOS_OK)) {
+            return;
+        }
+#ifdef LOSCFG_KERNEL_VM_ZRAM
+        if (LOS_ArchMmuSwapEntryGet(&space->archMmu, vaddr, NULL) == LOS_OK) {//换出的页等真访问时再换入
+            return;
+        }
+#endif
+        page = LOS_PhysPageAlloc();
+        if (page == NULL) {
+            return;
+        }
+        (VOID)memset_s(OsVmPageToVaddr(page), PAGE_SIZE, 0, PAGE_SIZE);
+        LOS_AtomicInc(&page->refCounts);
+        if (LOS_ArchMmuMap(&space->archMmu, vaddr, VM_PAGE_TO_PHYS(page), 1, region->regionFlags) < 0) {
+            LOS_PhysPageFree(page);
+            return;
+        }
+    }
+}
+#endif
+
 STATUS_T OsVmPageFaultHandler(VADDR_T vaddr, UINT32 flags, ExcContext *frame)
 {
     LosVmSpace *space = LOS_SpaceGet(vaddr);//获取虚拟地址所属空间
@@ -415,6 +599,24 @@ STATUS_T OsVmPageFaultHandler(VADDR_T vaddr, UINT32 flags, ExcContext *frame)
         goto DONE;
     }
 #endif
+    if ((region->regionFlags & VM_MAP_REGION_FLAG_LAZYFREE) && (flags & VM_MAP_PF_FLAG_WRITE) &&
+        (OsDoLazyFreeFault(space, region, vaddr) == LOS_OK)) {
+        status = LOS_OK;
+        goto DONE;
+    }
+#ifdef LOSCFG_KERNEL_VM_ZRAM
+    status = OsZramSwapIn(space, region, vaddr);//换出到压缩池的页, 解压回来
+    if (status != LOS_ERRNO_VM_NOT_FOUND) {
+        if (status != LOS_OK) {
+            goto CHECK_FAILED;
+        }
+        goto DONE;
+    }
+#endif
+    if ((region->regionFlags & VM_MAP_REGION_FLAG_HUGEPAGE) && (OsDoHugePageFault(space, region, vaddr) == LOS_OK)) {
+        status = LOS_OK;
+        goto DONE;
+    }
 	//请求调页:推迟到不能再推迟为止
     newPage = LOS_PhysPageAlloc();//分配一个新的物理页
     if (newPage == NULL) {
@@ -453,6 +655,12 @@ STATUS_T OsVmPageFaultHandler(VADDR_T vaddr, UINT32 flags, ExcContext *frame)
             status = LOS_ERRNO_VM_MAP_FAILED;
             goto VMM_MAP_FAILED;
         }
+#ifdef LOSCFG_KERNEL_VM_ZRAM
+        OsSetPageReferenced(newPage);//刚访问过的页, 换出扫描时先放它一马
+#endif
+#if (LOSCFG_KERNEL_VM_ANON_FAULT_PAGES > 1)
+        OsDoAnonFaultBatch(space, region, vaddr);
+#endif
     }
 
     status = LOS_OK;
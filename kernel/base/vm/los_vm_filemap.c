@@ -41,6 +41,8 @@
 #include "los_vm_fault.h"
 #include "los_process_pri.h"
 #include "los_vm_lock.h"
+#include "los_event.h"
+#include "los_init.h"
 #ifdef LOSCFG_FS_VFS
 #include "vnode.h"
 #endif
@@ -449,6 +451,164 @@ INT32 OsVmmFileFault(LosVmMapRegion *region, LosVmPgFault *vmf)
     LOS_SpinUnlockRestore(&mapping->list_lock, intSave);
     return LOS_OK;
 }
+#ifdef LOSCFG_FS_VFS
+#define VM_READAHEAD_QUEUE_SIZE     16      ///< 预读请求队列长度,满了直接丢弃,预读只是提示
+#define VM_READAHEAD_MAX_PAGES      64      ///< 单个请求最多预读的页数
+#define VM_READAHEAD_EVENT          0x01
+
+/// 异步预读请求, vnode在入队时加了引用, 预读完才放掉
+typedef struct {
+    struct Vnode    *vnode;
+    VM_OFFSET_T     pgoff;
+    UINT32          nPages;
+} VmReadaheadReq;
+
+STATIC VmReadaheadReq g_readaheadQueue[VM_READAHEAD_QUEUE_SIZE];
+STATIC UINT32 g_readaheadHead = 0;
+STATIC UINT32 g_readaheadTail = 0;
+STATIC BOOL g_readaheadReady = FALSE;
+STATIC EVENT_CB_S g_readaheadEvent;
+LITE_OS_SEC_BSS STATIC SPIN_LOCK_INIT(g_readaheadSpin);
+
+/* 把文件第pgoff页读进页高速缓存但不映射, 已经在缓存里就什么也不做; 返回FALSE表示读不到(多半是过了文件尾) */
+STATIC BOOL OsFileReadaheadPage(struct Vnode *vnode, VM_OFFSET_T pgoff)
+{
+    INT32 ret;
+    UINT32 intSave;
+    struct page_mapping *mapping = &vnode->mapping;
+    LosFilePage *fpage = NULL;
+
+    LOS_SpinLockSave(&mapping->list_lock, &intSave);
+    fpage = OsFindGetEntry(mapping, pgoff);
+    if (fpage != NULL) {
+        LOS_SpinUnlockRestore(&mapping->list_lock, intSave);
+        return TRUE;
+    }
+    fpage = OsPageCacheAlloc(mapping, pgoff);
+    if (fpage == NULL) {
+        LOS_SpinUnlockRestore(&mapping->list_lock, intSave);
+        return FALSE;
+    }
+    OsSetPageLocked(fpage->vmPage);
+    LOS_SpinUnlockRestore(&mapping->list_lock, intSave);
+
+    ret = vnode->vop->ReadPage(vnode, OsVmPageToVaddr(fpage->vmPage), pgoff << PAGE_SHIFT);
+    if (ret <= 0) {
+        OsReleaseFpage(mapping, fpage);
+        return FALSE;
+    }
+
+    LOS_SpinLockSave(&mapping->list_lock, &intSave);
+    OsAddToPageacheLru(fpage, mapping, pgoff);
+    OsCleanPageLocked(fpage->vmPage);
+    LOS_SpinUnlockRestore(&mapping->list_lock, intSave);
+    return TRUE;
+}
+
+STATIC VOID OsFileReadaheadVnodePut(struct Vnode *vnode)
+{
+    VnodeHold();
+    vnode->useCount--;
+    VnodeDrop();
+}
+
+/* 预读任务: 逐页持mapping锁读盘, 缺页的任务最多等一页的IO */
+STATIC VOID OsFileReadaheadTask(VOID)
+{
+    UINT32 intSave;
+    UINT32 index;
+    VmReadaheadReq req;
+
+    while (1) {
+        (VOID)LOS_EventRead(&g_readaheadEvent, VM_READAHEAD_EVENT, LOS_WAITMODE_OR | LOS_WAITMODE_CLR,
+                            LOS_WAIT_FOREVER);
+        while (1) {
+            LOS_SpinLockSave(&g_readaheadSpin, &intSave);
+            if (g_readaheadHead == g_readaheadTail) {
+                LOS_SpinUnlockRestore(&g_readaheadSpin, intSave);
+                break;
+            }
+            req = g_readaheadQueue[g_readaheadHead % VM_READAHEAD_QUEUE_SIZE];
+            g_readaheadHead++;
+            LOS_SpinUnlockRestore(&g_readaheadSpin, intSave);
+
+            for (index = 0; index < req.nPages; index++) {
+                (VOID)LOS_MuxAcquire(&req.vnode->mapping.mux_lock);
+                if (!OsFileReadaheadPage(req.vnode, req.pgoff + index)) {
+                    (VOID)LOS_MuxRelease(&req.vnode->mapping.mux_lock);
+                    break;
+                }
+                (VOID)LOS_MuxRelease(&req.vnode->mapping.mux_lock);
+            }
+            OsFileReadaheadVnodePut(req.vnode);
+        }
+    }
+}
+
+/*!
+ * 请求把文件[pgoff, pgoff + nPages)异步读进页高速缓存, 用于madvise(MADV_WILLNEED)和顺序访问的预读
+ * 调用者不能持有该文件的mapping->mux_lock; 队列满或预读任务没起来时直接忽略
+ */
+VOID OsFileReadaheadAsync(struct Vnode *vnode, VM_OFFSET_T pgoff, UINT32 nPages)
+{
+    UINT32 intSave;
+    VmReadaheadReq *req = NULL;
+
+    if (!g_readaheadReady || (vnode == NULL) || (nPages == 0) ||
+        (vnode->vop == NULL) || (vnode->vop->ReadPage == NULL)) {
+        return;
+    }
+    if (nPages > VM_READAHEAD_MAX_PAGES) {
+        nPages = VM_READAHEAD_MAX_PAGES;
+    }
+
+    VnodeHold();
+    vnode->useCount++;
+    VnodeDrop();
+
+    LOS_SpinLockSave(&g_readaheadSpin, &intSave);
+    if ((g_readaheadTail - g_readaheadHead) >= VM_READAHEAD_QUEUE_SIZE) {
+        LOS_SpinUnlockRestore(&g_readaheadSpin, intSave);
+        OsFileReadaheadVnodePut(vnode);
+        return;
+    }
+    req = &g_readaheadQueue[g_readaheadTail % VM_READAHEAD_QUEUE_SIZE];
+    req->vnode = vnode;
+    req->pgoff = pgoff;
+    req->nPages = nPages;
+    g_readaheadTail++;
+    LOS_SpinUnlockRestore(&g_readaheadSpin, intSave);
+
+    (VOID)LOS_EventWrite(&g_readaheadEvent, VM_READAHEAD_EVENT);
+}
+
+STATIC UINT32 OsFileReadaheadInit(VOID)
+{
+    UINT32 ret;
+    UINT32 taskID;
+    TSK_INIT_PARAM_S taskInitParam;
+
+    ret = LOS_EventInit(&g_readaheadEvent);
+    if (ret != LOS_OK) {
+        return ret;
+    }
+
+    (VOID)memset_s(&taskInitParam, sizeof(TSK_INIT_PARAM_S), 0, sizeof(TSK_INIT_PARAM_S));
+    taskInitParam.pfnTaskEntry = (TSK_ENTRY_FUNC)OsFileReadaheadTask;
+    taskInitParam.usTaskPrio = LOSCFG_BASE_CORE_TSK_DEFAULT_PRIO;
+    taskInitParam.pcName = "VmReadahead";
+    taskInitParam.uwStackSize = LOSCFG_BASE_CORE_TSK_DEFAULT_STACK_SIZE;
+    ret = LOS_TaskCreate(&taskID, &taskInitParam);
+    if (ret != LOS_OK) {
+        return ret;
+    }
+    g_readaheadReady = TRUE;
+    return LOS_OK;
+}
+
+LOS_MODULE_INIT(OsFileReadaheadInit, LOS_INIT_LEVEL_KMOD_TASK);
+#endif
+
 ///文件缓存冲洗,把所有fpage冲洗一边，把脏页洗到dirtyList中,配合OsFileCacheRemove理解 
 VOID OsFileCacheFlush(struct page_mapping *mapping)
 {
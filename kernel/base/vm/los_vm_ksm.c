@@ -0,0 +1,408 @@
+/*
+ * Copyright (c) 2013-2019 Huawei Technologies Co., Ltd. All rights reserved.
+ * Copyright (c) 2020-2021 Huawei Device Co., Ltd. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of
+ *    conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list
+ *    of conditions and the following disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used
+ *    to endorse or promote products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "los_vm_ksm.h"
+
+#ifdef LOSCFG_KERNEL_VM_KSM
+#include "los_vm_map.h"
+#include "los_vm_filemap.h"
+#include "los_vm_lock.h"
+#include "los_vm_page.h"
+#include "los_vm_phys.h"
+#include "los_hash.h"
+#include "los_memory.h"
+#include "los_task.h"
+#include "los_init.h"
+
+#define KSM_HASH_BUCKETS    256
+#define KSM_UNSTABLE_MAX    4096    ///< 候选表上限, 限制一轮全量扫描占用的内核堆
+#define KSM_TASK_PRIORITY   25      ///< 比普通任务低, 只在空闲时扫描
+
+/// 稳定表节点: 一个合并出来的只读共享页
+typedef struct {
+    LOS_DL_LIST node;
+    LosVmPage   *page;
+    UINT32      hash;
+} KsmStableNode;
+
+/// 候选表节点: 只记空间和虚拟地址, 用的时候重新查页表确认映射没变
+typedef struct {
+    LOS_DL_LIST node;
+    LosVmSpace  *space;
+    VADDR_T     vaddr;
+    UINT32      hash;
+} KsmUnstableNode;
+
+typedef struct {
+    LOS_DL_LIST     stable[KSM_HASH_BUCKETS];
+    LOS_DL_LIST     unstable[KSM_HASH_BUCKETS];
+    UINT32          unstableCount;
+    LosVmSpace      *cursorSpace;   ///< 上一轮停在哪个空间
+    VADDR_T         cursorVaddr;    ///< 该空间扫到哪个地址了
+    UINT32          passSpaces;     ///< 本轮全量扫描已经扫完的空间数
+    LosVmKsmStat    stat;
+} VmKsm;
+
+STATIC VmKsm g_ksm;
+
+/// 只合并进程私有的匿名内存, 和换出的范围一样
+STATIC BOOL OsKsmRegionMergeable(LosVmMapRegion *region)
+{
+    if (LOS_IsRegionTypeFile(region) || LOS_IsRegionTypeDev(region) ||
+        (region->regionFlags & (VM_MAP_REGION_FLAG_SHARED | VM_MAP_REGION_FLAG_SHM | VM_MAP_REGION_FLAG_VDSO))) {
+        return FALSE;
+    }
+    return LOS_IsUserAddress(region->range.base);
+}
+
+/// 候选表里记的空间可能已经释放了, 调用者持有空间链表锁
+STATIC BOOL OsKsmSpaceAlive(const LosVmSpace *space)
+{
+    LosVmSpace *iter = NULL;
+
+    LOS_DL_LIST_FOR_EACH_ENTRY(iter, LOS_GetVmSpaceList(), LosVmSpace, node) {
+        if (iter == space) {
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+/// 虚拟地址上映射的私有匿名页, 写时拷贝还共享着的, 已经合并过的和懒回收的都不算, 调用者持有regionMux
+STATIC LosVmPage *OsKsmPageGet(LosVmSpace *space, VADDR_T vaddr, UINT32 *mmuFlags)
+{
+    PADDR_T paddr = 0;
+    LosVmPage *page = NULL;
+
+    if (OsArchMmuIsSection(&space->archMmu, vaddr) ||
+        (LOS_ArchMmuQuery(&space->archMmu, vaddr, &paddr, mmuFlags) != LOS_OK)) {
+        return NULL;
+    }
+    page = LOS_VmPageGet(paddr);
+    if ((page == NULL) || OsIsPageKsm(page) || OsIsPageLazyFree(page) ||
+        (LOS_AtomicRead(&page->refCounts) != 1)) {
+        return NULL;
+    }
+    return page;
+}
+
+/// 先去掉写权限再比较内容, 比较通过后页里的数据就不会再变了; 内容不同就恢复写权限
+STATIC BOOL OsKsmWriteProtect(LosVmSpace *space, VADDR_T vaddr, LosVmPage *page, UINT32 mmuFlags, LosVmPage *kpage)
+{
+    if ((mmuFlags & VM_MAP_REGION_FLAG_PERM_WRITE) &&
+        (LOS_ArchMmuChangeProt(&space->archMmu, vaddr, 1, mmuFlags & ~VM_MAP_REGION_FLAG_PERM_WRITE) != LOS_OK)) {
+        return FALSE;
+    }
+    if (memcmp(OsVmPageToVaddr(page), OsVmPageToVaddr(kpage), PAGE_SIZE) != 0) {
+        if (mmuFlags & VM_MAP_REGION_FLAG_PERM_WRITE) {
+            (VOID)LOS_ArchMmuChangeProt(&space->archMmu, vaddr, 1, mmuFlags);
+        }
+        return FALSE;
+    }
+    return TRUE;
+}
+
+/// 把page换成只读映射的共享页kpage, page释放; 再写时缺页, 共享页引用数大于1会拷贝出新页
+STATIC BOOL OsKsmMerge(LosVmSpace *space, VADDR_T vaddr, LosVmPage *page, UINT32 mmuFlags, LosVmPage *kpage)
+{
+    if (!OsKsmWriteProtect(space, vaddr, page, mmuFlags, kpage)) {
+        return FALSE;
+    }
+
+    LOS_AtomicInc(&kpage->refCounts);
+    LOS_ArchMmuUnmap(&space->archMmu, vaddr, 1);
+    if (LOS_ArchMmuMap(&space->archMmu, vaddr, VM_PAGE_TO_PHYS(kpage), 1,
+                       mmuFlags & ~VM_MAP_REGION_FLAG_PERM_WRITE) < 0) {
+        LOS_AtomicDec(&kpage->refCounts);
+        (VOID)LOS_ArchMmuMap(&space->archMmu, vaddr, VM_PAGE_TO_PHYS(page), 1, mmuFlags);
+        return FALSE;
+    }
+    LOS_PhysPageFree(page);
+    return TRUE;
+}
+
+STATIC LosVmPage *OsKsmStableFind(UINT32 hash, LosVmPage *page)
+{
+    KsmStableNode *node = NULL;
+
+    LOS_DL_LIST_FOR_EACH_ENTRY(node, &g_ksm.stable[hash % KSM_HASH_BUCKETS], KsmStableNode, node) {
+        if ((node->hash == hash) && (memcmp(OsVmPageToVaddr(node->page), OsVmPageToVaddr(page), PAGE_SIZE) == 0)) {
+            return node->page;
+        }
+    }
+    return NULL;
+}
+
+/*
+ * 合并任务自己持有共享页一个引用: 最后一个映射写时拷贝时引用数仍大于1, 会拷贝而不是把共享页原地变回私有页,
+ * 稳定表里的页因此永远是只读的. 只剩这个引用时由OsKsmStablePrune释放
+ */
+STATIC BOOL OsKsmStableInsert(LosVmPage *kpage, UINT32 hash)
+{
+    KsmStableNode *node = LOS_MemAlloc(m_aucSysMem0, sizeof(KsmStableNode));
+
+    if (node == NULL) {
+        return FALSE;
+    }
+    node->page = kpage;
+    node->hash = hash;
+    OsSetPageKsm(kpage);
+    LOS_AtomicInc(&kpage->refCounts);
+    LOS_ListAdd(&g_ksm.stable[hash % KSM_HASH_BUCKETS], &node->node);
+    return TRUE;
+}
+
+/// 在候选表里找内容相同的页, 找到就写保护后升级成共享页, 调用者持有空间链表锁
+STATIC LosVmPage *OsKsmUnstableMatch(UINT32 hash, LosVmPage *page)
+{
+    KsmUnstableNode *item = NULL;
+    KsmUnstableNode *next = NULL;
+    LosVmMapRegion *region = NULL;
+    LosVmPage *cand = NULL;
+    LosVmPage *kpage = NULL;
+    UINT32 mmuFlags = 0;
+
+    LOS_DL_LIST_FOR_EACH_ENTRY_SAFE(item, next, &g_ksm.unstable[hash % KSM_HASH_BUCKETS], KsmUnstableNode, node) {
+        if ((item->hash != hash) || !OsKsmSpaceAlive(item->space) ||
+            (LOS_MuxTrylock(&item->space->regionMux) != LOS_OK)) {
+            continue;
+        }
+        region = LOS_RegionFind(item->space, item->vaddr);
+        if ((region != NULL) && OsKsmRegionMergeable(region)) {
+            cand = OsKsmPageGet(item->space, item->vaddr, &mmuFlags);
+            if ((cand != NULL) && (cand != page) &&
+                OsKsmWriteProtect(item->space, item->vaddr, cand, mmuFlags, page) &&
+                OsKsmStableInsert(cand, hash)) {
+                kpage = cand;
+            }
+        }
+        (VOID)LOS_MuxRelease(&item->space->regionMux);
+        if (kpage != NULL) {
+            LOS_ListDelete(&item->node);
+            (VOID)LOS_MemFree(m_aucSysMem0, item);
+            g_ksm.unstableCount--;
+            return kpage;
+        }
+    }
+    return NULL;
+}
+
+STATIC VOID OsKsmUnstableInsert(LosVmSpace *space, VADDR_T vaddr, UINT32 hash)
+{
+    KsmUnstableNode *item = NULL;
+
+    if (g_ksm.unstableCount >= KSM_UNSTABLE_MAX) {
+        return;
+    }
+    item = LOS_MemAlloc(m_aucSysMem0, sizeof(KsmUnstableNode));
+    if (item == NULL) {
+        return;
+    }
+    item->space = space;
+    item->vaddr = vaddr;
+    item->hash = hash;
+    LOS_ListAdd(&g_ksm.unstable[hash % KSM_HASH_BUCKETS], &item->node);
+    g_ksm.unstableCount++;
+}
+
+/// 每轮全量扫描后清空候选表, 页里的数据随时在变, 旧的校验和没有参考价值
+STATIC VOID OsKsmUnstableReset(VOID)
+{
+    KsmUnstableNode *item = NULL;
+    KsmUnstableNode *next = NULL;
+    UINT32 index;
+
+    for (index = 0; index < KSM_HASH_BUCKETS; index++) {
+        LOS_DL_LIST_FOR_EACH_ENTRY_SAFE(item, next, &g_ksm.unstable[index], KsmUnstableNode, node) {
+            LOS_ListDelete(&item->node);
+            (VOID)LOS_MemFree(m_aucSysMem0, item);
+        }
+    }
+    g_ksm.unstableCount = 0;
+}
+
+/// 释放已经没人映射的共享页, 顺便统计共享页数和省下的页数
+STATIC VOID OsKsmStablePrune(VOID)
+{
+    KsmStableNode *node = NULL;
+    KsmStableNode *next = NULL;
+    UINT32 shared = 0;
+    UINT32 sharing = 0;
+    UINT32 index;
+    INT32 refs;
+
+    for (index = 0; index < KSM_HASH_BUCKETS; index++) {
+        LOS_DL_LIST_FOR_EACH_ENTRY_SAFE(node, next, &g_ksm.stable[index], KsmStableNode, node) {
+            refs = LOS_AtomicRead(&node->page->refCounts);
+            if (refs <= 1) {
+                LOS_ListDelete(&node->node);
+                OsCleanPageKsm(node->page);
+                LOS_PhysPageFree(node->page);
+                (VOID)LOS_MemFree(m_aucSysMem0, node);
+                continue;
+            }
+            shared++;
+            sharing += (UINT32)(refs - 2);//减去合并任务自己的引用和共享页本身
+        }
+    }
+    g_ksm.stat.pagesShared = shared;
+    g_ksm.stat.pagesSharing = sharing;
+}
+
+STATIC VOID OsKsmScanPage(LosVmSpace *space, VADDR_T vaddr)
+{
+    UINT32 mmuFlags = 0;
+    UINT32 hash;
+    LosVmPage *kpage = NULL;
+    LosVmPage *page = OsKsmPageGet(space, vaddr, &mmuFlags);
+
+    if (page == NULL) {
+        return;
+    }
+    hash = LOS_HashFNV32aBuf(OsVmPageToVaddr(page), PAGE_SIZE, FNV1_32A_INIT);
+    kpage = OsKsmStableFind(hash, page);
+    if (kpage == NULL) {
+        kpage = OsKsmUnstableMatch(hash, page);
+    }
+    if (kpage == NULL) {
+        OsKsmUnstableInsert(space, vaddr, hash);
+        return;
+    }
+    (VOID)OsKsmMerge(space, vaddr, page, mmuFlags, kpage);
+}
+
+/// 从上次停下的地址接着扫一个空间, 扫完返回TRUE, 调用者持有space->regionMux
+STATIC BOOL OsKsmScanSpace(LosVmSpace *space, UINT32 *budget)
+{
+    LosVmMapRegion *region = NULL;
+    LosRbNode *pstRbNode = NULL;
+    LosRbNode *pstRbNodeNext = NULL;
+    VADDR_T vaddr;
+
+    RB_SCAN_SAFE(&space->regionRbTree, pstRbNode, pstRbNodeNext)
+        region = (LosVmMapRegion *)pstRbNode;
+        if (!OsKsmRegionMergeable(region) || (LOS_RegionEndAddr(region) < g_ksm.cursorVaddr)) {
+            continue;
+        }
+        vaddr = (region->range.base > g_ksm.cursorVaddr) ? region->range.base : g_ksm.cursorVaddr;
+        for (; vaddr < LOS_RegionEndAddr(region); vaddr += PAGE_SIZE) {
+            if (*budget == 0) {
+                g_ksm.cursorVaddr = vaddr;
+                return FALSE;
+            }
+            (*budget)--;
+            g_ksm.stat.pagesScanned++;
+            OsKsmScanPage(space, vaddr);
+        }
+    RB_SCAN_SAFE_END(&space->regionRbTree, pstRbNode, pstRbNodeNext)
+    return TRUE;
+}
+
+/*
+ * 一轮最多扫LOSCFG_KERNEL_VM_KSM_PAGES_TO_SCAN页, 扫完的空间挪到链表尾, 没扫完的下一轮从停下的地址接着扫.
+ * 链表里所有空间都扫过一遍算一次全量扫描
+ */
+STATIC VOID OsKsmScanRound(VOID)
+{
+    LOS_DL_LIST *spaceList = LOS_GetVmSpaceList();
+    LosVmSpace *space = NULL;
+    UINT32 budget = LOSCFG_KERNEL_VM_KSM_PAGES_TO_SCAN;
+    UINT32 total = 0;
+    UINT32 count;
+    BOOL done = FALSE;
+
+    (VOID)LOS_MuxAcquire(OsGVmSpaceMuxGet());
+    LOS_DL_LIST_FOR_EACH_ENTRY(space, spaceList, LosVmSpace, node) {
+        total++;
+    }
+    for (count = 0; (count < total) && (budget > 0); count++) {
+        space = LOS_DL_LIST_ENTRY(spaceList->pstNext, LosVmSpace, node);
+        if (space != g_ksm.cursorSpace) {
+            g_ksm.cursorSpace = space;
+            g_ksm.cursorVaddr = 0;
+        }
+        done = TRUE;
+        if ((space != LOS_GetKVmSpace()) && (space != LOS_GetVmallocSpace()) &&
+            (LOS_MuxTrylock(&space->regionMux) == LOS_OK)) {
+            done = OsKsmScanSpace(space, &budget);
+            (VOID)LOS_MuxRelease(&space->regionMux);
+        }
+        if (!done) {
+            break;
+        }
+        LOS_ListDelete(&space->node);
+        LOS_ListTailInsert(spaceList, &space->node);
+        g_ksm.cursorSpace = NULL;
+        if (++g_ksm.passSpaces >= total) {
+            g_ksm.passSpaces = 0;
+            g_ksm.stat.fullScans++;
+            OsKsmUnstableReset();
+        }
+    }
+    (VOID)LOS_MuxRelease(OsGVmSpaceMuxGet());
+
+    OsKsmStablePrune();
+}
+
+STATIC VOID OsKsmTask(VOID)
+{
+    while (1) {
+        OsKsmScanRound();
+        LOS_Msleep(LOSCFG_KERNEL_VM_KSM_SLEEP_MS);
+    }
+}
+
+VOID OsKsmStatGet(LosVmKsmStat *stat)
+{
+    *stat = g_ksm.stat;
+}
+
+STATIC UINT32 OsKsmInit(VOID)
+{
+    UINT32 index;
+    UINT32 taskID;
+    TSK_INIT_PARAM_S taskInitParam;
+
+    for (index = 0; index < KSM_HASH_BUCKETS; index++) {
+        LOS_ListInit(&g_ksm.stable[index]);
+        LOS_ListInit(&g_ksm.unstable[index]);
+    }
+
+    (VOID)memset_s(&taskInitParam, sizeof(TSK_INIT_PARAM_S), 0, sizeof(TSK_INIT_PARAM_S));
+    taskInitParam.pfnTaskEntry = (TSK_ENTRY_FUNC)OsKsmTask;
+    taskInitParam.usTaskPrio = KSM_TASK_PRIORITY;
+    taskInitParam.pcName = "Ksmd";
+    taskInitParam.uwStackSize = LOSCFG_BASE_CORE_TSK_DEFAULT_STACK_SIZE;
+    return LOS_TaskCreate(&taskID, &taskInitParam);
+}
+
+LOS_MODULE_INIT(OsKsmInit, LOS_INIT_LEVEL_KMOD_TASK);
+#endif
@@ -85,6 +85,7 @@
 #include "los_vm_zone.h"
 #include "los_vm_common.h"
 #include "los_vm_filemap.h"
+#include "los_vm_zram.h"
 #include "los_vm_shm_pri.h"
 #include "los_arch_mmu.h"
 #include "los_process_pri.h"
@@ -95,6 +96,9 @@
 #include "los_task.h"
 #include "los_memory_pri.h"
 #include "los_vm_boot.h"
+#ifdef LOSCFG_ARCH_USER_UNWIND
+#include "los_unwind_pri.h"
+#endif
 
 
 #ifdef LOSCFG_KERNEL_VM
@@ -367,6 +371,14 @@ STATUS_T LOS_VmSpaceClone(LosVmSpace *oldVmSpace, LosVmSpace *newVmSpace)
         for (i = 0; i < numPages; i++) {//一页一页进行重新映射
             vaddr = newRegion->range.base + (i << PAGE_SHIFT);
             if (LOS_ArchMmuQuery(&oldVmSpace->archMmu, vaddr, &paddr, &flags) != LOS_OK) {//先查物理地址
+#ifdef LOSCFG_KERNEL_VM_ZRAM
+                OsZramEntryDup(&oldVmSpace->archMmu, &newVmSpace->archMmu, vaddr);//换出的页共享同一个槽
+#endif
+                continue;
+            }
+
+            if (LOS_IsRegionTypeDev(oldRegion)) {//设备内存不做写时拷贝, 新老空间原样共享, 解映射时也不减引用
+                LOS_ArchMmuMap(&newVmSpace->archMmu, vaddr, paddr, 1, flags);
                 continue;
             }
 
@@ -589,7 +601,11 @@ LosVmMapRegion *LOS_RegionAlloc(LosVmSpace *vmSpace, VADDR_T vaddr, size_t len,
      * then the kernel takes it as where to place the mapping;
      */
     (VOID)LOS_MuxAcquire(&vmSpace->regionMux);//获得互斥锁
-    if (vaddr == 0) {//如果地址是0，则由内核选择创建映射的虚拟地址，    这是创建新映射的最便捷的方法。
+    if ((vaddr == 0) && (regionFlags & VM_MAP_REGION_FLAG_HUGEPAGE) && (len >= VM_SECTION_SIZE)) {
+        /* reserve the slack so the region can start on a section boundary */
+        rstVaddr = OsAllocRange(vmSpace, len + VM_SECTION_SIZE - PAGE_SIZE);
+        rstVaddr = (rstVaddr != 0) ? ROUNDUP(rstVaddr, VM_SECTION_SIZE) : 0;
+    } else if (vaddr == 0) {//如果地址是0，则由内核选择创建映射的虚拟地址，    这是创建新映射的最便捷的方法。
         rstVaddr = OsAllocRange(vmSpace, len);
     } else {
         /* if it is already mmapped here, we unmmap it */
@@ -622,6 +638,26 @@ OUT:
  * 删除匿名页,匿名页就是内存映射页
  * 1.解除映射关系 2.释放物理内存
 */
+STATIC VOID OsAnonSectionRemove(LosArchMmu *archMmu, VADDR_T vaddr)
+{
+    paddr_t paddr = 0;
+    LosVmPage *page = NULL;
+    UINT32 index;
+
+    (VOID)LOS_ArchMmuQuery(archMmu, vaddr, &paddr, NULL);
+    LOS_ArchMmuUnmap(archMmu, vaddr, VM_SECTION_PAGES);
+
+    page = LOS_VmPageGet(paddr);
+    if (page == NULL) {
+        return;
+    }
+    for (index = 0; index < VM_SECTION_PAGES; index++) {
+        if (!OsIsPageShared(&page[index])) {
+            LOS_PhysPageFree(&page[index]);
+        }
+    }
+}
+
 STATIC VOID OsAnonPagesRemove(LosArchMmu *archMmu, VADDR_T vaddr, UINT32 count)
 {
     status_t status;
@@ -634,9 +670,18 @@ STATIC VOID OsAnonPagesRemove(LosArchMmu *archMmu, VADDR_T vaddr, UINT32 count)
     }
 
     while (count > 0) {//一页页操作
+        if (IS_ALIGNED(vaddr, VM_SECTION_SIZE) && (count >= VM_SECTION_PAGES) && OsArchMmuIsSection(archMmu, vaddr)) {
+            OsAnonSectionRemove(archMmu, vaddr);//整个section一起解除, 不用先拆成小页
+            vaddr += VM_SECTION_SIZE;
+            count -= VM_SECTION_PAGES;
+            continue;
+        }
         count--;
         status = LOS_ArchMmuQuery(archMmu, vaddr, &paddr, NULL);//通过虚拟地址拿到物理地址
         if (status != LOS_OK) {//失败，拿下一页的物理地址
+#ifdef LOSCFG_KERNEL_VM_ZRAM
+            OsZramEntryRelease(archMmu, vaddr);//换出到压缩池的页, 放掉槽
+#endif
             vaddr += PAGE_SIZE;
             continue;
         }
@@ -702,6 +747,9 @@ STATUS_T LOS_RegionFree(LosVmSpace *space, LosVmMapRegion *region)
 
 #ifdef LOSCFG_FS_VFS
     if (LOS_IsRegionFileValid(region)) {
+#ifdef LOSCFG_ARCH_USER_UNWIND
+        OsUnwindRegionFree(space, region);//作废用户栈回溯缓存的这个镜像的索引表
+#endif
         OsFilePagesRemove(space, region);
         VnodeHold();
         region->unTypeData.rf.vnode->useCount--;
@@ -728,6 +776,48 @@ STATUS_T LOS_RegionFree(LosVmSpace *space, LosVmMapRegion *region)
     return LOS_OK;
 }
 
+/*!
+ * 丢掉线性区内[vaddr, vaddr + size)的页但保留线性区, 供madvise(MADV_DONTNEED)使用, 调用者持有regionMux
+ * 匿名页直接释放, 再访问时缺页拿到清零的新页; 文件页解除映射, 再访问时从页高速缓存/文件重新读
+ */
+STATUS_T OsRegionPagesDrop(LosVmSpace *space, LosVmMapRegion *region, VADDR_T vaddr, size_t size)
+{
+    UINT32 count = size >> PAGE_SHIFT;
+#ifdef LOSCFG_FS_VFS
+    VM_OFFSET_T pgoff;
+#endif
+
+    if ((space == NULL) || (region == NULL) || (count == 0)) {
+        return LOS_ERRNO_VM_INVALID_ARGS;
+    }
+
+#ifdef LOSCFG_FS_VFS
+    if (LOS_IsRegionFileValid(region)) {
+        if (region->unTypeData.rf.vmFOps == NULL) {
+            return LOS_ERRNO_VM_INVALID_ARGS;
+        }
+        pgoff = ((vaddr - region->range.base) >> PAGE_SHIFT) + region->pgOff;
+        while (count > 0) {
+            region->unTypeData.rf.vmFOps->remove(region, &space->archMmu, pgoff);
+            pgoff++;
+            count--;
+        }
+        return LOS_OK;
+    }
+#endif
+#ifdef LOSCFG_KERNEL_SHM
+    if (OsIsShmRegion(region)) {//共享内存的页不会再缺页补回来
+        return LOS_ERRNO_VM_INVALID_ARGS;
+    }
+#endif
+    if (LOS_IsRegionTypeDev(region)) {
+        return LOS_ERRNO_VM_INVALID_ARGS;
+    }
+
+    OsAnonPagesRemove(&space->archMmu, vaddr, count);
+    return LOS_OK;
+}
+
 LosVmMapRegion *OsVmRegionDup(LosVmSpace *space, LosVmMapRegion *oldRegion, VADDR_T vaddr, size_t size)
 {
     LosVmMapRegion *newRegion = NULL;
@@ -881,6 +971,9 @@ INT32 OsUserHeapFree(LosVmSpace *vmSpace, VADDR_T addr, size_t len)
                 vmPage = LOS_VmPageGet(paddr);//获取物理页面信息
                 LOS_PhysPageFree(vmPage);//释放页
             }
+#ifdef LOSCFG_KERNEL_VM_ZRAM
+            OsZramEntryRelease(&vmSpace->archMmu, vaddr);//没映射的页可能换出到了压缩池
+#endif
             vaddr += PAGE_SIZE;
             len -= PAGE_SIZE;
         }
@@ -975,8 +1068,10 @@ STATUS_T LOS_VmSpaceFree(LosVmSpace *space)
     }
 
     /* pop it out of the global aspace list */
-    (VOID)LOS_MuxAcquire(&space->regionMux);
+    (VOID)LOS_MuxAcquire(&g_vmSpaceListMux);//回收和同页合并持着它遍历链表, 摘链也要持它
     LOS_ListDelete(&space->node);//从g_vmSpaceList链表里删除，g_vmSpaceList记录了所有空间节点。
+    (VOID)LOS_MuxRelease(&g_vmSpaceListMux);
+    (VOID)LOS_MuxAcquire(&space->regionMux);
 
     OsVmSpaceAllRegionFree(space);
 
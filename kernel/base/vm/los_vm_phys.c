@@ -69,6 +69,7 @@
 #include "los_vm_common.h"
 #include "los_vm_map.h"
 #include "los_vm_dump.h"
+#include "los_vm_filemap.h"
 #include "los_process_pri.h"
 
 
@@ -441,9 +442,26 @@ VOID OsVmPhysPagesFreeContiguous(LosVmPage *page, size_t nPages)
  *
  * @see
  */
+#ifdef LOSCFG_KERNEL_VM_KSWAPD
+/* 段内空闲页数, 调用者持有freeListLock */
+STATIC size_t OsVmPhysSegFreePagesLocked(const struct VmPhysSeg *seg)
+{
+    UINT32 order;
+    size_t freePages = 0;
+
+    for (order = 0; order < VM_LIST_ORDER_MAX; order++) {
+        freePages += (size_t)seg->freeList[order].listCnt << order;
+    }
+    return freePages;
+}
+#endif
+
 STATIC LosVmPage *OsVmPhysPagesGet(size_t nPages)
 {
     UINT32 intSave;
+#ifdef LOSCFG_KERNEL_VM_KSWAPD
+    size_t freePages;
+#endif
     struct VmPhysSeg *seg = NULL;
     LosVmPage *page = NULL;
     UINT32 segID;
@@ -456,10 +474,19 @@ STATIC LosVmPage *OsVmPhysPagesGet(size_t nPages)
             /*  */
             LOS_AtomicSet(&page->refCounts, 0);//设置引用次数为0
             page->nPages = nPages;//页数
+#ifdef LOSCFG_KERNEL_VM_KSWAPD
+            freePages = OsVmPhysSegFreePagesLocked(seg);
+#endif
             LOS_SpinUnlockRestore(&seg->freeListLock, intSave);
+#ifdef LOSCFG_KERNEL_VM_KSWAPD
+            OsKswapdWakeupCheck(segID, freePages);//跌破低水位就叫后台回收任务起来干活
+#endif
             return page;
         }
         LOS_SpinUnlockRestore(&seg->freeListLock, intSave);
+#ifdef LOSCFG_KERNEL_VM_KSWAPD
+        OsKswapdWakeupCheck(segID, 0);
+#endif
     }
     return NULL;
 }
@@ -534,6 +561,13 @@ VOID LOS_PhysPageFree(LosVmPage *page)
         seg = &g_vmPhysSeg[page->segID];
         LOS_SpinLockSave(&seg->freeListLock, &intSave);
 
+        OsCleanPageLazyFree(page);//标签不能带给下一个使用者
+#ifdef LOSCFG_KERNEL_VM_ZRAM
+        OsCleanPageReferenced(page);
+#endif
+#ifdef LOSCFG_KERNEL_VM_KSM
+        OsCleanPageKsm(page);
+#endif
         OsVmPhysPagesFreeContiguous(page, ONE_PAGE);//释放一页
         LOS_AtomicSet(&page->refCounts, 0);//只要物理内存被释放了,引用数就必须得重置为 0
 
@@ -546,6 +580,27 @@ LosVmPage *LOS_PhysPageAlloc(VOID)
     return OsVmPhysPagesGet(ONE_PAGE);//分配一页物理页
 }
 
+/*!
+ * @brief LOS_PhysSectionAlloc 申请1M对齐的连续物理内存, 给section映射使用
+ * 每一页都和 LOS_PhysPageAlloc 分到的页一样单独计数, 所以拆成小页后可以逐页 LOS_PhysPageFree
+ * @return 第一页, 失败返回NULL
+ */
+LosVmPage *LOS_PhysSectionAlloc(VOID)
+{
+    LosVmPage *page = OsVmPhysPagesGet(VM_SECTION_PAGES);//最大块在伙伴算法里天然按1M对齐
+    UINT32 index;
+
+    if (page == NULL) {
+        return NULL;
+    }
+
+    for (index = 0; index < VM_SECTION_PAGES; index++) {
+        LOS_AtomicSet(&page[index].refCounts, 0);
+        page[index].nPages = ONE_PAGE;
+    }
+    return page;
+}
+
 /*!
  * @brief LOS_PhysPagesAlloc 分配nPages页个物理页框,并将页框挂入list
  	\n 返回已分配的页面大小,不负责一定能分配到nPages的页框	
@@ -33,6 +33,11 @@
 
 #include "fs/file.h"
 #include "los_vm_filemap.h"
+#include "los_vm_lock.h"
+#include "los_vm_dump.h"
+#include "los_event.h"
+#include "los_init.h"
+#include "los_vm_zram.h"
 
 #ifdef LOSCFG_KERNEL_VM
 
@@ -289,17 +294,125 @@ int OsShrinkInactiveList(LosVmPhysSeg *physSeg, int nScan, LOS_DL_LIST *list)
     return nrReclaimed;
 }
 
+LosVmReclaimStat g_vmReclaimStat; ///< 页面回收统计
+
+/* 回收线性区内MADV_FREE过且之后没再写过的匿名页: 页仍是只读映射且只有本进程引用, 解除映射直接释放, 不用回写 */
+STATIC size_t OsShrinkLazyFreeRegion(LosVmSpace *space, LosVmMapRegion *region, size_t nPage)
+{
+    VADDR_T vaddr;
+    PADDR_T paddr = 0;
+    UINT32 mmuFlags = 0;
+    LosVmPage *page = NULL;
+    size_t nReclaimed = 0;
+    BOOL remain = FALSE;
+
+    for (vaddr = region->range.base; vaddr < (region->range.base + region->range.size); vaddr += PAGE_SIZE) {
+        if (LOS_ArchMmuQuery(&space->archMmu, vaddr, &paddr, &mmuFlags) != LOS_OK) {
+            continue;
+        }
+        page = LOS_VmPageGet(paddr);
+        if ((page == NULL) || !OsIsPageLazyFree(page)) {
+            continue;
+        }
+        if (mmuFlags & VM_MAP_REGION_FLAG_PERM_WRITE) {//被mprotect重新放开了写权限,当作已经撤销
+            OsCleanPageLazyFree(page);
+            continue;
+        }
+        if ((nReclaimed >= nPage) || (LOS_AtomicRead(&page->refCounts) != 1)) {//fork后还共享着的页等对方释放了再回收
+            remain = TRUE;
+            continue;
+        }
+        OsCleanPageLazyFree(page);
+        LOS_ArchMmuUnmap(&space->archMmu, vaddr, 1);
+        LOS_PhysPageFree(page);
+        nReclaimed++;
+    }
+
+    if (!remain) {
+        region->regionFlags &= ~VM_MAP_REGION_FLAG_LAZYFREE;
+    }
+    return nReclaimed;
+}
+
+/* 懒回收页不需要读写磁盘, 比页高速缓存更便宜, 收缩内存时先回收它们; 锁都用trylock, 持锁等内存的任务不会被卡死 */
+STATIC size_t OsShrinkLazyFreePages(size_t nPage)
+{
+    LosVmSpace *space = NULL;
+    LosVmMapRegion *region = NULL;
+    LosRbNode *pstRbNode = NULL;
+    LosRbNode *pstRbNodeNext = NULL;
+    size_t nReclaimed = 0;
+
+    if (LOS_MuxTrylock(OsGVmSpaceMuxGet()) != LOS_OK) {
+        return 0;
+    }
+    LOS_DL_LIST_FOR_EACH_ENTRY(space, LOS_GetVmSpaceList(), LosVmSpace, node) {
+        if (LOS_MuxTrylock(&space->regionMux) != LOS_OK) {
+            continue;
+        }
+        RB_SCAN_SAFE(&space->regionRbTree, pstRbNode, pstRbNodeNext)
+            region = (LosVmMapRegion *)pstRbNode;
+            if (region->regionFlags & VM_MAP_REGION_FLAG_LAZYFREE) {
+                nReclaimed += OsShrinkLazyFreeRegion(space, region, nPage - nReclaimed);
+            }
+            if (nReclaimed >= nPage) {
+                break;
+            }
+        RB_SCAN_SAFE_END(&space->regionRbTree, pstRbNode, pstRbNodeNext)
+        (VOID)LOS_MuxRelease(&space->regionMux);
+        if (nReclaimed >= nPage) {
+            break;
+        }
+    }
+    (VOID)LOS_MuxRelease(OsGVmSpaceMuxGet());
+    if (nReclaimed > 0) {
+        (VOID)LOS_AtomicAdd(&g_vmReclaimStat.lazyFree, (INT32)nReclaimed);
+    }
+
+    return nReclaimed;
+}
+
 #ifdef LOSCFG_FS_VFS
-int OsTryShrinkMemory(size_t nPage)//尝试收缩文件页
+/* 回收一个物理段的文件页: 非活动链表偏少时先老化活动链表, 脏页拷贝一份挂到dirtyList, 由调用者出锁后回写 */
+STATIC size_t OsShrinkPhysSeg(LosVmPhysSeg *physSeg, size_t nPage, LOS_DL_LIST *dirtyList)
 {
     UINT32 intSave;
-    size_t totalPages;
     size_t nReclaimed = 0;
-    LosVmPhysSeg *physSeg = NULL;
-    UINT32 index;
-    LOS_DL_LIST_HEAD(dirtyList);//初始化脏页链表,上面将挂所有脏页用于同步到磁盘后回收
+
+    LOS_SpinLockSave(&physSeg->lruLock, &intSave);
+    if ((physSeg->lruSize[VM_LRU_ACTIVE_FILE] + physSeg->lruSize[VM_LRU_INACTIVE_FILE]) >= VM_FILEMAP_MIN_SCAN) {
+        if (OsInactiveListIsLow(physSeg)) {
+            OsShrinkActiveList(physSeg, (nPage < VM_FILEMAP_MIN_SCAN) ? VM_FILEMAP_MIN_SCAN : nPage);//缩小活动页
+        }
+        nReclaimed = OsShrinkInactiveList(physSeg, nPage, dirtyList);//缩小未活动页,带出脏页链表
+    }
+    LOS_SpinUnlockRestore(&physSeg->lruLock, intSave);
+
+    return nReclaimed;
+}
+
+/* 把回收时拷贝出来的脏页回写磁盘, OsDoFlushDirtyPage会释放节点, 所以最后要重新初始化链表 */
+STATIC VOID OsFlushDirtyList(LOS_DL_LIST *dirtyList)
+{
     LosFilePage *fpage = NULL;
     LosFilePage *fnext = NULL;
+    UINT32 count = 0;
+
+    LOS_DL_LIST_FOR_EACH_ENTRY_SAFE(fpage, fnext, dirtyList, LosFilePage, node) {//遍历处理脏页数据
+        OsDoFlushDirtyPage(fpage);//冲洗脏页数据,将脏页数据回写磁盘
+        count++;
+    }
+    LOS_ListInit(dirtyList);
+    if (count > 0) {
+        (VOID)LOS_AtomicAdd(&g_vmReclaimStat.writeback, (INT32)count);
+    }
+}
+
+int OsTryShrinkMemory(size_t nPage)//尝试收缩文件页
+{
+    size_t nReclaimed;
+    UINT32 index;
+    LOS_DL_LIST_HEAD(dirtyList);//初始化脏页链表,上面将挂所有脏页用于同步到磁盘后回收
 
     if (nPage <= 0) {
         nPage = VM_FILEMAP_MIN_SCAN;//
@@ -309,37 +422,150 @@ int OsTryShrinkMemory(size_t nPage)//尝试收缩文件页
         nPage = VM_FILEMAP_MAX_SCAN;
     }
 
-    for (index = 0; index < g_vmPhysSegNum; index++) {//遍历整个物理段组
-        physSeg = &g_vmPhysSeg[index];//一段段来
-        LOS_SpinLockSave(&physSeg->lruLock, &intSave);
-        totalPages = physSeg->lruSize[VM_LRU_ACTIVE_FILE] + physSeg->lruSize[VM_LRU_INACTIVE_FILE];//统计所有文件页
-        if (totalPages < VM_FILEMAP_MIN_SCAN) {//文件页占用内存不多的情况下,怎么处理?
-            LOS_SpinUnlockRestore(&physSeg->lruLock, intSave);
-            continue;//放过这一段,找下一段
-        }
+    nReclaimed = OsShrinkLazyFreePages(nPage);
+    for (index = 0; (index < g_vmPhysSegNum) && (nReclaimed < nPage); index++) {//遍历整个物理段组
+        nReclaimed += OsShrinkPhysSeg(&g_vmPhysSeg[index], nPage, &dirtyList);
+    }
+    OsFlushDirtyList(&dirtyList);
+#ifdef LOSCFG_KERNEL_VM_ZRAM
+    if (nReclaimed < nPage) {//页高速缓存不够, 再把冷匿名页压缩换出
+        nReclaimed += OsZramSwapOut(nPage - nReclaimed);
+    }
+#endif
+    (VOID)LOS_AtomicAdd(&g_vmReclaimStat.stealDirect, (INT32)nReclaimed);
 
-        if (OsInactiveListIsLow(physSeg)) {
-            OsShrinkActiveList(physSeg, (nPage < VM_FILEMAP_MIN_SCAN) ? VM_FILEMAP_MIN_SCAN : nPage);//缩小活动页
-        }
+    return nReclaimed;
+}
 
-        nReclaimed += OsShrinkInactiveList(physSeg, nPage, &dirtyList);//缩小未活动页,带出脏页链表
-        LOS_SpinUnlockRestore(&physSeg->lruLock, intSave);
+#ifdef LOSCFG_KERNEL_VM_KSWAPD
+#define VM_KSWAPD_BATCH         VM_FILEMAP_MIN_SCAN ///< 每轮回收的页数, 限制持lru锁关中断的时长
+#define VM_KSWAPD_EVENT         0x01
+#define VM_KSWAPD_PER_MILLE     1000
+
+/// 每个物理段一个后台回收任务
+typedef struct {
+    LosVmPhysSeg    *physSeg;
+    size_t          wmarkLow;   ///< 空闲页低于它就唤醒回收
+    size_t          wmarkHigh;  ///< 回收到空闲页高于它就停
+    EVENT_CB_S      event;
+    Atomic          pending;    ///< 事件已写还没被回收任务读走, 分配路径不用重复写事件
+    BOOL            ready;
+    CHAR            name[OS_TCB_NAME_LEN];
+} VmKswapd;
+
+STATIC VmKswapd g_kswapd[VM_PHYS_SEG_MAX];
+
+/* 分配路径调用: 段内空闲页跌破低水位时唤醒该段的回收任务, 不在这里回收 */
+VOID OsKswapdWakeupCheck(UINT32 segID, size_t freePages)
+{
+    VmKswapd *kswapd = &g_kswapd[segID];
 
-        if (nReclaimed >= nPage) {//够了,够了,达到目的了.
-            break;//退出收缩
+    if (!kswapd->ready || (freePages >= kswapd->wmarkLow)) {
+        return;
+    }
+    if (LOS_AtomicCmpXchg32bits(&kswapd->pending, 1, 0)) {//已经唤醒过了
+        return;
+    }
+    LOS_AtomicInc(&g_vmReclaimStat.kswapdWakeups);
+    (VOID)LOS_EventWrite(&kswapd->event, VM_KSWAPD_EVENT);
+}
+
+/* 一批一批地回收到高水位, 连续几轮都回收不到就睡, 等下次跌破低水位 */
+STATIC VOID OsKswapdTask(UINTPTR segID)
+{
+    VmKswapd *kswapd = &g_kswapd[segID];
+    LOS_DL_LIST_HEAD(dirtyList);
+    size_t nReclaimed;
+    UINT32 idleRounds;
+
+    while (1) {
+        (VOID)LOS_EventRead(&kswapd->event, VM_KSWAPD_EVENT, LOS_WAITMODE_OR | LOS_WAITMODE_CLR, LOS_WAIT_FOREVER);
+        /*
+         * 读走事件后马上清标志, 回收期间再跌破低水位的分配会重新写事件, 事件位会保留到下次读,
+         * 不会出现回收结束后清标志之前的唤醒被丢掉, 而回收任务又睡下去的情况
+         */
+        LOS_AtomicSet(&kswapd->pending, 0);
+        idleRounds = 0;
+        while ((OsVmPhySegPagesGet(kswapd->physSeg) < kswapd->wmarkHigh) &&
+               (idleRounds < MAX_SHRINK_PAGECACHE_TRY)) {
+            nReclaimed = OsShrinkLazyFreePages(VM_KSWAPD_BATCH);
+            nReclaimed += OsShrinkPhysSeg(kswapd->physSeg, VM_KSWAPD_BATCH, &dirtyList);
+            OsFlushDirtyList(&dirtyList);
+#ifdef LOSCFG_KERNEL_VM_ZRAM
+            if ((nReclaimed == 0) && (idleRounds > 0)) {//页高速缓存已经回收不动了, 再换出冷匿名页
+                nReclaimed = OsZramSwapOut(VM_KSWAPD_BATCH);
+            }
+#endif
+            if (nReclaimed == 0) {//第一轮可能只是把活动页老化到非活动链表
+                idleRounds++;
+                continue;
+            }
+            idleRounds = 0;
+            (VOID)LOS_AtomicAdd(&g_vmReclaimStat.stealKswapd, (INT32)nReclaimed);
+            (VOID)LOS_TaskYield();
         }
     }
+}
 
-    LOS_DL_LIST_FOR_EACH_ENTRY_SAFE(fpage, fnext, &dirtyList, LosFilePage, node) {//遍历处理脏页数据
-        OsDoFlushDirtyPage(fpage);//冲洗脏页数据,将脏页数据回写磁盘
+VOID OsKswapdWmarkGet(size_t *wmarkLow, size_t *wmarkHigh)
+{
+    UINT32 index;
+
+    *wmarkLow = 0;
+    *wmarkHigh = 0;
+    for (index = 0; index < g_vmPhysSegNum; index++) {
+        *wmarkLow += g_kswapd[index].wmarkLow;
+        *wmarkHigh += g_kswapd[index].wmarkHigh;
     }
+}
 
-    return nReclaimed;
+STATIC UINT32 OsKswapdInit(VOID)
+{
+    UINT32 ret;
+    UINT32 index;
+    UINT32 taskID;
+    VmKswapd *kswapd = NULL;
+    TSK_INIT_PARAM_S taskInitParam;
+
+    for (index = 0; index < g_vmPhysSegNum; index++) {
+        kswapd = &g_kswapd[index];
+        kswapd->physSeg = &g_vmPhysSeg[index];
+        if (kswapd->physSeg->size == 0) {
+            continue;
+        }
+        kswapd->wmarkLow = (kswapd->physSeg->size >> PAGE_SHIFT) * LOSCFG_KERNEL_VM_KSWAPD_WMARK_LOW /
+                           VM_KSWAPD_PER_MILLE;
+        if (kswapd->wmarkLow < VM_KSWAPD_BATCH) {
+            kswapd->wmarkLow = VM_KSWAPD_BATCH;
+        }
+        kswapd->wmarkHigh = kswapd->wmarkLow << 1;
+        ret = LOS_EventInit(&kswapd->event);
+        if (ret != LOS_OK) {
+            return ret;
+        }
+
+        (VOID)snprintf_s(kswapd->name, OS_TCB_NAME_LEN, OS_TCB_NAME_LEN - 1, "Kswapd%u", index);
+        (VOID)memset_s(&taskInitParam, sizeof(TSK_INIT_PARAM_S), 0, sizeof(TSK_INIT_PARAM_S));
+        taskInitParam.pfnTaskEntry = (TSK_ENTRY_FUNC)OsKswapdTask;
+        taskInitParam.usTaskPrio = LOSCFG_BASE_CORE_TSK_DEFAULT_PRIO;
+        taskInitParam.pcName = kswapd->name;
+        taskInitParam.uwStackSize = LOSCFG_BASE_CORE_TSK_DEFAULT_STACK_SIZE;
+        taskInitParam.auwArgs[0] = index;
+        ret = LOS_TaskCreate(&taskID, &taskInitParam);
+        if (ret != LOS_OK) {
+            return ret;
+        }
+        kswapd->ready = TRUE;
+    }
+    return LOS_OK;
 }
+
+LOS_MODULE_INIT(OsKswapdInit, LOS_INIT_LEVEL_KMOD_TASK);
+#endif
 #else
 int OsTryShrinkMemory(size_t nPage)
 {
-    return 0;
+    return OsShrinkLazyFreePages((nPage == 0) ? VM_FILEMAP_MIN_SCAN : nPage);
 }
 #endif
 #endif
@@ -380,6 +380,7 @@ INT32 LOS_DoMprotect(VADDR_T vaddr, size_t len, unsigned long prot)
     vmFlags = OsCvtProtFlagsToRegionFlags(prot, 0);//转换FLAGS
     vmFlags |= (region->regionFlags & VM_MAP_REGION_FLAG_SHARED) ? VM_MAP_REGION_FLAG_SHARED : 0;
     vmFlags |= OsInheritOldRegionName(region->regionFlags);
+    vmFlags |= region->regionFlags & VM_MAP_REGION_FLAG_MADV_MASK;
     region = LOS_RegionFind(space, vaddr);
     if (region == NULL) {
         ret = -ENOMEM;
@@ -406,6 +407,118 @@ OUT_MPROTECT:
     return ret;
 }
 
+/* MADV_FREE: 把已映射的私有匿名页改成只读并贴上懒回收标签, 内存紧张时直接回收, 回收前被写过就撤销 */
+STATIC INT32 OsMadviseFree(LosVmSpace *space, LosVmMapRegion *region, VADDR_T vaddr, size_t len)
+{
+    VADDR_T end = vaddr + len;
+    PADDR_T paddr = 0;
+    LosVmPage *page = NULL;
+
+    if (LOS_IsRegionTypeFile(region) || LOS_IsRegionTypeDev(region) ||
+        (region->regionFlags & (VM_MAP_REGION_FLAG_SHARED | VM_MAP_REGION_FLAG_SHM | VM_MAP_REGION_FLAG_VDSO))) {
+        return -EINVAL;
+    }
+
+    for (; vaddr < end; vaddr += PAGE_SIZE) {
+        if (OsArchMmuIsSection(&space->archMmu, vaddr)) {//section映射的大页不做懒回收
+            continue;
+        }
+        if (LOS_ArchMmuQuery(&space->archMmu, vaddr, &paddr, NULL) != LOS_OK) {
+            continue;
+        }
+        page = LOS_VmPageGet(paddr);
+        if ((page == NULL) || (LOS_AtomicRead(&page->refCounts) != 1)) {
+            continue;
+        }
+        if (LOS_ArchMmuChangeProt(&space->archMmu, vaddr, 1,
+                                  region->regionFlags & (~VM_MAP_REGION_FLAG_PERM_WRITE)) < 0) {
+            continue;
+        }
+        OsSetPageLazyFree(page);
+        region->regionFlags |= VM_MAP_REGION_FLAG_LAZYFREE;
+    }
+    return LOS_OK;
+}
+
+/*!
+ * @brief 系统调用|给内核访问方式的建议, [vaddr, vaddr + len)必须落在同一个线性区内
+ * @param advice MADV_NORMAL/MADV_SEQUENTIAL/MADV_RANDOM: 设置整个线性区的访问方式, 影响fault-around和预读
+ *        \n MADV_WILLNEED: 文件映射把该范围异步读进页高速缓存
+ *        \n MADV_DONTNEED: 立即丢掉该范围的页但保留线性区, 再访问时匿名页为全0, 文件页重新从文件读
+ *        \n MADV_FREE: 私有匿名页延迟到内存紧张时回收, 在那之前写过的页保持不变
+ * @return INT32 成功返回0, 失败返回负的错误码
+ */
+INT32 LOS_DoMadvise(VADDR_T vaddr, size_t len, INT32 advice)
+{
+    LosVmSpace *space = OsCurrProcessGet()->vmSpace;
+    LosVmMapRegion *region = NULL;
+    VM_OFFSET_T pgoff;
+    INT32 ret = LOS_OK;
+
+    if (!IS_ALIGNED(vaddr, PAGE_SIZE) || ((vaddr + len) < vaddr)) {
+        return -EINVAL;
+    }
+    len = LOS_Align(len, PAGE_SIZE);
+    if (len == 0) {
+        return LOS_OK;
+    }
+    if (!LOS_IsUserAddressRange(vaddr, len)) {
+        return -ENOMEM;
+    }
+
+    (VOID)LOS_MuxAcquire(&space->regionMux);
+    region = LOS_RegionFind(space, vaddr);
+    if (region == NULL) {
+        ret = -ENOMEM;
+        goto OUT_MADVISE;
+    }
+    /* can't operation cross region */
+    if ((region->range.base + region->range.size) < (vaddr + len)) {
+        ret = -EINVAL;
+        goto OUT_MADVISE;
+    }
+
+    switch (advice) {
+        case MADV_NORMAL:
+            region->regionFlags &= ~(VM_MAP_REGION_FLAG_SEQUENTIAL | VM_MAP_REGION_FLAG_RANDOM);
+            break;
+        case MADV_SEQUENTIAL:
+            region->regionFlags &= ~VM_MAP_REGION_FLAG_RANDOM;
+            region->regionFlags |= VM_MAP_REGION_FLAG_SEQUENTIAL;
+            break;
+        case MADV_RANDOM:
+            region->regionFlags &= ~VM_MAP_REGION_FLAG_SEQUENTIAL;
+            region->regionFlags |= VM_MAP_REGION_FLAG_RANDOM;
+            break;
+        case MADV_WILLNEED:
+#ifdef LOSCFG_FS_VFS
+            if (LOS_IsRegionFileValid(region)) {//匿名页本来就是缺页时清零分配,没有可预读的
+                pgoff = ((vaddr - region->range.base) >> PAGE_SHIFT) + region->pgOff;
+                OsFileReadaheadAsync(region->unTypeData.rf.vnode, pgoff, len >> PAGE_SHIFT);
+            }
+#else
+            (VOID)pgoff;
+#endif
+            break;
+        case MADV_DONTNEED:
+            if ((region->regionFlags & VM_MAP_REGION_FLAG_VDSO) ||
+                (OsRegionPagesDrop(space, region, vaddr, len) != LOS_OK)) {
+                ret = -EINVAL;
+            }
+            break;
+        case MADV_FREE:
+            ret = OsMadviseFree(space, region, vaddr, len);
+            break;
+        default:
+            ret = -EINVAL;
+            break;
+    }
+
+OUT_MADVISE:
+    (VOID)LOS_MuxRelease(&space->regionMux);
+    return ret;
+}
+
 STATUS_T OsMremapCheck(VADDR_T addr, size_t oldLen, VADDR_T newAddr, size_t newLen, unsigned int flags)
 {
     LosVmSpace *space = OsCurrProcessGet()->vmSpace;
@@ -0,0 +1,448 @@
+/*
+ * Copyright (c) 2013-2019 Huawei Technologies Co., Ltd. All rights reserved.
+ * Copyright (c) 2020-2021 Huawei Device Co., Ltd. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of
+ *    conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list
+ *    of conditions and the following disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used
+ *    to endorse or promote products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "los_vm_zram.h"
+
+#ifdef LOSCFG_KERNEL_VM_ZRAM
+#include "zlib.h"
+#include "los_vm_filemap.h"
+#include "los_vm_lock.h"
+#include "los_vm_page.h"
+#include "los_vm_phys.h"
+#include "los_memory.h"
+#include "los_tick.h"
+#include "los_init.h"
+
+#define VM_ZRAM_MAX_COMPR   (PAGE_SIZE - (PAGE_SIZE >> 2))  ///< 压缩后超过3/4页就不值得换出了
+#define VM_ZRAM_WBITS       12  ///< 一次只压一页, 4K的窗口足够, 省下deflate的工作内存
+#define VM_ZRAM_MEMLEVEL    5
+
+/// 压缩池里的一个槽, 槽号+1就是页表项里的交换项, 0留给"没有交换项"
+typedef struct {
+    VOID    *data;  ///< 压缩后的数据
+    UINT16  size;   ///< 压缩后的字节数
+    UINT16  refs;   ///< 指向这个槽的页表项数, fork后父子进程共享
+} VmZramSlot;
+
+typedef struct {
+    VmZramSlot      *slots;
+    UINT32          *freeStack;     ///< 空闲槽号栈
+    UINT32          freeTop;
+    SPIN_LOCK_S     lock;           ///< 保护槽和统计
+    LosMux          deflateMux;     ///< 非递归锁: 换出路径里分配内存又递归进回收时trylock会失败, 不会重入
+    LosMux          inflateMux;
+    z_stream        deflate;        ///< 压缩流和解压流初始化时分配好工作内存, 回收路径上不再为它们申请内存
+    z_stream        inflate;
+    UINT8           *buf;           ///< 压缩输出缓冲, 持deflateMux使用
+    LosVmZramStat   stat;
+    BOOL            ready;
+} VmZram;
+
+STATIC VmZram g_zram;
+
+STATIC voidpf OsZramZalloc(voidpf opaque, uInt items, uInt size)
+{
+    (VOID)opaque;
+    return LOS_MemAlloc(m_aucSysMem0, items * size);
+}
+
+STATIC VOID OsZramZfree(voidpf opaque, voidpf address)
+{
+    (VOID)opaque;
+    (VOID)LOS_MemFree(m_aucSysMem0, address);
+}
+
+STATIC UINT32 OsZramSlotAlloc(VOID)
+{
+    UINT32 intSave;
+    UINT32 index;
+
+    LOS_SpinLockSave(&g_zram.lock, &intSave);
+    if (g_zram.freeTop == 0) {
+        LOS_SpinUnlockRestore(&g_zram.lock, intSave);
+        return 0;
+    }
+    index = g_zram.freeStack[--g_zram.freeTop];
+    g_zram.slots[index].data = NULL;
+    g_zram.slots[index].size = 0;
+    g_zram.slots[index].refs = 1;
+    LOS_SpinUnlockRestore(&g_zram.lock, intSave);
+    return index + 1;
+}
+
+/// 减一个引用, 最后一个引用走了才释放压缩数据并把槽还回空闲栈
+STATIC VOID OsZramSlotPut(UINT32 entry)
+{
+    UINT32 intSave;
+    VmZramSlot *slot = &g_zram.slots[entry - 1];
+    VOID *data = NULL;
+
+    LOS_SpinLockSave(&g_zram.lock, &intSave);
+    if (--slot->refs > 0) {
+        LOS_SpinUnlockRestore(&g_zram.lock, intSave);
+        return;
+    }
+    data = slot->data;
+    if (data != NULL) {
+        g_zram.stat.storedPages--;
+        g_zram.stat.comprBytes -= slot->size;
+    }
+    slot->data = NULL;
+    g_zram.freeStack[g_zram.freeTop++] = entry - 1;
+    LOS_SpinUnlockRestore(&g_zram.lock, intSave);
+
+    if (data != NULL) {
+        (VOID)LOS_MemFree(m_aucSysMem0, data);
+    }
+}
+
+/// 压到buf里, 返回压缩后的字节数, 超过VM_ZRAM_MAX_COMPR返回0, 调用者持deflateMux
+STATIC UINT32 OsZramCompress(const VOID *src)
+{
+    z_stream *strm = &g_zram.deflate;
+
+    (VOID)deflateReset(strm);
+    strm->next_in = (Bytef *)src;
+    strm->avail_in = PAGE_SIZE;
+    strm->next_out = g_zram.buf;
+    strm->avail_out = VM_ZRAM_MAX_COMPR;
+    if (deflate(strm, Z_FINISH) != Z_STREAM_END) {
+        return 0;
+    }
+    return VM_ZRAM_MAX_COMPR - strm->avail_out;
+}
+
+STATIC STATUS_T OsZramDecompress(const VmZramSlot *slot, VOID *dst)
+{
+    z_stream *strm = &g_zram.inflate;
+    INT32 ret;
+
+    (VOID)LOS_MuxAcquire(&g_zram.inflateMux);
+    (VOID)inflateReset(strm);
+    strm->next_in = (Bytef *)slot->data;
+    strm->avail_in = slot->size;
+    strm->next_out = (Bytef *)dst;
+    strm->avail_out = PAGE_SIZE;
+    ret = inflate(strm, Z_FINISH);
+    (VOID)LOS_MuxRelease(&g_zram.inflateMux);
+    if ((ret != Z_STREAM_END) || (strm->avail_out != 0)) {
+        return LOS_NOK;
+    }
+    return LOS_OK;
+}
+
+/*
+ * 换出一页: 先把页表项换成交换项并刷TLB, 同进程其他线程再访问会缺页并等在regionMux上,
+ * 压缩时页里的数据不会再变; 压缩失败就按原来的属性映射回去
+ */
+STATIC STATUS_T OsZramPageStore(LosArchMmu *archMmu, VADDR_T vaddr, LosVmPage *page, UINT32 mmuFlags)
+{
+    UINT32 intSave;
+    UINT32 entry;
+    UINT32 size;
+    VOID *data = NULL;
+    VmZramSlot *slot = NULL;
+
+    entry = OsZramSlotAlloc();
+    if (entry == 0) {
+        return LOS_ERRNO_VM_NO_MEMORY;
+    }
+    if (LOS_ArchMmuSwapEntrySet(archMmu, vaddr, entry) != LOS_OK) {
+        OsZramSlotPut(entry);
+        return LOS_NOK;
+    }
+
+    size = OsZramCompress(OsVmPageToVaddr(page));
+    if (size != 0) {
+        data = LOS_MemAlloc(m_aucSysMem0, size);
+    }
+    if (data == NULL) {
+        (VOID)LOS_ArchMmuMap(archMmu, vaddr, VM_PAGE_TO_PHYS(page), 1, mmuFlags);
+        OsZramSlotPut(entry);
+        if (size == 0) {
+            LOS_SpinLockSave(&g_zram.lock, &intSave);
+            g_zram.stat.rejected++;
+            LOS_SpinUnlockRestore(&g_zram.lock, intSave);
+        }
+        return LOS_NOK;
+    }
+    (VOID)memcpy_s(data, size, g_zram.buf, size);
+
+    slot = &g_zram.slots[entry - 1];
+    LOS_SpinLockSave(&g_zram.lock, &intSave);
+    slot->data = data;
+    slot->size = (UINT16)size;
+    g_zram.stat.storedPages++;
+    g_zram.stat.comprBytes += size;
+    g_zram.stat.swapOut++;
+    LOS_SpinUnlockRestore(&g_zram.lock, intSave);
+    return LOS_OK;
+}
+
+/// 只换出进程私有的匿名内存(堆,栈,私有匿名映射), 文件,设备,共享内存都有各自的归宿
+STATIC BOOL OsZramRegionSwappable(LosVmMapRegion *region)
+{
+    if (LOS_IsRegionTypeFile(region) || LOS_IsRegionTypeDev(region) ||
+        (region->regionFlags & (VM_MAP_REGION_FLAG_SHARED | VM_MAP_REGION_FLAG_SHM | VM_MAP_REGION_FLAG_VDSO))) {
+        return FALSE;
+    }
+    return LOS_IsUserAddress(region->range.base);
+}
+
+/*
+ * 短描述符页表没有硬件访问位, 用软件的二次机会: 缺页和换入时给页打上引用标签,
+ * 扫描到带标签的页只摘掉标签, 下一轮扫描时还没被重新打上标签的才算冷页
+ */
+STATIC size_t OsZramSwapOutRegion(LosVmSpace *space, LosVmMapRegion *region, size_t nPage)
+{
+    VADDR_T vaddr;
+    PADDR_T paddr = 0;
+    UINT32 mmuFlags = 0;
+    LosVmPage *page = NULL;
+    size_t nSwapped = 0;
+
+    for (vaddr = region->range.base; (vaddr < (region->range.base + region->range.size)) && (nSwapped < nPage);
+         vaddr += PAGE_SIZE) {
+        if (OsArchMmuIsSection(&space->archMmu, vaddr)) {//section映射的大页不换出
+            continue;
+        }
+        if (LOS_ArchMmuQuery(&space->archMmu, vaddr, &paddr, &mmuFlags) != LOS_OK) {
+            continue;
+        }
+        page = LOS_VmPageGet(paddr);
+        if ((page == NULL) || (LOS_AtomicRead(&page->refCounts) != 1) || OsIsPageLazyFree(page)) {
+            continue;//写时拷贝共享着的页没有反向映射, 换不干净; 懒回收页直接丢比压缩便宜
+        }
+        if (OsIsPageReferenced(page)) {
+            OsCleanPageReferenced(page);
+            continue;
+        }
+        if (OsZramPageStore(&space->archMmu, vaddr, page, mmuFlags) == LOS_OK) {
+            LOS_PhysPageFree(page);
+            nSwapped++;
+        }
+    }
+    return nSwapped;
+}
+
+/*
+ * 回收路径调用: 轮流从各用户进程换出冷匿名页, 处理过的空间挪到链表尾, 下次从别的进程开始.
+ * 锁都用trylock, 可能在OOM的自旋锁里被调到, 也可能在内核堆扩容时递归进来
+ */
+size_t OsZramSwapOut(size_t nPage)
+{
+    LOS_DL_LIST *spaceList = LOS_GetVmSpaceList();
+    LosVmSpace *space = NULL;
+    LosVmMapRegion *region = NULL;
+    LosRbNode *pstRbNode = NULL;
+    LosRbNode *pstRbNodeNext = NULL;
+    size_t nSwapped = 0;
+    UINT32 count = 0;
+
+    if (!g_zram.ready || (LOS_MuxTrylock(&g_zram.deflateMux) != LOS_OK)) {
+        return 0;
+    }
+    if (LOS_MuxTrylock(OsGVmSpaceMuxGet()) != LOS_OK) {
+        (VOID)LOS_MuxRelease(&g_zram.deflateMux);
+        return 0;
+    }
+
+    LOS_DL_LIST_FOR_EACH_ENTRY(space, spaceList, LosVmSpace, node) {
+        count++;
+    }
+    for (; (count > 0) && (nSwapped < nPage); count--) {
+        space = LOS_DL_LIST_ENTRY(spaceList->pstNext, LosVmSpace, node);
+        LOS_ListDelete(&space->node);
+        LOS_ListTailInsert(spaceList, &space->node);
+        if ((space == LOS_GetKVmSpace()) || (space == LOS_GetVmallocSpace()) || (space == LOS_CurrSpaceGet())) {
+            continue;
+        }
+        if (LOS_MuxTrylock(&space->regionMux) != LOS_OK) {
+            continue;
+        }
+        RB_SCAN_SAFE(&space->regionRbTree, pstRbNode, pstRbNodeNext)
+            region = (LosVmMapRegion *)pstRbNode;
+            if (OsZramRegionSwappable(region)) {
+                nSwapped += OsZramSwapOutRegion(space, region, nPage - nSwapped);
+            }
+            if (nSwapped >= nPage) {
+                break;
+            }
+        RB_SCAN_SAFE_END(&space->regionRbTree, pstRbNode, pstRbNodeNext)
+        (VOID)LOS_MuxRelease(&space->regionMux);
+    }
+
+    (VOID)LOS_MuxRelease(OsGVmSpaceMuxGet());
+    (VOID)LOS_MuxRelease(&g_zram.deflateMux);
+    return nSwapped;
+}
+
+/*!
+ * @brief OsZramSwapIn 缺页时把换出的页解压回来, 调用者持有space->regionMux
+ * @return LOS_ERRNO_VM_NOT_FOUND 该地址不是换出页, 走普通的缺页流程
+ */
+STATUS_T OsZramSwapIn(LosVmSpace *space, LosVmMapRegion *region, VADDR_T vaddr)
+{
+    UINT64 start = LOS_CurrNanosec();
+    UINT64 cost;
+    UINT32 intSave;
+    UINT32 entry;
+    LosVmPage *page = NULL;
+
+    if (LOS_ArchMmuSwapEntryGet(&space->archMmu, vaddr, &entry) != LOS_OK) {
+        return LOS_ERRNO_VM_NOT_FOUND;
+    }
+    if ((entry == 0) || (entry > LOSCFG_KERNEL_VM_ZRAM_PAGES)) {
+        VM_ERR("bad swap entry %#x, vaddr %#x", entry, vaddr);
+        return LOS_ERRNO_VM_FAULT;
+    }
+
+    page = LOS_PhysPageAlloc();
+    if (page == NULL) {
+        return LOS_ERRNO_VM_NO_MEMORY;
+    }
+    /* 本页表项还持有槽的引用, 别的进程换入只会减它们自己的引用, 这里读槽不用加锁 */
+    if (OsZramDecompress(&g_zram.slots[entry - 1], OsVmPageToVaddr(page)) != LOS_OK) {
+        VM_ERR("decompress swap entry %#x failed, vaddr %#x", entry, vaddr);
+        LOS_PhysPageFree(page);
+        return LOS_ERRNO_VM_FAULT;
+    }
+
+    LOS_AtomicInc(&page->refCounts);
+    OsSetPageReferenced(page);
+    if (LOS_ArchMmuMap(&space->archMmu, vaddr, VM_PAGE_TO_PHYS(page), 1, region->regionFlags) < 0) {
+        LOS_PhysPageFree(page);
+        return LOS_ERRNO_VM_MAP_FAILED;
+    }
+    OsZramSlotPut(entry);
+
+    cost = LOS_CurrNanosec() - start;
+    LOS_SpinLockSave(&g_zram.lock, &intSave);
+    g_zram.stat.swapIn++;
+    g_zram.stat.faultNsTotal += cost;
+    if (cost > g_zram.stat.faultNsMax) {
+        g_zram.stat.faultNsMax = cost;
+    }
+    LOS_SpinUnlockRestore(&g_zram.lock, intSave);
+    return LOS_OK;
+}
+
+/// fork时子进程的页表项指向同一个槽, 各自换入时各自解压出一份
+VOID OsZramEntryDup(LosArchMmu *oldArchMmu, LosArchMmu *newArchMmu, VADDR_T vaddr)
+{
+    UINT32 intSave;
+    UINT32 entry;
+
+    if (LOS_ArchMmuSwapEntryGet(oldArchMmu, vaddr, &entry) != LOS_OK) {
+        return;
+    }
+    LOS_SpinLockSave(&g_zram.lock, &intSave);
+    g_zram.slots[entry - 1].refs++;
+    LOS_SpinUnlockRestore(&g_zram.lock, intSave);
+    if (LOS_ArchMmuSwapEntrySet(newArchMmu, vaddr, entry) != LOS_OK) {
+        OsZramSlotPut(entry);
+    }
+}
+
+/// 解除映射时清掉交换项并放掉槽的引用
+VOID OsZramEntryRelease(LosArchMmu *archMmu, VADDR_T vaddr)
+{
+    UINT32 entry;
+
+    if (LOS_ArchMmuSwapEntryGet(archMmu, vaddr, &entry) != LOS_OK) {
+        return;
+    }
+    (VOID)LOS_ArchMmuSwapEntrySet(archMmu, vaddr, 0);
+    OsZramSlotPut(entry);
+}
+
+VOID OsZramStatGet(LosVmZramStat *stat)
+{
+    UINT32 intSave;
+
+    LOS_SpinLockSave(&g_zram.lock, &intSave);
+    *stat = g_zram.stat;
+    LOS_SpinUnlockRestore(&g_zram.lock, intSave);
+}
+
+STATIC UINT32 OsZramInit(VOID)
+{
+    UINT32 index;
+    LosMuxAttr attr;
+
+    g_zram.slots = LOS_MemAlloc(m_aucSysMem0, LOSCFG_KERNEL_VM_ZRAM_PAGES * sizeof(VmZramSlot));
+    g_zram.freeStack = LOS_MemAlloc(m_aucSysMem0, LOSCFG_KERNEL_VM_ZRAM_PAGES * sizeof(UINT32));
+    g_zram.buf = LOS_MemAlloc(m_aucSysMem0, VM_ZRAM_MAX_COMPR);
+    if ((g_zram.slots == NULL) || (g_zram.freeStack == NULL) || (g_zram.buf == NULL)) {
+        goto ERR_FREE;
+    }
+    (VOID)memset_s(g_zram.slots, LOSCFG_KERNEL_VM_ZRAM_PAGES * sizeof(VmZramSlot), 0,
+                   LOSCFG_KERNEL_VM_ZRAM_PAGES * sizeof(VmZramSlot));
+    for (index = 0; index < LOSCFG_KERNEL_VM_ZRAM_PAGES; index++) {
+        g_zram.freeStack[index] = LOSCFG_KERNEL_VM_ZRAM_PAGES - 1 - index;
+    }
+    g_zram.freeTop = LOSCFG_KERNEL_VM_ZRAM_PAGES;
+
+    g_zram.deflate.zalloc = OsZramZalloc;
+    g_zram.deflate.zfree = OsZramZfree;
+    g_zram.deflate.opaque = Z_NULL;
+    if (deflateInit2(&g_zram.deflate, Z_BEST_SPEED, Z_DEFLATED, -VM_ZRAM_WBITS, VM_ZRAM_MEMLEVEL,
+                     Z_DEFAULT_STRATEGY) != Z_OK) {
+        goto ERR_FREE;
+    }
+    g_zram.inflate.zalloc = OsZramZalloc;
+    g_zram.inflate.zfree = OsZramZfree;
+    g_zram.inflate.opaque = Z_NULL;
+    g_zram.inflate.next_in = Z_NULL;
+    g_zram.inflate.avail_in = 0;
+    if (inflateInit2(&g_zram.inflate, -VM_ZRAM_WBITS) != Z_OK) {
+        (VOID)deflateEnd(&g_zram.deflate);
+        goto ERR_FREE;
+    }
+
+    (VOID)LOS_MuxAttrInit(&attr);
+    (VOID)LOS_MuxAttrSetType(&attr, LOS_MUX_NORMAL);
+    (VOID)LOS_MuxInit(&g_zram.deflateMux, &attr);
+    (VOID)LOS_MuxInit(&g_zram.inflateMux, NULL);
+    LOS_SpinInit(&g_zram.lock);
+    g_zram.stat.totalPages = LOSCFG_KERNEL_VM_ZRAM_PAGES;
+    g_zram.ready = TRUE;
+    return LOS_OK;
+
+ERR_FREE:
+    (VOID)LOS_MemFree(m_aucSysMem0, g_zram.slots);
+    (VOID)LOS_MemFree(m_aucSysMem0, g_zram.freeStack);
+    (VOID)LOS_MemFree(m_aucSysMem0, g_zram.buf);
+    return LOS_ERRNO_VM_NO_MEMORY;
+}
+
+LOS_MODULE_INIT(OsZramInit, LOS_INIT_LEVEL_KMOD_EXTENDED);
+#endif
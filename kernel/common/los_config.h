@@ -272,6 +272,23 @@ extern UINT32 __heap_end;		///< 堆区结束地址
 #define LOSCFG_BASE_IPC_MUX
 #endif
 
+/**
+ * @ingroup los_config
+ * Maximum cycles a task spins on a mutex whose owner is running on another core before it pends, 0: never spin
+ */
+#ifndef LOSCFG_BASE_IPC_MUX_SPIN_CYCLES
+#define LOSCFG_BASE_IPC_MUX_SPIN_CYCLES 20000 //自适应互斥锁的自旋预算
+#endif
+
+/****************************** Rwlock module configuration ******************************/
+/**
+ * @ingroup los_config
+ * Configuration item for rwlock module tailoring
+ */
+#ifndef LOSCFG_BASE_IPC_RWLOCK
+#define LOSCFG_BASE_IPC_RWLOCK
+#endif
+
 /****************************** Queue module configuration ********************************/
 /**
  * @ingroup los_config
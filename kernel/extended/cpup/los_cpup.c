@@ -115,6 +115,7 @@
 #include "los_base.h"
 #include "los_init.h"
 #include "los_process_pri.h"
+#include "los_percpu_pri.h"
 #include "los_swtmr.h"
 
 
@@ -135,6 +136,23 @@ LITE_OS_SEC_BSS STATIC UINT64 cpupIntTimeStart[LOSCFG_KERNEL_CORE_NUM];
 
 #define INVALID_ID ((UINT32)-1)
 
+/*
+ * 每个CPU一份的时间累加器. 只有本CPU在关中断时写(任务切换,中断退出),
+ * 写前后各把 seq 加一, 读者不拿任何锁, seq 为奇数或前后不一致就重读.
+ */
+typedef struct {
+    volatile UINT32 seq;
+    UINT32 curTaskID;   /* task running on this CPU */
+    UINT64 sliceStart;  /* start of the running time slice */
+    UINT64 userTime;
+    UINT64 sysTime;
+    UINT64 irqTime;
+    UINT64 softirqTime; /* software timer task */
+    UINT64 idleTime;
+} __attribute__((aligned(64))) OsCpupCpuTime;
+
+LITE_OS_SEC_BSS STATIC OsCpupCpuTime g_cpupCpuTime[LOSCFG_KERNEL_CORE_NUM];
+
 #define OS_CPUP_UNUSED 0x0U
 #define OS_CPUP_USED   0x1U
 #define HIGH_BITS 32
@@ -163,6 +181,101 @@ STATIC UINT64 OsGetCpuCycle(VOID)
     return (cycles - cpupStartCycles);
 }
 
+STATIC INLINE VOID OsCpupSeqWriteBegin(volatile UINT32 *seq)
+{
+    (*seq)++;
+    DMB;
+}
+
+STATIC INLINE VOID OsCpupSeqWriteEnd(volatile UINT32 *seq)
+{
+    DMB;
+    (*seq)++;
+}
+
+STATIC INLINE UINT32 OsCpupSeqReadBegin(const volatile UINT32 *seq)
+{
+    UINT32 val;
+
+    while ((val = *seq) & 1) {
+    }
+    DMB;
+    return val;
+}
+
+STATIC INLINE BOOL OsCpupSeqReadRetry(const volatile UINT32 *seq, UINT32 val)
+{
+    DMB;
+    return (*seq != val);
+}
+
+/* 本时间片里被中断占用的时间 */
+STATIC INLINE UINT64 OsCpupSliceIrq(UINT16 cpuID)
+{
+#ifdef LOSCFG_CPUP_INCLUDE_IRQ
+    return timeInIrqSwitch[cpuID];
+#else
+    (VOID)cpuID;
+    return 0;
+#endif
+}
+
+/* 从进入系统调用到 cycle 这段时间, 扣掉其中的中断时间 */
+STATIC INLINE UINT64 OsCpupSysWindow(const OsCpupBase *taskCpup, UINT64 irqTotal, UINT64 cycle)
+{
+    UINT64 irqCycle = irqTotal - taskCpup->sysIrqBase;
+    UINT64 window = cycle - taskCpup->sysStart;
+
+    return (window > irqCycle) ? (window - irqCycle) : 0;
+}
+
+STATIC INLINE VOID OsCpupSysWindowOpen(OsCpupBase *taskCpup, const OsCpupCpuTime *cpuTime, UINT64 cycle)
+{
+    taskCpup->sysStart = cycle;
+    taskCpup->sysIrqBase = cpuTime->irqTime;
+}
+
+/* 任务切出时把这个时间片拆成 用户态/内核态/中断, 记到任务, 进程和本CPU上 */
+STATIC VOID OsCpupTimeCharge(const LosTaskCB *runTask, OsCpupBase *processCpup, OsCpupCpuTime *cpuTime,
+                             UINT64 runCycle, UINT64 irqCycle, UINT64 cycle)
+{
+    OsCpupBase *taskCpup = (OsCpupBase *)&runTask->taskCpup;
+    Percpu *percpu = OsPercpuGet();
+    UINT64 sysCycle = runCycle;
+    UINT64 userCycle = 0;
+
+    OsCpupSeqWriteBegin(&taskCpup->seq);
+    if (taskCpup->inSys) {
+        taskCpup->sliceSys += OsCpupSysWindow(taskCpup, cpuTime->irqTime, cycle);
+    }
+    if (OsProcessIsUserMode(OS_PCB_FROM_PID(runTask->processID))) {
+        sysCycle = (taskCpup->sliceSys < runCycle) ? taskCpup->sliceSys : runCycle;
+        userCycle = runCycle - sysCycle;
+    }
+    taskCpup->sliceSys = 0;
+    taskCpup->userTime += userCycle;
+    taskCpup->sysTime += sysCycle;
+    taskCpup->irqTime += irqCycle;
+    OsCpupSeqWriteEnd(&taskCpup->seq);
+
+    if (processCpup != NULL) {
+        OsCpupSeqWriteBegin(&processCpup->seq);
+        processCpup->userTime += userCycle;
+        processCpup->sysTime += sysCycle;
+        processCpup->irqTime += irqCycle;
+        OsCpupSeqWriteEnd(&processCpup->seq);
+    }
+
+    if (runTask->taskID == percpu->idleTaskID) {
+        cpuTime->idleTime += runCycle;
+    } else if (runTask->taskID == percpu->swtmrTaskID) {
+        cpuTime->softirqTime += runCycle;
+    } else {
+        cpuTime->userTime += userCycle;
+        cpuTime->sysTime += sysCycle;
+    }
+}
+
 LITE_OS_SEC_TEXT_INIT VOID OsCpupGuard(VOID)
 {
     UINT16 prevPos;
@@ -257,6 +370,7 @@ LITE_OS_SEC_TEXT_INIT UINT32 OsCpupInit(VOID)
 
     for (loop = 0; loop < LOSCFG_KERNEL_CORE_NUM; loop++) {
         runningTasks[loop] = INVALID_ID;
+        g_cpupCpuTime[loop].curTaskID = INVALID_ID;
     }
     cpupInitFlg = 1;
     return LOS_OK;
@@ -331,31 +445,271 @@ VOID OsCpupCycleEndStart(UINT32 runTaskID, UINT32 newTaskID)
     OsCpupBase *runTaskCpup = &runTask->taskCpup;
     OsCpupBase *newTaskCpup = (OsCpupBase *)&(OS_TCB_FROM_TID(newTaskID)->taskCpup);
     OsCpupBase *processCpup = OS_PCB_FROM_PID(runTask->processID)->processCpup;
-    UINT64 cpuCycle, cycleIncrement;
+    UINT64 cpuCycle, cycleIncrement, irqIncrement;
     UINT16 cpuID = ArchCurrCpuid();
+    OsCpupCpuTime *cpuTime = &g_cpupCpuTime[cpuID];
 
     if (cpupInitFlg == 0) {
         return;
     }
 
     cpuCycle = OsGetCpuCycle();
+    OsCpupSeqWriteBegin(&cpuTime->seq);
     if (runTaskCpup->startTime != 0) {
         cycleIncrement = cpuCycle - runTaskCpup->startTime;
+        irqIncrement = OsCpupSliceIrq(cpuID);
+        cycleIncrement -= irqIncrement;
 #ifdef LOSCFG_CPUP_INCLUDE_IRQ
-        cycleIncrement -= timeInIrqSwitch[cpuID];
         timeInIrqSwitch[cpuID] = 0;
 #endif
         runTaskCpup->allTime += cycleIncrement;
         if (processCpup != NULL) {
             processCpup->allTime += cycleIncrement;
         }
+        OsCpupTimeCharge(runTask, processCpup, cpuTime, cycleIncrement, irqIncrement, cpuCycle);
         runTaskCpup->startTime = 0;
     }
 
+    OsCpupSeqWriteBegin(&newTaskCpup->seq);
     newTaskCpup->startTime = cpuCycle;
+    if (newTaskCpup->inSys) {//在系统调用里被切走的任务,切回来时重新开始计内核态时间
+        OsCpupSysWindowOpen(newTaskCpup, cpuTime, cpuCycle);
+    }
+    OsCpupSeqWriteEnd(&newTaskCpup->seq);
+    cpuTime->curTaskID = newTaskID;
+    cpuTime->sliceStart = cpuCycle;
+    OsCpupSeqWriteEnd(&cpuTime->seq);
     runningTasks[cpuID] = newTaskID;
 }
 
+/* 系统调用入口/出口, 用来把用户任务的运行时间拆成用户态和内核态 */
+VOID OsCpupSyscallEnter(VOID)
+{
+    OsCpupBase *taskCpup = NULL;
+    UINT32 intSave;
+
+    if (cpupInitFlg == 0) {
+        return;
+    }
+
+    intSave = LOS_IntLock();
+    taskCpup = &OsCurrTaskGet()->taskCpup;
+    OsCpupSeqWriteBegin(&taskCpup->seq);
+    taskCpup->inSys = TRUE;
+    OsCpupSysWindowOpen(taskCpup, &g_cpupCpuTime[ArchCurrCpuid()], OsGetCpuCycle());
+    OsCpupSeqWriteEnd(&taskCpup->seq);
+    LOS_IntRestore(intSave);
+}
+
+VOID OsCpupSyscallExit(VOID)
+{
+    OsCpupBase *taskCpup = NULL;
+    UINT32 intSave;
+
+    intSave = LOS_IntLock();
+    taskCpup = &OsCurrTaskGet()->taskCpup;
+    if (taskCpup->inSys) {
+        OsCpupSeqWriteBegin(&taskCpup->seq);
+        taskCpup->sliceSys += OsCpupSysWindow(taskCpup, g_cpupCpuTime[ArchCurrCpuid()].irqTime, OsGetCpuCycle());
+        taskCpup->inSys = FALSE;
+        OsCpupSeqWriteEnd(&taskCpup->seq);
+    }
+    LOS_IntRestore(intSave);
+}
+
+/*
+ * 取某个CPU的累加值快照, 以及它上面正在运行的时间片拆分(还没记到任务和进程上的那部分).
+ * 返回正在运行的任务ID, CPU上还没有任务时返回 INVALID_ID.
+ */
+STATIC UINT32 OsCpupRunningSliceGet(UINT16 cpuid, UINT64 cycle, OsCpupCpuTime *cpuSnap, CPUP_TIME_S *slice)
+{
+    const OsCpupCpuTime *cpuTime = &g_cpupCpuTime[cpuid];
+    const OsCpupBase *taskCpup = NULL;
+    const LosTaskCB *taskCB = NULL;
+    UINT64 sliceIrq, runCycle, sysCycle;
+    UINT32 seq, taskSeq;
+
+    do {
+        seq = OsCpupSeqReadBegin(&cpuTime->seq);
+        *cpuSnap = *cpuTime;
+        sliceIrq = OsCpupSliceIrq(cpuid);
+    } while (OsCpupSeqReadRetry(&cpuTime->seq, seq));
+
+    (VOID)memset_s(slice, sizeof(CPUP_TIME_S), 0, sizeof(CPUP_TIME_S));
+    if (cpuSnap->curTaskID == INVALID_ID) {
+        return INVALID_ID;
+    }
+
+    runCycle = (cycle > cpuSnap->sliceStart) ? (cycle - cpuSnap->sliceStart) : 0;
+    runCycle = (runCycle > sliceIrq) ? (runCycle - sliceIrq) : 0;
+    taskCB = OS_TCB_FROM_TID(cpuSnap->curTaskID);
+    taskCpup = &taskCB->taskCpup;
+    sysCycle = runCycle;
+    if (OsProcessIsUserMode(OS_PCB_FROM_PID(taskCB->processID))) {
+        do {
+            taskSeq = OsCpupSeqReadBegin(&taskCpup->seq);
+            sysCycle = taskCpup->sliceSys;
+            if (taskCpup->inSys) {
+                sysCycle += OsCpupSysWindow(taskCpup, cpuSnap->irqTime, cycle);
+            }
+        } while (OsCpupSeqReadRetry(&taskCpup->seq, taskSeq));
+        sysCycle = (sysCycle < runCycle) ? sysCycle : runCycle;
+    }
+
+    slice->userTime = runCycle - sysCycle;
+    slice->sysTime = sysCycle;
+    slice->irqTime = sliceIrq;
+    return cpuSnap->curTaskID;
+}
+
+LITE_OS_SEC_TEXT_MINOR UINT32 LOS_CpupCpuTimeGet(UINT16 cpuid, CPUP_CPU_TIME_S *cpuTime)
+{
+    OsCpupCpuTime cpuSnap;
+    CPUP_TIME_S slice;
+    UINT32 taskID;
+    Percpu *percpu = NULL;
+
+    if (cpupInitFlg == 0) {
+        return LOS_ERRNO_CPUP_NO_INIT;
+    }
+
+    if (cpuTime == NULL) {
+        return LOS_ERRNO_CPUP_PTR_ERR;
+    }
+
+    if (cpuid >= LOSCFG_KERNEL_CORE_NUM) {
+        return LOS_ERRNO_CPUP_ID_INVALID;
+    }
+
+    taskID = OsCpupRunningSliceGet(cpuid, OsGetCpuCycle(), &cpuSnap, &slice);
+    cpuTime->userTime = cpuSnap.userTime;
+    cpuTime->sysTime = cpuSnap.sysTime;
+    cpuTime->irqTime = cpuSnap.irqTime;
+    cpuTime->softirqTime = cpuSnap.softirqTime;
+    cpuTime->idleTime = cpuSnap.idleTime;
+
+    percpu = OsPercpuGetByID(cpuid);
+    if (taskID == INVALID_ID) {
+        return LOS_OK;
+    } else if (taskID == percpu->idleTaskID) {
+        cpuTime->idleTime += slice.userTime + slice.sysTime;
+    } else if (taskID == percpu->swtmrTaskID) {
+        cpuTime->softirqTime += slice.userTime + slice.sysTime;
+    } else {
+        cpuTime->userTime += slice.userTime;
+        cpuTime->sysTime += slice.sysTime;
+    }
+    return LOS_OK;
+}
+
+/* 进程回收时在调度锁内摘掉 processCpup 再释放, 所以要在调度锁内取指针并拷贝计数 */
+STATIC UINT32 OsCpupProcessTimeGetUnsafe(UINT32 pid, CPUP_TIME_S *cpupTime)
+{
+    const LosProcessCB *processCB = NULL;
+    const OsCpupBase *processCpup = NULL;
+    OsCpupCpuTime cpuSnap;
+    CPUP_TIME_S slice;
+    UINT64 cycle;
+    UINT32 taskID, seq;
+    UINT16 cpuid;
+
+    if (cpupInitFlg == 0) {
+        return LOS_ERRNO_CPUP_NO_INIT;
+    }
+
+    if (cpupTime == NULL) {
+        return LOS_ERRNO_CPUP_PTR_ERR;
+    }
+
+    if (OS_PID_CHECK_INVALID(pid)) {
+        return LOS_ERRNO_CPUP_ID_INVALID;
+    }
+
+    processCB = OS_PCB_FROM_PID(pid);
+    processCpup = processCB->processCpup;
+    if (OsProcessIsUnused(processCB) || (processCpup == NULL)) {
+        return LOS_ERRNO_CPUP_NO_CREATED;
+    }
+
+    cycle = OsGetCpuCycle();
+    do {
+        seq = OsCpupSeqReadBegin(&processCpup->seq);
+        cpupTime->userTime = processCpup->userTime;
+        cpupTime->sysTime = processCpup->sysTime;
+        cpupTime->irqTime = processCpup->irqTime;
+        for (cpuid = 0; cpuid < LOSCFG_KERNEL_CORE_NUM; cpuid++) {
+            taskID = OsCpupRunningSliceGet(cpuid, cycle, &cpuSnap, &slice);
+            if ((taskID == INVALID_ID) || (OS_TCB_FROM_TID(taskID)->processID != pid)) {
+                continue;
+            }
+            cpupTime->userTime += slice.userTime;
+            cpupTime->sysTime += slice.sysTime;
+            cpupTime->irqTime += slice.irqTime;
+        }
+    } while (OsCpupSeqReadRetry(&processCpup->seq, seq));
+
+    return LOS_OK;
+}
+
+LITE_OS_SEC_TEXT_MINOR UINT32 LOS_CpupProcessTimeGet(UINT32 pid, CPUP_TIME_S *cpupTime)
+{
+    UINT32 ret;
+    UINT32 intSave;
+
+    SCHEDULER_LOCK(intSave);
+    ret = OsCpupProcessTimeGetUnsafe(pid, cpupTime);
+    SCHEDULER_UNLOCK(intSave);
+    return ret;
+}
+
+LITE_OS_SEC_TEXT_MINOR UINT32 LOS_CpupTaskTimeGet(UINT32 tid, CPUP_TIME_S *cpupTime)
+{
+    const LosTaskCB *taskCB = NULL;
+    const OsCpupBase *taskCpup = NULL;
+    OsCpupCpuTime cpuSnap;
+    CPUP_TIME_S slice;
+    UINT64 cycle;
+    UINT32 seq;
+    UINT16 cpuid;
+
+    if (cpupInitFlg == 0) {
+        return LOS_ERRNO_CPUP_NO_INIT;
+    }
+
+    if (cpupTime == NULL) {
+        return LOS_ERRNO_CPUP_PTR_ERR;
+    }
+
+    if (OS_TID_CHECK_INVALID(tid)) {
+        return LOS_ERRNO_CPUP_ID_INVALID;
+    }
+
+    taskCB = OS_TCB_FROM_TID(tid);
+    if (OsTaskIsUnused(taskCB)) {
+        return LOS_ERRNO_CPUP_NO_CREATED;
+    }
+
+    taskCpup = &taskCB->taskCpup;
+    cycle = OsGetCpuCycle();
+    do {
+        seq = OsCpupSeqReadBegin(&taskCpup->seq);
+        cpupTime->userTime = taskCpup->userTime;
+        cpupTime->sysTime = taskCpup->sysTime;
+        cpupTime->irqTime = taskCpup->irqTime;
+        for (cpuid = 0; cpuid < LOSCFG_KERNEL_CORE_NUM; cpuid++) {
+            if (OsCpupRunningSliceGet(cpuid, cycle, &cpuSnap, &slice) != tid) {
+                continue;
+            }
+            cpupTime->userTime += slice.userTime;
+            cpupTime->sysTime += slice.sysTime;
+            cpupTime->irqTime += slice.irqTime;
+            break;
+        }
+    } while (OsCpupSeqReadRetry(&taskCpup->seq, seq));
+
+    return LOS_OK;
+}
+
 LITE_OS_SEC_TEXT_MINOR STATIC VOID OsCpupGetPos(UINT16 mode, UINT16 *curPosPointer, UINT16 *prePosPointer)
 {
     UINT16 curPos;
@@ -644,13 +998,17 @@ LITE_OS_SEC_TEXT_MINOR VOID OsCpupIrqEnd(UINT32 intNum)
     UINT32 low;
     UINT64 intTimeEnd;
     UINT32 cpuID = ArchCurrCpuid();
+    OsCpupCpuTime *cpuTime = &g_cpupCpuTime[cpuID];
 
     LOS_GetCpuCycle(&high, &low);
     intTimeEnd = ((UINT64)high << HIGH_BITS) + low;
 
     g_irqCpup[intNum].id = intNum;
     g_irqCpup[intNum].status = OS_CPUP_USED;
+    OsCpupSeqWriteBegin(&cpuTime->seq);
     timeInIrqSwitch[cpuID] += (intTimeEnd - cpupIntTimeStart[cpuID]);
+    cpuTime->irqTime += (intTimeEnd - cpupIntTimeStart[cpuID]);
+    OsCpupSeqWriteEnd(&cpuTime->seq);
     g_irqCpup[intNum].cpup.allTime += (intTimeEnd - cpupIntTimeStart[cpuID]);
 
     return;
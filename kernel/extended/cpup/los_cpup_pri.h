@@ -50,6 +50,14 @@ typedef struct {
     UINT64 allTime;    /**< Total running time */
     UINT64 startTime;  /**< Time before a task is invoked */
     UINT64 historyTime[OS_CPUP_HISTORY_RECORD_NUM + 1]; /**< Historical running time, the last one saves zero */
+    volatile UINT32 seq; /**< Odd while the split times are being updated, lockless readers retry */
+    UINT32 inSys;      /**< Task only: the task is inside a system call */
+    UINT64 userTime;   /**< Running time in user mode */
+    UINT64 sysTime;    /**< Running time in the kernel */
+    UINT64 irqTime;    /**< Interrupt time taken while running */
+    UINT64 sysStart;   /**< Task only: start of the open system call window */
+    UINT64 sysIrqBase; /**< Task only: interrupt time of the CPU when the window was opened */
+    UINT64 sliceSys;   /**< Task only: system call time in the current time slice */
 } OsCpupBase;
 
 /**
@@ -65,6 +73,8 @@ typedef struct {
 extern UINT32 OsCpupInit(VOID);
 extern UINT32 OsCpupGuardCreator(VOID);
 extern VOID OsCpupCycleEndStart(UINT32 runTaskID, UINT32 newTaskID);
+extern VOID OsCpupSyscallEnter(VOID);
+extern VOID OsCpupSyscallExit(VOID);
 extern UINT32 OsGetAllTaskCpuUsageUnsafe(UINT16 mode, CPUP_INFO_S *cpupInfo, UINT32 len);
 extern UINT32 OsGetAllProcessCpuUsageUnsafe(UINT16 mode, CPUP_INFO_S *cpupInfo, UINT32 len);
 extern UINT32 OsGetAllProcessAndTaskCpuUsageUnsafe(UINT16 mode, CPUP_INFO_S *cpupInfo, UINT32 len);
@@ -197,6 +197,7 @@ typedef struct {
 #define LD_PT_SHLIB            5	//该段类型是保留的,而且未定义语法.UNIX System V系统上的应用程序不会包含这种表项.
 #define LD_PT_PHDR             6	//此类型的程序头如果存在的话,它表明的是其自身所在的程序头表在文件或内存中的位置和大小.这样的段在文件中可以不存在,只有当所在程序头表所覆盖的段只是整个程序的一部分时,才会出现一次这种表项,而且这种表项一定出现在其它可装载段的表项之前.
 #define LD_PT_GNU_STACK        0x6474e551
+#define LD_PT_ARM_EXIDX        0x70000001	//ARM 栈展开索引表 .ARM.exidx 所在的段, 用于不依赖帧指针的栈回溯
 
 /* e_version and EI_VERSION */
 #define LD_EV_NONE             0
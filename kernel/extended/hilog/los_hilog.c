@@ -33,6 +33,7 @@
 #include "los_init.h"
 #include "los_mp.h"
 #include "los_mux.h"
+#include "los_atomic.h"
 #include "los_process_pri.h"
 #include "los_task_pri.h"
 #include "fs/file.h"
@@ -41,7 +42,14 @@
 #include "los_vm_lock.h"
 #include "user_copy.h"
 //hilog是鸿蒙的一个用于输出的功能模块
-#define HILOG_BUFFER LOSCFG_HILOG_BUFFER_SIZE// 4K缓存, ring buf 方式管理
+#define HILOG_BUFFER LOSCFG_HILOG_BUFFER_SIZE// 所有 CPU 的 ring 总大小, 启动时按核均分
+#define HILOG_RING_NUM LOSCFG_KERNEL_CORE_NUM // 每个 CPU 一个 ring, 写者之间不争同一条 cache line
+#define HILOG_RING_MIN_SIZE 1024 // 单个 ring 的下限
+#define HILOG_RECORD_ALIGN 4 // 记录按 4 字节对齐, 保证提交标记不会跨越 ring 尾部
+#define HILOG_RECORD_COMMITTED 0x474F4C48U // "HLOG", 写者拷贝完成
+#define HILOG_RECORD_DISCARD 0x44524F50U // "DROP", 写者预留后拷贝失败, 读者直接跳过
+#define HILOG_WAKEUP_BATCH 16 // 攒够这么多条未读日志才唤醒读者
+#define HILOG_READ_TIMEOUT (LOSCFG_BASE_CORE_TICK_PER_SECOND / 10) // 不足一批时读者最多等 100ms
 #define DRIVER_MODE 0666 //权限 chmod 666
 #define HILOG_DRIVER "/dev/hilog" // 可以看出hilog是当一种字符设备来实现
 
@@ -56,6 +64,12 @@ struct HiLogEntry { //hilog 实体
     char msg[0];	//消息内容
 };
 
+struct HiLogRecord { //ring 中的记录, 读出时只返回 entry 部分
+    unsigned int flag;	//提交标记, 写者最后写, 读者消费后清零
+    unsigned int seq;	//全局序号, 读者按它合并各 CPU 的 ring
+    struct HiLogEntry entry;
+};
+
 ssize_t HilogRead(struct file *filep, char __user *buf, size_t count);
 ssize_t HilogWrite(struct file *filep, const char __user *buf, size_t count);
 int HiLogOpen(struct file *filep);
@@ -63,6 +77,7 @@ int HiLogClose(struct file *filep);
 
 static ssize_t HiLogWrite(struct file *filep, const char *buffer, size_t bufLen);
 static ssize_t HiLogRead(struct file *filep, char *buffer, size_t bufLen);
+static int HiLogIoctl(struct file *filep, int cmd, unsigned long arg);
 //实现VFS接口函数,对hilog进行操作
 STATIC struct file_operations_vfs g_hilogFops = {
     HiLogOpen,  /* open */
@@ -70,7 +85,7 @@ STATIC struct file_operations_vfs g_hilogFops = {
     HiLogRead,  /* read */
     HiLogWrite, /* write */
     NULL,       /* seek */
-    NULL,       /* ioctl */
+    HiLogIoctl, /* ioctl */
     NULL,       /* mmap */
 #ifndef CONFIG_DISABLE_POLL
     NULL, /* poll */
@@ -78,21 +93,28 @@ STATIC struct file_operations_vfs g_hilogFops = {
     NULL, /* unlink */
 };
 
+/*
+ * 写者无锁: 用 CAS 推进 tail 预留空间, 拷贝完再写提交标记; 满了就丢弃新日志并计数, 从不阻塞.
+ * 读者持 mtx 串行, 消费后清零记录再推进 head, 把空间还给写者.
+ */
+struct HiLogRing {
+    unsigned char *buffer;
+    unsigned int size;	//2 的幂
+    Atomic tail;	//写者预留到的位置, 只增不减
+    volatile unsigned int head;	//读者消费到的位置, 只增不减
+    Atomic dropped;	//ring 满或拷贝失败丢掉的行数
+};
+
 struct HiLogCharDevice {
     int flag;	//设备标签
-    LosMux mtx;	//读写buf的互斥量
-    unsigned char *buffer;//采用 ring buffer 管理
+    LosMux mtx;	//读者之间的互斥量, 写者不拿锁
+    struct HiLogRing ring[HILOG_RING_NUM];
     wait_queue_head_t wq;
-    size_t writeOffset;//用于写操作,不断累加
-    size_t headOffset;//用于读操作,不断累加
-    size_t size;//记录buffer使用的大小, 读写操作会返回 +-这个size
-    size_t count;//读写操作的次数对冲
+    Atomic seq;	//下一条日志的序号
+    Atomic unread;	//已提交未读的行数, 用于批量唤醒
+    Atomic written;	//累计写入的行数
 } g_hiLogDev;
 
-static inline unsigned char *HiLogBufferHead(void)
-{
-    return g_hiLogDev.buffer + g_hiLogDev.headOffset;
-}
 ///为支持VFS,作打开状
 int HiLogOpen(struct file *filep)
 {
@@ -105,26 +127,6 @@ int HiLogClose(struct file *filep)
     (void)filep;
     return 0;
 }
-///读写对冲,对hilog的写操作,更新相关变量内容
-static void HiLogBufferInc(size_t sz)
-{
-    if (g_hiLogDev.size + sz <= HILOG_BUFFER) {
-        g_hiLogDev.size += sz;	//已使用buf的size 
-        g_hiLogDev.writeOffset += sz;//大小是不断累加
-        g_hiLogDev.writeOffset %= HILOG_BUFFER;//ring buf
-        g_hiLogDev.count++;//读写对冲
-    }
-}
-///读写对冲,对hilog的读操作,更新相关变量内容
-static void HiLogBufferDec(size_t sz)
-{
-    if (g_hiLogDev.size >= sz) {
-        g_hiLogDev.size -= sz;//维持可使用buf size
-        g_hiLogDev.headOffset += sz;
-        g_hiLogDev.headOffset %= HILOG_BUFFER;
-        g_hiLogDev.count--;//读写对冲
-    }
-}
 
 static int HiLogBufferCopy(unsigned char *dst, unsigned dstLen, const unsigned char *src, size_t srcLen)
 {
@@ -145,202 +147,305 @@ static int HiLogBufferCopy(unsigned char *dst, unsigned dstLen, const unsigned c
     }
     return retval;
 }
-///读取ring buffer
-static int HiLogReadRingBuffer(unsigned char *buffer, size_t bufLen)
+
+static inline unsigned int HiLogRecordSize(size_t len)
+{
+    return (unsigned int)((sizeof(struct HiLogRecord) + len + HILOG_RECORD_ALIGN - 1) & ~(HILOG_RECORD_ALIGN - 1));
+}
+
+static inline volatile unsigned int *HiLogRecordFlag(const struct HiLogRing *ring, unsigned int pos)
 {
-    size_t retval;
-    size_t bufLeft = HILOG_BUFFER - g_hiLogDev.headOffset;
-    if (bufLeft > bufLen) {//计算出读取方向
-        retval = HiLogBufferCopy(buffer, bufLen, HiLogBufferHead(), bufLen);
-    } else {
-        retval = HiLogBufferCopy(buffer, bufLen, HiLogBufferHead(), bufLeft);
-        if (retval < 0) {
-            return retval;
+    return (volatile unsigned int *)(ring->buffer + (pos & (ring->size - 1)));
+}
+///往 ring 的 pos 处写入, 尾部放不下时折回开头
+static int HiLogRingWrite(struct HiLogRing *ring, unsigned int pos, const unsigned char *src, size_t len)
+{
+    unsigned int offset = pos & (ring->size - 1);
+    size_t bufLeft = ring->size - offset;
+
+    if (len > bufLeft) {
+        if (HiLogBufferCopy(ring->buffer + offset, bufLeft, src, bufLeft) != 0) {
+            return -1;
         }
+        return HiLogBufferCopy(ring->buffer, ring->size, src + bufLeft, len - bufLeft);
+    }
+    return HiLogBufferCopy(ring->buffer + offset, bufLeft, src, len);
+}
+///从 ring 的 pos 处读出, 尾部不够时接着读开头
+static int HiLogRingRead(const struct HiLogRing *ring, unsigned int pos, unsigned char *dst, size_t len)
+{
+    unsigned int offset = pos & (ring->size - 1);
+    size_t bufLeft = ring->size - offset;
 
-        retval = HiLogBufferCopy(buffer + bufLeft, bufLen - bufLeft, g_hiLogDev.buffer, bufLen - bufLeft);
+    if (len > bufLeft) {
+        if (HiLogBufferCopy(dst, bufLeft, ring->buffer + offset, bufLeft) != 0) {
+            return -1;
+        }
+        return HiLogBufferCopy(dst + bufLeft, len - bufLeft, ring->buffer, len - bufLeft);
     }
-    return retval;
+    return HiLogBufferCopy(dst, len, ring->buffer + offset, len);
+}
+///预留 len 字节, 空间不够时直接失败; 调用者已关中断, 同一 ring 只有本 CPU 在预留
+static int HiLogRingReserve(struct HiLogRing *ring, unsigned int len, unsigned int *pos)
+{
+    unsigned int tail;
+
+    do {
+        tail = (unsigned int)LOS_AtomicRead(&ring->tail);
+        if (len > ring->size - (tail - ring->head)) {
+            return -1;
+        }
+    } while (LOS_AtomicCmpXchg32bits(&ring->tail, (INT32)(tail + len), (INT32)tail));
+
+    *pos = tail;
+    return 0;
+}
+///读者消费 head 处的记录: 先清零再推进 head, 保证写者拿到的空间里不会残留旧的提交标记
+static void HiLogRingConsume(struct HiLogRing *ring, unsigned int len)
+{
+    unsigned int offset = ring->head & (ring->size - 1);
+    size_t bufLeft = ring->size - offset;
+
+    if (len > bufLeft) {
+        (void)memset_s(ring->buffer + offset, bufLeft, 0, bufLeft);
+        (void)memset_s(ring->buffer, ring->size, 0, len - bufLeft);
+    } else {
+        (void)memset_s(ring->buffer + offset, bufLeft, 0, len);
+    }
+    DMB;
+    ring->head += len;
+}
+///找出各 CPU ring 头部已提交且序号最小的记录, 正在写的记录先跳过
+static struct HiLogRing *HiLogRingNext(struct HiLogRecord *record)
+{
+    struct HiLogRing *next = NULL;
+    struct HiLogRecord header;
+    unsigned int flag;
+    int i;
+
+    for (i = 0; i < HILOG_RING_NUM; i++) {
+        struct HiLogRing *ring = &g_hiLogDev.ring[i];
+        while ((ring->buffer != NULL) && (ring->head != (unsigned int)LOS_AtomicRead(&ring->tail))) {
+            flag = *HiLogRecordFlag(ring, ring->head);
+            if (flag == 0) {
+                break;
+            }
+            DMB;
+            (void)HiLogRingRead(ring, ring->head, (unsigned char *)&header, sizeof(header));
+            if (flag == HILOG_RECORD_DISCARD) {
+                HiLogRingConsume(ring, HiLogRecordSize(header.entry.len));
+                continue;
+            }
+            if ((next == NULL) || ((int)(header.seq - record->seq) < 0)) {
+                next = ring;
+                *record = header;
+            }
+            break;
+        }
+    }
+    return next;
+}
+
+static BOOL HiLogHasData(void)
+{
+    struct HiLogRecord record;
+    BOOL ret;
+
+    (VOID)LOS_MuxAcquire(&g_hiLogDev.mtx);
+    ret = (HiLogRingNext(&record) != NULL);
+    (VOID)LOS_MuxRelease(&g_hiLogDev.mtx);
+    return ret;
 }
 
 static ssize_t HiLogRead(struct file *filep, char *buffer, size_t bufLen)
 {
-    size_t retval;
-    struct HiLogEntry header;
+    ssize_t retval;
+    struct HiLogRecord record;
+    struct HiLogRing *ring = NULL;
 
     (void)filep;
 
-    wait_event_interruptible(g_hiLogDev.wq, (g_hiLogDev.size > 0));
+    while (!HiLogHasData()) { //写者每攒够一批才唤醒, 零星的日志靠超时捞走
+        (void)wait_event_interruptible_timeout(g_hiLogDev.wq, HiLogHasData(), HILOG_READ_TIMEOUT);
+    }
 
     (VOID)LOS_MuxAcquire(&g_hiLogDev.mtx);//临界区操作开始
-    retval = HiLogReadRingBuffer((unsigned char *)&header, sizeof(header));
-    if (retval < 0) {
-        retval = -EINVAL;
+    ring = HiLogRingNext(&record);
+    if (ring == NULL) {
+        retval = 0;
         goto out;
     }
 
-    if (bufLen < header.len + sizeof(header)) {
-        dprintf("buffer too small,bufLen=%d, header.len=%d,%d\n", bufLen, header.len, header.hdrSize);
+    if (bufLen < record.entry.len + sizeof(record.entry)) {
+        dprintf("buffer too small,bufLen=%d, header.len=%d,%d\n", bufLen, record.entry.len, record.entry.hdrSize);
         retval = -ENOMEM;
-        goto out;
+        goto out; //记录留在 ring 里, 调用者换个大缓冲区还能读到
     }
 
-    HiLogBufferDec(sizeof(header));
-
-    retval = HiLogBufferCopy((unsigned char *)buffer, bufLen, (unsigned char *)&header, sizeof(header));
-    if (retval < 0) {
+    retval = HiLogBufferCopy((unsigned char *)buffer, bufLen, (unsigned char *)&record.entry, sizeof(record.entry));
+    if (retval != 0) {
         retval = -EINVAL;
-        goto out;
+        goto consume;
     }
 
-    retval = HiLogReadRingBuffer((unsigned char *)(buffer + sizeof(header)), header.len);
-    if (retval < 0) {
+    retval = HiLogRingRead(ring, ring->head + sizeof(record), (unsigned char *)(buffer + sizeof(record.entry)),
+                           record.entry.len);
+    if (retval != 0) {
         retval = -EINVAL;
-        goto out;
+        goto consume;
     }
-
-    HiLogBufferDec(header.len);
-    retval = header.len + sizeof(header);
+    retval = record.entry.len + sizeof(record.entry);
+consume: //拷贝出错时也丢掉这条记录, 不让一条坏记录卡住整个 ring
+    HiLogRingConsume(ring, HiLogRecordSize(record.entry.len));
+    LOS_AtomicDec(&g_hiLogDev.unread);
 out:
-    if (retval == -ENOMEM) {
-        // clean ring buffer
-        g_hiLogDev.writeOffset = 0;
-        g_hiLogDev.headOffset = 0;
-        g_hiLogDev.size = 0;
-        g_hiLogDev.count = 0;
-    }
     (VOID)LOS_MuxRelease(&g_hiLogDev.mtx);//临界区操作结束
     return retval;
 }
-///写入 RingBuffer环形缓冲，也叫 circleBuffer
-static int HiLogWriteRingBuffer(unsigned char *buffer, size_t bufLen)
-{
-    int retval;
-    size_t bufLeft = HILOG_BUFFER - g_hiLogDev.writeOffset;
-    if (bufLen > bufLeft) {
-        retval = HiLogBufferCopy(g_hiLogDev.buffer + g_hiLogDev.writeOffset, bufLeft, buffer, bufLeft);
-        if (retval) {
-            return -1;
-        }
-        retval = HiLogBufferCopy(g_hiLogDev.buffer, HILOG_BUFFER, buffer + bufLeft, bufLen - bufLeft);
-    } else {
-        retval = HiLogBufferCopy(g_hiLogDev.buffer + g_hiLogDev.writeOffset, bufLeft, buffer, bufLen);
-    }
-    if (retval < 0) {
-        return -1;
-    }
-    return 0;
-}
 ///hilog实体初始化
 static void HiLogHeadInit(struct HiLogEntry *header, size_t len)
 {
     struct timespec now;//标准C库函数,时间格式,包含秒数和纳秒数
     int ret;
 
-    ret = clock_gettime(CLOCK_REALTIME, &now);//获取系统实时时间
-    if (ret != 0) {
-        dprintf("In %s line %d,clock_gettime fail", __FUNCTION__, __LINE__);
-        return;
-    }
-
     header->len = len;//写入buffer的内容长度
     header->pid = LOS_GetCurrProcessID();//当前进程ID
     header->taskId = LOS_CurTaskIDGet();	//当前任务ID
-    header->sec = now.tv_sec;	//秒级记录
-    header->nsec = now.tv_nsec; //纳秒级记录
     header->hdrSize = sizeof(struct HiLogEntry);
-}
-
-static void HiLogCoverOldLog(size_t bufLen)
-{
-    int retval;
-    struct HiLogEntry header;
-    size_t totalSize = bufLen + sizeof(struct HiLogEntry);
-    int dropLogLines = 0;
-
-    while (totalSize + g_hiLogDev.size > HILOG_BUFFER) {
-        retval = HiLogReadRingBuffer((unsigned char *)&header, sizeof(header));
-        if (retval < 0) {
-            break;
-        }
+    header->reserved = 0;
 
-        dropLogLines++;
-        HiLogBufferDec(sizeof(header));
-        HiLogBufferDec(header.len);
-    }
-    if (dropLogLines > 0) {
-        dprintf("hilog ringbuffer full, drop %d line(s) log", dropLogLines);
+    ret = clock_gettime(CLOCK_REALTIME, &now);//获取系统实时时间
+    if (ret != 0) {
+        dprintf("In %s line %d,clock_gettime fail", __FUNCTION__, __LINE__);
+        now.tv_sec = 0;
+        now.tv_nsec = 0;
     }
+    header->sec = now.tv_sec;	//秒级记录
+    header->nsec = now.tv_nsec; //纳秒级记录
 }
-///将外部buf写入hilog设备分两步完成
+///将外部buf写入当前 CPU 的 ring: 预留 -> 拷贝 -> 提交, 全程不拿锁, 中断里也能写
 int HiLogWriteInternal(const char *buffer, size_t bufLen)
 {
-    struct HiLogEntry header;
+    struct HiLogRecord record;
+    struct HiLogRing *ring = NULL;
+    unsigned int recordSize = HiLogRecordSize(bufLen);
+    unsigned int pos;
+    UINT32 intSave;
     int retval;
-    LosTaskCB *runTask =  (LosTaskCB *)OsCurrTaskGet();
 
-    if ((g_hiLogDev.buffer == NULL) || (OS_INT_ACTIVE) || (runTask->taskStatus & OS_TASK_FLAG_SYSTEM_TASK)) {
+    if (g_hiLogDev.ring[0].buffer == NULL) {
         PRINTK("%s\n", buffer);
         return -EAGAIN;
     }
 
-    (VOID)LOS_MuxAcquire(&g_hiLogDev.mtx);
-    HiLogCoverOldLog(bufLen);
-    HiLogHeadInit(&header, bufLen);
-
-    retval = HiLogWriteRingBuffer((unsigned char *)&header, sizeof(header));//1.先写入头部内容
-    if (retval) {
-        retval = -ENODATA;
-        goto out;
+    /*
+     * 关中断把选 ring、预留、取序号做成一步: ring[i] 只会被 CPU i 预留, 同一 ring 内位置先后与序号先后一致,
+     * 读者只看各 ring 头部按序号合并才不会乱序. 拷贝和提交仍在开中断后进行.
+     */
+    intSave = LOS_IntLock();
+    ring = &g_hiLogDev.ring[ArchCurrCpuid()];
+    if ((recordSize > ring->size) || (HiLogRingReserve(ring, recordSize, &pos) != 0)) {
+        LOS_IntRestore(intSave);
+        LOS_AtomicInc(&ring->dropped);
+        return -EAGAIN;
     }
-    HiLogBufferInc(sizeof(header));//
+    record.seq = (unsigned int)LOS_AtomicIncRet(&g_hiLogDev.seq);
+    LOS_IntRestore(intSave);
 
-    retval = HiLogWriteRingBuffer((unsigned char *)(buffer), header.len);//2.再写入实际buf内容
-    if (retval) {
-        retval = -ENODATA;
-        goto out;
-    }
+    record.flag = 0;
+    HiLogHeadInit(&record.entry, bufLen);
 
-    HiLogBufferInc(header.len);
+    retval = HiLogRingWrite(ring, pos, (unsigned char *)&record, sizeof(record));//1.先写入头部内容
+    if (retval == 0) {
+        retval = HiLogRingWrite(ring, pos + sizeof(record), (unsigned char *)buffer, bufLen);//2.再写入实际buf内容
+    }
 
-    retval = header.len;
+    DMB;
+    if (retval != 0) {
+        *HiLogRecordFlag(ring, pos) = HILOG_RECORD_DISCARD;
+        LOS_AtomicInc(&ring->dropped);
+        dprintf("write fail retval=%d\n", retval);
+        return -ENODATA;
+    }
+    *HiLogRecordFlag(ring, pos) = HILOG_RECORD_COMMITTED;//3.最后提交, 读者看到标记才会读
 
-out:
-    (VOID)LOS_MuxRelease(&g_hiLogDev.mtx);
-    if (retval > 0) {
+    LOS_AtomicInc(&g_hiLogDev.written);
+    if (LOS_AtomicIncRet(&g_hiLogDev.unread) == HILOG_WAKEUP_BATCH) {
         wake_up_interruptible(&g_hiLogDev.wq);
     }
-    if (retval < 0) {
-        dprintf("write fail retval=%d\n", retval);
-    }
-    return retval;
+    return bufLen;
 }
 ///写hilog,外部以VFS方式写入
 static ssize_t HiLogWrite(struct file *filep, const char *buffer, size_t bufLen)
 {
     (void)filep;
-    if (bufLen + sizeof(struct HiLogEntry) > HILOG_BUFFER) {
+    if (HiLogRecordSize(bufLen) > g_hiLogDev.ring[0].size) {
         dprintf("input too large\n");
         return -ENOMEM;
     }
 
     return HiLogWriteInternal(buffer, bufLen);
 }
-///初始化全局变量g_hiLogDev
+///读取丢弃计数等统计信息
+static int HiLogIoctl(struct file *filep, int cmd, unsigned long arg)
+{
+    struct HiLogStat stat = {0};
+    int i;
+
+    (void)filep;
+    if (cmd != HILOG_GET_STAT) {
+        return -EINVAL;
+    }
+
+    for (i = 0; i < HILOG_RING_NUM; i++) {
+        stat.dropped += (unsigned int)LOS_AtomicRead(&g_hiLogDev.ring[i].dropped);
+        stat.bufferSize += g_hiLogDev.ring[i].size;
+    }
+    stat.written = (unsigned int)LOS_AtomicRead(&g_hiLogDev.written);
+    stat.unread = (unsigned int)LOS_AtomicRead(&g_hiLogDev.unread);
+    stat.ringNum = HILOG_RING_NUM;
+
+    if (HiLogBufferCopy((unsigned char *)(UINTPTR)arg, sizeof(stat), (unsigned char *)&stat, sizeof(stat)) != 0) {
+        return -EFAULT;
+    }
+    return 0;
+}
+///初始化全局变量g_hiLogDev, ring 在启动时按核均分 HILOG_BUFFER, 每个取不超过份额的 2 的幂
 static void HiLogDeviceInit(void)
 {
-    g_hiLogDev.buffer = LOS_MemAlloc((VOID *)OS_SYS_MEM_ADDR, HILOG_BUFFER);//分配内核空间
-    if (g_hiLogDev.buffer == NULL) {
-        dprintf("In %s line %d,LOS_MemAlloc fail", __FUNCTION__, __LINE__);
+    unsigned int size = HILOG_RING_MIN_SIZE;
+    int i;
+
+    while ((size << 1) <= (HILOG_BUFFER / HILOG_RING_NUM)) {
+        size <<= 1;
+    }
+
+    for (i = 0; i < HILOG_RING_NUM; i++) {
+        g_hiLogDev.ring[i].buffer = LOS_MemAlloc((VOID *)OS_SYS_MEM_ADDR, size);//分配内核空间
+        if (g_hiLogDev.ring[i].buffer == NULL) {
+            dprintf("In %s line %d,LOS_MemAlloc fail", __FUNCTION__, __LINE__);
+            break;
+        }
+        (void)memset_s(g_hiLogDev.ring[i].buffer, size, 0, size);
+        g_hiLogDev.ring[i].size = size;
+        g_hiLogDev.ring[i].head = 0;
+        LOS_AtomicSet(&g_hiLogDev.ring[i].tail, 0);
+        LOS_AtomicSet(&g_hiLogDev.ring[i].dropped, 0);
+    }
+    if (i < HILOG_RING_NUM) { //任何一个 ring 分配失败都整体退回 printk
+        while (i-- > 0) {
+            (VOID)LOS_MemFree((VOID *)OS_SYS_MEM_ADDR, g_hiLogDev.ring[i].buffer);
+            g_hiLogDev.ring[i].buffer = NULL;
+            g_hiLogDev.ring[i].size = 0;
+        }
     }
 	//初始化waitqueue头,请确保输入参数wait有效，否则系统将崩溃。
     init_waitqueue_head(&g_hiLogDev.wq);//见于..\third_party\FreeBSD\sys\compat\linuxkpi\common\src\linux_semaphore.c
     LOS_MuxInit(&g_hiLogDev.mtx, NULL);//初始化hilog互斥量
 
-    g_hiLogDev.writeOffset = 0;//写g_hiLogDev.buffer偏移地址
-    g_hiLogDev.headOffset = 0;
-    g_hiLogDev.size = 0;	//
-    g_hiLogDev.count = 0;
+    LOS_AtomicSet(&g_hiLogDev.seq, 0);
+    LOS_AtomicSet(&g_hiLogDev.unread, 0);
+    LOS_AtomicSet(&g_hiLogDev.written, 0);
 }
 ///初始化hilog驱动
 int OsHiLogDriverInit(VOID)
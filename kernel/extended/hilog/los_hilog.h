@@ -32,6 +32,8 @@
 #ifndef LOS_HILOG_H
 #define LOS_HILOG_H
 
+#include "sys/ioctl.h"
+
 #ifdef __cplusplus
 #if __cplusplus
 extern "C" {
@@ -42,6 +44,18 @@ extern "C" {
 #define __user
 #endif
 
+/* 通过 /dev/hilog 的 ioctl 读出, 写者从不阻塞, ring 满时新日志被丢弃并计入 dropped */
+struct HiLogStat {
+    unsigned long long written;	//累计写入的行数
+    unsigned long long dropped;	//ring 满或拷贝失败丢掉的行数
+    unsigned int unread;	//已提交未读的行数
+    unsigned int bufferSize;	//所有 ring 的总字节数
+    unsigned int ringNum;	//ring 个数, 每个 CPU 一个
+};
+
+#define HILOG_IOC_MAGIC 'h'
+#define HILOG_GET_STAT  _IOR(HILOG_IOC_MAGIC, 1, struct HiLogStat)
+
 extern int OsHiLogDriverInit(void);
 
 #ifdef __cplusplus
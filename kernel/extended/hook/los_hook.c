@@ -31,32 +31,113 @@
 
 #include "los_hook.h"
 #include "los_hook_types_parse.h"
+#include "los_printf.h"
+#include "los_spinlock.h"
+#include "los_hw_cpu.h"
+#ifdef LOSCFG_SHELL
+#include "shcmd.h"
+#include "shell.h"
+#endif
 
 #ifdef LOSCFG_KERNEL_HOOK
-/// 定义钩子函数
-#define LOS_HOOK_TYPE_DEF(type, paramList)                  \
-    STATIC type##_FN g_fn##type;                            \
-    UINT32 type##_RegHook(type##_FN func) {                 \
-        if ((func) == NULL) {                               \
-            return LOS_ERRNO_HOOK_REG_INVALID;              \
-        }                                                   \
-        if (g_fn##type) {                                   \
-            return LOS_ERRNO_HOOK_POOL_IS_FULL;             \
-        }                                                   \
-        g_fn##type = (func);                                \
-        return LOS_OK;                                      \
-    }                                                       \
-    UINT32 type##_UnRegHook(type##_FN func) {               \
-        if (((func) == NULL) || (g_fn##type != (func))) {   \
-            return LOS_ERRNO_HOOK_UNREG_INVALID;            \
-        }                                                   \
-        g_fn##type = NULL;                                  \
-        return LOS_OK;                                      \
-    }                                                       \
-    VOID type##_CallHook paramList {                        \
-        if (g_fn##type) {                                   \
-            g_fn##type(PARAM_TO_ARGS paramList);            \
-        }                                                   \
+/*
+ * 每种钩子有一个静态开关和 LOS_HOOK_PROBE_NUM 个回调槽位.
+ * 第一个回调注册时打开开关, 最后一个注销时关闭, 没有回调时调用点 OsHookCall 只是一条 nop.
+ * trace, perf 等多个模块可以同时挂在同一种钩子上.
+ */
+typedef struct {
+    const CHAR *name;   /* 钩子类型名 */
+    const CHAR *args;   /* 回调参数表 */
+    VOID **probes;      /* 回调槽位 */
+} HookInfo;
+
+/*
+ * 打开期间的调用次数, 每个 CPU 一份, 调用路径上不做原子操作也不和别的核争抢缓存行.
+ * 只是粗略统计: 计数时被中断或迁移到别的核上可能少记一次.
+ */
+typedef struct {
+    UINT32 hits[LOS_HOOK_TYPE_END];
+} __attribute__((aligned(64))) HookHitsPercpu;
+
+LosStaticKey g_hookKeys[LOS_HOOK_TYPE_END];
+STATIC HookHitsPercpu g_hookHits[LOSCFG_KERNEL_CORE_NUM];
+LITE_OS_SEC_BSS SPIN_LOCK_INIT(g_hookSpin);
+
+STATIC UINT32 OsHookProbeAdd(HookType type, VOID **probes, VOID *func)
+{
+    UINT32 intSave;
+    UINT32 i;
+    UINT32 free = LOS_HOOK_PROBE_NUM;
+
+    if (func == NULL) {
+        return LOS_ERRNO_HOOK_REG_INVALID;
+    }
+
+    LOS_SpinLockSave(&g_hookSpin, &intSave);
+    for (i = 0; i < LOS_HOOK_PROBE_NUM; i++) {
+        if (probes[i] == func) {
+            LOS_SpinUnlockRestore(&g_hookSpin, intSave);
+            return LOS_ERRNO_HOOK_REG_INVALID;
+        }
+        if ((probes[i] == NULL) && (free == LOS_HOOK_PROBE_NUM)) {
+            free = i;
+        }
+    }
+    if (free == LOS_HOOK_PROBE_NUM) {
+        LOS_SpinUnlockRestore(&g_hookSpin, intSave);
+        return LOS_ERRNO_HOOK_POOL_IS_FULL;
+    }
+    probes[free] = func;
+    LOS_SpinUnlockRestore(&g_hookSpin, intSave);
+
+    LOS_StaticKeyInc(&g_hookKeys[type]);
+    return LOS_OK;
+}
+
+STATIC UINT32 OsHookProbeDel(HookType type, VOID **probes, VOID *func)
+{
+    UINT32 intSave;
+    UINT32 i;
+
+    if (func == NULL) {
+        return LOS_ERRNO_HOOK_UNREG_INVALID;
+    }
+
+    LOS_SpinLockSave(&g_hookSpin, &intSave);
+    for (i = 0; i < LOS_HOOK_PROBE_NUM; i++) {
+        if (probes[i] == func) {
+            probes[i] = NULL;
+            break;
+        }
+    }
+    LOS_SpinUnlockRestore(&g_hookSpin, intSave);
+    if (i == LOS_HOOK_PROBE_NUM) {
+        return LOS_ERRNO_HOOK_UNREG_INVALID;
+    }
+
+    LOS_StaticKeyDec(&g_hookKeys[type]);
+    return LOS_OK;
+}
+
+/// 定义钩子函数, 回调槽位在调用时不加锁读取, 注销后正在执行的回调仍会执行完
+#define LOS_HOOK_TYPE_DEF(type, paramList)                              \
+    STATIC type##_FN g_fn##type[LOS_HOOK_PROBE_NUM];                    \
+    UINT32 type##_RegHook(type##_FN func) {                             \
+        return OsHookProbeAdd(type, (VOID **)g_fn##type, (VOID *)func); \
+    }                                                                   \
+    UINT32 type##_UnRegHook(type##_FN func) {                           \
+        return OsHookProbeDel(type, (VOID **)g_fn##type, (VOID *)func); \
+    }                                                                   \
+    VOID type##_CallHook paramList {                                    \
+        UINT32 probe;                                                   \
+        type##_FN hookFn;                                               \
+        g_hookHits[ArchCurrCpuid()].hits[type]++;                       \
+        for (probe = 0; probe < LOS_HOOK_PROBE_NUM; probe++) {          \
+            hookFn = g_fn##type[probe];                                 \
+            if (hookFn != NULL) {                                       \
+                hookFn(PARAM_TO_ARGS paramList);                        \
+            }                                                           \
+        }                                                               \
     }
 
 LOS_HOOK_ALL_TYPES_DEF;
@@ -65,7 +146,7 @@ LOS_HOOK_ALL_TYPES_DEF;
 LOS_HOOK_TYPE_DEF(LOS_HOOK_TYPE_MEM_INIT, (VOID *pool, UINT32 size))
 拆完之后变成
 
-STATIC LOS_HOOK_TYPE_MEM_INIT_FN g_fnLOS_HOOK_TYPE_MEM_INIT;
+STATIC LOS_HOOK_TYPE_MEM_INIT_FN g_fnLOS_HOOK_TYPE_MEM_INIT[LOS_HOOK_PROBE_NUM];
 
 
 
@@ -73,5 +154,84 @@ STATIC LOS_HOOK_TYPE_MEM_INIT_FN g_fnLOS_HOOK_TYPE_MEM_INIT;
 */
 #undef LOS_HOOK_TYPE_DEF
 
-#endif /* LOSCFG_DEBUG_HOOK */
+/// 钩子注册表, 由同一张类型表生成, 下标就是钩子类型
+#define LOS_HOOK_TYPE_DEF(type, paramList)                  \
+    [type] = { #type, #paramList, (VOID **)g_fn##type },
 
+STATIC const HookInfo g_hookInfo[LOS_HOOK_TYPE_END] = {
+    LOS_HOOK_ALL_TYPES_DEF
+};
+
+#undef LOS_HOOK_TYPE_DEF
+
+#define HOOK_NAME_PREFIX    "LOS_HOOK_TYPE_"
+
+#ifdef LOSCFG_SHELL
+STATIC UINT32 OsHookHitsGet(UINT32 type)
+{
+    UINT32 hits = 0;
+    UINT32 cpuid;
+
+    for (cpuid = 0; cpuid < LOSCFG_KERNEL_CORE_NUM; cpuid++) {
+        hits += g_hookHits[cpuid].hits[type];
+    }
+    return hits;
+}
+
+STATIC VOID OsHookInfoShow(UINT32 type, BOOL verbose)
+{
+    const HookInfo *info = &g_hookInfo[type];
+    UINT32 i;
+
+    PRINTK("%-28s %-6u %-4s %-10u %s\n", info->name + sizeof(HOOK_NAME_PREFIX) - 1,
+           g_hookKeys[type].count, (g_hookKeys[type].count != 0) ? "on" : "off",
+           OsHookHitsGet(type), info->args);
+    if (!verbose) {
+        return;
+    }
+    for (i = 0; i < LOS_HOOK_PROBE_NUM; i++) {
+        if (info->probes[i] != NULL) {
+            PRINTK("    probe %u: %p\n", i, info->probes[i]);
+        }
+    }
+}
+
+/*
+ * 命令格式: tracepoint [name | reset]
+ * 不带参数时列出所有钩子的回调数, 开关状态, 调用次数和参数表, 带钩子名时另外打印回调地址
+ */
+LITE_OS_SEC_TEXT_MINOR UINT32 OsShellCmdTracepoint(INT32 argc, const CHAR **argv)
+{
+    UINT32 type;
+    BOOL found = FALSE;
+
+    if (argc > 1) {
+        PRINTK("\nUsage: tracepoint [name | reset]\n");
+        return LOS_NOK;
+    }
+
+    if ((argc == 1) && (strcmp(argv[0], "reset") == 0)) {
+        (VOID)memset_s(g_hookHits, sizeof(g_hookHits), 0, sizeof(g_hookHits));
+        return LOS_OK;
+    }
+
+    PRINTK("%-28s %-6s %-4s %-10s %s\n", "name", "probes", "key", "hits", "args");
+    for (type = LOS_HOOK_TYPE_START + 1; type < LOS_HOOK_TYPE_END; type++) {
+        if (argc == 0) {
+            OsHookInfoShow(type, FALSE);
+        } else if (strcmp(argv[0], g_hookInfo[type].name + sizeof(HOOK_NAME_PREFIX) - 1) == 0) {
+            OsHookInfoShow(type, TRUE);
+            found = TRUE;
+        }
+    }
+    if ((argc == 1) && !found) {
+        PRINTK("tracepoint %s not found\n", argv[0]);
+        return LOS_NOK;
+    }
+    return LOS_OK;
+}
+
+SHELLCMD_ENTRY(tracepoint_shellcmd, CMD_TYPE_EX, "tracepoint", XARGS, (CmdCallBackFunc)OsShellCmdTracepoint);
+#endif
+
+#endif /* LOSCFG_DEBUG_HOOK */
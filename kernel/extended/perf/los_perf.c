@@ -37,6 +37,11 @@
 #include "los_tick.h"
 #include "los_sys.h"
 #include "los_spinlock.h"
+#include "los_sched_pri.h"
+#ifdef LOSCFG_ARCH_USER_UNWIND
+#include "los_unwind_pri.h"
+#include "los_vm_map.h"
+#endif
 
 STATIC Pmu *g_pmu = NULL;
 STATIC PerfCB g_perfCb = {0};
@@ -127,8 +132,19 @@ STATIC VOID OsPerfPrintCount(VOID)
         if (event->period == 0) {
             continue;
         }
-        PRINT_EMG("[%s] eventType: 0x%x [core %u]: %llu\n", g_pmu->getName(event), event->eventId, cpuid,
-            event->count[cpuid]);
+        UINT64 enabled = event->timeEnabled[cpuid];
+        UINT64 running = event->timeRunning[cpuid];
+        if ((enabled != 0) && (running == 0)) {
+            PRINT_EMG("[%s] eventType: 0x%x [core %u]: <not counted>\n", g_pmu->getName(event), event->eventId, cpuid);
+        } else if (running < enabled) { /* multiplexed, scale up to the whole enabled time */
+            PRINT_EMG("[%s] eventType: 0x%x [core %u]: %llu (scaled from %llu, %u%% running)\n",
+                g_pmu->getName(event), event->eventId, cpuid,
+                (UINT64)((DOUBLE)event->count[cpuid] * enabled / running), event->count[cpuid],
+                (UINT32)(running * 100 / enabled)); /* 100: percent */
+        } else {
+            PRINT_EMG("[%s] eventType: 0x%x [core %u]: %llu\n", g_pmu->getName(event), event->eventId, cpuid,
+                event->count[cpuid]);
+        }
     }
     PERF_UNLOCK(intSave);
 }
@@ -160,6 +176,8 @@ STATIC VOID OsPerfStart(VOID)
         }
 
         g_perfCb.pmuStatusPerCpu[cpuid] = PERF_PMU_STARTED;
+        g_perfCb.pausedPerCpu[cpuid] = FALSE;
+        OsPerfTaskSwitch(OsCurrTaskGet(), OsCurrTaskGet()); /* pause at once if the current task is filtered out */
     } else {
         PRINT_ERR("percpu status err %d\n", g_perfCb.pmuStatusPerCpu[cpuid]);
     }
@@ -214,9 +232,61 @@ STATIC INLINE UINT32 OsPerfSaveIpInfo(CHAR *buf, IpInfo *info)
     return size;
 }
 
+#ifdef LOSCFG_ARCH_USER_UNWIND
+/* 中断入口保存的被打断现场, 每个核一份, 只在本核的中断里读写 */
+STATIC UINTPTR g_perfIrqRegs[LOSCFG_KERNEL_CORE_NUM][PERF_IRQ_REG_NUM];
+STATIC BOOL g_perfIrqRegsValid[LOSCFG_KERNEL_CORE_NUM];
+
+/*
+ * User frames are unwound with the EXIDX tables. When the sample hits a system call they follow the kernel
+ * frames and start from the user context saved at the kernel stack bottom. When the sample interrupted
+ * user mode they start from r4-r11, sp and lr saved by the irq entry; without those only the pc is kept.
+ */
+STATIC UINT32 OsPerfUserBackTrace(IpInfo *callChain, UINT32 maxDepth, const PerfRegs *regs)
+{
+    UnwindRegs unwindRegs;
+    UINTPTR pcs[PERF_MAX_CALLCHAIN_DEPTH + 1];
+    const UINTPTR *irqRegs = NULL;
+    UINT32 skip = 0;
+    UINT32 count, i;
+
+    if ((maxDepth == 0) || (OsUnwindUserRegsGet(&unwindRegs) != TRUE)) {
+        return 0;
+    }
+    if (LOS_IsUserAddress(regs->pc)) {
+        if (!OS_INT_ACTIVE || !g_perfIrqRegsValid[ArchCurrCpuid()]) {
+            return 0; /* the sample ip is recorded on its own */
+        }
+        irqRegs = g_perfIrqRegs[ArchCurrCpuid()];
+        for (i = 0; i < PERF_IRQ_REG_USP; i++) {
+            unwindRegs.R[4 + i] = irqRegs[i]; /* 4: irqRegs starts with r4 */
+        }
+        unwindRegs.R[UNWIND_REG_SP] = irqRegs[PERF_IRQ_REG_USP];
+        unwindRegs.R[UNWIND_REG_LR] = irqRegs[PERF_IRQ_REG_ULR];
+        unwindRegs.R[UNWIND_REG_PC] = regs->pc;
+        skip = 1;
+    }
+
+    count = OsUnwindUser(&unwindRegs, pcs, MIN(maxDepth + skip, PERF_MAX_CALLCHAIN_DEPTH + 1));
+    for (i = skip; i < count; i++) {
+        (VOID)OsGetUsrIpInfo(pcs[i], &callChain[i - skip]);
+    }
+    return (count > skip) ? (count - skip) : 0;
+}
+#endif
+
 STATIC UINT32 OsPerfBackTrace(PerfBackTrace *callChain, UINT32 maxDepth, PerfRegs *regs)
 {
-    UINT32 count = BackTraceGet(regs->fp, (IpInfo *)(callChain->ip), maxDepth);
+    UINT32 count = 0;
+
+#ifdef LOSCFG_ARCH_USER_UNWIND
+    if (!LOS_IsUserAddress(regs->pc)) {
+        count = BackTraceGet(regs->fp, (IpInfo *)(callChain->ip), maxDepth);
+    }
+    count += OsPerfUserBackTrace(&callChain->ip[count], maxDepth - count, regs);
+#else
+    count = BackTraceGet(regs->fp, (IpInfo *)(callChain->ip), maxDepth);
+#endif
     PRINT_DEBUG("backtrace depth = %u, fp = 0x%x\n", count, regs->fp);
     return count;
 }
@@ -336,7 +406,7 @@ STATIC UINT32 OsPerfHdrInit(UINT32 id)
         .eventType  = g_pmu->type,
         .len        = sizeof(PerfDataHdr),
     };
-    return OsPerfOutputWrite((CHAR *)&head, head.len);
+    return OsPerfOutputHdrWrite((CHAR *)&head, head.len);
 }
 
 VOID OsPerfUpdateEventCount(Event *event, UINT32 value)
@@ -372,7 +442,7 @@ STATIC UINT32 OsPerfInit(VOID)
         goto PERF_INIT_ERROR;
     }
 
-    ret = OsPerfOutputInit(NULL, LOSCFG_PERF_BUFFER_SIZE);
+    ret = OsPerfOutputInit(LOSCFG_PERF_BUFFER_SIZE);
     if (ret != LOS_OK) {
         ret = LOS_ERRNO_PERF_BUF_ERROR;
         goto PERF_INIT_ERROR;
@@ -444,6 +514,7 @@ UINT32 LOS_PerfConfig(PerfConfigAttr *attr)
 
     OsPerfSetFilterIds(g_perfCb.taskIds, &g_perfCb.taskIdsNr, attr->taskIds, attr->taskIdsNr);
     OsPerfSetFilterIds(g_perfCb.processIds, &g_perfCb.processIdsNr, attr->processIds, attr->processIdsNr);
+    g_perfCb.perTask = (g_perfCb.taskIdsNr != 0) || (g_perfCb.processIdsNr != 0);
 
     ret = OsPerfConfig(&attr->eventsCfg);
     PerfInfoDump();
@@ -534,11 +605,81 @@ VOID LOS_PerfFlushHookReg(const PERF_BUF_FLUSH_HOOK func)
     PERF_UNLOCK(intSave);
 }
 
-VOID OsPerfSetIrqRegs(UINTPTR pc, UINTPTR fp)
+VOID *LOS_PerfRingBufGet(UINT32 *size)
+{
+    if ((size == NULL) || (g_perfCb.status == PERF_UNINIT)) {
+        return NULL;
+    }
+    return OsPerfOutputBufGet(size);
+}
+
+/*
+ * 采样可能在调度器的钩子里写入, 那里持有任务锁, 写者没法发事件唤醒读者, 所以读者按tick检查水位线
+ */
+UINT32 LOS_PerfDataWait(UINT32 timeout)
+{
+    UINT32 waited = 0;
+
+    while (!OsPerfOutputReady()) {
+        if (g_perfCb.status != PERF_STARTED) {
+            return LOS_OK;
+        }
+        if (waited >= timeout) {
+            return LOS_NOK;
+        }
+        (VOID)LOS_TaskDelay(1);
+        waited++;
+    }
+    return LOS_OK;
+}
+
+VOID LOS_PerfWakeupMarkSet(UINT32 bytes)
+{
+    if (g_perfCb.status != PERF_UNINIT) {
+        OsPerfOutputWakeupMarkSet(bytes);
+    }
+}
+
+/*
+ * With a task or process filter the counters only run while a filtered task is on the cpu. Called from
+ * OsSchedTaskSwitch with the task lock held, the pmu keeps its values while paused.
+ */
+VOID OsPerfTaskSwitch(const LosTaskCB *runTask, const LosTaskCB *newTask)
+{
+    UINT32 cpuid = ArchCurrCpuid();
+    BOOL pause;
+
+    (VOID)runTask;
+    if (!g_perfCb.perTask || (g_perfCb.pmuStatusPerCpu[cpuid] != PERF_PMU_STARTED) || (g_pmu->pause == NULL)) {
+        return;
+    }
+
+    pause = !OsPerfFilter(newTask->taskID, newTask->processID);
+    if (pause == g_perfCb.pausedPerCpu[cpuid]) {
+        return;
+    }
+    g_perfCb.pausedPerCpu[cpuid] = pause;
+    if (pause) {
+        g_pmu->pause();
+    } else {
+        g_pmu->resume();
+    }
+}
+
+VOID OsPerfSetIrqRegs(UINTPTR pc, UINTPTR fp, const UINTPTR *irqRegs)
 {
     LosTaskCB *runTask = (LosTaskCB *)ArchCurrTaskGet();
     runTask->pc = pc;
     runTask->fp = fp;
+#ifdef LOSCFG_ARCH_USER_UNWIND
+    UINT32 cpuid = ArchCurrCpuid();
+    g_perfIrqRegsValid[cpuid] = (irqRegs != NULL);
+    if (irqRegs != NULL) {
+        (VOID)memcpy_s(g_perfIrqRegs[cpuid], sizeof(g_perfIrqRegs[cpuid]), irqRegs, sizeof(g_perfIrqRegs[cpuid]));
+    }
+#else
+    (VOID)irqRegs;
+#endif
 }
 
 LOS_MODULE_INIT(OsPerfInit, LOS_INIT_LEVEL_KMOD_EXTENDED);
@@ -47,6 +47,7 @@ extern "C" {
 #define PERF_EVENT_TO_CODE       0
 #define PERF_CODE_TO_EVENT       1
 #define PERF_DATA_MAGIC_WORD     0xEFEFEF00
+#define PERF_EVENT_GROUP_ALL     0xFFFFFFFF /* event stays on its counter, never multiplexed */
 
 #define SMP_CALL_PERF_FUNC(func)  OsMpFuncCall(OS_MP_CPU_ALL, (SMP_FUNC_CALL)func, NULL)
 
@@ -89,6 +90,9 @@ typedef struct {
     UINT32 eventId;
     UINT32 period;
     UINT64 count[LOSCFG_KERNEL_CORE_NUM];
+    UINT32 group;                                   /* multiplexing group, PERF_EVENT_GROUP_ALL if always counted */
+    UINT64 timeEnabled[LOSCFG_KERNEL_CORE_NUM];     /* cycles the pmu was counting for us on this cpu */
+    UINT64 timeRunning[LOSCFG_KERNEL_CORE_NUM];     /* cycles this event actually owned a counter */
 } Event;
 
 typedef struct {
@@ -104,6 +108,8 @@ typedef struct {
     UINT32 (*start)(VOID);
     UINT32 (*stop)(VOID);
     CHAR *(*getName)(Event *event);
+    VOID (*pause)(VOID);                /* optional, stop counting while no filtered task runs */
+    VOID (*resume)(VOID);
 } Pmu;
 
 typedef struct {
@@ -122,6 +128,8 @@ typedef struct {
     UINT32                  processIds[PERF_MAX_FILTER_TSKS];
     UINT8                   processIdsNr;
     UINT8                   needSample;
+    UINT8                   perTask;            /* count only while a filtered task is on the cpu */
+    BOOL                    pausedPerCpu[LOSCFG_KERNEL_CORE_NUM];
 } PerfCB;
 
 #ifndef OsPerfArchFetchIrqRegs
@@ -145,7 +153,12 @@ STATIC INLINE VOID OsPerfFetchCallerRegs(PerfRegs *regs)
     PRINT_DEBUG("pc = 0x%x, fp = 0x%x\n", regs->pc, regs->fp);
 }
 
-extern VOID OsPerfSetIrqRegs(UINTPTR pc, UINTPTR fp);
+/* r4-r11, 用户态 sp 和 lr, 由中断入口保存, 见 los_dispatch.S */
+#define PERF_IRQ_REG_NUM            10
+#define PERF_IRQ_REG_USP            8
+#define PERF_IRQ_REG_ULR            9
+
+extern VOID OsPerfSetIrqRegs(UINTPTR pc, UINTPTR fp, const UINTPTR *irqRegs);
 extern VOID OsPerfUpdateEventCount(Event *event, UINT32 value);
 extern VOID OsPerfHandleOverFlow(Event *event, PerfRegs *regs);
 
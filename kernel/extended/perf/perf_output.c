@@ -30,6 +30,12 @@
  */
 
 #include "perf_output_pri.h"
+#include "los_vm_phys.h"
+#include "los_vm_map.h"
+
+#define PERF_RECORD_ALIGN(size)     ALIGN((size), sizeof(UINT32))
+#define PERF_LOST_RECORD_SIZE       (sizeof(PerfRecordHdr) + sizeof(UINT32))
+#define PERF_RING_SIZE(ring)        ((ring)->mask + 1)
 
 STATIC PERF_BUF_NOTIFY_HOOK g_perfBufNotifyHook = NULL;
 STATIC PERF_BUF_FLUSH_HOOK g_perfBufFlushHook = NULL;
@@ -40,79 +46,269 @@ STATIC VOID OsPerfDefaultNotify(VOID)
     PRINT_INFO("perf buf waterline notify!\n");
 }
 
-UINT32 OsPerfOutputInit(VOID *buf, UINT32 size)
+/*
+ * 每个核一个环: 一页控制页加上2的幂次页数据区. 所有核的环放在一段物理连续内存里,
+ * 整段映射给用户态就能直接读, 不用再经过read拷贝
+ */
+UINT32 OsPerfOutputInit(UINT32 size)
 {
-    UINT32 ret;
-    BOOL releaseFlag = FALSE;
-    if (buf == NULL) {
-        buf = LOS_MemAlloc(m_aucSysMem1, size);
-        if (buf == NULL) {
-            return LOS_NOK;
-        } else {
-            releaseFlag = TRUE;
-        }
+    UINT32 dataPages = 1;
+    UINT32 ringSize;
+    UINT32 cpu;
+    PerfCpuRing *ring = NULL;
+
+    while (((dataPages << 1) << PAGE_SHIFT) * LOSCFG_KERNEL_CORE_NUM <= size) {
+        dataPages <<= 1;
     }
-    ret = LOS_CirBufInit(&g_perfOutputCb.ringbuf, buf, size);
-    if (ret != LOS_OK) {
-        goto RELEASE;
+    ringSize = (dataPages + 1) << PAGE_SHIFT;
+    g_perfOutputCb.size = ringSize * LOSCFG_KERNEL_CORE_NUM;
+    g_perfOutputCb.base = LOS_PhysPagesAllocContiguous(g_perfOutputCb.size >> PAGE_SHIFT);
+    if (g_perfOutputCb.base == NULL) {
+        return LOS_NOK;
+    }
+    (VOID)memset_s(g_perfOutputCb.base, g_perfOutputCb.size, 0, g_perfOutputCb.size);
+
+    for (cpu = 0; cpu < LOSCFG_KERNEL_CORE_NUM; cpu++) {
+        ring = &g_perfOutputCb.ring[cpu];
+        ring->ctrl = (PerfMmapPage *)((UINTPTR)g_perfOutputCb.base + cpu * ringSize);
+        ring->data = (CHAR *)ring->ctrl + PAGE_SIZE;
+        ring->mask = (dataPages << PAGE_SHIFT) - 1;
+        ring->head = 0;
+        ring->ctrl->version = PERF_MMAP_VERSION;
+        ring->ctrl->cpuid = cpu;
+        ring->ctrl->cpuNum = LOSCFG_KERNEL_CORE_NUM;
+        ring->ctrl->dataOffset = PAGE_SIZE;
+        ring->ctrl->dataSize = dataPages << PAGE_SHIFT;
+        ring->ctrl->wakeupMark = ring->ctrl->dataSize / PERF_BUFFER_WATERMARK_ONE_N;
     }
-    g_perfOutputCb.waterMark = size / PERF_BUFFER_WATERMARK_ONE_N;
     g_perfBufNotifyHook = OsPerfDefaultNotify;
-    return ret;
-RELEASE:
-    if (releaseFlag) {
-        (VOID)LOS_MemFree(m_aucSysMem1, buf);
+    return LOS_OK;
+}
+
+STATIC VOID OsPerfRingFlush(const PerfCpuRing *ring)
+{
+    if (g_perfBufFlushHook != NULL) {
+        g_perfBufFlushHook(ring->data, PERF_RING_SIZE(ring));
     }
-    return ret;
 }
 
 VOID OsPerfOutputFlush(VOID)
 {
-    if (g_perfBufFlushHook != NULL) {
-        g_perfBufFlushHook(g_perfOutputCb.ringbuf.fifo, g_perfOutputCb.ringbuf.size);
+    UINT32 cpu;
+
+    for (cpu = 0; cpu < LOSCFG_KERNEL_CORE_NUM; cpu++) {
+        OsPerfRingFlush(&g_perfOutputCb.ring[cpu]);
     }
 }
 
-UINT32 OsPerfOutputRead(CHAR *dest, UINT32 size)
+STATIC INLINE UINT32 OsPerfRingUsed(const PerfCpuRing *ring)
 {
-    OsPerfOutputFlush();
-    return LOS_CirBufRead(&g_perfOutputCb.ringbuf, dest, size);
+    UINT32 used = ring->head - *(volatile UINT32 *)&ring->ctrl->dataTail;
+    return (used > PERF_RING_SIZE(ring)) ? PERF_RING_SIZE(ring) : used; /* a broken tail from user only stalls */
 }
 
-STATIC BOOL OsPerfOutputBegin(UINT32 size)
+/// 按环内偏移拷贝, 到数据区末尾就绕回开头
+STATIC VOID OsPerfRingCopyIn(PerfCpuRing *ring, UINT32 offset, const VOID *src, UINT32 size)
 {
-    if (g_perfOutputCb.ringbuf.remain < size) {
-        PRINT_INFO("perf buf has no enough space for 0x%x\n", size);
-        return FALSE;
+    UINT32 pos = offset & ring->mask;
+    UINT32 first = ((PERF_RING_SIZE(ring) - pos) < size) ? (PERF_RING_SIZE(ring) - pos) : size;
+
+    (VOID)memcpy_s(ring->data + pos, first, src, first);
+    if (first < size) {
+        (VOID)memcpy_s(ring->data, size - first, (const CHAR *)src + first, size - first);
     }
-    return TRUE;
 }
 
-STATIC VOID OsPerfOutputEnd(VOID)
+STATIC VOID OsPerfRingCopyOut(const PerfCpuRing *ring, UINT32 offset, VOID *dest, UINT32 size)
 {
-    OsPerfOutputFlush();
-    if (LOS_CirBufUsedSize(&g_perfOutputCb.ringbuf) >= g_perfOutputCb.waterMark) {
-        if (g_perfBufNotifyHook != NULL) {
-            g_perfBufNotifyHook();
-        }
+    UINT32 pos = offset & ring->mask;
+    UINT32 first = ((PERF_RING_SIZE(ring) - pos) < size) ? (PERF_RING_SIZE(ring) - pos) : size;
+
+    (VOID)memcpy_s(dest, first, ring->data + pos, first);
+    if (first < size) {
+        (VOID)memcpy_s((CHAR *)dest + first, size - first, ring->data, size - first);
     }
 }
 
-UINT32 OsPerfOutputWrite(CHAR *data, UINT32 size)
+STATIC UINT32 OsPerfRingRecord(PerfCpuRing *ring, UINT32 head, UINT16 type, const VOID *payload, UINT32 len)
 {
-    if (!OsPerfOutputBegin(size)) {
+    PerfRecordHdr hdr = {
+        .type = type,
+        .size = (UINT16)(sizeof(PerfRecordHdr) + len),
+    };
+
+    OsPerfRingCopyIn(ring, head, &hdr, sizeof(PerfRecordHdr));
+    OsPerfRingCopyIn(ring, head + sizeof(PerfRecordHdr), payload, len);
+    return head + PERF_RECORD_ALIGN(hdr.size);
+}
+
+/*
+ * 环只有所属的核写, 调用者关本核中断即可. 空间不够就丢弃并计数, 等有空间了先补一条丢失记录,
+ * 读者据此知道中间少了多少个采样. 记录写完整后才推进dataHead
+ */
+STATIC UINT32 OsPerfRingPut(PerfCpuRing *ring, UINT16 type, const CHAR *data, UINT32 size)
+{
+    UINT32 head = ring->head;
+    UINT32 recSize = PERF_RECORD_ALIGN(sizeof(PerfRecordHdr) + size);
+    UINT32 space;
+
+    if ((recSize > PERF_RING_SIZE(ring)) || (recSize > 0xFFFF)) { /* 0xFFFF: record size is UINT16 */
+        return LOS_NOK;
+    }
+    space = PERF_RING_SIZE(ring) - OsPerfRingUsed(ring);
+    DMB; /* read dataTail before overwriting the data the reader has released */
+    if ((space < recSize) || ((ring->pendingLost != 0) && (space < recSize + PERF_LOST_RECORD_SIZE))) {
+        ring->pendingLost++;
+        ring->ctrl->lost++;
         return LOS_NOK;
     }
+    if (ring->pendingLost != 0) {
+        head = OsPerfRingRecord(ring, head, PERF_RECORD_TYPE_LOST, &ring->pendingLost, sizeof(UINT32));
+        ring->pendingLost = 0;
+    }
+    head = OsPerfRingRecord(ring, head, type, data, size);
+    DMB; /* the record must be complete before the reader sees the new head */
+    ring->head = head;
+    ring->ctrl->dataHead = head;
+    return LOS_OK;
+}
 
-    LOS_CirBufWrite(&g_perfOutputCb.ringbuf, data, size);
+STATIC VOID OsPerfOutputEnd(PerfCpuRing *ring, UINT32 size)
+{
+    UINT32 used;
 
-    OsPerfOutputEnd();
-    return LOS_OK;
+    OsPerfRingFlush(ring);
+    used = OsPerfRingUsed(ring);
+    if (used < ring->ctrl->wakeupMark) {
+        return;
+    }
+    if ((used - size < ring->ctrl->wakeupMark) && (g_perfBufNotifyHook != NULL)) { /* only when crossing the mark */
+        g_perfBufNotifyHook();
+    }
+}
+
+/// 采样写进当前核的环
+UINT32 OsPerfOutputWrite(CHAR *data, UINT32 size)
+{
+    UINT32 intSave;
+    UINT32 ret;
+    PerfCpuRing *ring = NULL;
+
+    intSave = LOS_IntLock();
+    ring = &g_perfOutputCb.ring[ArchCurrCpuid()];
+    ret = OsPerfRingPut(ring, PERF_RECORD_TYPE_SAMPLE, data, size);
+    if (ret == LOS_OK) {
+        OsPerfOutputEnd(ring, size);
+    }
+    LOS_IntRestore(intSave);
+    return ret;
+}
+
+/// 段头固定写进0号核的环, 此时各核的pmu还没启动, 没有别的写者
+UINT32 OsPerfOutputHdrWrite(CHAR *data, UINT32 size)
+{
+    UINT32 intSave;
+    UINT32 ret;
+
+    intSave = LOS_IntLock();
+    ret = OsPerfRingPut(&g_perfOutputCb.ring[0], PERF_RECORD_TYPE_HDR, data, size);
+    LOS_IntRestore(intSave);
+    return ret;
+}
+
+/*
+ * 拷出一个环里的整条记录, 去掉记录头, 跳过丢失记录, 和原来单个缓冲区的数据格式一样.
+ * dataTail 和数据区用户态都能写, 不对齐或越过 head 的 tail, 以及长度不对的记录头都当作环已损坏,
+ * 丢掉剩下的数据, 循环次数不超过环里的记录数
+ */
+STATIC UINT32 OsPerfRingRead(PerfCpuRing *ring, CHAR *dest, UINT32 size)
+{
+    PerfRecordHdr hdr;
+    UINT32 head = *(volatile UINT32 *)&ring->head;
+    UINT32 tail = *(volatile UINT32 *)&ring->ctrl->dataTail;
+    UINT32 copied = 0;
+    UINT32 len;
+
+    DMB; /* read the records after dataHead */
+    if ((tail != PERF_RECORD_ALIGN(tail)) || ((head - tail) > PERF_RING_SIZE(ring))) {
+        tail = head;
+    }
+    while (tail != head) {
+        OsPerfRingCopyOut(ring, tail, &hdr, sizeof(PerfRecordHdr));
+        if ((hdr.size < sizeof(PerfRecordHdr)) || (PERF_RECORD_ALIGN(hdr.size) > (head - tail))) {
+            tail = head;
+            break;
+        }
+        len = hdr.size - sizeof(PerfRecordHdr);
+        if (hdr.type != PERF_RECORD_TYPE_LOST) {
+            if (copied + len > size) {
+                break;
+            }
+            OsPerfRingCopyOut(ring, tail + sizeof(PerfRecordHdr), dest + copied, len);
+            copied += len;
+        }
+        tail += PERF_RECORD_ALIGN(hdr.size);
+    }
+    DMB; /* finish reading before releasing the space */
+    ring->ctrl->dataTail = tail;
+    return copied;
+}
+
+UINT32 OsPerfOutputRead(CHAR *dest, UINT32 size)
+{
+    UINT32 cpu;
+    UINT32 copied = 0;
+
+    OsPerfOutputFlush();
+    for (cpu = 0; cpu < LOSCFG_KERNEL_CORE_NUM; cpu++) {
+        copied += OsPerfRingRead(&g_perfOutputCb.ring[cpu], dest + copied, size - copied);
+    }
+    return copied;
+}
+
+BOOL OsPerfOutputReady(VOID)
+{
+    UINT32 cpu;
+    PerfCpuRing *ring = NULL;
+
+    for (cpu = 0; cpu < LOSCFG_KERNEL_CORE_NUM; cpu++) {
+        ring = &g_perfOutputCb.ring[cpu];
+        if (OsPerfRingUsed(ring) >= ring->ctrl->wakeupMark) {
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+VOID OsPerfOutputWakeupMarkSet(UINT32 bytes)
+{
+    UINT32 cpu;
+    PerfMmapPage *ctrl = NULL;
+
+    for (cpu = 0; cpu < LOSCFG_KERNEL_CORE_NUM; cpu++) {
+        ctrl = g_perfOutputCb.ring[cpu].ctrl;
+        ctrl->wakeupMark = (bytes < sizeof(PerfRecordHdr)) ? sizeof(PerfRecordHdr) :
+                           ((bytes > PERF_RING_SIZE(&g_perfOutputCb.ring[cpu])) ?
+                            PERF_RING_SIZE(&g_perfOutputCb.ring[cpu]) : bytes);
+    }
+}
+
+VOID *OsPerfOutputBufGet(UINT32 *size)
+{
+    *size = g_perfOutputCb.size;
+    return g_perfOutputCb.base;
 }
 
 VOID OsPerfOutputInfo(VOID)
 {
-    PRINT_EMG("dump perf data, addr: %p length: %#x\n", g_perfOutputCb.ringbuf.fifo, g_perfOutputCb.ringbuf.size);
+    UINT32 cpu;
+    PerfCpuRing *ring = NULL;
+
+    for (cpu = 0; cpu < LOSCFG_KERNEL_CORE_NUM; cpu++) {
+        ring = &g_perfOutputCb.ring[cpu];
+        PRINT_EMG("dump perf data, cpu %u addr: %p length: %#x used: %#x lost: %u\n", cpu, ring->data,
+            PERF_RING_SIZE(ring), OsPerfRingUsed(ring), ring->ctrl->lost);
+    }
 }
 
 VOID OsPerfNotifyHookReg(const PERF_BUF_NOTIFY_HOOK func)
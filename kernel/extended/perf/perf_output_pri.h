@@ -33,7 +33,6 @@
 #define _PERF_OUTPUT_PRI_H
 
 #include "los_perf_pri.h"
-#include "los_cir_buf.h"
 
 #ifdef __cplusplus
 #if __cplusplus
@@ -41,14 +40,29 @@ extern "C" {
 #endif /* __cplusplus */
 #endif /* __cplusplus */
 
+#define PERF_MMAP_VERSION           1
+
+typedef struct {
+    PerfMmapPage *ctrl;        /* control page shared with the reader */
+    CHAR *data;                /* data area right after the control page */
+    UINT32 mask;               /* dataSize - 1, the control page is writable by user so use this copy */
+    UINT32 head;               /* kernel copy of dataHead */
+    UINT32 pendingLost;        /* dropped samples not reported by a lost record yet */
+} PerfCpuRing;
+
 typedef struct {
-    CirBuf ringbuf;           /* ring buffer */
-    UINT32 waterMark;          /* notify water mark */
+    PerfCpuRing ring[LOSCFG_KERNEL_CORE_NUM]; /* written only by its own cpu */
+    VOID *base;                /* rings of all cpus, physically contiguous */
+    UINT32 size;               /* total size of the rings */
 } PerfOutputCB;
 
-extern UINT32 OsPerfOutputInit(VOID *buf, UINT32 size);
+extern UINT32 OsPerfOutputInit(UINT32 size);
 extern UINT32 OsPerfOutputRead(CHAR *dest, UINT32 size);
 extern UINT32 OsPerfOutputWrite(CHAR *data, UINT32 size);
+extern UINT32 OsPerfOutputHdrWrite(CHAR *data, UINT32 size);
+extern BOOL OsPerfOutputReady(VOID);
+extern VOID OsPerfOutputWakeupMarkSet(UINT32 bytes);
+extern VOID *OsPerfOutputBufGet(UINT32 *size);
 extern VOID OsPerfOutputInfo(VOID);
 extern VOID OsPerfOutputFlush(VOID);
 extern VOID OsPerfNotifyHookReg(const PERF_BUF_NOTIFY_HOOK func);
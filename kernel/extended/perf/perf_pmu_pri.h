@@ -120,6 +120,9 @@ extern UINT32 OsGetPmuCounter0(VOID);
 extern UINT32 OsGetPmuMaxCounter(VOID);
 extern UINT32 OsGetPmuCycleCounter(VOID);
 extern UINT32 OsPerfHwInit(HwPmu *hwPmu);
+extern BOOL OsPerfHwEventActive(const Event *event);
+extern VOID OsPerfHwMuxTick(VOID);
+extern BOOL OsPerfHwCounting(VOID);
 
 #ifdef __cplusplus
 #if __cplusplus
@@ -44,22 +44,61 @@ STATIC CHAR *g_eventName[PERF_COUNT_HW_MAX] = {
     [PERF_COUNT_HW_BRANCH_MISSES]           = "branches-misses",
 };
 
+/*
+ * Events beyond the programmable counters are split into groups that take turns on the counters, the cycle
+ * event keeps the cycle counter. Each cpu rotates its own group from the pmu interrupt, and every event
+ * accumulates timeEnabled/timeRunning so the count can be scaled by enabled / running when printed.
+ * Rotation only happens on a counter overflow at least 4ms after the last one. Without a cycle event the
+ * cycle counter is borrowed as a clock that overflows about every PERF_HW_MUX_CLOCK_PERIOD cycles; with one,
+ * its period sets the pace, so a long period rotates the groups less often than every 4ms.
+ */
+#define PERF_HW_MUX_INTERVAL        (OS_SYS_CLOCK / 1000 * 4)   /* rotate at most every 4ms */
+#define PERF_HW_MUX_CLOCK_PERIOD    0x100000                    /* cycle counter irq when no cycle event */
+#define PERF_HW_CNT_DIVIDER_SHIFT   6                           /* divided cycle counter counts every 64th cycle */
+
+typedef struct {
+    UINT64 lastTime;            /* last time the event times were updated */
+    UINT64 lastRotate;          /* last time the groups were rotated */
+    UINT32 group;               /* group currently on the counters */
+    BOOL counting;              /* FALSE while paused for a task that is filtered out */
+} PerfHwCpu;
+
+STATIC PerfHwCpu g_perfHwCpu[LOSCFG_KERNEL_CORE_NUM];
+STATIC UINT32 g_perfHwGroupNr;
+STATIC Event g_perfHwMuxClock;  /* only rotates the groups, never reported */
+STATIC BOOL g_perfHwMuxClockOn;
+
+/* the pmu interrupt restarts the counters only when this cpu is counting, not while paused or stopped */
+BOOL OsPerfHwCounting(VOID)
+{
+    return g_perfHwCpu[ArchCurrCpuid()].counting;
+}
+
+BOOL OsPerfHwEventActive(const Event *event)
+{
+    return (event->group == PERF_EVENT_GROUP_ALL) || (event->group == g_perfHwCpu[ArchCurrCpuid()].group);
+}
+
 /**
  * 1.If config event is PERF_EVENT_TYPE_HW, then map it to the real eventId first, otherwise use the configured
  * eventId directly.
- * 2.Find available counter for each event.
+ * 2.Find available counter for each event, events beyond the counters go to the next multiplexing group.
  * 3.Decide whether this hardware pmu need prescaler (once every 64 cycle counts).
  */
 STATIC UINT32 OsPerfHwConfig(VOID)
 {
     UINT32 i;
     HwPmu *armPmu = GET_HW_PMU(g_perfHw);
+    BOOL hasCycle = FALSE;
+    UINT32 cyclePeriod = 0;
 
     UINT32 maxCounter = OsGetPmuMaxCounter();
-    UINT32 counter = OsGetPmuCounter0();
+    UINT32 counter0 = OsGetPmuCounter0();
     UINT32 cycleCounter = OsGetPmuCycleCounter();
+    UINT32 counterNr = maxCounter - counter0;
+    UINT32 index = 0;
     UINT32 cycleCode = armPmu->mapEvent(PERF_COUNT_HW_CPU_CYCLES, PERF_EVENT_TO_CODE);
-    if (cycleCode == PERF_HW_INVALID_EVENT_TYPE) {
+    if ((cycleCode == PERF_HW_INVALID_EVENT_TYPE) || (counterNr == 0)) {
         return LOS_NOK;
     }
 
@@ -83,31 +122,123 @@ STATIC UINT32 OsPerfHwConfig(VOID)
             event->eventId = eventId;
         }
 
-        if (event->eventId == cycleCode) {
+        if ((event->eventId == cycleCode) && !hasCycle) {
             event->counter = cycleCounter;
+            event->group = PERF_EVENT_GROUP_ALL;
+            hasCycle = TRUE;
+            cyclePeriod = event->period;
         } else {
-            event->counter = counter;
-            counter++;
+            event->counter = counter0 + (index % counterNr);
+            event->group = index / counterNr;
+            index++;
         }
 
-        if (counter >= maxCounter) {
-            PRINT_ERR("max events: %u excluding cycle event\n", maxCounter - 1);
-            return LOS_NOK;
-        }
-
-        PRINT_DEBUG("Perf Config %u eventId = 0x%x, counter = 0x%x, period = 0x%x\n", i, event->eventId, event->counter,
-            event->period);
+        PRINT_DEBUG("Perf Config %u eventId = 0x%x, counter = 0x%x, group = %u, period = 0x%x\n", i, event->eventId,
+            event->counter, event->group, event->period);
     }
 
     armPmu->cntDivided = events->cntDivided & armPmu->canDivided;
+
+    g_perfHwGroupNr = (index == 0) ? 1 : ((index + counterNr - 1) / counterNr);
+    g_perfHwMuxClockOn = (g_perfHwGroupNr > 1) && !hasCycle;
+    g_perfHwMuxClock.counter = cycleCounter;
+    g_perfHwMuxClock.eventId = cycleCode;
+    /* keep the clock in cpu cycles when the cycle counter is divided */
+    g_perfHwMuxClock.period = (armPmu->cntDivided != 0) ? (PERF_HW_MUX_CLOCK_PERIOD >> PERF_HW_CNT_DIVIDER_SHIFT) :
+        PERF_HW_MUX_CLOCK_PERIOD;
+    g_perfHwMuxClock.group = PERF_EVENT_GROUP_ALL;
+    if (g_perfHwGroupNr > 1) {
+        PRINT_INFO("perf: %u events multiplexed on %u counters\n", index, counterNr);
+        if (hasCycle && (cyclePeriod > g_perfHwMuxClock.period)) {
+            PRINT_INFO("perf: groups rotate only on cycle event overflows, every %#x counts\n", cyclePeriod);
+        }
+    }
     return LOS_OK;
 }
 
+/* charge the time since the last update to every event, running time only to the events on the counters */
+STATIC VOID OsPerfHwTimeUpdate(UINT32 cpuid)
+{
+    UINT32 i;
+    PerfHwCpu *cpu = &g_perfHwCpu[cpuid];
+    PerfEvent *events = &g_perfHw->events;
+    UINT64 now = HalClockGetCycles();
+    UINT64 delta = now - cpu->lastTime;
+
+    cpu->lastTime = now;
+    if (!cpu->counting) {
+        return;
+    }
+
+    for (i = 0; i < events->nr; i++) {
+        Event *event = &(events->per[i]);
+        event->timeEnabled[cpuid] += delta;
+        if ((event->group == PERF_EVENT_GROUP_ALL) || (event->group == cpu->group)) {
+            event->timeRunning[cpuid] += delta;
+        }
+    }
+}
+
+STATIC VOID OsPerfHwGroupRead(UINT32 cpuid, UINT32 group)
+{
+    UINT32 i;
+    HwPmu *armPmu = GET_HW_PMU(g_perfHw);
+    PerfEvent *events = &g_perfHw->events;
+
+    for (i = 0; i < events->nr; i++) {
+        Event *event = &(events->per[i]);
+        if (event->group == group) {
+            armPmu->disable(event);
+            event->count[cpuid] += armPmu->readCnt(event);
+        }
+    }
+}
+
+STATIC VOID OsPerfHwGroupLoad(UINT32 group)
+{
+    UINT32 i;
+    HwPmu *armPmu = GET_HW_PMU(g_perfHw);
+    PerfEvent *events = &g_perfHw->events;
+
+    for (i = 0; i < events->nr; i++) {
+        Event *event = &(events->per[i]);
+        if (event->group == group) {
+            armPmu->setPeriod(event);
+            armPmu->enable(event);
+        }
+    }
+}
+
+/*
+ * Called from the pmu interrupt with all counters stopped: reload the mux clock and move the next group onto
+ * the counters once the interval is over.
+ */
+VOID OsPerfHwMuxTick(VOID)
+{
+    UINT32 cpuid = ArchCurrCpuid();
+    PerfHwCpu *cpu = &g_perfHwCpu[cpuid];
+    HwPmu *armPmu = GET_HW_PMU(g_perfHw);
+
+    if (g_perfHwMuxClockOn) {
+        armPmu->setPeriod(&g_perfHwMuxClock);
+    }
+    if ((g_perfHwGroupNr <= 1) || !cpu->counting || ((HalClockGetCycles() - cpu->lastRotate) < PERF_HW_MUX_INTERVAL)) {
+        return;
+    }
+
+    OsPerfHwTimeUpdate(cpuid);
+    OsPerfHwGroupRead(cpuid, cpu->group);
+    cpu->group = (cpu->group + 1) % g_perfHwGroupNr;
+    OsPerfHwGroupLoad(cpu->group);
+    cpu->lastRotate = cpu->lastTime;
+}
+
 STATIC UINT32 OsPerfHwStart(VOID)
 {
     UINT32 i;
     UINT32 cpuid = ArchCurrCpuid();
     HwPmu *armPmu = GET_HW_PMU(g_perfHw);
+    PerfHwCpu *cpu = &g_perfHwCpu[cpuid];
 
     PerfEvent *events = &g_perfHw->events;
     UINT32 eventNum = events->nr;
@@ -116,9 +247,21 @@ STATIC UINT32 OsPerfHwStart(VOID)
 
     for (i = 0; i < eventNum; i++) {
         Event *event = &(events->per[i]);
-        armPmu->setPeriod(event);
-        armPmu->enable(event);
         event->count[cpuid] = 0;
+        event->timeEnabled[cpuid] = 0;
+        event->timeRunning[cpuid] = 0;
+    }
+
+    cpu->group = 0;
+    cpu->counting = TRUE;
+    cpu->lastTime = HalClockGetCycles();
+    cpu->lastRotate = cpu->lastTime;
+
+    OsPerfHwGroupLoad(PERF_EVENT_GROUP_ALL);
+    OsPerfHwGroupLoad(cpu->group);
+    if (g_perfHwMuxClockOn) {
+        armPmu->setPeriod(&g_perfHwMuxClock);
+        armPmu->enable(&g_perfHwMuxClock);
     }
 
     armPmu->start();
@@ -130,17 +273,22 @@ STATIC UINT32 OsPerfHwStop(VOID)
     UINT32 i;
     UINT32 cpuid = ArchCurrCpuid();
     HwPmu *armPmu = GET_HW_PMU(g_perfHw);
+    PerfHwCpu *cpu = &g_perfHwCpu[cpuid];
 
     PerfEvent *events = &g_perfHw->events;
     UINT32 eventNum = events->nr;
 
     armPmu->stop();
+    OsPerfHwTimeUpdate(cpuid);
+    cpu->counting = FALSE;
 
     for (i = 0; i < eventNum; i++) {
         Event *event = &(events->per[i]);
-        UINTPTR value = armPmu->readCnt(event);
-        PRINT_DEBUG("perf stop readCnt value = 0x%x\n", value);
-        event->count[cpuid] += value;
+        if (OsPerfHwEventActive(event)) {
+            UINTPTR value = armPmu->readCnt(event);
+            PRINT_DEBUG("perf stop readCnt value = 0x%x\n", value);
+            event->count[cpuid] += value;
+        }
 
         /* multiplier of cycle counter */
         UINT32 eventId = armPmu->mapEvent(event->eventId, PERF_CODE_TO_EVENT);
@@ -151,9 +299,33 @@ STATIC UINT32 OsPerfHwStop(VOID)
         PRINT_DEBUG("perf stop eventCount[0x%x] : [%s] = %llu\n", event->eventId, g_eventName[eventId],
             event->count[cpuid]);
     }
+    if (g_perfHwMuxClockOn) {
+        armPmu->disable(&g_perfHwMuxClock);
+    }
     return LOS_OK;
 }
 
+/* the counters keep their values while stopped, so pausing is enough to save the task's counting context */
+STATIC VOID OsPerfHwPause(VOID)
+{
+    UINT32 cpuid = ArchCurrCpuid();
+    HwPmu *armPmu = GET_HW_PMU(g_perfHw);
+
+    armPmu->stop();
+    OsPerfHwTimeUpdate(cpuid);
+    g_perfHwCpu[cpuid].counting = FALSE;
+}
+
+STATIC VOID OsPerfHwResume(VOID)
+{
+    UINT32 cpuid = ArchCurrCpuid();
+    HwPmu *armPmu = GET_HW_PMU(g_perfHw);
+
+    OsPerfHwTimeUpdate(cpuid);
+    g_perfHwCpu[cpuid].counting = TRUE;
+    armPmu->start();
+}
+
 STATIC CHAR *OsPerfGetEventName(Event *event)
 {
     UINT32 eventId;
@@ -178,6 +350,8 @@ UINT32 OsPerfHwInit(HwPmu *hwPmu)
     hwPmu->pmu.start   = OsPerfHwStart;
     hwPmu->pmu.stop    = OsPerfHwStop;
     hwPmu->pmu.getName = OsPerfGetEventName;
+    hwPmu->pmu.pause   = OsPerfHwPause;
+    hwPmu->pmu.resume  = OsPerfHwResume;
 
     (VOID)memset_s(&hwPmu->pmu.events, sizeof(PerfEvent), 0, sizeof(PerfEvent));
     ret = OsPerfPmuRegister(&hwPmu->pmu);
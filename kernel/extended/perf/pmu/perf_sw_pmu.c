@@ -30,9 +30,11 @@
  */
 
 #include "perf_pmu_pri.h"
+#include "los_atomic.h"
 #include "los_hook.h"
 
 STATIC SwPmu g_perfSw;
+STATIC Atomic g_perfSwHooked;  /* 钩子只在采样期间挂上, 各核都会调 start/stop, 只由第一个核挂或摘 */
 STATIC CHAR *g_eventName[PERF_COUNT_SW_MAX] = {
     [PERF_COUNT_SW_TASK_SWITCH]  = "task switch",
     [PERF_COUNT_SW_IRQ_RESPONSE] = "irq response",
@@ -96,12 +98,26 @@ STATIC VOID LOS_PerfTaskSwitchedIn(const LosTaskCB *newTask, const LosTaskCB *ru
 
 STATIC VOID OsPerfCnvInit(VOID)
 {
+    if (LOS_AtomicCmpXchg32bits(&g_perfSwHooked, TRUE, FALSE)) {
+        return;
+    }
     LOS_HookReg(LOS_HOOK_TYPE_MEM_ALLOC, LOS_PerfMemAlloc);
     LOS_HookReg(LOS_HOOK_TYPE_MUX_PEND, LOS_PerfMuxPend);
     LOS_HookReg(LOS_HOOK_TYPE_ISR_ENTER, LOS_PerfIsrEnter);
     LOS_HookReg(LOS_HOOK_TYPE_TASK_SWITCHEDIN, LOS_PerfTaskSwitchedIn);
 }
 
+STATIC VOID OsPerfCnvDeinit(VOID)
+{
+    if (LOS_AtomicCmpXchg32bits(&g_perfSwHooked, FALSE, TRUE)) {
+        return;
+    }
+    LOS_HookUnReg(LOS_HOOK_TYPE_MEM_ALLOC, LOS_PerfMemAlloc);
+    LOS_HookUnReg(LOS_HOOK_TYPE_MUX_PEND, LOS_PerfMuxPend);
+    LOS_HookUnReg(LOS_HOOK_TYPE_ISR_ENTER, LOS_PerfIsrEnter);
+    LOS_HookUnReg(LOS_HOOK_TYPE_TASK_SWITCHEDIN, LOS_PerfTaskSwitchedIn);
+}
+
 STATIC UINT32 OsPerfSwConfig(VOID)
 {
     UINT32 i;
@@ -132,12 +148,14 @@ STATIC UINT32 OsPerfSwStart(VOID)
     }
 
     g_perfSw.enable = TRUE;
+    OsPerfCnvInit();
     return LOS_OK;
 }
 
 STATIC UINT32 OsPerfSwStop(VOID)
 {
     g_perfSw.enable = FALSE;
+    OsPerfCnvDeinit();
     return LOS_OK;
 }
 
@@ -161,8 +179,7 @@ UINT32 OsSwPmuInit(VOID)
     };
 
     g_perfSw.enable = FALSE;
-
-    OsPerfCnvInit();
+    LOS_AtomicSet(&g_perfSwHooked, FALSE);
 
     (VOID)memset_s(&g_perfSw.pmu.events, sizeof(PerfEvent), 0, sizeof(PerfEvent));
     return OsPerfPmuRegister(&g_perfSw.pmu);
@@ -266,51 +266,65 @@ STATIC VOID LOS_TraceUsrEvent(VOID *buffer, UINT32 len)
     LOS_MemFree(m_aucSysMem0, buffer);
 #endif
 }
+
+#define TRACE_CNV_HOOK(reg, hookType, hookFn) \
+    (VOID)((reg) ? LOS_HookReg(hookType, hookFn) : LOS_HookUnReg(hookType, hookFn))
+
 ///< 将事件的钩子函数注册进HOOK框架 ,但谁能告诉我 cnv 是啥意思 ?  @note_thinking
+STATIC VOID OsTraceCnvHookSet(BOOL reg)
+{
+    TRACE_CNV_HOOK(reg, LOS_HOOK_TYPE_MEM_ALLOC, LOS_TraceMemAlloc);
+    TRACE_CNV_HOOK(reg, LOS_HOOK_TYPE_MEM_FREE, LOS_TraceMemFree);
+    TRACE_CNV_HOOK(reg, LOS_HOOK_TYPE_MEM_INIT, LOS_TraceMemInit);
+    TRACE_CNV_HOOK(reg, LOS_HOOK_TYPE_MEM_REALLOC, LOS_TraceMemRealloc);
+    TRACE_CNV_HOOK(reg, LOS_HOOK_TYPE_MEM_ALLOCALIGN, LOS_TraceMemAllocAlign);
+    TRACE_CNV_HOOK(reg, LOS_HOOK_TYPE_EVENT_INIT, LOS_TraceEventInit);
+    TRACE_CNV_HOOK(reg, LOS_HOOK_TYPE_EVENT_READ, LOS_TraceEventRead);
+    TRACE_CNV_HOOK(reg, LOS_HOOK_TYPE_EVENT_WRITE, LOS_TraceEventWrite);
+    TRACE_CNV_HOOK(reg, LOS_HOOK_TYPE_EVENT_CLEAR, LOS_TraceEventClear);
+    TRACE_CNV_HOOK(reg, LOS_HOOK_TYPE_EVENT_DESTROY, LOS_TraceEventDestroy);
+    TRACE_CNV_HOOK(reg, LOS_HOOK_TYPE_QUEUE_CREATE, LOS_TraceQueueCreate);
+    TRACE_CNV_HOOK(reg, LOS_HOOK_TYPE_QUEUE_DELETE, LOS_TraceQueueDelete);
+    TRACE_CNV_HOOK(reg, LOS_HOOK_TYPE_QUEUE_READ, LOS_TraceQueueRW);
+    TRACE_CNV_HOOK(reg, LOS_HOOK_TYPE_QUEUE_WRITE, LOS_TraceQueueRW);
+    TRACE_CNV_HOOK(reg, LOS_HOOK_TYPE_SEM_CREATE, LOS_TraceSemCreate);
+    TRACE_CNV_HOOK(reg, LOS_HOOK_TYPE_SEM_DELETE, LOS_TraceSemDelete);
+    TRACE_CNV_HOOK(reg, LOS_HOOK_TYPE_SEM_POST, LOS_TraceSemPost);
+    TRACE_CNV_HOOK(reg, LOS_HOOK_TYPE_SEM_PEND, LOS_TraceSemPend);
+    TRACE_CNV_HOOK(reg, LOS_HOOK_TYPE_MUX_CREATE, LOS_TraceMuxCreate);
+    TRACE_CNV_HOOK(reg, LOS_HOOK_TYPE_MUX_POST, LOS_TraceMuxPost);
+    TRACE_CNV_HOOK(reg, LOS_HOOK_TYPE_MUX_PEND, LOS_TraceMuxPend);
+    TRACE_CNV_HOOK(reg, LOS_HOOK_TYPE_MUX_DELETE, LOS_TraceMuxDelete);
+    TRACE_CNV_HOOK(reg, LOS_HOOK_TYPE_TASK_PRIMODIFY, LOS_TraceTaskPriModify);		// 修改任务优先    		
+    TRACE_CNV_HOOK(reg, LOS_HOOK_TYPE_TASK_DELETE, LOS_TraceTaskDelete);            // 删除任务
+    TRACE_CNV_HOOK(reg, LOS_HOOK_TYPE_TASK_CREATE, LOS_TraceTaskCreate);			// 创建任务
+    TRACE_CNV_HOOK(reg, LOS_HOOK_TYPE_TASK_SWITCHEDIN, LOS_TraceTaskSwitchedIn);	// 任务切换   	
+    TRACE_CNV_HOOK(reg, LOS_HOOK_TYPE_MOVEDTASKTOREADYSTATE, LOS_TraceTaskResume);  // 恢复任务
+    TRACE_CNV_HOOK(reg, LOS_HOOK_TYPE_MOVEDTASKTOSUSPENDEDLIST, LOS_TraceTaskSuspend);// 暂停任务
+    TRACE_CNV_HOOK(reg, LOS_HOOK_TYPE_ISR_ENTER, LOS_TraceIsrEnter);			// 进入中断
+    TRACE_CNV_HOOK(reg, LOS_HOOK_TYPE_ISR_EXIT, LOS_TraceIsrExit);				// 完成中断
+    TRACE_CNV_HOOK(reg, LOS_HOOK_TYPE_SWTMR_CREATE, LOS_TraceSwtmrCreate);		// 创建定时    	
+    TRACE_CNV_HOOK(reg, LOS_HOOK_TYPE_SWTMR_DELETE, LOS_TraceSwtmrDelete);  // 删除定时   
+    TRACE_CNV_HOOK(reg, LOS_HOOK_TYPE_SWTMR_EXPIRED, LOS_TraceSwtmrExpired);	// 定时器时间到
+    TRACE_CNV_HOOK(reg, LOS_HOOK_TYPE_SWTMR_START, LOS_TraceSwtmrStart);		// 启动定时  
+    TRACE_CNV_HOOK(reg, LOS_HOOK_TYPE_SWTMR_STOP, LOS_TraceSwtmrStop);		// 停止定时
+    TRACE_CNV_HOOK(reg, LOS_HOOK_TYPE_USR_EVENT, LOS_TraceUsrEvent);
+    TRACE_CNV_HOOK(reg, LOS_HOOK_TYPE_IPC_WRITE_DROP, LOS_TraceIpcWriteDrop);
+    TRACE_CNV_HOOK(reg, LOS_HOOK_TYPE_IPC_WRITE, LOS_TraceIpcWrite);
+    TRACE_CNV_HOOK(reg, LOS_HOOK_TYPE_IPC_READ_DROP, LOS_TraceIpcReadDrop);
+    TRACE_CNV_HOOK(reg, LOS_HOOK_TYPE_IPC_READ, LOS_TraceIpcRead);
+    TRACE_CNV_HOOK(reg, LOS_HOOK_TYPE_IPC_TRY_READ, LOS_TraceIpcTryRead);
+    TRACE_CNV_HOOK(reg, LOS_HOOK_TYPE_IPC_READ_TIMEOUT, LOS_TraceIpcReadTimeout);
+    TRACE_CNV_HOOK(reg, LOS_HOOK_TYPE_IPC_KILL, LOS_TraceIpcKill);
+}
+
+/* trace 启动时才挂上钩子, 停止时摘掉, 停止期间各调用点不再进 trace 的回调 */
 VOID OsTraceCnvInit(VOID)
 {
-    LOS_HookReg(LOS_HOOK_TYPE_MEM_ALLOC, LOS_TraceMemAlloc);
-    LOS_HookReg(LOS_HOOK_TYPE_MEM_FREE, LOS_TraceMemFree);
-    LOS_HookReg(LOS_HOOK_TYPE_MEM_INIT, LOS_TraceMemInit);
-    LOS_HookReg(LOS_HOOK_TYPE_MEM_REALLOC, LOS_TraceMemRealloc);
-    LOS_HookReg(LOS_HOOK_TYPE_MEM_ALLOCALIGN, LOS_TraceMemAllocAlign);
-    LOS_HookReg(LOS_HOOK_TYPE_EVENT_INIT, LOS_TraceEventInit);
-    LOS_HookReg(LOS_HOOK_TYPE_EVENT_READ, LOS_TraceEventRead);
-    LOS_HookReg(LOS_HOOK_TYPE_EVENT_WRITE, LOS_TraceEventWrite);
-    LOS_HookReg(LOS_HOOK_TYPE_EVENT_CLEAR, LOS_TraceEventClear);
-    LOS_HookReg(LOS_HOOK_TYPE_EVENT_DESTROY, LOS_TraceEventDestroy);
-    LOS_HookReg(LOS_HOOK_TYPE_QUEUE_CREATE, LOS_TraceQueueCreate);
-    LOS_HookReg(LOS_HOOK_TYPE_QUEUE_DELETE, LOS_TraceQueueDelete);
-    LOS_HookReg(LOS_HOOK_TYPE_QUEUE_READ, LOS_TraceQueueRW);
-    LOS_HookReg(LOS_HOOK_TYPE_QUEUE_WRITE, LOS_TraceQueueRW);
-    LOS_HookReg(LOS_HOOK_TYPE_SEM_CREATE, LOS_TraceSemCreate);
-    LOS_HookReg(LOS_HOOK_TYPE_SEM_DELETE, LOS_TraceSemDelete);
-    LOS_HookReg(LOS_HOOK_TYPE_SEM_POST, LOS_TraceSemPost);
-    LOS_HookReg(LOS_HOOK_TYPE_SEM_PEND, LOS_TraceSemPend);
-    LOS_HookReg(LOS_HOOK_TYPE_MUX_CREATE, LOS_TraceMuxCreate);
-    LOS_HookReg(LOS_HOOK_TYPE_MUX_POST, LOS_TraceMuxPost);
-    LOS_HookReg(LOS_HOOK_TYPE_MUX_PEND, LOS_TraceMuxPend);
-    LOS_HookReg(LOS_HOOK_TYPE_MUX_DELETE, LOS_TraceMuxDelete);
-    LOS_HookReg(LOS_HOOK_TYPE_TASK_PRIMODIFY, LOS_TraceTaskPriModify);		// 修改任务优先    		
-    LOS_HookReg(LOS_HOOK_TYPE_TASK_DELETE, LOS_TraceTaskDelete);            // 删除任务
-    LOS_HookReg(LOS_HOOK_TYPE_TASK_CREATE, LOS_TraceTaskCreate);			// 创建任务
-    LOS_HookReg(LOS_HOOK_TYPE_TASK_SWITCHEDIN, LOS_TraceTaskSwitchedIn);	// 任务切换   	
-    LOS_HookReg(LOS_HOOK_TYPE_MOVEDTASKTOREADYSTATE, LOS_TraceTaskResume);  // 恢复任务
-    LOS_HookReg(LOS_HOOK_TYPE_MOVEDTASKTOSUSPENDEDLIST, LOS_TraceTaskSuspend);// 暂停任务
-    LOS_HookReg(LOS_HOOK_TYPE_ISR_ENTER, LOS_TraceIsrEnter);			// 进入中断
-    LOS_HookReg(LOS_HOOK_TYPE_ISR_EXIT, LOS_TraceIsrExit);				// 完成中断
-    LOS_HookReg(LOS_HOOK_TYPE_SWTMR_CREATE, LOS_TraceSwtmrCreate);		// 创建定时    	
-    LOS_HookReg(LOS_HOOK_TYPE_SWTMR_DELETE, LOS_TraceSwtmrDelete);  // 删除定时   
-    LOS_HookReg(LOS_HOOK_TYPE_SWTMR_EXPIRED, LOS_TraceSwtmrExpired);	// 定时器时间到
-    LOS_HookReg(LOS_HOOK_TYPE_SWTMR_START, LOS_TraceSwtmrStart);		// 启动定时  
-    LOS_HookReg(LOS_HOOK_TYPE_SWTMR_STOP, LOS_TraceSwtmrStop);		// 停止定时
-    LOS_HookReg(LOS_HOOK_TYPE_USR_EVENT, LOS_TraceUsrEvent);
-    LOS_HookReg(LOS_HOOK_TYPE_IPC_WRITE_DROP, LOS_TraceIpcWriteDrop);
-    LOS_HookReg(LOS_HOOK_TYPE_IPC_WRITE, LOS_TraceIpcWrite);
-    LOS_HookReg(LOS_HOOK_TYPE_IPC_READ_DROP, LOS_TraceIpcReadDrop);
-    LOS_HookReg(LOS_HOOK_TYPE_IPC_READ, LOS_TraceIpcRead);
-    LOS_HookReg(LOS_HOOK_TYPE_IPC_TRY_READ, LOS_TraceIpcTryRead);
-    LOS_HookReg(LOS_HOOK_TYPE_IPC_READ_TIMEOUT, LOS_TraceIpcReadTimeout);
-    LOS_HookReg(LOS_HOOK_TYPE_IPC_KILL, LOS_TraceIpcKill);
+    OsTraceCnvHookSet(TRUE);
 }
 
+VOID OsTraceCnvDeinit(VOID)
+{
+    OsTraceCnvHookSet(FALSE);
+}
@@ -41,6 +41,7 @@ extern "C" {
 #endif /* __cplusplus */
 
 extern VOID OsTraceCnvInit(VOID);
+extern VOID OsTraceCnvDeinit(VOID);
 
 #ifdef __cplusplus
 #if __cplusplus
@@ -72,6 +72,10 @@
 #include "trace_cnv.h"
 #include "los_init.h"
 #include "los_process.h"
+#include "los_atomic.h"
+#if defined(LOS_TRACE_FRAME_LR) && defined(LOSCFG_ARCH_USER_UNWIND)
+#include "los_unwind_pri.h"
+#endif
 
 #ifdef LOSCFG_KERNEL_SMP
 #include "los_mp.h"
@@ -82,7 +86,7 @@
 #include "shell.h"
 #endif
 
-LITE_OS_SEC_BSS STATIC UINT32 g_traceEventCount;
+LITE_OS_SEC_BSS STATIC Atomic g_traceEventCount;
 LITE_OS_SEC_BSS STATIC volatile enum TraceState g_traceState = TRACE_UNINIT;
 LITE_OS_SEC_DATA_INIT STATIC volatile BOOL g_enableTrace = FALSE; ///< trace开关
 LITE_OS_SEC_BSS STATIC UINT32 g_traceMask = TRACE_DEFAULT_MASK;	///< 全局变量设置事件掩码，仅记录某些模块的事件
@@ -115,11 +119,32 @@ STATIC_INLINE BOOL OsTraceHwiFilter(UINT32 hwiNum)
     return ret;
 }
 
+#if defined(LOS_TRACE_FRAME_LR) && defined(LOSCFG_ARCH_USER_UNWIND)
+/* 内核调用链没填满的槽位接着放用户态返回地址(按 .ARM.exidx 展开), 离线 trace 一并打印 */
+STATIC VOID OsTraceUserLR(UINTPTR *linkReg, UINT32 count)
+{
+    UINTPTR pcs[LOS_TRACE_LR_RECORD];
+    UnwindRegs regs;
+    UINT32 used = 0;
+    UINT32 depth, i;
+
+    while ((used < count) && (linkReg[used] != 0)) {
+        used++;
+    }
+    if ((used == count) || (OsUnwindUserRegsGet(&regs) != TRUE)) {
+        return;
+    }
+    depth = OsUnwindUser(&regs, pcs, count - used);
+    for (i = 0; i < depth; i++) {
+        linkReg[used + i] = pcs[i];
+    }
+}
+#endif
+
 STATIC VOID OsTraceSetFrame(TraceEventFrame *frame, UINT32 eventType, UINTPTR identity, const UINTPTR *params,
     UINT16 paramCount)
 {
     INT32 i;
-    UINT32 intSave;
 
     (VOID)memset_s(frame, sizeof(TraceEventFrame), 0, sizeof(TraceEventFrame));
 
@@ -127,7 +152,6 @@ STATIC VOID OsTraceSetFrame(TraceEventFrame *frame, UINT32 eventType, UINTPTR id
         paramCount = LOSCFG_TRACE_FRAME_MAX_PARAMS;
     }
 
-    TRACE_LOCK(intSave);
     frame->curTask   = OsTraceGetMaskTid(LOS_CurTaskIDGet());
     frame->curPid    = LOS_GetCurrProcessID();
     frame->identity  = identity;
@@ -144,13 +168,16 @@ STATIC VOID OsTraceSetFrame(TraceEventFrame *frame, UINT32 eventType, UINTPTR id
 #ifdef LOS_TRACE_FRAME_LR
     /* Get the linkreg from stack fp and storage to frame */
     LOS_RecordLR(frame->linkReg, LOS_TRACE_LR_RECORD, LOS_TRACE_LR_RECORD, LOS_TRACE_LR_IGNORE);
+#ifdef LOSCFG_ARCH_USER_UNWIND
+    if (!OS_INT_ACTIVE) {
+        OsTraceUserLR(frame->linkReg, LOS_TRACE_LR_RECORD);
+    }
+#endif
 #endif
 
 #ifdef LOSCFG_TRACE_FRAME_EVENT_COUNT
-    frame->eventCount = g_traceEventCount;
-    g_traceEventCount++;
+    frame->eventCount = (UINT32)LOS_AtomicIncRet(&g_traceEventCount) - 1;
 #endif
-    TRACE_UNLOCK(intSave);
 
     for (i = 0; i < paramCount; i++) {
         frame->params[i] = params[i];
@@ -204,8 +231,21 @@ VOID OsTraceHook(UINT32 eventType, UINTPTR identity, const UINTPTR *params, UINT
             return;
         }
 
+        /*
+         * 只关本核中断, 保证取到的任务, cpu和时间戳是同一时刻的. 离线模式下写进本核的环也在同一段里,
+         * 中间不会被抢占或换核, 每个环里的帧按时间有序, 停止后按时间戳合并依赖这一点
+         */
+#ifdef LOSCFG_RECORDER_MODE_OFFLINE
+        UINT32 intSave = LOS_IntLock();
         OsTraceSetFrame(&frame, eventType, id, params, paramCount);//创建帧数据
-        OsTraceWriteOrSendEvent(&frame);//保存(离线模式下)或者发送(在线模式下)帧数据
+        OsTraceWriteOrSendEvent(&frame);//保存帧数据
+        LOS_IntRestore(intSave);
+#else
+        UINT32 intSave = LOS_IntLock();
+        OsTraceSetFrame(&frame, eventType, id, params, paramCount);
+        LOS_IntRestore(intSave);
+        OsTraceWriteOrSendEvent(&frame);//在线模式下编码发送帧数据, 不在关中断时做
+#endif
     }
 }
 
@@ -331,7 +371,6 @@ STATIC UINT32 OsTraceInit(VOID)
 #endif
 
     OsTraceHookInstall();//安装HOOK框架
-    OsTraceCnvInit();//将事件处理函数注册到HOOK框架
 
     g_traceEventCount = 0;
 
@@ -339,6 +378,7 @@ STATIC UINT32 OsTraceInit(VOID)
     g_enableTrace = FALSE;
     g_traceState = TRACE_INITED;
 #else
+    OsTraceCnvInit();//将事件处理函数注册到HOOK框架
     g_enableTrace = TRUE;
     g_traceState = TRACE_STARTED;
 #endif
@@ -363,7 +403,9 @@ UINT32 LOS_TraceStart(VOID)
         goto START_END;
     }
 
+    OsTraceRecordRestart();//上次的记录已按时间合并过, 重新开始记录
     OsTraceNotifyStart();//通知系统开始
+    OsTraceCnvInit();//将事件处理函数注册到HOOK框架
 
     g_enableTrace = TRUE; //使能trace功能
     g_traceState = TRACE_STARTED;//设置状态,已开始
@@ -387,6 +429,7 @@ VOID LOS_TraceStop(VOID)
 
     g_enableTrace = FALSE;
     g_traceState = TRACE_STOPED;
+    OsTraceCnvDeinit();//摘掉钩子, 调用点恢复成 nop
     OsTraceNotifyStop();
 STOP_END:
     TRACE_UNLOCK(intSave);
@@ -420,6 +463,15 @@ VOID LOS_TraceReset(VOID)
 
     OsTraceReset();
 }
+/// 设置各核的环写满后覆盖旧帧还是丢弃新帧
+VOID LOS_TraceBufModeSet(enum TraceBufMode mode)
+{
+    UINT32 intSave;
+
+    TRACE_LOCK(intSave);
+    OsTraceBufModeSet(mode);
+    TRACE_UNLOCK(intSave);
+}
 /// 注册过滤特定中断号事件的钩子函数
 VOID LOS_TraceHwiFilterHookReg(TRACE_HWI_FILTER_HOOK hook)
 {
@@ -470,11 +522,24 @@ LITE_OS_SEC_TEXT_MINOR UINT32 OsShellCmdTraceDump(INT32 argc, const CHAR **argv)
     return LOS_OK;
 }
 
+LITE_OS_SEC_TEXT_MINOR UINT32 OsShellCmdTraceSetBufMode(INT32 argc, const CHAR **argv)
+{
+    CHAR *endPtr = NULL;
+
+    if (argc != 1) {
+        PRINTK("\nUsage: trace_bufmode [0/1], 0: overwrite when full, 1: stop when full\n");
+        return OS_ERROR;
+    }
+    LOS_TraceBufModeSet((strtoul(argv[0], &endPtr, 0) != 0) ? TRACE_BUF_STOP_WHEN_FULL : TRACE_BUF_OVERWRITE);
+    return LOS_OK;
+}
+
 SHELLCMD_ENTRY(tracestart_shellcmd,   CMD_TYPE_EX, "trace_start", 0, (CmdCallBackFunc)LOS_TraceStart);//通过shell 启动trace
 SHELLCMD_ENTRY(tracestop_shellcmd,    CMD_TYPE_EX, "trace_stop",  0, (CmdCallBackFunc)LOS_TraceStop);
 SHELLCMD_ENTRY(tracesetmask_shellcmd, CMD_TYPE_EX, "trace_mask",  1, (CmdCallBackFunc)OsShellCmdTraceSetMask);//设置事件掩码，仅记录某些模块的事件
 SHELLCMD_ENTRY(tracereset_shellcmd,   CMD_TYPE_EX, "trace_reset", 0, (CmdCallBackFunc)LOS_TraceReset);
 SHELLCMD_ENTRY(tracedump_shellcmd,    CMD_TYPE_EX, "trace_dump", 1, (CmdCallBackFunc)OsShellCmdTraceDump);
+SHELLCMD_ENTRY(tracebufmode_shellcmd, CMD_TYPE_EX, "trace_bufmode", 1, (CmdCallBackFunc)OsShellCmdTraceSetBufMode);
 #endif
 
 LOS_MODULE_INIT(OsTraceInit, LOS_INIT_LEVEL_KMOD_EXTENDED);
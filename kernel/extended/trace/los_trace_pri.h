@@ -62,9 +62,14 @@ extern "C" {
 extern SPIN_LOCK_S g_traceSpin;
 #define TRACE_LOCK(state)                   LOS_SpinLockSave(&g_traceSpin, &(state))
 #define TRACE_UNLOCK(state)                 LOS_SpinUnlockRestore(&g_traceSpin, (state))
+/* 环锁只有本核的写者和清空/合并时拿, 平时不争抢. 调用者已关中断, 用裸锁避免 lockstat 和调度锁计数 */
+#define TRACE_RING_LOCK(ring)               ArchSpinLock(&(ring)->lock)
+#define TRACE_RING_UNLOCK(ring)             ArchSpinUnlock(&(ring)->lock)
 #else
 #define TRACE_LOCK(state)		    (state) = LOS_IntLock()
 #define TRACE_UNLOCK(state)     	    LOS_IntRestore(state)
+#define TRACE_RING_LOCK(ring)
+#define TRACE_RING_UNLOCK(ring)
 #endif
 
 typedef VOID (*TRACE_DUMP_HOOK)(BOOL toClient);
@@ -101,18 +106,34 @@ typedef struct {
     UINT32 param;   /* magic numb stand for notify msg | 命令参数*/
 } TraceNotifyFrame;
 
+/**
+ * @ingroup los_trace
+ * struct to store the per-cpu event frames. | 每个CPU一个环, 只有本核关中断写, 清空和合并时拿环锁挡住写者
+ */
+typedef struct {
+    size_t lock;                    /* Taken by the writer, and by reset and merge | 环锁*/
+    UINT16 curIndex;                /* The next record index of this cpu | 下一帧写到哪*/
+    UINT16 maxRecordCount;          /* The max num of trace items of this cpu | 本核帧数上限*/
+    BOOL wrapped;                   /* Whether the ring has been filled once | 环是否写满过*/
+    UINT32 lostCount;               /* Frames overwritten or dropped when full | 写满后被覆盖或丢弃的帧数*/
+    TraceEventFrame *frameBuf;      /* Pointer to the trace items of this cpu | 本核的帧数组*/
+} __attribute__((aligned(64))) TraceCpuRing;
+
 /**
  * @ingroup los_trace
  * struct to store the trace config information. | 离线模式是将数据保存在缓存中,需要信息来记录整体数据.
  */
 typedef struct {
     struct WriteCtrl {//内容控制器
-        UINT16 curIndex;            /* The current record index | 当前帧数据索引位*/
+        UINT16 curIndex;            /* The merged record count | 按时间戳合并后的帧数*/
         UINT16 maxRecordCount;      /* The max num of trace items | 记录帧数据上限数*/
         UINT16 curObjIndex;         /* The current obj index | 当前对象索引位*/
         UINT16 maxObjCount;         /* The max num of obj index | 对象上限数*/
         ObjData *objBuf;            /* Pointer to obj info data | 循环buf,数组保存任务数据 ObjData*/
         TraceEventFrame *frameBuf;  /* Pointer to the trace items | 循环buf,数组保存帧数据 TraceEventFrame*/
+        BOOL merged;                /* Whether the cpu rings have been merged into frameBuf | 各核的环是否已合并*/
+        BOOL stopWhenFull;          /* Drop new frames instead of overwriting old ones | 写满后丢弃新帧*/
+        TraceCpuRing ring[LOSCFG_KERNEL_CORE_NUM];
     } ctrl;
     OfflineHead *head;///< 离线模式头部信息
 } TraceOfflineHeaderInfo;
@@ -141,10 +162,14 @@ extern VOID OsTraceSendNotify(UINT32 type, UINT32 value);
 
 #define OsTraceReset()
 #define OsTraceRecordDump(toClient)
+#define OsTraceBufModeSet(mode)
+#define OsTraceRecordRestart()
 #else
 extern UINT32 OsTraceBufInit(UINT32 size);
 extern VOID OsTraceReset(VOID);
 extern VOID OsTraceRecordDump(BOOL toClient);
+extern VOID OsTraceBufModeSet(enum TraceBufMode mode);
+extern VOID OsTraceRecordRestart(VOID);
 #define OsTraceNotifyStart()
 #define OsTraceNotifyStop()
 #endif
@@ -63,12 +63,19 @@ UINT32 OsTraceGetMaskTid(UINT32 tid)
 UINT32 OsTraceBufInit(UINT32 size)
 {
     UINT32 headSize;
+    UINT32 cpuRecordCount;
+    UINT32 cpu;
     VOID *buf = NULL;
     headSize = sizeof(OfflineHead) + sizeof(ObjData) * LOSCFG_TRACE_OBJ_MAX_NUM;
     if (size <= headSize) {
         TRACE_ERROR("trace buf size not enough than 0x%x\n", headSize);
         return LOS_ERRNO_TRACE_BUF_TOO_SMALL;
     }
+    cpuRecordCount = (size - headSize) / sizeof(TraceEventFrame) / LOSCFG_KERNEL_CORE_NUM;//帧区平分给每个核
+    if (cpuRecordCount == 0) {
+        TRACE_ERROR("trace buf size not enough for %u cpus\n", LOSCFG_KERNEL_CORE_NUM);
+        return LOS_ERRNO_TRACE_BUF_TOO_SMALL;
+    }
 
 
     buf = LOS_MemAlloc(m_aucSysMem0, size);//在内核堆空间中申请内存
@@ -90,9 +97,14 @@ UINT32 OsTraceBufInit(UINT32 size)
     g_traceRecoder.ctrl.curIndex       = 0;	//当前帧位置
     g_traceRecoder.ctrl.curObjIndex    = 0;	//当前对象位置
     g_traceRecoder.ctrl.maxObjCount    = LOSCFG_TRACE_OBJ_MAX_NUM;//最大
-    g_traceRecoder.ctrl.maxRecordCount = (size - headSize) / sizeof(TraceEventFrame);//最大记录数
+    g_traceRecoder.ctrl.maxRecordCount = cpuRecordCount * LOSCFG_KERNEL_CORE_NUM;//最大记录数
     g_traceRecoder.ctrl.objBuf         = (ObjData *)((UINTPTR)buf + g_traceRecoder.head->objOffset);
     g_traceRecoder.ctrl.frameBuf       = (TraceEventFrame *)((UINTPTR)buf + g_traceRecoder.head->frameOffset);
+    for (cpu = 0; cpu < LOSCFG_KERNEL_CORE_NUM; cpu++) {
+        g_traceRecoder.ctrl.ring[cpu].lock = 0;
+        g_traceRecoder.ctrl.ring[cpu].maxRecordCount = cpuRecordCount;
+        g_traceRecoder.ctrl.ring[cpu].frameBuf = g_traceRecoder.ctrl.frameBuf + cpu * cpuRecordCount;
+    }
 
     return LOS_OK;
 }
@@ -125,33 +137,172 @@ VOID OsTraceObjAdd(UINT32 eventType, UINT32 taskId)
     /* add obj end */
     TRACE_UNLOCK(intSave);
 }
-/// 离线模式下保存帧数据 @note_thinking 此处未封装好,会懵逼,文件名中体现了对离线模式的保存或对在线模式的发送这样真的好吗? .
+/*
+ * 离线模式下保存帧数据. 每个核只写自己的环, 关本核中断挡住同核中断嵌套抢同一个位置, 环锁只和
+ * 清空/合并争抢, 不用全局自旋锁, 各核记录互不干扰. 环写满后按模式覆盖最旧的帧或者丢弃新帧
+ */
 VOID OsTraceWriteOrSendEvent(const TraceEventFrame *frame)
 {
-    UINT16 index;
     UINT32 intSave;
+    TraceCpuRing *ring = NULL;
+
+    intSave = LOS_IntLock();
+    ring = &g_traceRecoder.ctrl.ring[ArchCurrCpuid()];
+    TRACE_RING_LOCK(ring);
+    if (ring->wrapped) {
+        ring->lostCount++;
+        if (g_traceRecoder.ctrl.stopWhenFull) {
+            TRACE_RING_UNLOCK(ring);
+            LOS_IntRestore(intSave);
+            return;
+        }
+    }
+    ring->frameBuf[ring->curIndex] = *frame;
+    ring->curIndex++;
+    if (ring->curIndex >= ring->maxRecordCount) {
+        ring->curIndex = 0;
+        ring->wrapped = TRUE;
+    }
+    TRACE_RING_UNLOCK(ring);
+    LOS_IntRestore(intSave);
+}
 
-    TRACE_LOCK(intSave);
-    index = g_traceRecoder.ctrl.curIndex;//获取当前位置,离线模式会将trace frame记录到预先申请好的循环buffer中
-    (VOID)memcpy_s(&g_traceRecoder.ctrl.frameBuf[index], sizeof(TraceEventFrame), frame, sizeof(TraceEventFrame));//保存帧内容至frameBuf中
+/// 拿到所有核的环锁, 挡住正在写的核, 调用者已关中断
+STATIC VOID OsTraceRingsLock(VOID)
+{
+    UINT32 cpu;
 
-    g_traceRecoder.ctrl.curIndex++;//当前位置向前滚
-    if (g_traceRecoder.ctrl.curIndex >= g_traceRecoder.ctrl.maxRecordCount) {//循环写入,这里可以看出,如果循环buffer记录的frame过多则可能出现翻转，
-        g_traceRecoder.ctrl.curIndex = 0;//会覆盖之前的记录，保持记录的信息始终是最新的信息。
+    for (cpu = 0; cpu < LOSCFG_KERNEL_CORE_NUM; cpu++) {
+        TRACE_RING_LOCK(&g_traceRecoder.ctrl.ring[cpu]);
+    }
+}
+
+STATIC VOID OsTraceRingsUnlock(VOID)
+{
+    UINT32 cpu;
+
+    for (cpu = 0; cpu < LOSCFG_KERNEL_CORE_NUM; cpu++) {
+        TRACE_RING_UNLOCK(&g_traceRecoder.ctrl.ring[cpu]);
     }
-    TRACE_UNLOCK(intSave);
 }
-/// 重置循环buf
+
+STATIC VOID OsTraceBufClear(VOID)
+{
+    UINT32 bufLen;
+    UINT32 cpu;
+    TraceCpuRing *ring = NULL;
+
+    bufLen = sizeof(TraceEventFrame) * g_traceRecoder.ctrl.maxRecordCount;
+    (VOID)memset_s(g_traceRecoder.ctrl.frameBuf, bufLen, 0, bufLen);
+    for (cpu = 0; cpu < LOSCFG_KERNEL_CORE_NUM; cpu++) {
+        ring = &g_traceRecoder.ctrl.ring[cpu];
+        ring->curIndex = 0;
+        ring->wrapped = FALSE;
+        ring->lostCount = 0;
+    }
+    g_traceRecoder.ctrl.curIndex = 0;
+    g_traceRecoder.ctrl.merged = FALSE;
+}
+/// 重置循环buf, 拿着所有环锁清空, 不会和正在写的核冲突
 VOID OsTraceReset(VOID)
 {
     UINT32 intSave;
-    UINT32 bufLen;
 
     TRACE_LOCK(intSave);
+    OsTraceRingsLock();
+    OsTraceBufClear();
+    OsTraceRingsUnlock();
+    TRACE_UNLOCK(intSave);
+}
+/// 合并过的帧区已经不是各核的环了, 重新开始记录前清空, 调用者持有TRACE_LOCK
+VOID OsTraceRecordRestart(VOID)
+{
+    OsTraceRingsLock();
+    if (g_traceRecoder.ctrl.merged) {
+        OsTraceBufClear();
+    }
+    OsTraceRingsUnlock();
+}
+
+VOID OsTraceBufModeSet(enum TraceBufMode mode)
+{
+    g_traceRecoder.ctrl.stopWhenFull = (mode == TRACE_BUF_STOP_WHEN_FULL);
+}
+
+/// 环里最旧一帧的位置, 返回有效帧数
+STATIC UINT16 OsTraceRingValid(const TraceCpuRing *ring, UINT16 *first)
+{
+    if (ring->wrapped) {
+        *first = ring->curIndex;
+        return ring->maxRecordCount;
+    }
+    *first = 0;
+    return ring->curIndex;
+}
+
+/*
+ * trace停止后把各核的环按时间戳归并到帧区开头, 导出的数据就是按时间排好的.
+ * 每个环内部本来就按时间有序(见 OsTraceHook), 每次取各核当前最早的一帧即可; 核数很少, 线性挑选比堆更快.
+ * 停止后可能还有核在写最后一帧, 合并时拿着所有环锁, 合并缓冲区在拿锁之前按最大帧数申请
+ */
+STATIC VOID OsTraceRecordMerge(VOID)
+{
+    TraceEventFrame *mergeBuf = NULL;
+    TraceCpuRing *ring = NULL;
+    UINT16 first[LOSCFG_KERNEL_CORE_NUM];
+    UINT16 left[LOSCFG_KERNEL_CORE_NUM];
+    UINT32 total = 0;
+    UINT32 bufLen;
+    UINT32 intSave;
+    UINT32 cpu;
+    UINT32 pick;
+    UINT32 i;
+
+    if (g_traceRecoder.ctrl.merged) {
+        return;
+    }
     bufLen = sizeof(TraceEventFrame) * g_traceRecoder.ctrl.maxRecordCount;
+    mergeBuf = LOS_MemAlloc(m_aucSysMem0, bufLen);
+    if (mergeBuf == NULL) {
+        TRACE_ERROR("trace merge no memory, frames are left in per-cpu order\n");
+        return;
+    }
+
+    TRACE_LOCK(intSave);
+    OsTraceRingsLock();
+    if (g_traceRecoder.ctrl.merged) {
+        goto MERGE_END;
+    }
+    for (cpu = 0; cpu < LOSCFG_KERNEL_CORE_NUM; cpu++) {
+        left[cpu] = OsTraceRingValid(&g_traceRecoder.ctrl.ring[cpu], &first[cpu]);
+        total += left[cpu];
+    }
+
+    for (i = 0; i < total; i++) {
+        pick = LOSCFG_KERNEL_CORE_NUM;
+        for (cpu = 0; cpu < LOSCFG_KERNEL_CORE_NUM; cpu++) {
+            ring = &g_traceRecoder.ctrl.ring[cpu];
+            if ((left[cpu] != 0) && ((pick == LOSCFG_KERNEL_CORE_NUM) ||
+                (ring->frameBuf[first[cpu]].curTime < g_traceRecoder.ctrl.ring[pick].frameBuf[first[pick]].curTime))) {
+                pick = cpu;
+            }
+        }
+        ring = &g_traceRecoder.ctrl.ring[pick];
+        mergeBuf[i] = ring->frameBuf[first[pick]];
+        first[pick] = (first[pick] + 1 < ring->maxRecordCount) ? (first[pick] + 1) : 0;
+        left[pick]--;
+    }
+
     (VOID)memset_s(g_traceRecoder.ctrl.frameBuf, bufLen, 0, bufLen);
-    g_traceRecoder.ctrl.curIndex = 0;
+    if (total != 0) {
+        (VOID)memcpy_s(g_traceRecoder.ctrl.frameBuf, bufLen, mergeBuf, total * sizeof(TraceEventFrame));
+    }
+    g_traceRecoder.ctrl.curIndex = (UINT16)total;
+    g_traceRecoder.ctrl.merged = TRUE;
+MERGE_END:
+    OsTraceRingsUnlock();
     TRACE_UNLOCK(intSave);
+    (VOID)LOS_MemFree(m_aucSysMem0, mergeBuf);
 }
 
 STATIC VOID OsTraceInfoObj(VOID)
@@ -171,7 +322,12 @@ STATIC VOID OsTraceInfoObj(VOID)
 
 STATIC VOID OsTraceInfoEventTitle(VOID)
 {
+    UINT32 cpu;
+
     PRINTK("CurEvtIndex = %u\n", g_traceRecoder.ctrl.curIndex);
+    for (cpu = 0; cpu < LOSCFG_KERNEL_CORE_NUM; cpu++) {
+        PRINTK("Cpu%u LostEvt = %u\n", cpu, g_traceRecoder.ctrl.ring[cpu].lostCount);
+    }
 
     PRINTK("Index   Time(cycles)      EventType      CurPid   CurTask   Identity      ");
 #ifdef LOSCFG_TRACE_FRAME_CORE_MSG
@@ -197,20 +353,13 @@ STATIC VOID OsTraceInfoEventData(VOID)
 {
     UINT32 i, j;
     TraceEventFrame *frame = &g_traceRecoder.ctrl.frameBuf[0];
+    UINT32 count = g_traceRecoder.ctrl.merged ? g_traceRecoder.ctrl.curIndex : g_traceRecoder.ctrl.maxRecordCount;
 
-    for (i = 0; i < g_traceRecoder.ctrl.maxRecordCount; i++, frame++) {
+    for (i = 0; i < count; i++, frame++) {
         PRINTK("%-7u 0x%-15llx 0x%-12x 0x%-7x 0x%-7x 0x%-11x ", i, frame->curTime, frame->eventType,
             frame->curPid, frame->curTask, frame->identity);
 #ifdef LOSCFG_TRACE_FRAME_CORE_MSG
-        UINT32 taskLockCnt = frame->core.taskLockCnt;
-#ifdef LOSCFG_KERNEL_SMP
-        /*
-         * For smp systems, TRACE_LOCK will requst taskLock, and this counter
-         * will increase by 1 in that case.
-         */
-        taskLockCnt -= 1;
-#endif
-        PRINTK("%-11u %-11u %-11u", frame->core.cpuId, frame->core.hwiActive, taskLockCnt);
+        PRINTK("%-11u %-11u %-11u", frame->core.cpuId, frame->core.hwiActive, frame->core.taskLockCnt);
 #endif
 #ifdef LOSCFG_TRACE_FRAME_EVENT_COUNT
         PRINTK("%-11u", frame->eventCount);
@@ -265,6 +414,7 @@ STATIC VOID OsTraceSendInfo(VOID)
 
 VOID OsTraceRecordDump(BOOL toClient)
 {
+    OsTraceRecordMerge();
     if (!toClient) {
         OsTraceInfoDisplay();
         return;
@@ -277,5 +427,8 @@ VOID OsTraceRecordDump(BOOL toClient)
 
 OfflineHead *OsTraceRecordGet(VOID)
 {
+    if (!OsTraceIsEnable() && (g_traceRecoder.head != NULL)) {//停止后才能合并, 记录中读到的是各核的环
+        OsTraceRecordMerge();
+    }
     return g_traceRecoder.head;
 }
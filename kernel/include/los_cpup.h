@@ -124,6 +124,28 @@ typedef struct tagCpupInfo {
     UINT32 usage;  /**< Usage. The value range is [0, LOS_CPUP_SINGLE_CORE_PRECISION].   */
 } CPUP_INFO_S;
 
+/**
+ * @ingroup los_cpup
+ * Accumulated running time of a process or a task, in cycles.
+ */
+typedef struct tagCpupTime {
+    UINT64 userTime; /**< Time spent in user mode */
+    UINT64 sysTime;  /**< Time spent in the kernel, system calls of user tasks and all time of kernel tasks */
+    UINT64 irqTime;  /**< Time of hardware interrupts taken while running, 0 without LOSCFG_CPUP_INCLUDE_IRQ */
+} CPUP_TIME_S;
+
+/**
+ * @ingroup los_cpup
+ * Accumulated time of one CPU, in cycles.
+ */
+typedef struct tagCpupCpuTime {
+    UINT64 userTime;    /**< Time spent in user mode */
+    UINT64 sysTime;     /**< Time spent in the kernel, except the software timer task and the idle task */
+    UINT64 irqTime;     /**< Time spent in hardware interrupts, 0 without LOSCFG_CPUP_INCLUDE_IRQ */
+    UINT64 softirqTime; /**< Time spent in the software timer task */
+    UINT64 idleTime;    /**< Time spent in the idle task */
+} CPUP_CPU_TIME_S;
+
 /**
  * @ingroup los_cpup
  * Query the CPU usage of the system.
@@ -306,6 +328,84 @@ extern UINT32 LOS_GetAllIrqCpuUsage(UINT16 mode, CPUP_INFO_S *cpupInfo, UINT32 l
  */
 extern VOID LOS_CpupReset(VOID);
 
+/**
+ * @ingroup los_cpup
+ * @brief Obtain the accumulated time of a CPU.
+ *
+ * @par Description:
+ * This API is used to obtain the user, system, interrupt, software timer and idle time of a CPU since boot,
+ * including the time slice that is currently running.
+ * @attention
+ * <ul>
+ * <li>The snapshot is read without taking any lock, it can be called at a high rate.</li>
+ * <li>The values are in cycles and are not cleared by LOS_CpupReset.</li>
+ * </ul>
+ *
+ * @param cpuid   [IN] CPU ID.
+ * @param cpuTime [OUT] Accumulated time of the CPU.
+ *
+ * @retval #LOS_ERRNO_CPUP_NO_INIT     The CPU usage is not initialized.
+ * @retval #LOS_ERRNO_CPUP_PTR_ERR     cpuTime is NULL.
+ * @retval #LOS_ERRNO_CPUP_ID_INVALID  cpuid is invalid.
+ * @retval #LOS_OK                     The time is successfully obtained.
+ * @par Dependency:
+ * <ul><li>los_cpup.h: the header file that contains the API declaration.</li></ul>
+ * @see LOS_CpupProcessTimeGet | LOS_CpupTaskTimeGet
+ */
+extern UINT32 LOS_CpupCpuTimeGet(UINT16 cpuid, CPUP_CPU_TIME_S *cpuTime);
+
+/**
+ * @ingroup los_cpup
+ * @brief Obtain the accumulated running time of a process.
+ *
+ * @par Description:
+ * This API is used to obtain the user, system and interrupt time of all tasks of a process,
+ * including the time slices that are currently running.
+ * @attention
+ * <ul>
+ * <li>The snapshot is read without taking any lock, it can be called at a high rate.</li>
+ * </ul>
+ *
+ * @param pid      [IN] Process ID.
+ * @param cpupTime [OUT] Accumulated time of the process.
+ *
+ * @retval #LOS_ERRNO_CPUP_NO_INIT     The CPU usage is not initialized.
+ * @retval #LOS_ERRNO_CPUP_PTR_ERR     cpupTime is NULL.
+ * @retval #LOS_ERRNO_CPUP_ID_INVALID  pid is invalid.
+ * @retval #LOS_ERRNO_CPUP_NO_CREATED  The process is not created.
+ * @retval #LOS_OK                     The time is successfully obtained.
+ * @par Dependency:
+ * <ul><li>los_cpup.h: the header file that contains the API declaration.</li></ul>
+ * @see LOS_CpupTaskTimeGet
+ */
+extern UINT32 LOS_CpupProcessTimeGet(UINT32 pid, CPUP_TIME_S *cpupTime);
+
+/**
+ * @ingroup los_cpup
+ * @brief Obtain the accumulated running time of a task.
+ *
+ * @par Description:
+ * This API is used to obtain the user, system and interrupt time of a task,
+ * including the time slice that is currently running.
+ * @attention
+ * <ul>
+ * <li>The snapshot is read without taking any lock, it can be called at a high rate.</li>
+ * </ul>
+ *
+ * @param tid      [IN] Task ID.
+ * @param cpupTime [OUT] Accumulated time of the task.
+ *
+ * @retval #LOS_ERRNO_CPUP_NO_INIT     The CPU usage is not initialized.
+ * @retval #LOS_ERRNO_CPUP_PTR_ERR     cpupTime is NULL.
+ * @retval #LOS_ERRNO_CPUP_ID_INVALID  tid is invalid.
+ * @retval #LOS_ERRNO_CPUP_NO_CREATED  The task is not created.
+ * @retval #LOS_OK                     The time is successfully obtained.
+ * @par Dependency:
+ * <ul><li>los_cpup.h: the header file that contains the API declaration.</li></ul>
+ * @see LOS_CpupProcessTimeGet
+ */
+extern UINT32 LOS_CpupTaskTimeGet(UINT32 tid, CPUP_TIME_S *cpupTime);
+
 #ifdef __cplusplus
 #if __cplusplus
 }
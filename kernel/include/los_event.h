@@ -161,10 +161,23 @@ extern "C" {
  * @ingroup los_event
  * Event control structure | 事件控制块数据结构
  */
+struct tagEvent;
+
+/**
+ * @ingroup los_event
+ * Callback invoked after events are written to an event control block with a notifier attached.
+ * It is called without the scheduler lock held, possibly in interrupt context.
+ */
+typedef VOID (*EVENT_NOTIFY_FUNC)(struct tagEvent *eventCB, UINT32 events, VOID *arg);
+
 typedef struct tagEvent {
     UINT32 uwEventID;        /**< Event mask in the event control block 
                                   indicating the event that has been logically processed. | 事件集合，表示已经处理（写入和清零）的事件集合 */
     LOS_DL_LIST stEventList; /**< Event control block linked list | 等待特定事件的任务链表,注意上面挂的是任务*/
+    UINT32 uwWaiters;        /**< Tasks reading in the slow path plus the attached notifier, writers skip the
+                                  scheduler lock while it is 0 | 慢路径上的读者数加通知者,为0时写事件不进调度锁 */
+    EVENT_NOTIFY_FUNC pfnNotify; /**< Notifier called after events are written | 写事件后的通知回调,如 eventfd 唤醒 poll */
+    VOID *pNotifyArg;        /**< Argument of pfnNotify | 通知回调的参数 */
 } EVENT_CB_S, *PEVENT_CB_S;//一个是结构体,一个是指针
 
 /**
@@ -269,6 +282,8 @@ extern UINT32 LOS_EventRead(PEVENT_CB_S eventCB, UINT32 eventMask, UINT32 mode,
  * <ul>
  * <li>To determine whether the LOS_EventRead API returns an event or an error code, bit 25 of the event mask
  * is forbidden to be used.</li>
+ * <li>When no task is waiting on the event control block and no notifier is attached, the bits are set
+ * atomically without taking the scheduler lock.</li>
  * </ul>
  *
  * @param eventCB  [IN/OUT] Pointer to the event control block into which an event is to be written.
@@ -38,6 +38,7 @@
 
 #ifdef LOSCFG_KERNEL_HOOK
 #include "los_hook_types.h"
+#include "los_static_key.h"
 #endif
 
 #ifdef __cplusplus
@@ -47,6 +48,12 @@ extern "C" {
 #endif /* __cplusplus */
 
 #ifdef LOSCFG_KERNEL_HOOK
+/**
+ * @ingroup los_hook
+ * Maximum number of functions registered on one hook type. | 每种钩子最多挂的回调数
+ */
+#define LOS_HOOK_PROBE_NUM                      4
+
 /**
  * @ingroup los_hook
  * Hook error code: The hook pool is insufficient. 
@@ -82,11 +89,15 @@ extern "C" {
  * @brief Registration of hook function.
  *
  * @par Description:
- * This API is used to register hook function.
+ * This API is used to register hook function. Up to LOS_HOOK_PROBE_NUM functions can be
+ * registered on one hook type. A new function takes the first free probe slot, so the call order
+ * follows the slots and is unspecified once a function has been unregistered.
  *
  * @attention
  * <ul>
- * <li> None.</li>
+ * <li>The call sites of a hook type cost one nop while nothing is registered on it, see los_static_key.h.</li>
+ * <li>It never sleeps, so it may be called with a spinlock held.</li>
+ * <li>The same function can not be registered twice on one hook type.</li>
  * </ul>
  *
  * @param hookType  [IN] Register the type of the hook.
@@ -121,10 +132,16 @@ extern "C" {
  */
 #define LOS_HookUnReg(hookType, hookFn)         hookType##_UnRegHook(hookFn) ///< 注销钩子函数
 
+extern LosStaticKey g_hookKeys[LOS_HOOK_TYPE_END];
+
 /**
  * Call hook functions.
  */
-#define OsHookCall(hookType, ...)               hookType##_CallHook(__VA_ARGS__) ///< 回调钩子函数
+#define OsHookCall(hookType, ...) do {                      \
+    if (LOS_StaticBranch(&g_hookKeys[hookType])) {          \
+        hookType##_CallHook(__VA_ARGS__);                   \
+    }                                                       \
+} while (0) ///< 回调钩子函数, 没有注册回调时调用点只有一条 nop
 
 #else
 #define LOS_HookReg(hookType, hookFn)
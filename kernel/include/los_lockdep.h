@@ -56,6 +56,7 @@ typedef struct {
     VOID *lockAddr;
     UINT64 waitTime;
     UINT64 holdTime;
+    UINT32 waitQueue; /* 请求时排队锁上已发出的号数, 即排在前面的持锁者和等锁者个数 */
 } HeldLocks;
 
 typedef struct {
@@ -0,0 +1,189 @@
+/*
+ * Copyright (c) 2013-2019 Huawei Technologies Co., Ltd. All rights reserved.
+ * Copyright (c) 2020-2021 Huawei Device Co., Ltd. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of
+ *    conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list
+ *    of conditions and the following disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used
+ *    to endorse or promote products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @defgroup los_lockstat Lock contention statistics
+ * @ingroup kernel
+ */
+
+#ifndef _LOS_LOCKSTAT_H
+#define _LOS_LOCKSTAT_H
+
+#include "los_typedef.h"
+#include "los_static_key.h"
+
+#ifdef __cplusplus
+#if __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+#endif /* __cplusplus */
+
+/**
+ * @ingroup los_lockstat
+ * Lock type recorded by lock-stat.
+ */
+typedef enum {
+    LOCKSTAT_SPIN = 0,      /**< SPIN_LOCK_S */
+    LOCKSTAT_MUX,           /**< LosMux */
+    LOCKSTAT_RWLOCK_RD,     /**< LosRwlock, read side */
+    LOCKSTAT_RWLOCK_WR,     /**< LosRwlock, write side */
+    LOCKSTAT_TYPE_MAX
+} LockStatType;
+
+/**
+ * @ingroup los_lockstat
+ * Hold time record embedded in a lock, only written by the lock holder.
+ */
+typedef struct {
+    UINT32 slot;    /**< Statistics slot + 1 of the current holder, 0 when not recorded | 0表示没在统计 */
+    UINT64 start;   /**< Cycle count when the lock was taken | 拿到锁的时刻 */
+} LockStatHold;
+
+/**
+ * @ingroup los_lockstat
+ * Statistics of one lock class summed over all call sites, times are in cycles.
+ */
+typedef struct {
+    UINT32 acquire;     /**< Times the lock was taken */
+    UINT32 contended;   /**< Times the lock was busy when requested */
+    UINT64 waitTotal;   /**< Total wait time */
+    UINT64 holdTotal;   /**< Total hold time, not recorded for rwlock readers */
+} LockStatClassInfo;
+
+/* 调用加锁接口的位置, 在加锁接口里取 */
+#define LOCKSTAT_SITE() ((const VOID *)__builtin_return_address(0))
+
+#ifdef LOSCFG_KERNEL_LOCKSTAT
+extern LosStaticKey g_lockStatKey;
+
+/* 统计没打开时加解锁路径上只多一条 nop, 见 los_static_key.h */
+#define LOCKSTAT_ON()   LOS_StaticBranch(&g_lockStatKey)
+
+/**
+ * @ingroup los_lockstat
+ * @brief Get the cycle count used by lock-stat.
+ */
+extern UINT64 OsLockStatCycles(VOID);
+
+/**
+ * @ingroup los_lockstat
+ * @brief Record a lock acquisition.
+ *
+ * @par Description:
+ * This API is called by the lock implementations after the lock is taken.
+ * @attention
+ * <ul>
+ * <li>It takes no lock, so it may be called with the scheduler lock held or interrupts disabled.</li>
+ * <li>hold may be NULL when the hold time cannot be tracked, e.g. rwlock readers.</li>
+ * </ul>
+ *
+ * @param hold       [IN] Hold time record of the lock, or NULL.
+ * @param lockClass  [IN] Spinlock name, or lock address for mutexes and rwlocks.
+ * @param type       [IN] Lock type.
+ * @param site       [IN] Return address of the lock API.
+ * @param contended  [IN] Whether the lock was busy when it was requested.
+ * @param waitStart  [IN] Cycle count when the lock was requested.
+ *
+ * @retval None.
+ * @par Dependency:
+ * <ul><li>los_lockstat.h: the header file that contains the API declaration.</li></ul>
+ * @see OsLockStatReleased
+ */
+extern VOID OsLockStatAcquired(LockStatHold *hold, const VOID *lockClass, LockStatType type,
+                               const VOID *site, BOOL contended, UINT64 waitStart);
+
+/**
+ * @ingroup los_lockstat
+ * @brief Record a lock release.
+ *
+ * @par Description:
+ * This API is called by the lock holder before the lock is released.
+ *
+ * @param hold  [IN] Hold time record of the lock.
+ *
+ * @retval None.
+ * @par Dependency:
+ * <ul><li>los_lockstat.h: the header file that contains the API declaration.</li></ul>
+ * @see OsLockStatAcquired
+ */
+extern VOID OsLockStatReleased(LockStatHold *hold);
+
+/**
+ * @ingroup los_lockstat
+ * @brief Start, stop or clear lock-stat recording.
+ *
+ * @par Description:
+ * LOS_LockStatStart starts recording, LOS_LockStatStop stops it and keeps the data,
+ * LOS_LockStatReset stops recording and clears all slots.
+ *
+ * @retval None.
+ * @par Dependency:
+ * <ul><li>los_lockstat.h: the header file that contains the API declaration.</li></ul>
+ */
+extern VOID LOS_LockStatStart(VOID);
+extern VOID LOS_LockStatStop(VOID);
+extern VOID LOS_LockStatReset(VOID);
+
+/**
+ * @ingroup los_lockstat
+ * @brief Get the statistics of one lock class.
+ *
+ * @param lockClass  [IN]  Spinlock name, or lock address for mutexes and rwlocks.
+ * @param type       [IN]  Lock type.
+ * @param info       [OUT] Statistics summed over all call sites.
+ *
+ * @retval #LOS_OK   The lock class was found.
+ * @retval #LOS_NOK  The lock class has not been recorded or info is NULL.
+ * @par Dependency:
+ * <ul><li>los_lockstat.h: the header file that contains the API declaration.</li></ul>
+ */
+extern UINT32 LOS_LockStatClassGet(const VOID *lockClass, LockStatType type, LockStatClassInfo *info);
+
+/**
+ * @ingroup los_lockstat
+ * @brief Dump the statistics grouped by lock class and call site.
+ *
+ * @param seqBuf  [IN] struct SeqBuf to print into, or NULL to print to the console.
+ *
+ * @retval None.
+ * @par Dependency:
+ * <ul><li>los_lockstat.h: the header file that contains the API declaration.</li></ul>
+ */
+extern VOID OsLockStatDump(VOID *seqBuf);
+#endif
+
+#ifdef __cplusplus
+#if __cplusplus
+}
+#endif /* __cplusplus */
+#endif /* __cplusplus */
+
+#endif /* _LOS_LOCKSTAT_H */
@@ -0,0 +1,209 @@
+/*
+ * Copyright (c) 2013-2019 Huawei Technologies Co., Ltd. All rights reserved.
+ * Copyright (c) 2020-2021 Huawei Device Co., Ltd. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of
+ *    conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list
+ *    of conditions and the following disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used
+ *    to endorse or promote products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @defgroup los_memprof Heap allocation profiler
+ * @ingroup kernel
+ */
+
+#ifndef _LOS_MEMPROF_H
+#define _LOS_MEMPROF_H
+
+#include "los_typedef.h"
+#include "los_static_key.h"
+
+#ifdef __cplusplus
+#if __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+#endif /* __cplusplus */
+
+/**
+ * @ingroup los_memprof
+ * Call chain depth recorded for a sampled allocation.
+ */
+#define MEMPROF_STACK_DEPTH 8
+
+/**
+ * @ingroup los_memprof
+ * Largest sample interval in bytes, the jitter is taken from 24 random bits.
+ */
+#define MEMPROF_INTERVAL_MAX 0x800000U
+
+#ifdef LOSCFG_KERNEL_MEMPROF
+extern LosStaticKey g_memProfKey;
+extern LosStaticKey g_memProfFreeKey;
+
+/* 采样没打开时分配路径上只多一条 nop, 见 los_static_key.h */
+#define MEMPROF_ON()        LOS_StaticBranch(&g_memProfKey)
+/* 停止采样后仍然匹配释放, 直到 reset, 这样停止之后看到的存活分布仍然准确 */
+#define MEMPROF_FREE_ON()   LOS_StaticBranch(&g_memProfFreeKey)
+
+/**
+ * @ingroup los_memprof
+ * @brief Count allocated bytes towards the next sample.
+ *
+ * @par Description:
+ * Every cpu counts the bytes allocated on it, an allocation is sampled when the count reaches
+ * the sampling interval (with a random jitter). The sample is weighted by the bytes counted
+ * since the previous sample, so the weights of all sites add up to the bytes allocated.
+ * @attention
+ * <ul>
+ * <li>It must be called with interrupts disabled, the memory pool lock is enough.</li>
+ * </ul>
+ *
+ * @param size  [IN] Requested size of the allocation.
+ *
+ * @retval 0      The allocation is not sampled.
+ * @retval other  Weight in bytes of the sampled allocation, pass it to #OsMemProfRecord.
+ * @par Dependency:
+ * <ul><li>los_memprof.h: the header file that contains the API declaration.</li></ul>
+ * @see OsMemProfRecord
+ */
+extern UINT32 OsMemProfTick(UINT32 size);
+
+/**
+ * @ingroup los_memprof
+ * @brief Record a sampled allocation.
+ *
+ * @par Description:
+ * The call chain of the caller of the memory API is taken from the current stack and the
+ * allocation is remembered until it is freed.
+ * @attention
+ * <ul>
+ * <li>It must be called directly by the memory API (LOS_MemAlloc and friends) with the memory
+ * pool lock released, the two innermost frames are skipped.</li>
+ * </ul>
+ *
+ * @param ptr     [IN] Address returned to the caller.
+ * @param weight  [IN] Weight returned by #OsMemProfTick.
+ *
+ * @retval None.
+ * @par Dependency:
+ * <ul><li>los_memprof.h: the header file that contains the API declaration.</li></ul>
+ * @see OsMemProfFree
+ */
+extern VOID OsMemProfRecord(const VOID *ptr, UINT32 weight);
+
+/**
+ * @ingroup los_memprof
+ * @brief Forget a sampled allocation that is freed.
+ *
+ * @par Description:
+ * Addresses that were not sampled are looked up without taking a lock.
+ *
+ * @param ptr  [IN] Address passed to LOS_MemFree or LOS_MemRealloc.
+ *
+ * @retval None.
+ * @par Dependency:
+ * <ul><li>los_memprof.h: the header file that contains the API declaration.</li></ul>
+ * @see OsMemProfRecord
+ */
+extern VOID OsMemProfFree(const VOID *ptr);
+
+/**
+ * @ingroup los_memprof
+ * @brief Follow a sampled allocation that LOS_MemRealloc moved.
+ *
+ * @par Description:
+ * The sample keeps its call chain and weight. Nothing changes when the block grew or shrank in place.
+ *
+ * @param oldPtr  [IN] Address passed to LOS_MemRealloc.
+ * @param newPtr  [IN] Address returned by LOS_MemRealloc.
+ *
+ * @retval None.
+ * @par Dependency:
+ * <ul><li>los_memprof.h: the header file that contains the API declaration.</li></ul>
+ * @see OsMemProfFree
+ */
+extern VOID OsMemProfMove(const VOID *oldPtr, const VOID *newPtr);
+
+/**
+ * @ingroup los_memprof
+ * @brief Start, stop or clear heap profiling.
+ *
+ * @par Description:
+ * LOS_MemProfStart starts sampling with the given interval in bytes, 0 keeps the current one.
+ * LOS_MemProfStop stops sampling but still matches the frees of sampled allocations.
+ * LOS_MemProfReset stops both and clears all data.
+ *
+ * @retval None.
+ * @par Dependency:
+ * <ul><li>los_memprof.h: the header file that contains the API declaration.</li></ul>
+ */
+extern VOID LOS_MemProfStart(UINT32 interval);
+extern VOID LOS_MemProfStop(VOID);
+extern VOID LOS_MemProfReset(VOID);
+
+/**
+ * @ingroup los_memprof
+ * @brief Dump the allocation profile of every recorded call site.
+ *
+ * @par Description:
+ * Every call site is printed with its sampled and estimated cumulative allocations, the
+ * estimated live bytes and a "stack" line in folded format, root first. Sites that keep
+ * growing in live bytes between two dumps are leak candidates.
+ *
+ * @param seqBuf  [IN] struct SeqBuf to print into, or NULL to print to the console.
+ *
+ * @retval None.
+ * @par Dependency:
+ * <ul><li>los_memprof.h: the header file that contains the API declaration.</li></ul>
+ */
+extern VOID OsMemProfDump(VOID *seqBuf);
+
+/**
+ * @ingroup los_memprof
+ * @brief Run a memprof command.
+ *
+ * @par Description:
+ * Accepts exactly "on", "on interval", "off" or "reset". The interval must be in
+ * [1, #MEMPROF_INTERVAL_MAX] bytes. The shell command and /proc/memprof both go through
+ * this function so they accept and reject the same input.
+ *
+ * @param argc  [IN] Number of words.
+ * @param argv  [IN] The words of the command.
+ *
+ * @retval #LOS_OK   The command was run.
+ * @retval #LOS_NOK  The command or the interval is invalid, nothing was changed.
+ * @par Dependency:
+ * <ul><li>los_memprof.h: the header file that contains the API declaration.</li></ul>
+ */
+extern UINT32 OsMemProfCmd(INT32 argc, const CHAR **argv);
+#endif
+
+#ifdef __cplusplus
+#if __cplusplus
+}
+#endif /* __cplusplus */
+#endif /* __cplusplus */
+
+#endif /* _LOS_MEMPROF_H */
@@ -34,6 +34,7 @@
 
 #include "los_config.h"
 #include "los_list.h"
+#include "los_atomic.h"
 
 #ifdef __cplusplus
 #if __cplusplus
@@ -71,24 +72,42 @@ STATIC INLINE VOID LOS_MpSchedule(UINT32 target)
 #endif
 
 #ifdef LOSCFG_KERNEL_SMP_CALL //多核下的回调开关
+/**
+ * Preallocated call slot, claimed by a sender and reused once every target has run the call.
+ */
 typedef struct {
-    LOS_DL_LIST node;	///< 链表节点,将挂到 g_percpu[cpuid]上
     SMP_FUNC_CALL func;	///< 回调函数地址
     VOID *args;			///< 回调函数的参数
-} MpCallFunc;
+    Atomic pending;		///< 还没执行完回调的目标CPU数, 为0时槽位可以复用
+} __attribute__((aligned(64))) MpCallSlot;
 
 /**
  * It is used to call function on target cpus by sending ipi, and the first param is target cpu mask value.
+ * The call does not wait for the targets. The current cpu, if targeted, runs the function from
+ * its own ipi once interrupts are enabled, never inside the caller's critical section.
+ * Returns LOS_NOK for a bad argument, or when every call slot is busy and interrupts are disabled.
+ */
+extern UINT32 OsMpFuncCall(UINT32 target, SMP_FUNC_CALL func, VOID *args);
+/**
+ * Same as OsMpFuncCall, and returns after every target cpu has run the function.
+ * It must be called with interrupts enabled.
  */
-extern VOID OsMpFuncCall(UINT32 target, SMP_FUNC_CALL func, VOID *args);
+extern UINT32 OsMpFuncCallSync(UINT32 target, SMP_FUNC_CALL func, VOID *args);
 extern VOID OsMpFuncCallHandler(VOID);
 #else
-INLINE VOID OsMpFuncCall(UINT32 target, SMP_FUNC_CALL func, VOID *args)
+INLINE UINT32 OsMpFuncCall(UINT32 target, SMP_FUNC_CALL func, VOID *args)
 {
     (VOID)target;
-    if (func != NULL) {
-        func(args);
+    if (func == NULL) {
+        return LOS_NOK;
     }
+    func(args);
+    return LOS_OK;
+}
+
+INLINE UINT32 OsMpFuncCallSync(UINT32 target, SMP_FUNC_CALL func, VOID *args)
+{
+    return OsMpFuncCall(target, func, args);
 }
 #endif /* LOSCFG_KERNEL_SMP_CALL */
 
@@ -38,6 +38,7 @@
 #define _LOS_MUX_H
 
 #include "los_base.h"
+#include "los_lockstat.h"
 
 #ifdef __cplusplus
 #if __cplusplus
@@ -77,6 +78,9 @@ typedef struct OsMux { //互斥锁结构体
     LOS_DL_LIST muxList; /**< Mutex linked list | 等这个锁的任务链表,上面挂的都是任务,注意和holdList的区别. */
     VOID *owner;         /**< The current thread that is locking a mutex | 当前拥有这把锁的任务 */
     UINT16 muxCount;     /**< Times of locking a mutex | 锁定互斥体的次数,递归锁允许多次 */
+#ifdef LOSCFG_KERNEL_LOCKSTAT
+    LockStatHold statHold; /**< Hold time record of lock-stat | 锁竞争统计的持锁记录 */
+#endif
 } LosMux;
 
 extern UINT32 LOS_MuxAttrInit(LosMuxAttr *attr);
@@ -155,6 +159,8 @@ extern UINT32 LOS_MuxDestroy(LosMux *mutex);
  * the priority of the thread that owns the mutex to avoid priority inversion.</li>
  * <li>A recursive mutex can be locked more than once by the same thread.</li>
  * <li>Do not call this API in software timer callback. </li>
+ * <li>On SMP, if the owner is running on another core and nobody is pended on the mutex, the caller spins
+ * for a bounded budget before pending, see LOS_MuxSpinBudgetSet.</li>
  * </ul>
  *
  * @param mutex           [IN] Handle of the mutex to be waited on.
@@ -234,6 +240,49 @@ extern UINT32 LOS_MuxTrylock(LosMux *mutex);
  */
 extern UINT32 LOS_MuxUnlock(LosMux *mutex);
 
+/**
+ * @ingroup los_mux
+ * Statistics of adaptive mutex locking, summed over all cores. | 自适应互斥锁统计
+ */
+typedef struct {
+    UINT64 spinAcquire; /**< Locks taken after spinning on a running owner | 自旋后拿到锁的次数 */
+    UINT64 spinFailed;  /**< Spins that ran out of budget or whose owner left the CPU | 自旋失败的次数 */
+    UINT64 sleep;       /**< Locks for which the task had to pend | 挂起等锁的次数 */
+} LosMuxSpinStat;
+
+/**
+ * @ingroup los_mux
+ * @brief Set the adaptive spinning budget of mutexes.
+ *
+ * @par Description:
+ * When a mutex is held by a task running on another core, LOS_MuxLock spins for at most this many cycles
+ * waiting for the owner to release it before the caller pends. 0 disables spinning.
+ * The spin never uses up the whole timeout passed to LOS_MuxLock, and the time spent spinning is taken off
+ * the timeout the caller then pends with.
+ *
+ * @param cycles [IN] Spinning budget in cycles.
+ *
+ * @retval None.
+ * @par Dependency:
+ * <ul><li>los_mux.h: the header file that contains the API declaration.</li></ul>
+ * @see LOS_MuxSpinStatGet
+ */
+extern VOID LOS_MuxSpinBudgetSet(UINT32 cycles);
+
+/**
+ * @ingroup los_mux
+ * @brief Get the adaptive spinning statistics of mutexes.
+ *
+ * @param stat [OUT] Statistics summed over all cores.
+ *
+ * @retval #LOS_EINVAL stat is NULL.
+ * @retval #LOS_OK     The statistics are obtained.
+ * @par Dependency:
+ * <ul><li>los_mux.h: the header file that contains the API declaration.</li></ul>
+ * @see LOS_MuxSpinBudgetSet
+ */
+extern UINT32 LOS_MuxSpinStatGet(LosMuxSpinStat *stat);
+
 #ifdef __cplusplus
 #if __cplusplus
 }
@@ -0,0 +1,177 @@
+/*
+ * Copyright (c) 2013-2019 Huawei Technologies Co., Ltd. All rights reserved.
+ * Copyright (c) 2020-2021 Huawei Device Co., Ltd. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of
+ *    conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list
+ *    of conditions and the following disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used
+ *    to endorse or promote products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @defgroup los_offcpu Off-CPU profiling
+ * @ingroup kernel
+ */
+
+#ifndef _LOS_OFFCPU_H
+#define _LOS_OFFCPU_H
+
+#include "los_typedef.h"
+
+#ifdef __cplusplus
+#if __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+#endif /* __cplusplus */
+
+/**
+ * @ingroup los_offcpu
+ * Kernel call chain depth recorded when a task blocks.
+ */
+#define OFFCPU_STACK_DEPTH  8
+
+/**
+ * @ingroup los_offcpu
+ * Why a task left the cpu.
+ */
+typedef enum {
+    OFFCPU_PEND_MUX = 0,    /**< Waiting for a LosMux */
+    OFFCPU_PEND_EVENT,      /**< Waiting for an event */
+    OFFCPU_PEND,            /**< Waiting on another wait queue: semaphore, queue, futex, join ... */
+    OFFCPU_DELAY,           /**< LOS_TaskDelay and friends */
+    OFFCPU_SUSPEND,         /**< Suspended */
+    OFFCPU_TYPE_MAX
+} OffCpuType;
+
+/**
+ * @ingroup los_offcpu
+ * Block record embedded in a task, protected by the scheduler lock.
+ */
+typedef struct {
+    UINT32 slot;        /**< Statistics slot + 1 of the current block, 0 when not recorded | 0表示没在统计 */
+    UINT64 blockTime;   /**< Cycle count when the task blocked | 阻塞的时刻 */
+    UINT64 wakeTime;    /**< Cycle count when the task became ready again, 0 before that | 被唤醒的时刻 */
+} OffCpuRecord;
+
+#ifdef LOSCFG_KERNEL_OFFCPU
+extern BOOL g_offCpuOn;
+
+/* 统计没打开时调度路径上只多这一次判断 */
+#define OFFCPU_ON()     (g_offCpuOn)
+
+/**
+ * @ingroup los_offcpu
+ * @brief Record that the current task is leaving the cpu.
+ *
+ * @par Description:
+ * This API is called by the scheduler before the blocked task is switched out,
+ * the kernel call chain is taken from the current stack.
+ * @attention
+ * <ul>
+ * <li>It must be called with the scheduler lock held and before the current task is changed.</li>
+ * </ul>
+ *
+ * @param record     [IN] Block record of the current task.
+ * @param processID  [IN] Process of the current task.
+ * @param type       [IN] Why the task blocks.
+ * @param obj        [IN] Object waited for, NULL if there is none.
+ * @param userPc     [IN] User mode pc of the task, 0 for kernel tasks.
+ * @param now        [IN] Current scheduler cycle count.
+ *
+ * @retval None.
+ * @par Dependency:
+ * <ul><li>los_offcpu.h: the header file that contains the API declaration.</li></ul>
+ * @see OsOffCpuRun
+ */
+extern VOID OsOffCpuBlock(OffCpuRecord *record, UINT32 processID, OffCpuType type,
+                          const VOID *obj, UINTPTR userPc, UINT64 now);
+
+/**
+ * @ingroup los_offcpu
+ * @brief Record that a blocked task runs again.
+ *
+ * @par Description:
+ * This API is called by the scheduler when the task is switched in. The time from
+ * #OsOffCpuBlock to the wakeup and the time from the wakeup to now are accumulated
+ * into the slot of the call chain.
+ *
+ * @param record  [IN] Block record of the task.
+ * @param now     [IN] Current scheduler cycle count.
+ *
+ * @retval None.
+ * @par Dependency:
+ * <ul><li>los_offcpu.h: the header file that contains the API declaration.</li></ul>
+ * @see OsOffCpuBlock
+ */
+extern VOID OsOffCpuRun(OffCpuRecord *record, UINT64 now);
+
+/* 任务重新进入就绪队列, 只记第一次, 之后被抢占再入队不算 */
+STATIC INLINE VOID OsOffCpuWake(OffCpuRecord *record, UINT64 now)
+{
+    if ((record->slot != 0) && (record->wakeTime == 0)) {
+        record->wakeTime = now;
+    }
+}
+
+/**
+ * @ingroup los_offcpu
+ * @brief Start, stop or clear off-cpu recording.
+ *
+ * @par Description:
+ * LOS_OffCpuStart starts recording, LOS_OffCpuStop stops it and keeps the data,
+ * LOS_OffCpuReset stops recording and clears all slots.
+ *
+ * @retval None.
+ * @par Dependency:
+ * <ul><li>los_offcpu.h: the header file that contains the API declaration.</li></ul>
+ */
+extern VOID LOS_OffCpuStart(VOID);
+extern VOID LOS_OffCpuStop(VOID);
+extern VOID LOS_OffCpuReset(VOID);
+
+/**
+ * @ingroup los_offcpu
+ * @brief Dump the statistics of every recorded call chain.
+ *
+ * @par Description:
+ * Every slot is printed with its counters, the block and wakeup latency histograms and a
+ * "stack" line in folded format (process;user pc;kernel frames;object), root first, so the
+ * stack lines can be fed to flame graph tools directly.
+ *
+ * @param seqBuf  [IN] struct SeqBuf to print into, or NULL to print to the console.
+ *
+ * @retval None.
+ * @par Dependency:
+ * <ul><li>los_offcpu.h: the header file that contains the API declaration.</li></ul>
+ */
+extern VOID OsOffCpuDump(VOID *seqBuf);
+#endif
+
+#ifdef __cplusplus
+#if __cplusplus
+}
+#endif /* __cplusplus */
+#endif /* __cplusplus */
+
+#endif /* _LOS_OFFCPU_H */
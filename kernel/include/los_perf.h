@@ -240,6 +240,48 @@ enum PerfSampleType {
     PERF_RECORD_PID       = 1U << 7, /* record current process id */
 };
 
+/**
+ * @ingroup los_perf
+ * perf ring buffer record types
+ */
+enum PerfRecordType {
+    PERF_RECORD_TYPE_HDR = 1,   /* section header written by LOS_PerfStart, always in cpu 0's ring */
+    PERF_RECORD_TYPE_SAMPLE,    /* one sample, the payload layout follows PerfConfigAttr->sampleType */
+    PERF_RECORD_TYPE_LOST,      /* the payload is a UINT32 count of samples dropped because the ring was full */
+};
+
+/**
+ * @ingroup los_perf
+ * perf ring buffer record header
+ *
+ * Every record starts at a 4 bytes aligned offset, the next record starts at ALIGN(size, 4).
+ * The header never wraps around the end of the data area, the payload may.
+ */
+typedef struct {
+    UINT16 type;                /* enum PerfRecordType */
+    UINT16 size;                /* size of this header and the payload */
+} PerfRecordHdr;
+
+/**
+ * @ingroup los_perf
+ * perf ring buffer control page
+ *
+ * Each cpu has one control page followed by its data area, /dev/perf maps the rings of all cpus back to back.
+ * The kernel publishes dataHead after a record is complete, the reader publishes dataTail after consuming records.
+ * Both are free running byte counts, the offset in the data area is count & (dataSize - 1).
+ */
+typedef struct {
+    UINT32 version;             /* layout version */
+    UINT32 cpuid;               /* cpu writing this ring */
+    UINT32 cpuNum;              /* number of rings */
+    UINT32 dataOffset;          /* offset of the data area to this page */
+    UINT32 dataSize;            /* size of the data area, power of 2 */
+    UINT32 wakeupMark;          /* readers waiting on /dev/perf are woken when so many bytes are ready */
+    UINT32 dataHead;            /* written by kernel */
+    UINT32 dataTail;            /* written by reader */
+    UINT32 lost;                /* samples dropped since boot */
+} PerfMmapPage;
+
 /**
  * @ingroup los_perf
  * perf configuration sub event information
@@ -372,9 +414,11 @@ UINT32 LOS_PerfConfig(PerfConfigAttr *attr);
  * @brief Read data from perf sample data buffer.
  *
  * @par Description
- * Because perf sample data buffer is a ringbuffer, the data may be covered after user read ringbuffer.
+ * Copy the samples out of the per-cpu ring buffers, cpu by cpu, in the same format as the old single buffer.
  * @attention
- * None.
+ * <ul>
+ * <li>Records that have been read are consumed, readers of the mapped rings will not see them again.</li>
+ * </ul>
  *
  * @param  dest                      [IN] The destination address.
  * @param  size                      [IN] Read size.
@@ -430,6 +474,63 @@ VOID LOS_PerfNotifyHookReg(const PERF_BUF_NOTIFY_HOOK func);
  */
 VOID LOS_PerfFlushHookReg(const PERF_BUF_FLUSH_HOOK func);
 
+/**
+ * @ingroup los_perf
+ * @brief Get the per-cpu perf ring buffers.
+ *
+ * @par Description
+ * Return the kernel address of the rings, which are physically contiguous so that they can be mapped to user space.
+ * @attention
+ * None.
+ *
+ * @param  size                      [OUT] Total size of the rings of all cpus.
+ * @retval #VOID*                    The first cpu's #PerfMmapPage, NULL if perf is not inited.
+ * @par Dependency:
+ * <ul>
+ * <li>los_perf.h: the header file that contains the API declaration.</li>
+ * </ul>
+ */
+VOID *LOS_PerfRingBufGet(UINT32 *size);
+
+/**
+ * @ingroup los_perf
+ * @brief Wait for perf sample data.
+ *
+ * @par Description
+ * Block until one cpu's ring holds wakeupMark bytes, perf is stopped or the timeout expires.
+ * @attention
+ * None.
+ *
+ * @param  timeout                   [IN] Timeout in ticks.
+ * @retval #LOS_OK                   Data ready or perf stopped.
+ * @retval #LOS_NOK                  Timeout.
+ * @par Dependency:
+ * <ul>
+ * <li>los_perf.h: the header file that contains the API declaration.</li>
+ * </ul>
+ */
+UINT32 LOS_PerfDataWait(UINT32 timeout);
+
+/**
+ * @ingroup los_perf
+ * @brief Set the wakeup water mark of the perf ring buffers.
+ *
+ * @par Description
+ * Set how many bytes one cpu's ring must hold before #LOS_PerfDataWait returns and the notify hook is called.
+ * @attention
+ * <ul>
+ * <li>The value is clamped to [sizeof(PerfRecordHdr), dataSize], the default is dataSize / PERF_BUFFER_WATERMARK_ONE_N.</li>
+ * </ul>
+ *
+ * @param  bytes                     [IN] Water mark in bytes.
+ * @retval None.
+ * @par Dependency:
+ * <ul>
+ * <li>los_perf.h: the header file that contains the API declaration.</li>
+ * </ul>
+ */
+VOID LOS_PerfWakeupMarkSet(UINT32 bytes);
+
 #ifdef __cplusplus
 #if __cplusplus
 }
@@ -331,6 +331,47 @@ extern "C" {
  */
 #define LOS_ERRNO_QUEUE_READ_SIZE_TOO_SMALL LOS_ERRNO_OS_ERROR(LOS_MOD_QUE, 0x1f)
 
+/**
+ * @ingroup los_queue
+ * Queue error code: The operation does not match the queue mode, for example a copy read on a
+ * zero-copy queue, or a reserve/peek on a normal queue.
+ *
+ * Value: 0x02000620
+ *
+ * Solution: Use LOS_QueueReserve/LOS_QueueCommit/LOS_QueuePeek/LOS_QueueRelease only on queues created
+ * with LOS_QUEUE_ZERO_COPY, and the copy interfaces only on the other queues.
+ */
+#define LOS_ERRNO_QUEUE_MODE_INVALID        LOS_ERRNO_OS_ERROR(LOS_MOD_QUE, 0x20)
+
+/**
+ * @ingroup los_queue
+ * Queue error code: The slot passed in is not the one reserved or peeked from the zero-copy queue.
+ *
+ * Value: 0x02000621
+ *
+ * Solution: Commit or release exactly the slot returned by LOS_QueueReserve or LOS_QueuePeek.
+ */
+#define LOS_ERRNO_QUEUE_SLOT_INVALID        LOS_ERRNO_OS_ERROR(LOS_MOD_QUE, 0x21)
+
+/**
+ * @ingroup los_queue
+ * Queue error code: The zero-copy queue being deleted still has a reserved slot or an unreleased message.
+ *
+ * Value: 0x02000622
+ *
+ * Solution: Commit the reserved slot and release every message before deleting the queue.
+ */
+#define LOS_ERRNO_QUEUE_SLOT_IN_USE         LOS_ERRNO_OS_ERROR(LOS_MOD_QUE, 0x22)
+
+/**
+ * @ingroup los_queue
+ * Queue create flag: zero-copy mode. | 零拷贝模式,消息直接在队列自有的槽位中生产和消费
+ *
+ * Messages are not copied in and out of the queue. The writer reserves a slot owned by the queue,
+ * fills it and commits it; the reader peeks the slot and releases it when done.
+ */
+#define LOS_QUEUE_ZERO_COPY                 0x1U
+
 /**
  * @ingroup los_queue
  * Structure of the block for queue information query
@@ -361,7 +402,7 @@ typedef struct tagQueueInfo { //变量前缀 uc:UINT8  us:UINT16 uw:UINT32 代
  * @param queueName        [IN]  Message queue name. Reserved parameter, not used for now.
  * @param len              [IN]  Queue length. The value range is [1,0xffff].
  * @param queueID          [OUT] ID of the queue control structure that is successfully created.
- * @param flags            [IN]  Queue mode. Reserved parameter, not used for now.
+ * @param flags            [IN]  Queue mode. 0 for a normal copy queue, LOS_QUEUE_ZERO_COPY for a zero-copy queue.
  * @param maxMsgSize       [IN]  Node size. The value range is [1,0xffff-4].
  *
  * @retval   #LOS_OK                            The message queue is successfully created.
@@ -683,6 +724,9 @@ extern UINT32 LOS_QueueWriteHeadCopy(UINT32 queueID,
  * <li>This API cannot be used to delete a queue that is not created.</li>
  * <li>A synchronous queue fails to be deleted if any tasks are blocked on it, or some queues are being read or
  * written.</li>
+ * <li>A zero-copy queue fails to be deleted while it holds committed messages, including one that is peeked but
+ * not released. A slot that is reserved but not committed does not stop the deletion. The writer must not touch
+ * it afterwards, and LOS_QueueCommit on it returns LOS_ERRNO_QUEUE_NOT_CREATE.</li>
  * </ul>
  *
  * @param queueID     [IN] Queue ID created by LOS_QueueCreate. The value range is
@@ -694,6 +738,7 @@ extern UINT32 LOS_QueueWriteHeadCopy(UINT32 queueID,
  * incorrect.
  * @retval   #LOS_ERRNO_QUEUE_IN_TSKUSE   The queue that blocks a task cannot be deleted.
  * @retval   #LOS_ERRNO_QUEUE_IN_TSKWRITE Queue reading and writing are not synchronous.
+ * @retval   #LOS_ERRNO_QUEUE_SLOT_IN_USE A zero-copy slot is still reserved or a message is not released.
  * @par Dependency:
  * <ul><li>los_queue.h: the header file that contains the API declaration.</li></ul>
  * @see LOS_QueueCreate | LOS_QueueCreate
@@ -726,6 +771,123 @@ extern UINT32 LOS_QueueDelete(UINT32 queueID);
  */
 extern UINT32 LOS_QueueInfoGet(UINT32 queueID, QUEUE_INFO_S *queueInfo);
 
+/**
+ * @ingroup los_queue
+ * @brief Reserve a free slot in a zero-copy queue.
+ *
+ * @par Description:
+ * This API is used to obtain the next free slot of a queue created with LOS_QUEUE_ZERO_COPY. The caller
+ * fills the slot in place and hands it to the reader with LOS_QueueCommit.
+ * @attention
+ * <ul>
+ * <li>A zero-copy queue has one producer and one consumer. Reserve/commit must be called by a single
+ * writer, peek/release by a single reader.</li>
+ * <li>Reserving again before committing returns the same slot.</li>
+ * <li>The queue cannot be deleted while a slot is reserved.</li>
+ * <li>The argument timeout is a relative time. Do not wait in interrupt context.</li>
+ * </ul>
+ *
+ * @param queueID        [IN]  Queue ID created by LOS_QueueCreate with LOS_QUEUE_ZERO_COPY.
+ * @param slotAddr       [OUT] Address of the reserved slot.
+ * @param slotSize       [OUT] Usable size of the slot, that is the maxMsgSize of the queue.
+ * @param timeout        [IN]  Expiry time. The value range is [0,LOS_WAIT_FOREVER](unit: Tick).
+ *
+ * @retval   #LOS_OK                             A slot is reserved.
+ * @retval   #LOS_ERRNO_QUEUE_INVALID            The queue handle is invalid.
+ * @retval   #LOS_ERRNO_QUEUE_WRITE_PTR_NULL     slotAddr or slotSize is null.
+ * @retval   #LOS_ERRNO_QUEUE_WRITE_IN_INTERRUPT Waiting for a slot in interrupt context.
+ * @retval   #LOS_ERRNO_QUEUE_NOT_CREATE         The queue is not created.
+ * @retval   #LOS_ERRNO_QUEUE_MODE_INVALID       The queue is not a zero-copy queue.
+ * @retval   #LOS_ERRNO_QUEUE_ISFULL             No free slot and timeout is LOS_NO_WAIT.
+ * @retval   #LOS_ERRNO_QUEUE_PEND_IN_LOCK       The task is forbidden to be blocked when the task is locked.
+ * @retval   #LOS_ERRNO_QUEUE_TIMEOUT            The time set for waiting expires.
+ * @par Dependency:
+ * <ul><li>los_queue.h: the header file that contains the API declaration.</li></ul>
+ * @see LOS_QueueCommit
+ */
+extern UINT32 LOS_QueueReserve(UINT32 queueID, VOID **slotAddr, UINT32 *slotSize, UINT32 timeout);
+
+/**
+ * @ingroup los_queue
+ * @brief Commit a reserved slot to a zero-copy queue.
+ *
+ * @par Description:
+ * This API is used to publish the slot obtained by LOS_QueueReserve to the reader. Ownership of the
+ * slot passes to the queue; the writer must not touch it afterwards.
+ *
+ * @param queueID        [IN] Queue ID created by LOS_QueueCreate with LOS_QUEUE_ZERO_COPY.
+ * @param slotAddr       [IN] Slot returned by LOS_QueueReserve.
+ * @param msgSize        [IN] Number of valid bytes in the slot, in the range (0, maxMsgSize].
+ *
+ * @retval   #LOS_OK                             The message is committed.
+ * @retval   #LOS_ERRNO_QUEUE_INVALID            The queue handle is invalid.
+ * @retval   #LOS_ERRNO_QUEUE_NOT_CREATE         The queue is not created.
+ * @retval   #LOS_ERRNO_QUEUE_MODE_INVALID       The queue is not a zero-copy queue.
+ * @retval   #LOS_ERRNO_QUEUE_WRITESIZE_ISZERO   msgSize is 0.
+ * @retval   #LOS_ERRNO_QUEUE_WRITE_SIZE_TOO_BIG msgSize is bigger than the slot.
+ * @retval   #LOS_ERRNO_QUEUE_SLOT_INVALID       slotAddr is not the reserved slot.
+ * @par Dependency:
+ * <ul><li>los_queue.h: the header file that contains the API declaration.</li></ul>
+ * @see LOS_QueueReserve
+ */
+extern UINT32 LOS_QueueCommit(UINT32 queueID, VOID *slotAddr, UINT32 msgSize);
+
+/**
+ * @ingroup los_queue
+ * @brief Peek the oldest message of a zero-copy queue.
+ *
+ * @par Description:
+ * This API is used to obtain the address and size of the oldest committed message without copying it.
+ * The message stays owned by the reader until LOS_QueueRelease is called.
+ * @attention
+ * <ul>
+ * <li>Peeking again before releasing returns the same message.</li>
+ * <li>The argument timeout is a relative time. Do not wait in interrupt context.</li>
+ * </ul>
+ *
+ * @param queueID        [IN]  Queue ID created by LOS_QueueCreate with LOS_QUEUE_ZERO_COPY.
+ * @param msgAddr        [OUT] Address of the message.
+ * @param msgSize        [OUT] Size of the message.
+ * @param timeout        [IN]  Expiry time. The value range is [0,LOS_WAIT_FOREVER](unit: Tick).
+ *
+ * @retval   #LOS_OK                             A message is available.
+ * @retval   #LOS_ERRNO_QUEUE_INVALID            The queue handle is invalid.
+ * @retval   #LOS_ERRNO_QUEUE_READ_PTR_NULL      msgAddr or msgSize is null.
+ * @retval   #LOS_ERRNO_QUEUE_READ_IN_INTERRUPT  Waiting for a message in interrupt context.
+ * @retval   #LOS_ERRNO_QUEUE_NOT_CREATE         The queue is not created.
+ * @retval   #LOS_ERRNO_QUEUE_MODE_INVALID       The queue is not a zero-copy queue.
+ * @retval   #LOS_ERRNO_QUEUE_ISEMPTY            No message and timeout is LOS_NO_WAIT.
+ * @retval   #LOS_ERRNO_QUEUE_PEND_IN_LOCK       The task is forbidden to be blocked when the task is locked.
+ * @retval   #LOS_ERRNO_QUEUE_TIMEOUT            The time set for waiting expires.
+ * @par Dependency:
+ * <ul><li>los_queue.h: the header file that contains the API declaration.</li></ul>
+ * @see LOS_QueueRelease
+ */
+extern UINT32 LOS_QueuePeek(UINT32 queueID, VOID **msgAddr, UINT32 *msgSize, UINT32 timeout);
+
+/**
+ * @ingroup los_queue
+ * @brief Release a peeked message back to a zero-copy queue.
+ *
+ * @par Description:
+ * This API is used to return the slot obtained by LOS_QueuePeek to the queue so that the writer can
+ * reuse it.
+ *
+ * @param queueID        [IN] Queue ID created by LOS_QueueCreate with LOS_QUEUE_ZERO_COPY.
+ * @param msgAddr        [IN] Message returned by LOS_QueuePeek.
+ *
+ * @retval   #LOS_OK                             The slot is released.
+ * @retval   #LOS_ERRNO_QUEUE_INVALID            The queue handle is invalid.
+ * @retval   #LOS_ERRNO_QUEUE_NOT_CREATE         The queue is not created.
+ * @retval   #LOS_ERRNO_QUEUE_MODE_INVALID       The queue is not a zero-copy queue.
+ * @retval   #LOS_ERRNO_QUEUE_ISEMPTY            There is no message to release.
+ * @retval   #LOS_ERRNO_QUEUE_SLOT_INVALID       msgAddr is not the peeked message.
+ * @par Dependency:
+ * <ul><li>los_queue.h: the header file that contains the API declaration.</li></ul>
+ * @see LOS_QueuePeek
+ */
+extern UINT32 LOS_QueueRelease(UINT32 queueID, VOID *msgAddr);
+
 #ifdef __cplusplus
 #if __cplusplus
 }
@@ -38,6 +38,7 @@
 #define _LOS_RWLOCK_H
 
 #include "los_base.h"
+#include "los_lockstat.h"
 
 #ifdef __cplusplus
 #if __cplusplus
@@ -56,10 +57,55 @@ typedef struct OsRwlock {
     VOID *writeOwner;      /**< The current write thread that is locking the rwlock */
     LOS_DL_LIST readList;  /**< Read waiting list */
     LOS_DL_LIST writeList; /**< Write waiting list */
+#ifdef LOSCFG_KERNEL_LOCKSTAT
+    LockStatHold statHold; /**< Hold time record of lock-stat, write side only */
+#endif
 } LosRwlock;
 
 extern BOOL LOS_RwlockIsValid(const LosRwlock *rwlock);
 
+/**
+ * @ingroup los_rwlock
+ * Size of a per-CPU reader slot of a brlock, one cache line so that readers on different cores never share it.
+ */
+#define LOS_BRLOCK_SLOT_SIZE        64
+
+/**
+ * @ingroup los_rwlock
+ * Brlock policy: a pending writer blocks new readers, writers can not be starved.
+ */
+#define LOS_BRLOCK_WRITER_PREFER    0
+
+/**
+ * @ingroup los_rwlock
+ * Brlock policy: new readers keep entering until the writer owns the lock, readers never wait for a pending writer.
+ */
+#define LOS_BRLOCK_READER_PREFER    1
+
+/**
+ * @ingroup los_rwlock
+ * Per-CPU reader slot of a brlock.
+ */
+typedef struct {
+    INT32 readers;      /**< Readers counted on this CPU, may be negative when a reader unlocks on another CPU */
+    UINT8 pad[LOS_BRLOCK_SLOT_SIZE - sizeof(INT32)];
+} LosBrlockSlot;
+
+/**
+ * @ingroup los_rwlock
+ * Big-reader rwlock object. | 大读者锁,读计数分散到每个CPU上,读锁不争抢同一条cache line,适合读多写少的数据
+ */
+typedef struct OsBrlock {
+    UINT32 magic;               /**< Magic number */
+    volatile UINT32 writerState; /**< No writer, writer draining readers, or writer holding the lock */
+    UINT32 policy;              /**< LOS_BRLOCK_WRITER_PREFER or LOS_BRLOCK_READER_PREFER */
+    VOID *writeOwner;           /**< The write thread that is draining or holding the lock */
+    LOS_DL_LIST readList;       /**< Read waiting list */
+    LOS_DL_LIST writeList;      /**< Write waiting list */
+    LOS_DL_LIST drainList;      /**< The write owner waiting for readers to leave */
+    LosBrlockSlot slot[LOSCFG_KERNEL_CORE_NUM] __attribute__((aligned(LOS_BRLOCK_SLOT_SIZE))); /**< Per-CPU readers */
+} LosBrlock;
+
 /**
  * @ingroup los_rwlock
  * @brief Init a rwlock.
@@ -277,6 +323,149 @@ extern UINT32 LOS_RwlockTryWrLock(LosRwlock *rwlock);
  */
 extern UINT32 LOS_RwlockUnLock(LosRwlock *rwlock);
 
+/**
+ * @ingroup los_rwlock
+ * @brief Init a brlock.
+ *
+ * @par Description:
+ * This API is used to init a big-reader rwlock. Read locking only touches the reader slot of the current CPU and
+ * takes no global lock unless a writer is present, write locking waits until the readers of all CPUs have left.
+ * @attention
+ * <ul>
+ * <li>Use a brlock for read-mostly data. Write locking is much more expensive than with LosRwlock.</li>
+ * </ul>
+ *
+ * @param brlock         [IN] Handle pointer of the brlock.
+ * @param policy         [IN] LOS_BRLOCK_WRITER_PREFER or LOS_BRLOCK_READER_PREFER.
+ *
+ * @retval #LOS_EINVAL   The brlock pointer is NULL or the policy is invalid.
+ * @retval #LOS_EPERM    Multiply initialization.
+ * @retval #LOS_OK       The brlock is successfully initialized.
+ * @par Dependency:
+ * <ul><li>los_rwlock.h: the header file that contains the API declaration.</li></ul>
+ * @see LOS_BrlockDestroy
+ */
+extern UINT32 LOS_BrlockInit(LosBrlock *brlock, UINT32 policy);
+
+/**
+ * @ingroup los_rwlock
+ * @brief Destroy a brlock.
+ *
+ * @param brlock         [IN] Handle of the brlock to be deleted.
+ *
+ * @retval #LOS_EINVAL   The brlock pointer is NULL.
+ * @retval #LOS_EBADF    The lock has been destroyed or broken.
+ * @retval #LOS_EBUSY    The brlock is held or tasks pended on it.
+ * @retval #LOS_OK       The brlock is successfully deleted.
+ * @par Dependency:
+ * <ul><li>los_rwlock.h: the header file that contains the API declaration.</li></ul>
+ * @see LOS_BrlockInit
+ */
+extern UINT32 LOS_BrlockDestroy(LosBrlock *brlock);
+
+/**
+ * @ingroup los_rwlock
+ * @brief Set the writer preference of a brlock.
+ *
+ * @param brlock         [IN] Handle of the brlock.
+ * @param policy         [IN] LOS_BRLOCK_WRITER_PREFER or LOS_BRLOCK_READER_PREFER.
+ *
+ * @retval #LOS_EINVAL   The brlock pointer is NULL or the policy is invalid.
+ * @retval #LOS_EBADF    The lock has been destroyed or broken.
+ * @retval #LOS_OK       The policy is set.
+ * @par Dependency:
+ * <ul><li>los_rwlock.h: the header file that contains the API declaration.</li></ul>
+ * @see LOS_BrlockInit
+ */
+extern UINT32 LOS_BrlockPolicySet(LosBrlock *brlock, UINT32 policy);
+
+/**
+ * @ingroup los_rwlock
+ * @brief Wait to lock a brlock for reading.
+ *
+ * @attention
+ * <ul>
+ * <li>Do not wait on a brlock during an interrupt or in system tasks.</li>
+ * <li>With LOS_BRLOCK_WRITER_PREFER, taking the read lock again while holding it deadlocks if a writer is pending.</li>
+ * <li>The read lock may be released on another CPU than the one that took it.</li>
+ * </ul>
+ *
+ * @param brlock          [IN] Handle of the brlock.
+ * @param timeout         [IN] Waiting time. The value range is [0, LOS_WAIT_FOREVER](unit: Tick).
+ *
+ * @retval #LOS_EINVAL    The brlock pointer is NULL or the timeout is zero and a writer is present.
+ * @retval #LOS_EINTR     The brlock is being locked during an interrupt.
+ * @retval #LOS_EBADF     The lock has been destroyed or broken.
+ * @retval #LOS_EDEADLK   The caller is the write owner or task scheduling is locked.
+ * @retval #LOS_ETIMEDOUT The brlock waiting times out.
+ * @retval #LOS_EPERM     The brlock is used in system tasks.
+ * @retval #LOS_OK        The brlock is successfully locked.
+ * @par Dependency:
+ * <ul><li>los_rwlock.h: the header file that contains the API declaration.</li></ul>
+ * @see LOS_BrlockRdUnlock
+ */
+extern UINT32 LOS_BrlockRdLock(LosBrlock *brlock, UINT32 timeout);
+
+/**
+ * @ingroup los_rwlock
+ * @brief Release the read lock of a brlock.
+ *
+ * @param brlock          [IN] Handle of the brlock.
+ *
+ * @retval #LOS_EINVAL    The brlock pointer is NULL.
+ * @retval #LOS_EINTR     The brlock is being unlocked during an interrupt.
+ * @retval #LOS_EBADF     The lock has been destroyed or broken.
+ * @retval #LOS_EPERM     The brlock is used in system tasks.
+ * @retval #LOS_OK        The brlock is successfully unlocked.
+ * @par Dependency:
+ * <ul><li>los_rwlock.h: the header file that contains the API declaration.</li></ul>
+ * @see LOS_BrlockRdLock
+ */
+extern UINT32 LOS_BrlockRdUnlock(LosBrlock *brlock);
+
+/**
+ * @ingroup los_rwlock
+ * @brief Wait to lock a brlock for writing.
+ *
+ * @attention
+ * <ul>
+ * <li>The write lock is not recursive.</li>
+ * <li>The timeout covers waiting for other writers and waiting for readers to leave.</li>
+ * </ul>
+ *
+ * @param brlock          [IN] Handle of the brlock.
+ * @param timeout         [IN] Waiting time. The value range is [0, LOS_WAIT_FOREVER](unit: Tick).
+ *
+ * @retval #LOS_EINVAL    The brlock pointer is NULL or the timeout is zero and the lock is busy.
+ * @retval #LOS_EINTR     The brlock is being locked during an interrupt.
+ * @retval #LOS_EBADF     The lock has been destroyed or broken.
+ * @retval #LOS_EDEADLK   The caller already owns the write lock or task scheduling is locked.
+ * @retval #LOS_ETIMEDOUT The brlock waiting times out.
+ * @retval #LOS_EPERM     The brlock is used in system tasks.
+ * @retval #LOS_OK        The brlock is successfully locked.
+ * @par Dependency:
+ * <ul><li>los_rwlock.h: the header file that contains the API declaration.</li></ul>
+ * @see LOS_BrlockWrUnlock
+ */
+extern UINT32 LOS_BrlockWrLock(LosBrlock *brlock, UINT32 timeout);
+
+/**
+ * @ingroup los_rwlock
+ * @brief Release the write lock of a brlock.
+ *
+ * @param brlock          [IN] Handle of the brlock.
+ *
+ * @retval #LOS_EINVAL    The brlock pointer is NULL.
+ * @retval #LOS_EINTR     The brlock is being unlocked during an interrupt.
+ * @retval #LOS_EBADF     The lock has been destroyed or broken.
+ * @retval #LOS_EPERM     The caller does not own the write lock.
+ * @retval #LOS_OK        The brlock is successfully unlocked.
+ * @par Dependency:
+ * <ul><li>los_rwlock.h: the header file that contains the API declaration.</li></ul>
+ * @see LOS_BrlockWrLock
+ */
+extern UINT32 LOS_BrlockWrUnlock(LosBrlock *brlock);
+
 #ifdef __cplusplus
 #if __cplusplus
 }
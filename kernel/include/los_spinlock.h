@@ -36,6 +36,7 @@
 #include "los_hwi.h"
 #include "los_task.h"
 #include "los_lockdep.h"
+#include "los_lockstat.h"
 
 #ifdef __cplusplus
 #if __cplusplus
@@ -48,11 +49,14 @@ extern VOID ArchSpinUnlock(size_t *lock);
 extern INT32 ArchSpinTrylock(size_t *lock);
 
 typedef struct Spinlock {
-    size_t      rawLock;
+    size_t      rawLock;    ///< 排队锁, 低16位是正在服务的号(owner), 高16位是下一个要发的号(next)
 #ifdef LOSCFG_KERNEL_SMP
     UINT32      cpuid;
     VOID        *owner;
     const CHAR  *name;
+#ifdef LOSCFG_KERNEL_LOCKSTAT
+    LockStatHold statHold;
+#endif
 #endif
 } SPIN_LOCK_S;
 
@@ -71,6 +75,12 @@ typedef struct Spinlock {
 #ifdef LOSCFG_KERNEL_SMP
 #define SPINLOCK_OWNER_INIT     NULL
 
+#define SPINLOCK_TICKET_SHIFT   16U
+#define SPINLOCK_TICKET_MASK    0xFFFFU
+/* 持锁者加排队者的个数, 锁空闲时为0 */
+#define SPINLOCK_TICKETS_OUT(rawLock) \
+    ((((rawLock) >> SPINLOCK_TICKET_SHIFT) - (rawLock)) & SPINLOCK_TICKET_MASK)
+
 #define SPIN_LOCK_INITIALIZER(lockName) \
 {                                       \
     .rawLock    = 0U,                   \
@@ -79,6 +89,15 @@ typedef struct Spinlock {
     .name       = #lockName,            \
 }
 
+/* 解锁并结束 lock-stat 的持锁记录. 绕过 LOS_SpinUnlock 直接放锁的地方也要走这里, 否则持锁时间算不对 */
+LITE_OS_SEC_ALW_INLINE STATIC INLINE VOID OsSpinLockRelease(SPIN_LOCK_S *lock)
+{
+#ifdef LOSCFG_KERNEL_LOCKSTAT
+    OsLockStatReleased(&lock->statHold);
+#endif
+    ArchSpinUnlock(&lock->rawLock);
+}
+
 /**
  * @ingroup  los_spinlock
  * @brief Lock the spinlock.
@@ -197,7 +216,11 @@ extern BOOL LOS_SpinHeld(const SPIN_LOCK_S *lock);
  * @par Description:
  * This API is used to initialize a spinlock.
  *
- * @attention None.
+ * @attention
+ * <ul>
+ * <li>The lock is named after the expression passed in, as SPIN_LOCK_INITIALIZER does, so that lock-stat reports
+ * locks initialized at different places as different classes.</li>
+ * </ul>
  *
  * @param  lock     [IN]    Type #SPIN_LOCK_S spinlock pointer.
  *
@@ -206,7 +229,9 @@ extern BOOL LOS_SpinHeld(const SPIN_LOCK_S *lock);
  * @par Dependency:
  * <ul><li>los_spinlock.h: the header file that contains the API declaration.</li></ul>
  */
-extern VOID LOS_SpinInit(SPIN_LOCK_S *lock);
+#define LOS_SpinInit(lock) OsSpinInit((lock), #lock)
+
+extern VOID OsSpinInit(SPIN_LOCK_S *lock, const CHAR *name);
 
 #else
 #define SPIN_LOCK_INITIALIZER(lockName) \
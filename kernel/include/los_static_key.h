@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2013-2019 Huawei Technologies Co., Ltd. All rights reserved.
+ * Copyright (c) 2020-2021 Huawei Device Co., Ltd. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of
+ *    conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list
+ *    of conditions and the following disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used
+ *    to endorse or promote products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @defgroup los_static_key Static key
+ * @ingroup kernel
+ */
+
+#ifndef _LOS_STATIC_KEY_H
+#define _LOS_STATIC_KEY_H
+
+#include "los_typedef.h"
+
+#ifdef __cplusplus
+#if __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+#endif /* __cplusplus */
+
+/*
+ * 静态开关: 给很少打开的代码路径(钩子, 统计)用.
+ * 打开了 LOSCFG_ARCH_STATIC_KEY 时, 每个 LOS_StaticBranch 分支点编译成一条 nop,
+ * 开关打开时把这条 nop 改写成跳到分支体的 b 指令, 所以关闭时分支点上没有访存也没有条件跳转.
+ * 没打开时退化为读一次计数.
+ */
+
+/**
+ * @ingroup los_static_key
+ * Static key, the branches are taken while count is not 0.
+ */
+typedef struct {
+    volatile UINT32 count;  /**< Enable count | 使能计数, 非0时分支点跳转 */
+} LosStaticKey;
+
+#define LOS_STATIC_KEY_INIT     { 0 }
+
+#ifdef LOSCFG_ARCH_STATIC_KEY
+/**
+ * @ingroup los_static_key
+ * Branch site record, emitted by LOS_StaticBranch into the __static_key_table section.
+ */
+typedef struct {
+    UINTPTR      code;      /**< Address of the nop | 分支点 */
+    UINTPTR      target;    /**< Branch target when the key is enabled | 开关打开时的跳转目标 */
+    LosStaticKey *key;
+} LosStaticKeyEntry;
+
+/* 0xe320f000 是 ARM 状态的 nop, 和 los_static_key.c 里的 OS_STATIC_KEY_NOP 一致 */
+STATIC INLINE __attribute__((always_inline)) BOOL OsStaticBranch(LosStaticKey *key)
+{
+    __asm__ goto("1:\n"
+                 "    .inst 0xe320f000\n"
+                 "    .pushsection __static_key_table, \"a\"\n"
+                 "    .align 2\n"
+                 "    .word 1b, %l[enabled], %c0\n"
+                 "    .popsection\n"
+                 : : "i"(key) : : enabled);
+    return FALSE;
+enabled:
+    return TRUE;
+}
+
+/* key 必须是链接时常量, 例如全局变量的地址 */
+#define LOS_StaticBranch(key)   OsStaticBranch(key)
+#else
+#define LOS_StaticBranch(key)   __builtin_expect((key)->count != 0, 0)
+#endif
+
+/**
+ * @ingroup los_static_key
+ * @brief Enable or disable a static key.
+ *
+ * @par Description:
+ * LOS_StaticKeyInc increases the enable count, the branch sites of the key are patched to jump
+ * when the count goes from 0 to 1. LOS_StaticKeyDec decreases it and restores the nops when it
+ * drops to 0.
+ * @attention
+ * <ul>
+ * <li>They take a spinlock and never sleep, so they may be called with other spinlocks held.</li>
+ * <li>Keys changed before the static key module is initialized are patched at initialization.</li>
+ * </ul>
+ *
+ * @param key  [IN] The static key.
+ *
+ * @retval None.
+ * @par Dependency:
+ * <ul><li>los_static_key.h: the header file that contains the API declaration.</li></ul>
+ */
+extern VOID LOS_StaticKeyInc(LosStaticKey *key);
+extern VOID LOS_StaticKeyDec(LosStaticKey *key);
+
+#ifdef __cplusplus
+#if __cplusplus
+}
+#endif /* __cplusplus */
+#endif /* __cplusplus */
+
+#endif /* _LOS_STATIC_KEY_H */
@@ -561,6 +561,35 @@ extern VOID LOS_TraceStop(VOID);
  */
 extern VOID LOS_TraceReset(VOID);
 
+/**
+ * @ingroup los_trace
+ * What the offline trace buffer does when a cpu's ring is full. | 离线模式下某个核的环写满后怎么办
+ */
+enum TraceBufMode {
+    TRACE_BUF_OVERWRITE = 0,            /**< overwrite the oldest frames, keep the latest ones | 覆盖最旧的帧*/
+    TRACE_BUF_STOP_WHEN_FULL,           /**< drop new frames, keep the earliest ones | 丢弃新帧*/
+};
+
+/**
+ * @ingroup los_trace
+ * @brief Set what to do when the trace buf is full.
+ *
+ * @par Description:
+ * Set whether a full per-cpu ring overwrites its oldest frames or drops new ones, only at offline mode.
+ * @attention
+ * <ul>
+ * <li>The default mode is #TRACE_BUF_OVERWRITE.</li>
+ * <li>The number of lost frames of each cpu is printed by #LOS_TraceRecordDump.</li>
+ * </ul>
+ *
+ * @param  mode [IN] Type #enum TraceBufMode. The buffer mode.
+ * @retval #NA
+ * @par Dependency:
+ * <ul><li>los_trace.h: the header file that contains the API declaration.</li></ul>
+ * @see LOS_TraceBufModeSet
+ */
+extern VOID LOS_TraceBufModeSet(enum TraceBufMode mode);
+
 /**
  * @ingroup los_trace
  * @brief Set trace event mask.
@@ -616,6 +645,7 @@ extern VOID LOS_TraceRecordDump(BOOL toClient);
  * <ul>
  * <li>This API can be called only after that trace buffer has been established. </li>
  * <li>The return buffer's address is a critical resource, user can only ready.</li>
+ * <li>After trace stopped, the per-cpu frames are merged by timestamp, so the frames are in time order.</li>
  * </ul>
  *
  * @param NA
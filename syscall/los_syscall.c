@@ -92,6 +92,9 @@
 #include "capability_api.h"
 #endif
 #include "sys/shm.h"
+#ifdef LOSCFG_KERNEL_CPUP
+#include "los_cpup_pri.h"
+#endif
 
 //500以后是LiteOS自定义的系统调用，与ARM EABI不兼容
 #define SYS_CALL_NUM    (__NR_syscallend + 1) // __NR_syscallend = 500 + customized syscalls
@@ -157,6 +160,9 @@ VOID OsArmA32SyscallHandle(TaskContext *regs)
     }
 	//regs[0-6] 记录系统调用的参数,这也是由R7寄存器保存系统调用号的原因
     OsSigIntLock();//禁止响应信号
+#ifdef LOSCFG_KERNEL_CPUP
+    OsCpupSyscallEnter();//从这里开始算内核态时间
+#endif
     switch (nArgs) {//参数的个数 
         case ARG_NUM_0:
         case ARG_NUM_1:
@@ -175,6 +181,9 @@ VOID OsArmA32SyscallHandle(TaskContext *regs)
     }
 
     regs->R0 = ret;//系统返回值,保存在R0寄存器
+#ifdef LOSCFG_KERNEL_CPUP
+    OsCpupSyscallExit();
+#endif
     OsSigIntUnlock();//打开响应信号
 
     return;
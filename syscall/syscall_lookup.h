@@ -161,6 +161,7 @@ SYSCALL_HAND_DEF(__NR_wait4, SysWait, int, ARG_NUM_4)
 SYSCALL_HAND_DEF(__NR_waitid, SysWaitid, int, ARG_NUM_5)
 SYSCALL_HAND_DEF(__NR_uname, SysUname, int, ARG_NUM_1)
 SYSCALL_HAND_DEF(__NR_mprotect, SysMprotect, int, ARG_NUM_3)
+SYSCALL_HAND_DEF(__NR_madvise, SysMadvise, int, ARG_NUM_3)
 SYSCALL_HAND_DEF(__NR_getpgid, SysGetProcessGroupID, int, ARG_NUM_1)
 SYSCALL_HAND_DEF(__NR_sched_setparam, SysSchedSetParam, int, ARG_NUM_3)
 SYSCALL_HAND_DEF(__NR_sched_getparam, SysSchedGetParam, int, ARG_NUM_2)
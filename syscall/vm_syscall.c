@@ -97,6 +97,18 @@ int SysMprotect(void *vaddr, size_t len, int prot)
     return LOS_DoMprotect((uintptr_t)vaddr, len, (unsigned long)prot);
 }
 
+/**
+ * @brief 给内核内存访问方式的建议
+ * @param addr 起始地址,必须页对齐
+ * @param len 长度,按页向上取整
+ * @param advice MADV_NORMAL/MADV_SEQUENTIAL/MADV_RANDOM/MADV_WILLNEED/MADV_DONTNEED/MADV_FREE
+ * @return int 成功返回0,失败返回负的错误码
+ */
+int SysMadvise(void *addr, size_t len, int advice)
+{
+    return LOS_DoMadvise((uintptr_t)addr, len, advice);
+}
+
 /**
  * @brief brk也是申请堆内存的一种方式,一般小于 128K 会使用它
  * @param addr 
@@ -210,6 +210,8 @@ void ItSuiteLosTask(void)
     ItSmpLosTask130();
     ItSmpLosTask159();
     ItSmpLosTask161();
+    ItSmpLosTask162();
+    ItSmpLosTask163();
     ItSmpLosTask137();
     ItSmpLosTask158();
     ItSmpLosTask021();
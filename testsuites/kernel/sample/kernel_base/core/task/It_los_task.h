@@ -221,6 +221,8 @@ void ItSmpLosTask157(void);
 void ItSmpLosTask158(void);
 void ItSmpLosTask159(void);
 void ItSmpLosTask161(void);
+void ItSmpLosTask162(void);
+void ItSmpLosTask163(void);
 #endif
 
 #ifdef LOSCFG_TEST_SMOKE
@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2013-2019 Huawei Technologies Co., Ltd. All rights reserved.
+ * Copyright (c) 2020-2021 Huawei Device Co., Ltd. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of
+ * conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used
+ * to endorse or promote products derived from this software without specific prior written
+ * permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "It_los_task.h"
+
+#ifdef __cplusplus
+#if __cplusplus
+extern "C" {
+#endif /* __cpluscplus */
+#endif /* __cpluscplus */
+
+#define SPIN_BENCH_LOOP 1000
+#define SPIN_BENCH_HOLD 64 /* 临界区里的空转次数 */
+#define PERCENT_50      50
+#define PERCENT_90      90
+#define PERCENT_99      99
+#define PERCENT_ALL     100
+
+static SPIN_LOCK_INIT(g_benchSpin);
+static volatile UINT32 g_benchCounter;
+static UINT32 g_benchLatency[LOSCFG_KERNEL_CORE_NUM][SPIN_BENCH_LOOP];
+
+static VOID TaskF01(VOID)
+{
+    UINT32 cpuid = ArchCurrCpuid();
+    UINT64 start;
+    UINT32 intSave;
+    UINT32 loop;
+    volatile UINT32 hold;
+
+    LOS_AtomicInc(&g_testCount);
+    while (g_testCount < LOSCFG_KERNEL_CORE_NUM) { // 所有核上的任务都到齐后再一起抢锁
+    }
+
+    for (loop = 0; loop < SPIN_BENCH_LOOP; loop++) {
+        start = HalClockGetCycles();
+        LOS_SpinLockSave(&g_benchSpin, &intSave);
+        g_benchLatency[cpuid][loop] = (UINT32)(HalClockGetCycles() - start);
+        g_benchCounter++;
+        for (hold = 0; hold < SPIN_BENCH_HOLD; hold++) {
+        }
+        LOS_SpinUnlockRestore(&g_benchSpin, intSave);
+    }
+    LOS_AtomicInc(&g_testCount);
+}
+
+static VOID LatencySort(UINT32 *latency, UINT32 count)
+{
+    UINT32 i, j, tmp;
+
+    for (i = 1; i < count; i++) {
+        tmp = latency[i];
+        for (j = i; (j > 0) && (latency[j - 1] > tmp); j--) {
+            latency[j] = latency[j - 1];
+        }
+        latency[j] = tmp;
+    }
+}
+
+static UINT32 Percentile(const UINT32 *sorted, UINT32 percent)
+{
+    return sorted[(SPIN_BENCH_LOOP - 1) * percent / PERCENT_ALL];
+}
+
+/* 每个核上一个任务抢同一把自旋锁, 按核打印拿锁等待时间的分位数(cycles) */
+static UINT32 Testcase(VOID)
+{
+    TSK_INIT_PARAM_S testTask;
+    UINT32 testid;
+    UINT32 cpuid;
+    UINT32 ret;
+
+    g_testCount = 0;
+    g_benchCounter = 0;
+
+    /* 比测试任务优先级低, 本核上的任务要等测试任务让出CPU才开始, 不会卡住下面的创建 */
+    for (cpuid = 0; cpuid < LOSCFG_KERNEL_CORE_NUM; cpuid++) {
+        TEST_TASK_PARAM_INIT_AFFI(testTask, "it_smp_task_162", TaskF01, TASK_PRIO_TEST + 1,
+            CPUID_TO_AFFI_MASK(cpuid));
+        ret = LOS_TaskCreate(&testid, &testTask);
+        ICUNIT_ASSERT_EQUAL(ret, LOS_OK, ret);
+    }
+
+    while (g_testCount != (LOSCFG_KERNEL_CORE_NUM * 2)) { // 2, every task counts once on start and once on exit
+        (VOID)LOS_TaskDelay(1);
+    }
+
+    ICUNIT_ASSERT_EQUAL(g_benchCounter, LOSCFG_KERNEL_CORE_NUM * SPIN_BENCH_LOOP, g_benchCounter);
+    ICUNIT_ASSERT_EQUAL(LOS_SpinHeld(&g_benchSpin), FALSE, g_benchSpin.rawLock);
+
+    dprintf("cpu      p50(cycles)  p90(cycles)  p99(cycles)  max(cycles)\n");
+    for (cpuid = 0; cpuid < LOSCFG_KERNEL_CORE_NUM; cpuid++) {
+        LatencySort(g_benchLatency[cpuid], SPIN_BENCH_LOOP);
+        dprintf("%-8u %-12u %-12u %-12u %-12u\n", cpuid, Percentile(g_benchLatency[cpuid], PERCENT_50),
+                Percentile(g_benchLatency[cpuid], PERCENT_90), Percentile(g_benchLatency[cpuid], PERCENT_99),
+                Percentile(g_benchLatency[cpuid], PERCENT_ALL));
+    }
+
+    return LOS_OK;
+}
+
+VOID ItSmpLosTask162(VOID)
+{
+    TEST_ADD_CASE("ItSmpLosTask162", Testcase, TEST_LOS, TEST_TASK, TEST_LEVEL2, TEST_PERFORMANCE);
+}
+
+#ifdef __cplusplus
+#if __cplusplus
+}
+#endif /* __cpluscplus */
+#endif /* __cpluscplus */
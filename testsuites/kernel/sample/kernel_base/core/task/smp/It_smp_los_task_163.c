@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2013-2019 Huawei Technologies Co., Ltd. All rights reserved.
+ * Copyright (c) 2020-2021 Huawei Device Co., Ltd. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of
+ * conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used
+ * to endorse or promote products derived from this software without specific prior written
+ * permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "It_los_task.h"
+#include "los_mp.h"
+
+#ifdef __cplusplus
+#if __cplusplus
+extern "C" {
+#endif /* __cpluscplus */
+#endif /* __cpluscplus */
+
+#define MP_CALL_LOOP 100
+#define MP_CALL_SLOT_MAX 32 /* funcCallPending 的位数 */
+
+static Atomic g_callCpuMask;
+
+static VOID MpCallMark(VOID *args)
+{
+    INT32 old;
+    INT32 bit = (INT32)CPUID_TO_AFFI_MASK(ArchCurrCpuid());
+
+    LOS_AtomicInc((Atomic *)args);
+    do {
+        old = LOS_AtomicRead(&g_callCpuMask);
+    } while (LOS_AtomicCmpXchg32bits(&g_callCpuMask, old | bit, old));
+}
+
+/* 同步核间调用返回时每个核都已执行完回调, 连续调用会复用同一个调用槽 */
+static UINT32 Testcase(VOID)
+{
+    Atomic calls = 0;
+    Atomic selfCalls = 0;
+    UINT32 loop;
+    UINT32 posted = 0;
+    UINT32 intSave;
+    UINT32 ret;
+
+    for (loop = 0; loop < MP_CALL_LOOP; loop++) {
+        LOS_AtomicSet(&g_callCpuMask, 0);
+        ret = OsMpFuncCallSync(OS_MP_CPU_ALL, MpCallMark, (VOID *)&calls);
+        ICUNIT_ASSERT_EQUAL(ret, LOS_OK, ret);
+        ICUNIT_ASSERT_EQUAL(LOS_AtomicRead(&g_callCpuMask), OS_MP_CPU_ALL, g_callCpuMask);
+        ICUNIT_ASSERT_EQUAL(LOS_AtomicRead(&calls), (loop + 1) * LOSCFG_KERNEL_CORE_NUM, calls);
+    }
+
+    for (loop = 0; loop < MP_CALL_LOOP; loop++) {
+        ret = OsMpFuncCall(OS_MP_CPU_ALL, MpCallMark, (VOID *)&calls);
+        ICUNIT_ASSERT_EQUAL(ret, LOS_OK, ret);
+    }
+    while (LOS_AtomicRead(&calls) != (INT32)(MP_CALL_LOOP * LOSCFG_KERNEL_CORE_NUM * 2)) {
+        (VOID)LOS_TaskDelay(1);
+    }
+
+    /* 关中断时发给本核的调用执行不了, 槽位用完后要返回错误而不是一直等 */
+    intSave = LOS_IntLock();
+    for (loop = 0; loop <= MP_CALL_SLOT_MAX; loop++) {
+        ret = OsMpFuncCall(CPUID_TO_AFFI_MASK(ArchCurrCpuid()), MpCallMark, (VOID *)&selfCalls);
+        if (ret != LOS_OK) {
+            break;
+        }
+        posted++;
+    }
+    LOS_IntRestore(intSave);
+    ICUNIT_ASSERT_NOT_EQUAL(ret, LOS_OK, ret);
+    while (LOS_AtomicRead(&selfCalls) != (INT32)posted) {
+        (VOID)LOS_TaskDelay(1);
+    }
+
+    return LOS_OK;
+}
+
+VOID ItSmpLosTask163(VOID)
+{
+    TEST_ADD_CASE("ItSmpLosTask163", Testcase, TEST_LOS, TEST_TASK, TEST_LEVEL0, TEST_FUNCTION);
+}
+
+#ifdef __cplusplus
+#if __cplusplus
+}
+#endif /* __cpluscplus */
+#endif /* __cpluscplus */
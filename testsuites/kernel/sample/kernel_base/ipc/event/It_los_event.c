@@ -73,6 +73,7 @@ VOID ItSuiteLosEvent(VOID)
     ItSmpLosEvent032();
     ItSmpLosEvent034();
     ItSmpLosEvent037();
+    ItSmpLosEvent038();
 #endif
 
 #if defined(LOSCFG_TEST_SMOKE)
@@ -123,6 +124,7 @@ VOID ItSuiteLosEvent(VOID)
     ItLosEvent040();
     ItLosEvent042();
     ItLosEvent043();
+    ItLosEvent044();
 #endif
 
 #if defined(LOSCFG_TEST_PRESSURE)
@@ -140,6 +140,7 @@ extern VOID ItLosEvent039(VOID);
 extern VOID ItLosEvent040(VOID);
 extern VOID ItLosEvent042(VOID);
 extern VOID ItLosEvent043(VOID);
+extern VOID ItLosEvent044(VOID);
 #endif
 
 #if defined(LOSCFG_TEST_PRESSURE)
@@ -189,6 +190,7 @@ VOID ItSmpLosEvent034(VOID);
 VOID ItSmpLosEvent035(VOID);
 VOID ItSmpLosEvent036(VOID);
 VOID ItSmpLosEvent037(VOID);
+VOID ItSmpLosEvent038(VOID);
 #endif
 
 #ifdef __cplusplus
@@ -0,0 +1,152 @@
+/*
+ * Copyright (c) 2013-2019 Huawei Technologies Co., Ltd. All rights reserved.
+ * Copyright (c) 2020-2021 Huawei Device Co., Ltd. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of
+ * conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used
+ * to endorse or promote products derived from this software without specific prior written
+ * permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "It_los_event.h"
+#include "los_event_pri.h"
+
+#ifdef __cplusplus
+#if __cplusplus
+extern "C" {
+#endif /* __cpluscplus */
+#endif /* __cpluscplus */
+
+static UINT32 g_notifyEvents;
+
+static VOID EventNotify(PEVENT_CB_S eventCB, UINT32 events, VOID *arg)
+{
+    (VOID)eventCB;
+    g_notifyEvents |= events;
+    (*(UINT32 *)arg)++;
+}
+
+static VOID TaskF01(VOID)
+{
+    UINT32 ret;
+
+    g_testCount++;
+
+    ret = LOS_EventRead(&g_event, 0x11, LOS_WAITMODE_AND | LOS_WAITMODE_CLR, LOS_WAIT_FOREVER);
+    ICUNIT_GOTO_EQUAL(ret, 0x11, ret, EXIT);
+
+    g_testCount++;
+
+EXIT:
+    LOS_TaskDelete(g_testTaskID01);
+}
+
+static UINT32 Testcase(VOID)
+{
+    UINT32 ret;
+    UINT32 notifyCount = 0;
+    TSK_INIT_PARAM_S task1;
+
+    ret = LOS_EventInit(&g_event);
+    ICUNIT_ASSERT_EQUAL(ret, LOS_OK, ret);
+
+    /* no waiter: write, read and clear all work on the event word directly */
+    ret = LOS_EventWrite(&g_event, 0x3);
+    ICUNIT_GOTO_EQUAL(ret, LOS_OK, ret, EXIT);
+    ICUNIT_GOTO_EQUAL(g_event.uwWaiters, 0, g_event.uwWaiters, EXIT);
+    ret = LOS_EventRead(&g_event, 0x1, LOS_WAITMODE_OR | LOS_WAITMODE_CLR, 0);
+    ICUNIT_GOTO_EQUAL(ret, 0x1, ret, EXIT);
+    ICUNIT_GOTO_EQUAL(g_event.uwEventID, 0x2, g_event.uwEventID, EXIT);
+    ret = LOS_EventRead(&g_event, 0x5, LOS_WAITMODE_AND, 0);
+    ICUNIT_GOTO_EQUAL(ret, 0, ret, EXIT);
+    ret = LOS_EventClear(&g_event, ~0x2);
+    ICUNIT_GOTO_EQUAL(ret, LOS_OK, ret, EXIT);
+    ICUNIT_GOTO_EQUAL(g_event.uwEventID, 0, g_event.uwEventID, EXIT);
+
+    /* a pended reader is counted as a waiter and is woken by the write that completes its mask */
+    (VOID)memset_s(&task1, sizeof(TSK_INIT_PARAM_S), 0, sizeof(TSK_INIT_PARAM_S));
+    task1.pfnTaskEntry = (TSK_ENTRY_FUNC)TaskF01;
+    task1.pcName = "EventTsk44";
+    task1.uwStackSize = TASK_STACK_SIZE_TEST;
+    task1.usTaskPrio = TASK_PRIO_TEST - 2; // 2, set new task priority, it is higher than the current task.
+    task1.uwResved = LOS_TASK_STATUS_DETACHED;
+    g_testCount = 0;
+    ret = LOS_TaskCreate(&g_testTaskID01, &task1);
+    ICUNIT_GOTO_EQUAL(ret, LOS_OK, ret, EXIT);
+    ICUNIT_GOTO_EQUAL(g_testCount, 1, g_testCount, EXIT);
+    ICUNIT_GOTO_EQUAL(g_event.uwWaiters, 1, g_event.uwWaiters, EXIT);
+
+    ret = LOS_EventWrite(&g_event, 0x1);
+    ICUNIT_GOTO_EQUAL(ret, LOS_OK, ret, EXIT);
+    ICUNIT_GOTO_EQUAL(g_testCount, 1, g_testCount, EXIT);
+    ret = LOS_EventWrite(&g_event, 0x10);
+    ICUNIT_GOTO_EQUAL(ret, LOS_OK, ret, EXIT);
+    ICUNIT_GOTO_EQUAL(g_testCount, 2, g_testCount, EXIT); // 2, the reader has run to the end.
+    ICUNIT_GOTO_EQUAL(g_event.uwWaiters, 0, g_event.uwWaiters, EXIT);
+    ICUNIT_GOTO_EQUAL(g_event.uwEventID, 0, g_event.uwEventID, EXIT);
+
+    /* an attached notifier sees every write, and keeps the event from being destroyed */
+    g_notifyEvents = 0;
+    ret = OsEventNotifySet(&g_event, EventNotify, &notifyCount);
+    ICUNIT_GOTO_EQUAL(ret, LOS_OK, ret, EXIT);
+    ret = OsEventNotifySet(&g_event, EventNotify, &notifyCount);
+    ICUNIT_GOTO_EQUAL(ret, LOS_NOK, ret, EXIT1);
+    ret = LOS_EventWrite(&g_event, 0x4);
+    ICUNIT_GOTO_EQUAL(ret, LOS_OK, ret, EXIT1);
+    ret = LOS_EventWrite(&g_event, 0x8);
+    ICUNIT_GOTO_EQUAL(ret, LOS_OK, ret, EXIT1);
+    ICUNIT_GOTO_EQUAL(notifyCount, 2, notifyCount, EXIT1); // 2, one call per write
+    ICUNIT_GOTO_EQUAL(g_notifyEvents, 0xc, g_notifyEvents, EXIT1);
+    ret = LOS_EventDestroy(&g_event);
+    ICUNIT_GOTO_EQUAL(ret, LOS_ERRNO_EVENT_SHOULD_NOT_DESTROY, ret, EXIT1);
+
+    ret = OsEventNotifySet(&g_event, NULL, NULL);
+    ICUNIT_GOTO_EQUAL(ret, LOS_OK, ret, EXIT);
+    ICUNIT_GOTO_EQUAL(g_event.uwWaiters, 0, g_event.uwWaiters, EXIT);
+    ret = LOS_EventWrite(&g_event, 0x4);
+    ICUNIT_GOTO_EQUAL(ret, LOS_OK, ret, EXIT);
+    ICUNIT_GOTO_EQUAL(notifyCount, 2, notifyCount, EXIT); // 2, detached notifier is not called any more
+
+    ret = LOS_EventDestroy(&g_event);
+    ICUNIT_ASSERT_EQUAL(ret, LOS_OK, ret);
+
+    return LOS_OK;
+
+EXIT1:
+    (VOID)OsEventNotifySet(&g_event, NULL, NULL);
+EXIT:
+    LOS_TaskDelete(g_testTaskID01);
+    (VOID)LOS_EventDestroy(&g_event);
+    return LOS_OK;
+}
+
+VOID ItLosEvent044(VOID) // IT_Layer_ModuleORFeature_No
+{
+    TEST_ADD_CASE("ItLosEvent044", Testcase, TEST_LOS, TEST_EVENT, TEST_LEVEL2, TEST_FUNCTION);
+}
+#ifdef __cplusplus
+#if __cplusplus
+}
+#endif /* __cpluscplus */
+#endif /* __cpluscplus */
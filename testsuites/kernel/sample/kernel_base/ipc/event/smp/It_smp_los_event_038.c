@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2013-2019 Huawei Technologies Co., Ltd. All rights reserved.
+ * Copyright (c) 2020-2021 Huawei Device Co., Ltd. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of
+ * conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used
+ * to endorse or promote products derived from this software without specific prior written
+ * permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "It_los_event.h"
+
+#ifdef __cplusplus
+#if __cplusplus
+extern "C" {
+#endif /* __cpluscplus */
+#endif /* __cpluscplus */
+
+#define EVENT_FAST_PATH_LOOP 10000
+
+static UINT32 g_ret = LOS_OK;
+
+/* Set and clear one bit again and again, checking after each step that the other cpu did not lose it */
+static UINT32 EventWriteClearLoop(UINT32 bit)
+{
+    UINT32 ret;
+    UINT32 i;
+
+    for (i = 0; i < EVENT_FAST_PATH_LOOP; i++) {
+        ret = LOS_EventWrite(&g_event, bit);
+        if (ret != LOS_OK) {
+            return ret;
+        }
+
+        ret = LOS_EventRead(&g_event, bit, LOS_WAITMODE_OR, LOS_NO_WAIT);
+        if (ret != bit) {
+            return LOS_NOK;
+        }
+
+        ret = LOS_EventClear(&g_event, ~bit);
+        if (ret != LOS_OK) {
+            return ret;
+        }
+
+        if (*(volatile UINT32 *)&g_event.uwEventID & bit) {
+            return LOS_NOK;
+        }
+    }
+
+    return LOS_EventWrite(&g_event, bit);
+}
+
+static VOID TaskF01(VOID)
+{
+    LOS_AtomicInc(&g_testCount);
+
+    do {
+        __asm__ volatile("nop");
+    } while (g_testCount == 1); // wait for the test task to start too
+
+    g_ret = EventWriteClearLoop(0x1);
+
+    TestDumpCpuid();
+    LOS_AtomicInc(&g_testCount);
+}
+
+static UINT32 Testcase(VOID)
+{
+    UINT32 ret;
+    TSK_INIT_PARAM_S testTask;
+
+    g_testCount = 0;
+    g_ret = LOS_NOK;
+
+    ret = LOS_EventInit(&g_event);
+    ICUNIT_ASSERT_EQUAL(ret, LOS_OK, ret);
+
+    TEST_TASK_PARAM_INIT_AFFI(testTask, "it_smp_event_038_task1", TaskF01, TASK_PRIO_TEST - 1,
+        CPUID_TO_AFFI_MASK((ArchCurrCpuid() + 1) % (LOSCFG_KERNEL_CORE_NUM))); // other cpu
+    ret = LOS_TaskCreate(&g_testTaskID01, &testTask);
+    ICUNIT_GOTO_EQUAL(ret, LOS_OK, ret, EXIT);
+
+    do {
+        __asm__ volatile("nop");
+    } while (g_testCount == 0); // wait for task f01
+
+    LOS_AtomicInc(&g_testCount);
+
+    ret = EventWriteClearLoop(0x2);
+    ICUNIT_GOTO_EQUAL(ret, LOS_OK, ret, EXIT);
+
+    do {
+        __asm__ volatile("nop");
+    } while (g_testCount == 2); // 2, wait for task f01 to finish its loop
+
+    ICUNIT_GOTO_EQUAL(g_ret, LOS_OK, g_ret, EXIT);
+
+    /* Both sides ended with a write, and nobody pended, so the lock was never needed */
+    ICUNIT_GOTO_EQUAL(g_event.uwEventID, 0x3, g_event.uwEventID, EXIT);
+    ICUNIT_GOTO_EQUAL(g_event.uwWaiters, 0, g_event.uwWaiters, EXIT);
+
+EXIT:
+    LOS_TaskDelete(g_testTaskID01);
+    ret = LOS_EventDestroy(&g_event);
+    ICUNIT_ASSERT_EQUAL(ret, LOS_OK, ret);
+    return LOS_OK;
+}
+
+VOID ItSmpLosEvent038(VOID) // IT_Layer_ModuleORFeature_No
+{
+    TEST_ADD_CASE("ItSmpLosEvent038", Testcase, TEST_LOS, TEST_EVENT, TEST_LEVEL2, TEST_FUNCTION);
+}
+
+#ifdef __cplusplus
+#if __cplusplus
+}
+#endif /* __cpluscplus */
+#endif /* __cpluscplus */
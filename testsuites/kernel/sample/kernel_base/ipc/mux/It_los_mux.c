@@ -105,6 +105,10 @@ VOID ItSuiteLosMux(void)
     ItLosMux041();
     ItLosMux042();
     ItLosMux043();
+    ItLosMux044();
+#ifdef LOSCFG_KERNEL_LOCKSTAT
+    ItLosMux045();
+#endif
 #endif
 
 #ifdef LOSCFG_KERNEL_SMP
@@ -141,6 +145,7 @@ VOID ItSuiteLosMux(void)
     ItSmpLosMux2027();
     ItSmpLosMux2028();
     ItSmpLosMux2029();
+    ItSmpLosMux2030();
 #endif
 
 #ifdef LOSCFG_KERNEL_SMP
@@ -102,6 +102,10 @@ VOID ItLosMux040(void);
 VOID ItLosMux041(void);
 VOID ItLosMux042(void);
 VOID ItLosMux043(void);
+VOID ItLosMux044(void);
+#ifdef LOSCFG_KERNEL_LOCKSTAT
+VOID ItLosMux045(void);
+#endif
 #endif
 
 #if defined(LOSCFG_TEST_SMP)
@@ -141,6 +145,7 @@ VOID ItSmpLosMux2026(void);
 VOID ItSmpLosMux2027(void);
 VOID ItSmpLosMux2028(void);
 VOID ItSmpLosMux2029(void);
+VOID ItSmpLosMux2030(void);
 #endif
 
 #ifdef __cplusplus
@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2013-2019 Huawei Technologies Co., Ltd. All rights reserved.
+ * Copyright (c) 2020-2021 Huawei Device Co., Ltd. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of
+ * conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used
+ * to endorse or promote products derived from this software without specific prior written
+ * permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "osTest.h"
+#include "los_config.h"
+#include "It_los_mux.h"
+
+#ifdef __cplusplus
+#if __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+#endif /* __cplusplus */
+
+static LosMux g_testMux1;
+static VOID TaskF01(VOID)
+{
+    UINT32 ret;
+
+    g_testCount++;
+
+    /* The owner is preempted on this core, so the task must pend instead of spinning. */
+    ret = LOS_MuxLock(&g_testMux1, 1);
+    ICUNIT_ASSERT_EQUAL_VOID(ret, LOS_ETIMEDOUT, ret);
+
+    g_testCount++;
+}
+
+static UINT32 Testcase(VOID)
+{
+    UINT32 ret;
+    TSK_INIT_PARAM_S taskParam = { 0 };
+    LosMuxSpinStat before = { 0 };
+    LosMuxSpinStat after = { 0 };
+    g_testCount = 0;
+
+    ret = LOS_MuxSpinStatGet(NULL);
+    ICUNIT_ASSERT_EQUAL(ret, LOS_EINVAL, ret);
+
+    ret = LosMuxCreate(&g_testMux1);
+    ICUNIT_ASSERT_EQUAL(ret, LOS_OK, ret);
+
+    ret = LOS_MuxLock(&g_testMux1, LOS_WAIT_FOREVER);
+    ICUNIT_GOTO_EQUAL(ret, LOS_OK, ret, EXIT);
+
+    ret = LOS_MuxSpinStatGet(&before);
+    ICUNIT_GOTO_EQUAL(ret, LOS_OK, ret, EXIT);
+
+    taskParam.pfnTaskEntry = (TSK_ENTRY_FUNC)TaskF01;
+    taskParam.usTaskPrio = TASK_PRIO_TEST - 1;
+    taskParam.pcName = "MuxSpinTsk";
+    taskParam.uwStackSize = LOSCFG_BASE_CORE_TSK_DEFAULT_STACK_SIZE;
+    taskParam.uwResved = LOS_TASK_STATUS_DETACHED;
+#ifdef LOSCFG_KERNEL_SMP
+    taskParam.usCpuAffiMask = CPUID_TO_AFFI_MASK(ArchCurrCpuid());
+#endif
+
+    ret = LOS_TaskCreate(&g_testTaskID01, &taskParam);
+    ICUNIT_GOTO_EQUAL(ret, LOS_OK, ret, EXIT);
+    ICUNIT_GOTO_EQUAL(g_testCount, 1, g_testCount, EXIT);
+
+    ret = LOS_TaskDelay(2); // 2, wait for the task to time out.
+    ICUNIT_GOTO_EQUAL(ret, LOS_OK, ret, EXIT);
+    ICUNIT_GOTO_EQUAL(g_testCount, 2, g_testCount, EXIT); // 2, here assert the result.
+
+    ret = LOS_MuxSpinStatGet(&after);
+    ICUNIT_GOTO_EQUAL(ret, LOS_OK, ret, EXIT);
+    ICUNIT_GOTO_EQUAL(after.sleep - before.sleep, 1, after.sleep - before.sleep, EXIT);
+    ICUNIT_GOTO_EQUAL(after.spinAcquire, before.spinAcquire, after.spinAcquire, EXIT);
+
+EXIT:
+    (VOID)LOS_MuxUnlock(&g_testMux1);
+    ret = LOS_MuxDestroy(&g_testMux1);
+    ICUNIT_ASSERT_EQUAL(ret, LOS_OK, ret);
+
+    return LOS_OK;
+}
+
+VOID ItLosMux044(void)
+{
+    TEST_ADD_CASE("ItLosMux044", Testcase, TEST_LOS, TEST_MUX, TEST_LEVEL1, TEST_FUNCTION);
+}
+
+#ifdef __cplusplus
+#if __cplusplus
+}
+#endif /* __cplusplus */
+#endif /* __cplusplus */
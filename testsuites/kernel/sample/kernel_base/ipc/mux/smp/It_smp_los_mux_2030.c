@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) 2013-2019 Huawei Technologies Co., Ltd. All rights reserved.
+ * Copyright (c) 2020-2021 Huawei Device Co., Ltd. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of
+ * conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used
+ * to endorse or promote products derived from this software without specific prior written
+ * permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "It_los_mux.h"
+
+#ifdef __cplusplus
+#if __cplusplus
+extern "C" {
+#endif /* __cpluscplus */
+#endif /* __cpluscplus */
+
+#define MUX_HOLD_LOOP 0xFFFFF
+
+static LosMux g_testMux1;
+static VOID TaskF01(VOID)
+{
+    UINT32 ret;
+    volatile UINT32 i;
+
+    ret = LOS_MuxLock(&g_testMux1, LOS_WAIT_FOREVER);
+    ICUNIT_ASSERT_EQUAL_VOID(ret, LOS_OK, ret);
+
+    LOS_AtomicInc(&g_testCount);
+
+    do {
+        __asm__ volatile("nop");
+    } while (g_testCount == 1); // keep running on this cpu with the mutex held
+
+    for (i = 0; i < MUX_HOLD_LOOP; i++) {
+    }
+
+    ret = LOS_MuxUnlock(&g_testMux1);
+    ICUNIT_ASSERT_EQUAL_VOID(ret, LOS_OK, ret);
+
+    LOS_AtomicInc(&g_testCount);
+}
+
+static UINT32 Testcase(VOID)
+{
+    UINT32 ret;
+    UINT64 tick;
+    TSK_INIT_PARAM_S testTask;
+    LosMuxSpinStat before = { 0 };
+    LosMuxSpinStat after = { 0 };
+
+    g_testCount = 0;
+
+    ret = LosMuxCreate(&g_testMux1);
+    ICUNIT_ASSERT_EQUAL(ret, LOS_OK, ret);
+
+    LOS_MuxSpinBudgetSet(0xFFFFFFFF); // the budget alone would let the caller spin for seconds
+
+    TEST_TASK_PARAM_INIT_AFFI(testTask, "it_smp_mux_2030_task1", TaskF01, TASK_PRIO_TEST - 1,
+        CPUID_TO_AFFI_MASK((ArchCurrCpuid() + 1) % (LOSCFG_KERNEL_CORE_NUM))); // other cpu
+    ret = LOS_TaskCreate(&g_testTaskID01, &testTask);
+    ICUNIT_GOTO_EQUAL(ret, LOS_OK, ret, EXIT);
+
+    do {
+        __asm__ volatile("nop");
+    } while (g_testCount == 0); // wait for task f01 to own the mutex
+
+    ret = LOS_MuxSpinStatGet(&before);
+    ICUNIT_GOTO_EQUAL(ret, LOS_OK, ret, EXIT);
+
+    /* The owner keeps running, so the spin is cut short by the one tick timeout and the caller pends. */
+    tick = LOS_TickCountGet();
+    ret = LOS_MuxLock(&g_testMux1, 1);
+    tick = LOS_TickCountGet() - tick;
+    ICUNIT_GOTO_EQUAL(ret, LOS_ETIMEDOUT, ret, EXIT);
+    ICUNIT_GOTO_EQUAL((tick <= 3), TRUE, tick, EXIT); // 3, spinning and pending both fit in the timeout
+
+    ret = LOS_MuxSpinStatGet(&after);
+    ICUNIT_GOTO_EQUAL(ret, LOS_OK, ret, EXIT);
+    ICUNIT_GOTO_EQUAL(after.spinFailed - before.spinFailed, 1, after.spinFailed - before.spinFailed, EXIT);
+    ICUNIT_GOTO_EQUAL(after.sleep - before.sleep, 1, after.sleep - before.sleep, EXIT);
+    ICUNIT_GOTO_EQUAL(after.spinAcquire, before.spinAcquire, after.spinAcquire, EXIT);
+
+    /* The owner releases the mutex while still running, so the caller takes it without pending. */
+    before = after;
+    LOS_AtomicInc(&g_testCount);
+    ret = LOS_MuxLock(&g_testMux1, LOS_WAIT_FOREVER);
+    ICUNIT_GOTO_EQUAL(ret, LOS_OK, ret, EXIT);
+
+    ret = LOS_MuxSpinStatGet(&after);
+    ICUNIT_GOTO_EQUAL(ret, LOS_OK, ret, EXIT);
+    ICUNIT_GOTO_EQUAL(after.spinAcquire - before.spinAcquire, 1, after.spinAcquire - before.spinAcquire, EXIT);
+    ICUNIT_GOTO_EQUAL(after.sleep, before.sleep, after.sleep, EXIT);
+
+    ret = LOS_MuxUnlock(&g_testMux1);
+    ICUNIT_GOTO_EQUAL(ret, LOS_OK, ret, EXIT);
+
+EXIT:
+    LOS_MuxSpinBudgetSet(LOSCFG_BASE_IPC_MUX_SPIN_CYCLES);
+    LOS_TaskDelete(g_testTaskID01);
+    LOS_MuxDestroy(&g_testMux1);
+    return LOS_OK;
+}
+
+VOID ItSmpLosMux2030(VOID) // IT_Layer_ModuleORFeature_No
+{
+    TEST_ADD_CASE("ItSmpLosMux2030", Testcase, TEST_LOS, TEST_MUX, TEST_LEVEL2, TEST_FUNCTION);
+}
+#ifdef __cplusplus
+#if __cplusplus
+}
+#endif /* __cpluscplus */
+#endif /* __cpluscplus */
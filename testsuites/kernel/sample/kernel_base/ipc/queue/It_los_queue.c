@@ -81,6 +81,7 @@ VOID ItSuiteLosQueue(VOID)
     ItLosQueue105();
 #endif
     ItLosQueueHead002();
+    ItLosQueue125();
 #endif
 
 #if defined(LOSCFG_TEST_FULL)
@@ -189,6 +190,9 @@ VOID ItSuiteLosQueue(VOID)
     ItLosQueue113();
     ItLosQueue114();
     ItLosQueue116();
+    ItLosQueue124();
+    ItLosQueue126();
+    ItLosQueue127();
 #endif
 
     ItLosQueueHead003();
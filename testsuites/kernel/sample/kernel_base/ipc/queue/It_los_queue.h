@@ -71,6 +71,7 @@ VOID ItLosQueue100(VOID);
 VOID ItLosQueue105(VOID);
 #endif
 VOID ItLosQueueHead002(VOID);
+VOID ItLosQueue125(VOID);
 #endif
 
 #if defined(LOSCFG_TEST_FULL)
@@ -176,6 +177,9 @@ VOID ItLosQueue112(VOID);
 VOID ItLosQueue113(VOID);
 VOID ItLosQueue114(VOID);
 VOID ItLosQueue116(VOID);
+VOID ItLosQueue124(VOID);
+VOID ItLosQueue126(VOID);
+VOID ItLosQueue127(VOID);
 
 VOID ItLosQueueHead003(VOID);
 VOID ItLosQueueHead004(VOID);
@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2013-2019 Huawei Technologies Co., Ltd. All rights reserved.
+ * Copyright (c) 2020-2021 Huawei Device Co., Ltd. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of
+ * conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used
+ * to endorse or promote products derived from this software without specific prior written
+ * permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "It_los_queue.h"
+#ifdef __cplusplus
+#if __cplusplus
+extern "C" {
+#endif /* __cpluscplus */
+#endif /* __cpluscplus */
+
+static VOID *g_zcSlot = NULL;
+
+static VOID TaskF01(VOID)
+{
+    UINT32 ret;
+    VOID *slot = NULL;
+    UINT32 slotSize = 0;
+
+    g_testCount++;
+
+    ret = LOS_QueueReserve(g_testQueueID01, &slot, &slotSize, LOS_WAIT_FOREVER);
+    ICUNIT_ASSERT_EQUAL_VOID(ret, LOS_OK, ret);
+    ICUNIT_ASSERT_EQUAL_VOID(slot, g_zcSlot, slot); // the writer gets the slot the reader just released.
+
+    *(CHAR *)slot = 'C';
+    ret = LOS_QueueCommit(g_testQueueID01, slot, 1);
+    ICUNIT_ASSERT_EQUAL_VOID(ret, LOS_OK, ret);
+
+    g_testCount++;
+}
+
+static UINT32 Testcase(VOID)
+{
+    UINT32 ret;
+    UINT32 index;
+    VOID *slot = NULL;
+    VOID *msg = NULL;
+    UINT32 slotSize;
+    UINT32 msgSize;
+    TSK_INIT_PARAM_S task = { 0 };
+    QUEUE_INFO_S queueInfo;
+
+    g_testCount = 0;
+
+    ret = LOS_QueueCreate("Q1", 2, &g_testQueueID01, LOS_QUEUE_ZERO_COPY, 8); // 2, queue length; 8, node size.
+    ICUNIT_GOTO_EQUAL(ret, LOS_OK, ret, EXIT);
+
+    for (index = 0; index < 2; index++) { // 2, fill the queue.
+        ret = LOS_QueueReserve(g_testQueueID01, &slot, &slotSize, 0);
+        ICUNIT_GOTO_EQUAL(ret, LOS_OK, ret, EXIT);
+        *(CHAR *)slot = (CHAR)('A' + index);
+        ret = LOS_QueueCommit(g_testQueueID01, slot, 1);
+        ICUNIT_GOTO_EQUAL(ret, LOS_OK, ret, EXIT);
+    }
+
+    ret = LOS_QueueReserve(g_testQueueID01, &slot, &slotSize, 0);
+    ICUNIT_GOTO_EQUAL(ret, LOS_ERRNO_QUEUE_ISFULL, ret, EXIT);
+
+    ret = LOS_QueueCommit(g_testQueueID01, slot, 1); // nothing is reserved on a full queue.
+    ICUNIT_GOTO_EQUAL(ret, LOS_ERRNO_QUEUE_SLOT_INVALID, ret, EXIT);
+
+    task.pfnTaskEntry = (TSK_ENTRY_FUNC)TaskF01;
+    task.pcName = "QueueZcTsk";
+    task.uwStackSize = LOSCFG_BASE_CORE_TSK_DEFAULT_STACK_SIZE;
+    task.usTaskPrio = TASK_PRIO_TEST - 1;
+    task.uwResved = LOS_TASK_STATUS_DETACHED;
+#ifdef LOSCFG_KERNEL_SMP
+    task.usCpuAffiMask = CPUID_TO_AFFI_MASK(ArchCurrCpuid());
+#endif
+    ret = LOS_TaskCreate(&g_testTaskID01, &task);
+    ICUNIT_GOTO_EQUAL(ret, LOS_OK, ret, EXIT);
+    ICUNIT_GOTO_EQUAL(g_testCount, 1, g_testCount, EXIT); // the writer is pending on the full queue.
+
+    ret = LOS_QueuePeek(g_testQueueID01, &msg, &msgSize, 0);
+    ICUNIT_GOTO_EQUAL(ret, LOS_OK, ret, EXIT);
+    ICUNIT_GOTO_EQUAL(*(CHAR *)msg, 'A', *(CHAR *)msg, EXIT);
+    g_zcSlot = msg;
+
+    ret = LOS_QueueRelease(g_testQueueID01, msg);
+    ICUNIT_GOTO_EQUAL(ret, LOS_OK, ret, EXIT);
+    ICUNIT_GOTO_EQUAL(g_testCount, 2, g_testCount, EXIT); // 2, the writer reused the released slot.
+
+    ret = LOS_QueueInfoGet(g_testQueueID01, &queueInfo);
+    ICUNIT_GOTO_EQUAL(ret, LOS_OK, ret, EXIT);
+    ICUNIT_GOTO_EQUAL(queueInfo.usReadableCnt, 2, queueInfo.usReadableCnt, EXIT); // 2, the queue is full again.
+
+    for (index = 1; index < 3; index++) { // 3, 'B' then 'C' in commit order.
+        ret = LOS_QueuePeek(g_testQueueID01, &msg, &msgSize, 0);
+        ICUNIT_GOTO_EQUAL(ret, LOS_OK, ret, EXIT);
+        ICUNIT_GOTO_EQUAL(*(CHAR *)msg, (CHAR)('A' + index), *(CHAR *)msg, EXIT);
+        ret = LOS_QueueRelease(g_testQueueID01, msg);
+        ICUNIT_GOTO_EQUAL(ret, LOS_OK, ret, EXIT);
+    }
+
+    ret = LOS_QueueDelete(g_testQueueID01);
+    ICUNIT_GOTO_EQUAL(ret, LOS_OK, ret, EXIT);
+
+    return LOS_OK;
+
+EXIT:
+    LOS_TaskDelete(g_testTaskID01);
+    LOS_QueueDelete(g_testQueueID01);
+    return LOS_OK;
+}
+
+VOID ItLosQueue126(VOID)
+{
+    TEST_ADD_CASE("ItLosQueue126", Testcase, TEST_LOS, TEST_QUE, TEST_LEVEL1, TEST_FUNCTION);
+}
+
+#ifdef __cplusplus
+#if __cplusplus
+}
+#endif /* __cpluscplus */
+#endif /* __cpluscplus */
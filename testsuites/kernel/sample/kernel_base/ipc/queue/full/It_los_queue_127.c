@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2013-2019 Huawei Technologies Co., Ltd. All rights reserved.
+ * Copyright (c) 2020-2021 Huawei Device Co., Ltd. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of
+ * conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used
+ * to endorse or promote products derived from this software without specific prior written
+ * permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "It_los_queue.h"
+#ifdef __cplusplus
+#if __cplusplus
+extern "C" {
+#endif /* __cpluscplus */
+#endif /* __cpluscplus */
+
+
+static UINT32 Testcase(VOID)
+{
+    UINT32 ret;
+    VOID *slot = NULL;
+    VOID *msg = NULL;
+    UINT32 slotSize;
+    UINT32 msgSize;
+
+    ret = LOS_QueueCreate("Q1", 2, &g_testQueueID01, LOS_QUEUE_ZERO_COPY, 8); // 2, queue length; 8, node size.
+    ICUNIT_GOTO_EQUAL(ret, LOS_OK, ret, EXIT);
+
+    ret = LOS_QueueReserve(g_testQueueID01, &slot, &slotSize, 0);
+    ICUNIT_GOTO_EQUAL(ret, LOS_OK, ret, EXIT);
+    (VOID)memcpy_s(slot, slotSize, "UniDSP", 7); // 7, "UniDSP" with the terminator.
+    ret = LOS_QueueCommit(g_testQueueID01, slot, 7); // 7, message size.
+    ICUNIT_GOTO_EQUAL(ret, LOS_OK, ret, EXIT);
+
+    /* A peeked message is still owned by the queue buffer, so the queue must stay alive. */
+    ret = LOS_QueuePeek(g_testQueueID01, &msg, &msgSize, 0);
+    ICUNIT_GOTO_EQUAL(ret, LOS_OK, ret, EXIT);
+
+    ret = LOS_QueueDelete(g_testQueueID01);
+    ICUNIT_GOTO_EQUAL(ret, LOS_ERRNO_QUEUE_SLOT_IN_USE, ret, EXIT);
+
+    ret = strcmp((CHAR *)msg, "UniDSP");
+    ICUNIT_GOTO_EQUAL(ret, 0, ret, EXIT);
+
+    ret = LOS_QueueRelease(g_testQueueID01, msg);
+    ICUNIT_GOTO_EQUAL(ret, LOS_OK, ret, EXIT);
+
+    /* The writer still owns a reserved slot, so the queue must stay alive until it commits. */
+    ret = LOS_QueueReserve(g_testQueueID01, &slot, &slotSize, 0);
+    ICUNIT_GOTO_EQUAL(ret, LOS_OK, ret, EXIT);
+
+    ret = LOS_QueueDelete(g_testQueueID01);
+    ICUNIT_GOTO_EQUAL(ret, LOS_ERRNO_QUEUE_SLOT_IN_USE, ret, EXIT);
+
+    ret = LOS_QueueCommit(g_testQueueID01, slot, 1);
+    ICUNIT_GOTO_EQUAL(ret, LOS_OK, ret, EXIT);
+
+    ret = LOS_QueuePeek(g_testQueueID01, &msg, &msgSize, 0);
+    ICUNIT_GOTO_EQUAL(ret, LOS_OK, ret, EXIT);
+    ret = LOS_QueueRelease(g_testQueueID01, msg);
+    ICUNIT_GOTO_EQUAL(ret, LOS_OK, ret, EXIT);
+
+    ret = LOS_QueueDelete(g_testQueueID01);
+    ICUNIT_GOTO_EQUAL(ret, LOS_OK, ret, EXIT);
+
+    ret = LOS_QueueReserve(g_testQueueID01, &slot, &slotSize, 0);
+    ICUNIT_GOTO_EQUAL(ret, LOS_ERRNO_QUEUE_NOT_CREATE, ret, EXIT);
+
+    ret = LOS_QueuePeek(g_testQueueID01, &msg, &msgSize, 0);
+    ICUNIT_GOTO_EQUAL(ret, LOS_ERRNO_QUEUE_NOT_CREATE, ret, EXIT);
+
+    return LOS_OK;
+
+EXIT:
+    LOS_QueueDelete(g_testQueueID01);
+    return LOS_OK;
+}
+
+VOID ItLosQueue127(VOID)
+{
+    TEST_ADD_CASE("ItLosQueue127", Testcase, TEST_LOS, TEST_QUE, TEST_LEVEL1, TEST_FUNCTION);
+}
+
+#ifdef __cplusplus
+#if __cplusplus
+}
+#endif /* __cpluscplus */
+#endif /* __cpluscplus */
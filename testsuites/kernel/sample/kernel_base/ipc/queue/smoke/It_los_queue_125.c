@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) 2013-2019 Huawei Technologies Co., Ltd. All rights reserved.
+ * Copyright (c) 2020-2021 Huawei Device Co., Ltd. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of
+ * conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used
+ * to endorse or promote products derived from this software without specific prior written
+ * permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "It_los_queue.h"
+#ifdef __cplusplus
+#if __cplusplus
+extern "C" {
+#endif /* __cpluscplus */
+#endif /* __cpluscplus */
+
+static VOID *g_zcSlot = NULL;
+
+static VOID TaskF01(VOID)
+{
+    UINT32 ret;
+    VOID *msg = NULL;
+    UINT32 msgSize = 0;
+
+    g_testCount++;
+
+    ret = LOS_QueuePeek(g_testQueueID01, &msg, &msgSize, LOS_WAIT_FOREVER);
+    ICUNIT_ASSERT_EQUAL_VOID(ret, LOS_OK, ret);
+    ICUNIT_ASSERT_EQUAL_VOID(msg, g_zcSlot, msg); // the reader gets the writer's slot, nothing is copied.
+    ICUNIT_ASSERT_EQUAL_VOID(msgSize, 7, msgSize); // 7, message size.
+    ret = strcmp((CHAR *)msg, "UniDSP");
+    ICUNIT_ASSERT_EQUAL_VOID(ret, 0, ret);
+
+    ret = LOS_QueueRelease(g_testQueueID01, msg);
+    ICUNIT_ASSERT_EQUAL_VOID(ret, LOS_OK, ret);
+
+    g_testCount++;
+}
+
+static UINT32 Testcase(VOID)
+{
+    UINT32 ret;
+    VOID *slot = NULL;
+    UINT32 slotSize;
+    TSK_INIT_PARAM_S task = { 0 };
+
+    g_testCount = 0;
+    g_zcSlot = NULL;
+
+    ret = LOS_QueueCreate("Q1", 1, &g_testQueueID01, LOS_QUEUE_ZERO_COPY, 8); // 8, node size.
+    ICUNIT_GOTO_EQUAL(ret, LOS_OK, ret, EXIT);
+
+    task.pfnTaskEntry = (TSK_ENTRY_FUNC)TaskF01;
+    task.pcName = "QueueZcTsk";
+    task.uwStackSize = LOSCFG_BASE_CORE_TSK_DEFAULT_STACK_SIZE;
+    task.usTaskPrio = TASK_PRIO_TEST - 1;
+    task.uwResved = LOS_TASK_STATUS_DETACHED;
+#ifdef LOSCFG_KERNEL_SMP
+    task.usCpuAffiMask = CPUID_TO_AFFI_MASK(ArchCurrCpuid());
+#endif
+    ret = LOS_TaskCreate(&g_testTaskID01, &task);
+    ICUNIT_GOTO_EQUAL(ret, LOS_OK, ret, EXIT);
+    ICUNIT_GOTO_EQUAL(g_testCount, 1, g_testCount, EXIT); // the reader is pending on the empty queue.
+
+    ret = LOS_QueueReserve(g_testQueueID01, &slot, &slotSize, 0);
+    ICUNIT_GOTO_EQUAL(ret, LOS_OK, ret, EXIT);
+    g_zcSlot = slot;
+    (VOID)memcpy_s(slot, slotSize, "UniDSP", 7); // 7, "UniDSP" with the terminator.
+
+    ret = LOS_QueueCommit(g_testQueueID01, slot, 7); // 7, message size.
+    ICUNIT_GOTO_EQUAL(ret, LOS_OK, ret, EXIT);
+    ICUNIT_GOTO_EQUAL(g_testCount, 2, g_testCount, EXIT); // 2, the reader peeked and released the slot.
+
+    /* The released slot is owned by the writer again. */
+    ret = LOS_QueueReserve(g_testQueueID01, &slot, &slotSize, 0);
+    ICUNIT_GOTO_EQUAL(ret, LOS_OK, ret, EXIT);
+    ICUNIT_GOTO_EQUAL(slot, g_zcSlot, slot, EXIT);
+
+    ret = LOS_QueueDelete(g_testQueueID01);
+    ICUNIT_GOTO_EQUAL(ret, LOS_OK, ret, EXIT);
+
+    return LOS_OK;
+
+EXIT:
+    LOS_TaskDelete(g_testTaskID01);
+    LOS_QueueDelete(g_testQueueID01);
+    return LOS_OK;
+}
+
+VOID ItLosQueue125(VOID)
+{
+    TEST_ADD_CASE("ItLosQueue125", Testcase, TEST_LOS, TEST_QUE, TEST_LEVEL0, TEST_FUNCTION);
+}
+
+#ifdef __cplusplus
+#if __cplusplus
+}
+#endif /* __cpluscplus */
+#endif /* __cpluscplus */
@@ -0,0 +1,155 @@
+/*
+ * Copyright (c) 2013-2019 Huawei Technologies Co., Ltd. All rights reserved.
+ * Copyright (c) 2020-2021 Huawei Device Co., Ltd. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of
+ * conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used
+ * to endorse or promote products derived from this software without specific prior written
+ * permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "It_los_rwlock.h"
+
+#ifdef __cplusplus
+#if __cplusplus
+extern "C" {
+#endif /* __cpluscplus */
+#endif /* __cpluscplus */
+
+static VOID TaskWriter(VOID)
+{
+    UINT32 ret;
+
+    ret = LOS_BrlockWrLock(&g_brlockTest1, LOS_WAIT_FOREVER);
+    ICUNIT_ASSERT_EQUAL_VOID(ret, LOS_OK, ret);
+
+    g_testCount++;
+
+    ret = LOS_BrlockWrUnlock(&g_brlockTest1);
+    ICUNIT_ASSERT_EQUAL_VOID(ret, LOS_OK, ret);
+}
+
+static UINT32 Testcase(VOID)
+{
+    UINT32 ret;
+    TSK_INIT_PARAM_S task = { 0 };
+    g_testCount = 0;
+
+    ret = LOS_BrlockInit(NULL, LOS_BRLOCK_WRITER_PREFER);
+    ICUNIT_ASSERT_EQUAL(ret, LOS_EINVAL, ret);
+
+    ret = LOS_BrlockInit(&g_brlockTest1, 2); // 2, invalid policy
+    ICUNIT_ASSERT_EQUAL(ret, LOS_EINVAL, ret);
+
+    ret = LOS_BrlockInit(&g_brlockTest1, LOS_BRLOCK_WRITER_PREFER);
+    ICUNIT_ASSERT_EQUAL(ret, LOS_OK, ret);
+
+    /* readers nest freely */
+    ret = LOS_BrlockRdLock(&g_brlockTest1, LOS_WAIT_FOREVER);
+    ICUNIT_GOTO_EQUAL(ret, LOS_OK, ret, EXIT);
+    ret = LOS_BrlockRdLock(&g_brlockTest1, LOS_NO_WAIT);
+    ICUNIT_GOTO_EQUAL(ret, LOS_OK, ret, EXIT);
+
+    ret = LOS_BrlockDestroy(&g_brlockTest1);
+    ICUNIT_GOTO_EQUAL(ret, LOS_EBUSY, ret, EXIT);
+
+    /* a writer has to wait until every reader is gone */
+    task.pfnTaskEntry = (TSK_ENTRY_FUNC)TaskWriter;
+    task.pcName = "BrlockWriter";
+    task.uwStackSize = TASK_STACK_SIZE_TEST;
+    task.usTaskPrio = TASK_PRIO_TEST - 1;
+    task.uwResved = LOS_TASK_STATUS_DETACHED;
+#ifdef LOSCFG_KERNEL_SMP
+    task.usCpuAffiMask = CPUID_TO_AFFI_MASK(ArchCurrCpuid());
+#endif
+    ret = LOS_TaskCreate(&g_testTaskID01, &task);
+    ICUNIT_GOTO_EQUAL(ret, LOS_OK, ret, EXIT);
+    ICUNIT_GOTO_EQUAL(g_testCount, 0, g_testCount, EXIT);
+
+    /* writer preferred: a new reader may not overtake the pending writer */
+    ret = LOS_BrlockRdLock(&g_brlockTest1, LOS_NO_WAIT);
+    ICUNIT_GOTO_EQUAL(ret, LOS_EINVAL, ret, EXIT);
+
+    ret = LOS_BrlockRdUnlock(&g_brlockTest1);
+    ICUNIT_GOTO_EQUAL(ret, LOS_OK, ret, EXIT);
+    ICUNIT_GOTO_EQUAL(g_testCount, 0, g_testCount, EXIT);
+
+    ret = LOS_BrlockRdUnlock(&g_brlockTest1);
+    ICUNIT_GOTO_EQUAL(ret, LOS_OK, ret, EXIT);
+    ICUNIT_GOTO_EQUAL(g_testCount, 1, g_testCount, EXIT);
+
+    /* the writer excludes itself and everybody else */
+    ret = LOS_BrlockWrLock(&g_brlockTest1, LOS_WAIT_FOREVER);
+    ICUNIT_GOTO_EQUAL(ret, LOS_OK, ret, EXIT);
+    ret = LOS_BrlockWrLock(&g_brlockTest1, LOS_WAIT_FOREVER);
+    ICUNIT_GOTO_EQUAL(ret, LOS_EDEADLK, ret, EXIT);
+    ret = LOS_BrlockRdLock(&g_brlockTest1, LOS_WAIT_FOREVER);
+    ICUNIT_GOTO_EQUAL(ret, LOS_EDEADLK, ret, EXIT);
+    ret = LOS_BrlockWrUnlock(&g_brlockTest1);
+    ICUNIT_GOTO_EQUAL(ret, LOS_OK, ret, EXIT);
+
+    ret = LOS_BrlockWrUnlock(&g_brlockTest1);
+    ICUNIT_GOTO_EQUAL(ret, LOS_EPERM, ret, EXIT);
+
+    /* reader preferred: readers keep entering while the writer drains */
+    ret = LOS_BrlockPolicySet(&g_brlockTest1, LOS_BRLOCK_READER_PREFER);
+    ICUNIT_GOTO_EQUAL(ret, LOS_OK, ret, EXIT);
+
+    ret = LOS_BrlockRdLock(&g_brlockTest1, LOS_WAIT_FOREVER);
+    ICUNIT_GOTO_EQUAL(ret, LOS_OK, ret, EXIT);
+    ret = LOS_TaskCreate(&g_testTaskID01, &task);
+    ICUNIT_GOTO_EQUAL(ret, LOS_OK, ret, EXIT);
+    ret = LOS_BrlockRdLock(&g_brlockTest1, LOS_NO_WAIT);
+    ICUNIT_GOTO_EQUAL(ret, LOS_OK, ret, EXIT);
+    ret = LOS_BrlockRdUnlock(&g_brlockTest1);
+    ICUNIT_GOTO_EQUAL(ret, LOS_OK, ret, EXIT);
+    ICUNIT_GOTO_EQUAL(g_testCount, 1, g_testCount, EXIT);
+    ret = LOS_BrlockRdUnlock(&g_brlockTest1);
+    ICUNIT_GOTO_EQUAL(ret, LOS_OK, ret, EXIT);
+    ICUNIT_GOTO_EQUAL(g_testCount, 2, g_testCount, EXIT); // 2, both writers done
+
+    ret = LOS_BrlockDestroy(&g_brlockTest1);
+    ICUNIT_ASSERT_EQUAL(ret, LOS_OK, ret);
+
+    ret = LOS_BrlockRdLock(&g_brlockTest1, LOS_NO_WAIT);
+    ICUNIT_ASSERT_EQUAL(ret, LOS_EBADF, ret);
+
+    return LOS_OK;
+
+EXIT:
+    (VOID)LOS_TaskDelete(g_testTaskID01);
+    (VOID)memset_s(&g_brlockTest1, sizeof(LosBrlock), 0, sizeof(LosBrlock));
+    return LOS_NOK;
+}
+
+VOID ItLosBrlock001(void)
+{
+    TEST_ADD_CASE("ItLosBrlock001", Testcase, TEST_LOS, TEST_RWLOCK, TEST_LEVEL0, TEST_FUNCTION);
+}
+
+#ifdef __cplusplus
+#if __cplusplus
+}
+#endif /* __cpluscplus */
+#endif /* __cpluscplus */
@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) 2013-2019 Huawei Technologies Co., Ltd. All rights reserved.
+ * Copyright (c) 2020-2021 Huawei Device Co., Ltd. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of
+ * conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used
+ * to endorse or promote products derived from this software without specific prior written
+ * permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "It_los_rwlock.h"
+
+#ifdef __cplusplus
+#if __cplusplus
+extern "C" {
+#endif /* __cpluscplus */
+#endif /* __cpluscplus */
+
+#define BRLOCK_TEST_LOOP 10000
+
+static UINT32 g_readerCores;
+static UINT64 g_readerCycles[LOSCFG_KERNEL_CORE_NUM];
+
+static VOID TaskBrlockReader(VOID)
+{
+    UINT64 start;
+    UINT32 loop;
+
+    LOS_AtomicInc(&g_testCount);
+    while (g_testCount < g_readerCores) { // 所有读者都到齐后再一起开始
+    }
+
+    start = HalClockGetCycles();
+    for (loop = 0; loop < BRLOCK_TEST_LOOP; loop++) {
+        (VOID)LOS_BrlockRdLock(&g_brlockTest1, LOS_WAIT_FOREVER);
+        (VOID)LOS_BrlockRdUnlock(&g_brlockTest1);
+    }
+    g_readerCycles[ArchCurrCpuid()] = HalClockGetCycles() - start;
+    LOS_AtomicInc(&g_testCount);
+}
+
+static VOID TaskRwlockReader(VOID)
+{
+    UINT64 start;
+    UINT32 loop;
+
+    LOS_AtomicInc(&g_testCount);
+    while (g_testCount < g_readerCores) { // 所有读者都到齐后再一起开始
+    }
+
+    start = HalClockGetCycles();
+    for (loop = 0; loop < BRLOCK_TEST_LOOP; loop++) {
+        (VOID)LOS_RwlockRdLock(&g_rwlockTest1, LOS_WAIT_FOREVER);
+        (VOID)LOS_RwlockUnLock(&g_rwlockTest1);
+    }
+    g_readerCycles[ArchCurrCpuid()] = HalClockGetCycles() - start;
+    LOS_AtomicInc(&g_testCount);
+}
+
+/* 在 cores 个核上各跑一个读者,返回平均每次加解读锁的周期数 */
+static UINT32 ReaderRun(TSK_ENTRY_FUNC entry, UINT32 cores, UINT64 *cyclesPerOp)
+{
+    TSK_INIT_PARAM_S testTask;
+    UINT32 testid;
+    UINT64 total = 0;
+    UINT32 cpuid;
+    UINT32 ret;
+
+    g_testCount = 0;
+    g_readerCores = cores;
+    /* 比测试任务优先级低, 本核上的读者要等测试任务让出CPU才开始, 不会卡住下面的创建 */
+    for (cpuid = 0; cpuid < cores; cpuid++) {
+        g_readerCycles[cpuid] = 0;
+        TEST_TASK_PARAM_INIT_AFFI(testTask, "it_smp_brlock_001", entry, TASK_PRIO_TEST + 1,
+            CPUID_TO_AFFI_MASK(cpuid));
+        ret = LOS_TaskCreate(&testid, &testTask);
+        if (ret != LOS_OK) {
+            g_readerCores = 0; /* 放行已经创建的读者 */
+            return ret;
+        }
+    }
+
+    while (g_testCount != (cores * 2)) { // 2, every reader counts once on start and once on exit
+        (VOID)LOS_TaskDelay(1);
+    }
+
+    for (cpuid = 0; cpuid < cores; cpuid++) {
+        total += g_readerCycles[cpuid];
+    }
+    *cyclesPerOp = total / ((UINT64)cores * BRLOCK_TEST_LOOP);
+    return LOS_OK;
+}
+
+static UINT32 Testcase(VOID)
+{
+    UINT64 brCycles, rwCycles;
+    UINT32 cores;
+    UINT32 ret;
+
+    ret = LOS_BrlockInit(&g_brlockTest1, LOS_BRLOCK_WRITER_PREFER);
+    ICUNIT_ASSERT_EQUAL(ret, LOS_OK, ret);
+
+    ret = LOS_RwlockInit(&g_rwlockTest1);
+    ICUNIT_GOTO_EQUAL(ret, LOS_OK, ret, EXIT);
+
+    dprintf("cores    brlock(cycles/op)    rwlock(cycles/op)\n");
+    for (cores = 1; cores <= LOSCFG_KERNEL_CORE_NUM; cores++) {
+        ret = ReaderRun((TSK_ENTRY_FUNC)TaskBrlockReader, cores, &brCycles);
+        ICUNIT_GOTO_EQUAL(ret, LOS_OK, ret, EXIT1);
+
+        ret = ReaderRun((TSK_ENTRY_FUNC)TaskRwlockReader, cores, &rwCycles);
+        ICUNIT_GOTO_EQUAL(ret, LOS_OK, ret, EXIT1);
+
+        dprintf("%-8u %-20llu %-20llu\n", cores, brCycles, rwCycles);
+    }
+
+EXIT1:
+    (VOID)LOS_RwlockDestroy(&g_rwlockTest1);
+EXIT:
+    (VOID)LOS_BrlockDestroy(&g_brlockTest1);
+    return LOS_OK;
+}
+
+VOID ItSmpLosBrlock001(void)
+{
+    TEST_ADD_CASE("ItSmpLosBrlock001", Testcase, TEST_LOS, TEST_RWLOCK, TEST_LEVEL2, TEST_PERFORMANCE);
+}
+
+#ifdef __cplusplus
+#if __cplusplus
+}
+#endif /* __cpluscplus */
+#endif /* __cpluscplus */
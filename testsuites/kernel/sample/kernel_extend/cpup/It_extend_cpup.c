@@ -91,6 +91,7 @@ VOID ItSuiteExtendCpup(VOID)
     ItExtendCpup008();
     ItExtendCpup011();
     ItExtendCpup012();
+    ItExtendCpup013();
 #endif
 
 #if defined(LOSCFG_TEST_LLT)
@@ -104,6 +104,7 @@ VOID ItExtendCpup007(VOID);
 VOID ItExtendCpup008(VOID);
 VOID ItExtendCpup011(VOID);
 VOID ItExtendCpup012(VOID);
+VOID ItExtendCpup013(VOID);
 #endif
 
 #if defined(LOSCFG_TEST_LLT)
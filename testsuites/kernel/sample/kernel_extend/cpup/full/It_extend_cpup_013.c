@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2013-2019 Huawei Technologies Co., Ltd. All rights reserved.
+ * Copyright (c) 2020-2021 Huawei Device Co., Ltd. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of
+ * conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used
+ * to endorse or promote products derived from this software without specific prior written
+ * permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "It_extend_cpup.h"
+
+#ifdef __cplusplus
+#if __cplusplus
+extern "C" {
+#endif /* __cpluscplus */
+#endif /* __cpluscplus */
+
+static UINT32 g_cpuTimeTaskID;
+
+static VOID TaskF01(VOID)
+{
+    LOS_Mdelay(100); // 100, busy loop for 100ms.
+    g_testCount++;
+}
+
+static UINT64 CpuTimeTotal(VOID)
+{
+    CPUP_CPU_TIME_S cpuTime;
+    UINT64 total = 0;
+    UINT16 cpuid;
+
+    for (cpuid = 0; cpuid < LOSCFG_KERNEL_CORE_NUM; cpuid++) {
+        if (LOS_CpupCpuTimeGet(cpuid, &cpuTime) != LOS_OK) {
+            return 0;
+        }
+        total += cpuTime.userTime + cpuTime.sysTime + cpuTime.irqTime + cpuTime.softirqTime + cpuTime.idleTime;
+    }
+    return total;
+}
+
+static UINT32 Testcase(VOID)
+{
+    UINT32 ret;
+    TSK_INIT_PARAM_S task = { 0 };
+    CPUP_TIME_S time1 = { 0 };
+    CPUP_TIME_S time2 = { 0 };
+    CPUP_CPU_TIME_S cpuTime;
+    UINT64 cpuTotal1, cpuTotal2;
+
+    ret = LOS_CpupCpuTimeGet(0, NULL);
+    ICUNIT_ASSERT_EQUAL(ret, LOS_ERRNO_CPUP_PTR_ERR, ret);
+    ret = LOS_CpupCpuTimeGet(LOSCFG_KERNEL_CORE_NUM, &cpuTime);
+    ICUNIT_ASSERT_EQUAL(ret, LOS_ERRNO_CPUP_ID_INVALID, ret);
+    ret = LOS_CpupTaskTimeGet(OS_INVALID_VALUE, &time1);
+    ICUNIT_ASSERT_EQUAL(ret, LOS_ERRNO_CPUP_ID_INVALID, ret);
+    ret = LOS_CpupProcessTimeGet(LOS_GetCurrProcessID(), NULL);
+    ICUNIT_ASSERT_EQUAL(ret, LOS_ERRNO_CPUP_PTR_ERR, ret);
+
+    g_testCount = 0;
+    task.pfnTaskEntry = (TSK_ENTRY_FUNC)TaskF01;
+    task.uwStackSize = LOS_TASK_MIN_STACK_SIZE;
+    task.pcName = "CpupTime013";
+    task.usTaskPrio = TASK_PRIO_TEST - 1;
+    task.uwResved = LOS_TASK_STATUS_DETACHED;
+#ifdef LOSCFG_KERNEL_SMP
+    task.usCpuAffiMask = CPUID_TO_AFFI_MASK(ArchCurrCpuid());
+#endif
+
+    cpuTotal1 = CpuTimeTotal();
+    ICUNIT_ASSERT_NOT_EQUAL(cpuTotal1, 0, cpuTotal1);
+
+    LOS_TaskLock();
+    ret = LOS_TaskCreate(&g_cpuTimeTaskID, &task);
+    ICUNIT_GOTO_EQUAL(ret, LOS_OK, ret, EXIT);
+    ret = LOS_CpupTaskTimeGet(g_cpuTimeTaskID, &time1);
+    ICUNIT_GOTO_EQUAL(ret, LOS_OK, ret, EXIT);
+    ICUNIT_GOTO_EQUAL(time1.userTime + time1.sysTime, 0, time1.sysTime, EXIT);
+    LOS_TaskUnlock();
+
+    /* the test task is preempted by TaskF01 here */
+    ICUNIT_ASSERT_EQUAL(g_testCount, 1, g_testCount);
+
+    ret = LOS_CpupProcessTimeGet(LOS_GetCurrProcessID(), &time1);
+    ICUNIT_ASSERT_EQUAL(ret, LOS_OK, ret);
+    LOS_Mdelay(10); // 10, busy loop for 10ms.
+    ret = LOS_CpupProcessTimeGet(LOS_GetCurrProcessID(), &time2);
+    ICUNIT_ASSERT_EQUAL(ret, LOS_OK, ret);
+
+    /* kernel process: all run time is system time, the running slice is counted too */
+    ICUNIT_ASSERT_EQUAL(time2.userTime, 0, time2.userTime);
+    ICUNIT_ASSERT_EQUAL((time2.sysTime > time1.sysTime), TRUE, time2.sysTime);
+
+    cpuTotal2 = CpuTimeTotal();
+    ICUNIT_ASSERT_EQUAL((cpuTotal2 > cpuTotal1), TRUE, cpuTotal2);
+
+    return LOS_OK;
+
+EXIT:
+    LOS_TaskUnlock();
+    return LOS_OK;
+}
+
+VOID ItExtendCpup013(VOID)
+{
+    TEST_ADD_CASE("ItExtendCpup013", Testcase, TEST_EXTEND, TEST_CPUP, TEST_LEVEL1, TEST_FUNCTION);
+}
+
+#ifdef __cplusplus
+#if __cplusplus
+}
+#endif /* __cpluscplus */
+#endif /* __cpluscplus */
@@ -390,6 +390,7 @@ VOID TestKernelBaseIpc(VOID)
     ItSuiteLosMux();
     ItSuiteLosSem();
     ItSuiteLosQueue();
+    ItSuiteLosRwlock();
 #endif
 }
 
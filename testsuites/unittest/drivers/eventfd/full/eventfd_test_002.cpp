@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2013-2019 Huawei Technologies Co., Ltd. All rights reserved.
+ * Copyright (c) 2020-2021 Huawei Device Co., Ltd. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of
+ * conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used
+ * to endorse or promote products derived from this software without specific prior written
+ * permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "it_test_eventfd.h"
+
+static int Testcase(VOID)
+{
+    int ret;
+    int fd = -1;
+    uint64_t value;
+    uint32_t shortValue = 1;
+    struct pollfd pfds[1];
+
+    fd = open(EVENTFD_DEV_PATH, O_RDWR | O_NONBLOCK, 0666);
+    ICUNIT_ASSERT_NOT_EQUAL(fd, -1, fd);
+
+    ret = write(fd, &shortValue, sizeof(shortValue));
+    ICUNIT_GOTO_EQUAL(ret, -1, ret, EXIT);
+    ICUNIT_GOTO_EQUAL(errno, EINVAL, errno, EXIT);
+
+    value = EVENTFD_COUNTER_MAX + 1;
+    ret = write(fd, &value, sizeof(value));
+    ICUNIT_GOTO_EQUAL(ret, -1, ret, EXIT);
+    ICUNIT_GOTO_EQUAL(errno, EINVAL, errno, EXIT);
+
+    /* fill the counter up to its maximum */
+    value = EVENTFD_COUNTER_MAX - 1;
+    ret = write(fd, &value, sizeof(value));
+    ICUNIT_GOTO_EQUAL(ret, sizeof(value), ret, EXIT);
+    value = 1;
+    ret = write(fd, &value, sizeof(value));
+    ICUNIT_GOTO_EQUAL(ret, sizeof(value), ret, EXIT);
+
+    /* a full counter is readable but not writable, and a write that would overflow fails */
+    pfds[0].fd = fd;
+    pfds[0].events = POLLIN | POLLOUT;
+    ret = poll(pfds, 1, 0);
+    ICUNIT_GOTO_EQUAL(ret, 1, ret, EXIT);
+    ICUNIT_GOTO_EQUAL(pfds[0].revents, POLLIN, pfds[0].revents, EXIT);
+
+    value = 1;
+    ret = write(fd, &value, sizeof(value));
+    ICUNIT_GOTO_EQUAL(ret, -1, ret, EXIT);
+    ICUNIT_GOTO_EQUAL(errno, EAGAIN, errno, EXIT);
+
+    /* writing 0 never overflows */
+    value = 0;
+    ret = write(fd, &value, sizeof(value));
+    ICUNIT_GOTO_EQUAL(ret, sizeof(value), ret, EXIT);
+
+    value = 0;
+    ret = read(fd, &value, sizeof(value));
+    ICUNIT_GOTO_EQUAL(ret, sizeof(value), ret, EXIT);
+    ICUNIT_GOTO_EQUAL((value == EVENTFD_COUNTER_MAX), 1, ret, EXIT);
+
+    /* the read made room again */
+    value = 1;
+    ret = write(fd, &value, sizeof(value));
+    ICUNIT_GOTO_EQUAL(ret, sizeof(value), ret, EXIT);
+
+    ret = close(fd);
+    ICUNIT_ASSERT_EQUAL(ret, 0, ret);
+    return 0;
+
+EXIT:
+    (void)close(fd);
+    return 0;
+}
+
+void ItTestEventfd002(void)
+{
+    TEST_ADD_CASE("IT_DRIVERS_EVENTFD_002", Testcase, TEST_LOS, TEST_DRIVERBASE, TEST_LEVEL0, TEST_FUNCTION);
+}
@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2013-2019 Huawei Technologies Co., Ltd. All rights reserved.
+ * Copyright (c) 2020-2021 Huawei Device Co., Ltd. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of
+ * conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used
+ * to endorse or promote products derived from this software without specific prior written
+ * permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "it_test_eventfd.h"
+#include "pthread.h"
+
+#define EVENTFD_POLL_WAIT_TIME 1000
+#define EVENTFD_WRITER_DELAY_US 10000
+
+static void *EventfdWriter(void *arg)
+{
+    int fd = *(int *)arg;
+    uint64_t value = 1;
+
+    usleep(EVENTFD_WRITER_DELAY_US);
+    (void)write(fd, &value, sizeof(value));
+    return NULL;
+}
+
+static int Testcase(VOID)
+{
+    int ret;
+    int fd = -1;
+    int fd2 = -1;
+    uint64_t value;
+    struct pollfd pfds[1];
+    pthread_t writer;
+
+    fd = open(EVENTFD_DEV_PATH, O_RDWR | O_NONBLOCK, 0666);
+    ICUNIT_ASSERT_NOT_EQUAL(fd, -1, fd);
+    fd2 = open(EVENTFD_DEV_PATH, O_RDWR | O_NONBLOCK, 0666);
+    ICUNIT_GOTO_NOT_EQUAL(fd2, -1, fd2, EXIT);
+
+    /* a new counter is 0: writable, not readable */
+    pfds[0].fd = fd;
+    pfds[0].events = POLLIN | POLLOUT;
+    ret = poll(pfds, 1, 0);
+    ICUNIT_GOTO_EQUAL(ret, 1, ret, EXIT);
+    ICUNIT_GOTO_EQUAL(pfds[0].revents, POLLOUT, pfds[0].revents, EXIT);
+
+    ret = read(fd, &value, sizeof(value));
+    ICUNIT_GOTO_EQUAL(ret, -1, ret, EXIT);
+    ICUNIT_GOTO_EQUAL(errno, EAGAIN, errno, EXIT);
+
+    /* writes add up, a read returns the sum and resets the counter */
+    value = 3; // 3, first increment
+    ret = write(fd, &value, sizeof(value));
+    ICUNIT_GOTO_EQUAL(ret, sizeof(value), ret, EXIT);
+    value = 4; // 4, second increment
+    ret = write(fd, &value, sizeof(value));
+    ICUNIT_GOTO_EQUAL(ret, sizeof(value), ret, EXIT);
+
+    pfds[0].events = POLLIN;
+    ret = poll(pfds, 1, 0);
+    ICUNIT_GOTO_EQUAL(ret, 1, ret, EXIT);
+    ICUNIT_GOTO_EQUAL(pfds[0].revents, POLLIN, pfds[0].revents, EXIT);
+
+    /* every open has its own counter */
+    pfds[0].fd = fd2;
+    ret = poll(pfds, 1, 0);
+    ICUNIT_GOTO_EQUAL(ret, 0, ret, EXIT);
+
+    value = 0;
+    ret = read(fd, &value, sizeof(value));
+    ICUNIT_GOTO_EQUAL(ret, sizeof(value), ret, EXIT);
+    ICUNIT_GOTO_EQUAL(value, 7, value, EXIT); // 7, 3 + 4
+
+    ret = read(fd, &value, sizeof(value));
+    ICUNIT_GOTO_EQUAL(ret, -1, ret, EXIT);
+    ICUNIT_GOTO_EQUAL(errno, EAGAIN, errno, EXIT);
+
+    /* a write from another thread wakes a blocked poll */
+    ret = pthread_create(&writer, NULL, EventfdWriter, &fd);
+    ICUNIT_GOTO_EQUAL(ret, 0, ret, EXIT);
+
+    pfds[0].fd = fd;
+    pfds[0].events = POLLIN;
+    ret = poll(pfds, 1, EVENTFD_POLL_WAIT_TIME);
+    (void)pthread_join(writer, NULL);
+    ICUNIT_GOTO_EQUAL(ret, 1, ret, EXIT);
+    ICUNIT_GOTO_EQUAL(pfds[0].revents, POLLIN, pfds[0].revents, EXIT);
+
+    ret = read(fd, &value, sizeof(value));
+    ICUNIT_GOTO_EQUAL(ret, sizeof(value), ret, EXIT);
+    ICUNIT_GOTO_EQUAL(value, 1, value, EXIT);
+
+    ret = close(fd2);
+    ICUNIT_GOTO_EQUAL(ret, 0, ret, EXIT);
+    ret = close(fd);
+    ICUNIT_ASSERT_EQUAL(ret, 0, ret);
+    return 0;
+
+EXIT:
+    if (fd2 != -1) {
+        (void)close(fd2);
+    }
+    (void)close(fd);
+    return 0;
+}
+
+void ItTestEventfd001(void)
+{
+    TEST_ADD_CASE("IT_DRIVERS_EVENTFD_001", Testcase, TEST_LOS, TEST_DRIVERBASE, TEST_LEVEL0, TEST_FUNCTION);
+}
@@ -153,6 +153,28 @@ HWTEST_F(MemVmTest, ItTestMmap010, TestSize.Level0)
     ItTestMmap010();
 }
 
+/* *
+ * @tc.name: it_test_mmap_011
+ * @tc.desc: function for MemVmTest
+ * @tc.type: FUNC
+ * @tc.require: AR000EEMQ9
+ */
+HWTEST_F(MemVmTest, ItTestMmap011, TestSize.Level0)
+{
+    ItTestMmap011();
+}
+
+/* *
+ * @tc.name: it_test_mmap_012
+ * @tc.desc: function for MemVmTest
+ * @tc.type: FUNC
+ * @tc.require: AR000EEMQ9
+ */
+HWTEST_F(MemVmTest, ItTestMmap012, TestSize.Level0)
+{
+    ItTestMmap012();
+}
+
 /* *
  * @tc.name: it_test_mprotect_001
  * @tc.desc: function for MemVmTest
@@ -164,6 +186,17 @@ HWTEST_F(MemVmTest, ItTestMprotect001, TestSize.Level0)
     ItTestMprotect001();
 }
 
+/* *
+ * @tc.name: it_test_madvise_001
+ * @tc.desc: function for MemVmTest
+ * @tc.type: FUNC
+ * @tc.require: AR000EEMQ9
+ */
+HWTEST_F(MemVmTest, ItTestMadvise001, TestSize.Level0)
+{
+    ItTestMadvise001();
+}
+
 #ifndef LOSCFG_USER_TEST_SMP
 /* *
  * @tc.name: it_test_oom_001
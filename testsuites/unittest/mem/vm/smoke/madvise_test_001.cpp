@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) 2013-2019 Huawei Technologies Co., Ltd. All rights reserved.
+ * Copyright (c) 2020-2021 Huawei Device Co., Ltd. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of
+ * conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used
+ * to endorse or promote products derived from this software without specific prior written
+ * permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "it_test_vm.h"
+
+#define PAGE_SIZE_TEST 0x1000
+#define MAP_PAGES      8
+#define MAP_LEN        (PAGE_SIZE_TEST * MAP_PAGES)
+
+static int FillPages(char *ptr)
+{
+    int i;
+
+    for (i = 0; i < MAP_PAGES; i++) {
+        (void)memset(ptr + i * PAGE_SIZE_TEST, i + 1, PAGE_SIZE_TEST);
+    }
+    return 0;
+}
+
+/* DONTNEED drops the pages but keeps the mapping, FREE keeps data that is written again */
+static int AnonTest(void)
+{
+    int ret;
+    int i;
+    char *ptr = NULL;
+
+    ptr = (char *)mmap(NULL, MAP_LEN, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+    ICUNIT_ASSERT_NOT_EQUAL(ptr, MAP_FAILED, ptr);
+    (void)FillPages(ptr);
+
+    ret = madvise(ptr + PAGE_SIZE_TEST * 2, PAGE_SIZE_TEST * 2, MADV_DONTNEED);
+    ICUNIT_GOTO_EQUAL(ret, 0, ret, EXIT);
+    ICUNIT_GOTO_EQUAL(ptr[PAGE_SIZE_TEST * 2], 0, ptr[PAGE_SIZE_TEST * 2], EXIT);
+    ICUNIT_GOTO_EQUAL(ptr[PAGE_SIZE_TEST * 4 - 1], 0, ptr[PAGE_SIZE_TEST * 4 - 1], EXIT);
+    ICUNIT_GOTO_EQUAL(ptr[PAGE_SIZE_TEST], 2, ptr[PAGE_SIZE_TEST], EXIT);
+    ICUNIT_GOTO_EQUAL(ptr[PAGE_SIZE_TEST * 4], 5, ptr[PAGE_SIZE_TEST * 4], EXIT);
+    ptr[PAGE_SIZE_TEST * 2] = 0x5a;
+    ICUNIT_GOTO_EQUAL(ptr[PAGE_SIZE_TEST * 2], 0x5a, ptr[PAGE_SIZE_TEST * 2], EXIT);
+
+    (void)FillPages(ptr);
+    ret = madvise(ptr, MAP_LEN, MADV_FREE);
+    ICUNIT_GOTO_EQUAL(ret, 0, ret, EXIT);
+    ptr[0] = 0x5a;
+    for (i = 1; i < MAP_PAGES; i++) {
+        /* an untouched page either survived or was reclaimed and reads as zero */
+        if ((ptr[i * PAGE_SIZE_TEST] != (char)(i + 1)) && (ptr[i * PAGE_SIZE_TEST] != 0)) {
+            goto EXIT;
+        }
+    }
+    ICUNIT_GOTO_EQUAL(ptr[0], 0x5a, ptr[0], EXIT);
+    ICUNIT_GOTO_EQUAL(ptr[1], 1, ptr[1], EXIT);
+
+    ret = madvise(ptr, MAP_LEN, 0x7f);
+    ICUNIT_GOTO_EQUAL(ret, -1, ret, EXIT);
+    ICUNIT_GOTO_EQUAL(errno, EINVAL, errno, EXIT);
+    ret = madvise(ptr + 1, PAGE_SIZE_TEST, MADV_DONTNEED);
+    ICUNIT_GOTO_EQUAL(ret, -1, ret, EXIT);
+    ICUNIT_GOTO_EQUAL(errno, EINVAL, errno, EXIT);
+
+    ret = munmap(ptr, MAP_LEN);
+    ICUNIT_ASSERT_EQUAL(ret, 0, ret);
+    return 0;
+
+EXIT:
+    (void)munmap(ptr, MAP_LEN);
+    return -1;
+}
+
+/* access pattern hints and WILLNEED on a file mapping must not change what is read */
+static int FileTest(void)
+{
+    int fd, ret;
+    char *ptr = NULL;
+    char buf[PAGE_SIZE_TEST];
+
+    fd = open("/bin/init", O_RDONLY);
+    if (fd < 0) {
+        return 0; /* not part of this image */
+    }
+    ret = read(fd, buf, sizeof(buf));
+    ICUNIT_GOTO_EQUAL(ret, sizeof(buf), ret, EXIT1);
+    ptr = (char *)mmap(NULL, PAGE_SIZE_TEST, PROT_READ, MAP_PRIVATE, fd, 0);
+    ICUNIT_GOTO_NOT_EQUAL(ptr, MAP_FAILED, ptr, EXIT1);
+
+    ret = madvise(ptr, PAGE_SIZE_TEST, MADV_WILLNEED);
+    ICUNIT_GOTO_EQUAL(ret, 0, ret, EXIT);
+    ret = madvise(ptr, PAGE_SIZE_TEST, MADV_SEQUENTIAL);
+    ICUNIT_GOTO_EQUAL(ret, 0, ret, EXIT);
+    ret = memcmp(ptr, buf, PAGE_SIZE_TEST);
+    ICUNIT_GOTO_EQUAL(ret, 0, ret, EXIT);
+
+    ret = madvise(ptr, PAGE_SIZE_TEST, MADV_DONTNEED);
+    ICUNIT_GOTO_EQUAL(ret, 0, ret, EXIT);
+    ret = madvise(ptr, PAGE_SIZE_TEST, MADV_RANDOM);
+    ICUNIT_GOTO_EQUAL(ret, 0, ret, EXIT);
+    ret = memcmp(ptr, buf, PAGE_SIZE_TEST);
+    ICUNIT_GOTO_EQUAL(ret, 0, ret, EXIT);
+    ret = madvise(ptr, PAGE_SIZE_TEST, MADV_NORMAL);
+    ICUNIT_GOTO_EQUAL(ret, 0, ret, EXIT);
+
+    (void)munmap(ptr, PAGE_SIZE_TEST);
+    (void)close(fd);
+    return 0;
+
+EXIT:
+    (void)munmap(ptr, PAGE_SIZE_TEST);
+EXIT1:
+    (void)close(fd);
+    return -1;
+}
+
+static int Testcase(void)
+{
+    int ret;
+
+    ret = AnonTest();
+    ICUNIT_ASSERT_EQUAL(ret, 0, ret);
+    ret = FileTest();
+    ICUNIT_ASSERT_EQUAL(ret, 0, ret);
+    return 0;
+}
+
+void ItTestMadvise001(void)
+{
+    TEST_ADD_CASE("IT_MEM_MADVISE_001", Testcase, TEST_LOS, TEST_MEM, TEST_LEVEL0, TEST_FUNCTION);
+}
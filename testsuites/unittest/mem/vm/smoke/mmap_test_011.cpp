@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2013-2019 Huawei Technologies Co., Ltd. All rights reserved.
+ * Copyright (c) 2020-2021 Huawei Device Co., Ltd. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of
+ * conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used
+ * to endorse or promote products derived from this software without specific prior written
+ * permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "it_test_vm.h"
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#define PAGE_SIZE_TEST 0x1000
+#define US_PER_SEC     1000000
+#define NS_PER_US      1000
+
+static const char *g_startupFiles[] = { "/bin/init", "/bin/shell" };
+
+static long long NowUs(void)
+{
+    struct timespec ts = { 0 };
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * US_PER_SEC + ts.tv_nsec / NS_PER_US;
+}
+
+/* Map the file and touch every page the way the init and shell processes fault in their
+ * images. The first pass fills the page cache one fault per page; on the second pass the
+ * pages are cached, so fault-around maps the neighbours with each fault. The content must
+ * match the file either way. */
+static int MapAndTouch(const char *path, const char *buf, size_t size, const char *pass)
+{
+    int fd, ret;
+    volatile char *ptr = NULL;
+    size_t offset;
+    long long start, cost;
+    unsigned int sum = 0;
+
+    fd = open(path, O_RDONLY);
+    ICUNIT_ASSERT_NOT_EQUAL(fd, -1, fd);
+    ptr = (volatile char *)mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    (void)close(fd);
+    ICUNIT_ASSERT_NOT_EQUAL(ptr, MAP_FAILED, ptr);
+
+    start = NowUs();
+    for (offset = 0; offset < size; offset += PAGE_SIZE_TEST) {
+        sum += (unsigned char)ptr[offset];
+    }
+    cost = NowUs() - start;
+    printf("%s %s: %u pages touched in %lld us (sum %u)\n", path, pass,
+           (unsigned int)((size + PAGE_SIZE_TEST - 1) / PAGE_SIZE_TEST), cost, sum);
+
+    ret = memcmp((const void *)ptr, buf, size);
+    (void)munmap((void *)ptr, size);
+    ICUNIT_ASSERT_EQUAL(ret, 0, ret);
+    return 0;
+}
+
+static int StartupFileTest(const char *path)
+{
+    int fd, ret;
+    struct stat st = { 0 };
+    char *buf = NULL;
+
+    fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return 0; /* not part of this image */
+    }
+    ret = fstat(fd, &st);
+    ICUNIT_GOTO_EQUAL(ret, 0, ret, EXIT);
+    ICUNIT_GOTO_NOT_EQUAL(st.st_size, 0, st.st_size, EXIT);
+
+    buf = (char *)malloc(st.st_size);
+    ICUNIT_GOTO_NOT_EQUAL(buf, NULL, buf, EXIT);
+    ret = read(fd, buf, st.st_size);
+    ICUNIT_GOTO_EQUAL(ret, st.st_size, ret, EXIT1);
+
+    ret = MapAndTouch(path, buf, st.st_size, "cold");
+    ICUNIT_GOTO_EQUAL(ret, 0, ret, EXIT1);
+    ret = MapAndTouch(path, buf, st.st_size, "warm");
+    ICUNIT_GOTO_EQUAL(ret, 0, ret, EXIT1);
+
+    free(buf);
+    (void)close(fd);
+    return 0;
+
+EXIT1:
+    free(buf);
+EXIT:
+    (void)close(fd);
+    return -1;
+}
+
+static int Testcase(void)
+{
+    int ret;
+    unsigned int i;
+
+    for (i = 0; i < sizeof(g_startupFiles) / sizeof(g_startupFiles[0]); i++) {
+        ret = StartupFileTest(g_startupFiles[i]);
+        ICUNIT_ASSERT_EQUAL(ret, 0, ret);
+    }
+
+    return 0;
+}
+
+void ItTestMmap011(void)
+{
+    TEST_ADD_CASE("IT_MEM_MMAP_011", Testcase, TEST_LOS, TEST_MEM, TEST_LEVEL0, TEST_FUNCTION);
+}
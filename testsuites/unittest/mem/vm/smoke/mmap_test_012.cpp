@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2013-2019 Huawei Technologies Co., Ltd. All rights reserved.
+ * Copyright (c) 2020-2021 Huawei Device Co., Ltd. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of
+ * conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used
+ * to endorse or promote products derived from this software without specific prior written
+ * permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "it_test_vm.h"
+
+#define SECTION_SIZE_TEST 0x100000
+#define PAGE_SIZE_TEST    0x1000
+#define MAP_LEN           (SECTION_SIZE_TEST * 4)
+
+static int CheckPages(const char *ptr, size_t start, size_t end, size_t hole)
+{
+    size_t offset;
+
+    for (offset = start; offset < end; offset += PAGE_SIZE_TEST) {
+        if (offset == hole) {
+            continue;
+        }
+        if (ptr[offset] != (char)(offset / PAGE_SIZE_TEST)) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/* Huge page mapping: fill it, then split sections with a partial munmap and mprotect */
+static int Testcase(void)
+{
+    int ret;
+    char *ptr = NULL;
+    size_t offset;
+    size_t hole = SECTION_SIZE_TEST + PAGE_SIZE_TEST * 3;
+    size_t roPage = SECTION_SIZE_TEST * 2 + PAGE_SIZE_TEST * 7;
+
+    ptr = (char *)mmap(NULL, MAP_LEN, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE | MAP_HUGETLB, -1, 0);
+    ICUNIT_ASSERT_NOT_EQUAL(ptr, MAP_FAILED, ptr);
+
+    for (offset = 0; offset < MAP_LEN; offset += PAGE_SIZE_TEST) {
+        ICUNIT_GOTO_EQUAL(ptr[offset], 0, ptr[offset], EXIT);
+        ptr[offset] = (char)(offset / PAGE_SIZE_TEST);
+    }
+
+    ret = munmap(ptr + hole, PAGE_SIZE_TEST);
+    ICUNIT_GOTO_EQUAL(ret, 0, ret, EXIT);
+    ret = mprotect(ptr + roPage, PAGE_SIZE_TEST, PROT_READ);
+    ICUNIT_GOTO_EQUAL(ret, 0, ret, EXIT);
+
+    ret = CheckPages(ptr, 0, MAP_LEN, hole);
+    ICUNIT_GOTO_EQUAL(ret, 0, ret, EXIT);
+
+    /* the pages next to the split ones are still writable */
+    ptr[roPage - PAGE_SIZE_TEST] = 0x5a;
+    ptr[hole + PAGE_SIZE_TEST] = 0x5a;
+    ICUNIT_GOTO_EQUAL(ptr[roPage - PAGE_SIZE_TEST], 0x5a, ptr[roPage - PAGE_SIZE_TEST], EXIT);
+
+    ret = munmap(ptr, hole);
+    ICUNIT_ASSERT_EQUAL(ret, 0, ret);
+    ret = munmap(ptr + hole + PAGE_SIZE_TEST, MAP_LEN - hole - PAGE_SIZE_TEST);
+    ICUNIT_ASSERT_EQUAL(ret, 0, ret);
+    return 0;
+
+EXIT:
+    (void)munmap(ptr, MAP_LEN);
+    return -1;
+}
+
+void ItTestMmap012(void)
+{
+    TEST_ADD_CASE("IT_MEM_MMAP_012", Testcase, TEST_LOS, TEST_MEM, TEST_LEVEL0, TEST_FUNCTION);
+}
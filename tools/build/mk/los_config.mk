@@ -393,6 +393,12 @@ ifeq ($(LOSCFG_DRIVERS_QUICKSTART), y)
     LITEOS_DEV_QUICKSTART_INCLUDE = -I $(LITEOSTOPDIR)/drivers/char/quickstart/include
 endif
 
+ifeq ($(LOSCFG_DRIVERS_EVENTFD), y)
+    LITEOS_BASELIB += -leventfd_dev
+    LIB_SUBDIRS       += $(LITEOSTOPDIR)/drivers/char/eventfd
+    LITEOS_DEV_EVENTFD_INCLUDE = -I $(LITEOSTOPDIR)/drivers/char/eventfd/include
+endif
+
 ifeq ($(LOSCFG_DRIVERS_RANDOM), y)
     LITEOS_BASELIB += -lrandom
     LIB_SUBDIRS    += $(LITEOSTOPDIR)/drivers/char/random
@@ -539,7 +545,8 @@ LITEOS_DRIVERS_INCLUDE     := $(LITEOS_CELLWISE_INCLUDE)   $(LITEOS_GPIO_INCLUDE
                               $(LITEOS_REGULATOR_INCLUDE)  $(LITEOS_VIDEO_INCLUDE) \
                               $(LITEOS_DRIVERS_HDF_INCLUDE) $(LITEOS_TZDRIVER_INCLUDE) \
                               $(LITEOS_HIEVENT_INCLUDE)    $(LITEOS_DEV_MEM_INCLUDE) \
-                              $(LITEOS_DEV_QUICKSTART_INCLUDE) $(LITEOS_DEV_PERF_INCLUDE)
+                              $(LITEOS_DEV_QUICKSTART_INCLUDE) $(LITEOS_DEV_PERF_INCLUDE) \
+                              $(LITEOS_DEV_EVENTFD_INCLUDE)
 LITEOS_DFX_INCLUDE    := $(LITEOS_HILOG_INCLUDE) \
                          $(LITEOS_BLACKBOX_INCLUDE) \
                          $(LITEOS_HIDUMPER_INCLUDE)